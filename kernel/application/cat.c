@@ -34,26 +34,45 @@ void app_cat(void) {
 
     if (i >= argc) { print_usage(); return; }
 
-    // Static buffer for reading files
-    static uint8_t buf[64 * 1024]; // 64 KiB
+    // Files are streamed through a small buffer; whole-file reads remain as
+    // a fallback for filesystems without descriptor support
+    static uint8_t buf[4096];
 
     for (; i < argc; ++i) {
         const int8_t* path = kos_argv(i);
         if (!path || !path[0]) continue;
-        int32_t n = kos_readfile(path, buf, sizeof(buf));
-        if (n < 0) {
-            kos_puts((const int8_t*)"cat: cannot read file: ");
-            kos_puts(path);
-            kos_puts((const int8_t*)"\n");
-            continue;
-        }
-        // Print exactly n bytes
-        for (int32_t k = 0; k < n; ++k) {
-            kos_putc((int8_t)buf[k]);
+        int32_t total = 0;
+        uint8_t last = 0;
+        int32_t fd = kos_open(path, KOS_O_READ);
+        if (fd >= 0) {
+            int32_t n;
+            while ((n = kos_read(fd, buf, sizeof(buf))) > 0) {
+                for (int32_t k = 0; k < n; ++k) kos_putc((int8_t)buf[k]);
+                total += n;
+                last = buf[n - 1];
+            }
+            kos_close(fd);
+            if (n < 0) {
+                kos_puts((const int8_t*)"\ncat: read error: ");
+                kos_puts(path);
+                kos_puts((const int8_t*)"\n");
+                continue;
+            }
+        } else {
+            static uint8_t whole[64 * 1024]; // 64 KiB
+            total = kos_readfile(path, whole, sizeof(whole));
+            if (total < 0) {
+                kos_puts((const int8_t*)"cat: cannot read file: ");
+                kos_puts(path);
+                kos_puts((const int8_t*)"\n");
+                continue;
+            }
+            for (int32_t k = 0; k < total; ++k) kos_putc((int8_t)whole[k]);
+            if (total > 0) last = whole[total - 1];
         }
         // If multiple files, add a trailing newline between files (only if file didn't end with one)
         if (i + 1 < argc) {
-            if (n == 0 || buf[n-1] != '\n') kos_putc('\n');
+            if (total == 0 || last != '\n') kos_putc('\n');
         }
     }
 }
@@ -1,5 +1,6 @@
 // Real hardware reboot for KOS
-#include <stdint.h>
+#include <lib/libc/stdio.h>
+#include <lib/libc/stdint.h>
 #include "app.h"
 
 static void outb(uint16_t port, uint8_t val) {
@@ -20,6 +21,8 @@ static void reboot_hw() {
 }
 
 void app_reboot(void) {
+    // Cached disk writes would be lost on reset
+    kos_sync();
     reboot_hw();
 }
 
@@ -55,6 +55,9 @@ void app_shutdown(void) {
         // Accept and ignore "now" and any trailing message (not implemented yet)
     }
 
+    // Cached disk writes would be lost on reset
+    kos_sync();
+
     if (do_reboot) {
         kos_puts((const int8_t*)"Rebooting...\n");
         // Inline reboot to avoid linking against separate reboot app
@@ -21,8 +21,34 @@ struct ProcInfo {
     uint32_t prio;
     uint32_t time;
     char name[32];
+    // TSC accounting (optional trailing fields)
+    uint32_t run_ms;
+    uint32_t wait_ms;
+    uint32_t vol;
+    uint32_t invol;
+    int has_acct;
 };
 
+// Wakeup-to-run latency per priority, from "# LAT" lines
+#define LAT_PRIOS   5
+#define LAT_BUCKETS 16
+struct LatInfo {
+    uint32_t samples;
+    uint32_t max_us;
+    uint32_t buckets[LAT_BUCKETS];
+};
+
+// Column layout (offsets from the left edge inside the table box)
+#define COL_PID    0
+#define COL_STATE  7
+#define COL_PRIO   16
+#define COL_TICKS  21
+#define COL_RUN    28
+#define COL_WAIT   36
+#define COL_VCSW   44
+#define COL_ICSW   50
+#define COL_NAME   57
+
 static void format_size_kb(uint32_t kb, char* out, int outsz) {
     if (outsz <= 0) return;
     if (kb < 1024u) {
@@ -111,7 +137,8 @@ static void draw_bar_line(uint32_t y, const char* label, int percent) {
 }
 
 int parse_line(const char* line, struct ProcInfo* info) {
-    // Expected: "<pid> <state> <prio> <time> <name>"; return 5 only when all parsed
+    // Expected: "<pid> <state> <prio> <time> <name> [<run_ms> <wait_ms> <vol> <invol>]";
+    // return 5 only when the first five fields parsed
     if (!line || !info) return 0;
     const char* p = line;
     // Skip leading spaces and reject if first non-space isn't a digit
@@ -150,9 +177,60 @@ int parse_line(const char* line, struct ProcInfo* info) {
     info->name[i] = 0;
     if (!got_name) return 0;
 
+    // Optional: "<run_ms> <wait_ms> <vol> <invol>"
+    uint32_t extra[4]; int got_extra = 0;
+    while (got_extra < 4) {
+        while (*p == ' ' || *p == '\t') ++p;
+        if (*p < '0' || *p > '9') break;
+        extra[got_extra] = 0;
+        while (*p >= '0' && *p <= '9') { extra[got_extra] = extra[got_extra] * 10 + (uint32_t)(*p - '0'); ++p; }
+        got_extra++;
+    }
+    info->has_acct = (got_extra == 4);
+    info->run_ms = info->has_acct ? extra[0] : 0;
+    info->wait_ms = info->has_acct ? extra[1] : 0;
+    info->vol = info->has_acct ? extra[2] : 0;
+    info->invol = info->has_acct ? extra[3] : 0;
+
     return 5;
 }
 
+// Parse "# LAT <prio> <samples> <max_us> <b0> ... <b15>"; returns 1 on success
+static int parse_lat_line(const char* line, struct LatInfo* lat) {
+    const char* p = line;
+    if (p[0] != '#') return 0;
+    ++p;
+    while (*p == ' ') ++p;
+    if (strncmp(p, "LAT", 3) != 0) return 0;
+    p += 3;
+    uint32_t vals[3 + LAT_BUCKETS]; int n = 0;
+    while (n < 3 + LAT_BUCKETS) {
+        while (*p == ' ') ++p;
+        if (*p < '0' || *p > '9') break;
+        vals[n] = 0;
+        while (*p >= '0' && *p <= '9') { vals[n] = vals[n] * 10 + (uint32_t)(*p - '0'); ++p; }
+        n++;
+    }
+    if (n != 3 + LAT_BUCKETS || vals[0] >= LAT_PRIOS) return 0;
+    struct LatInfo* l = &lat[vals[0]];
+    l->samples = vals[1];
+    l->max_us = vals[2];
+    for (int b = 0; b < LAT_BUCKETS; ++b) l->buckets[b] = vals[3 + b];
+    return 1;
+}
+
+// Upper bound (in us) of the bucket holding the given percentile
+static uint32_t lat_percentile_us(const struct LatInfo* l, uint32_t pct) {
+    if (l->samples == 0) return 0;
+    uint32_t want = (l->samples * pct + 99u) / 100u;
+    uint32_t seen = 0;
+    for (int b = 0; b < LAT_BUCKETS; ++b) {
+        seen += l->buckets[b];
+        if (seen >= want) return (b == LAT_BUCKETS - 1) ? l->max_us : (1u << b);
+    }
+    return l->max_us;
+}
+
 static void print_padded_at(uint32_t x, uint32_t y, const char* s, int width) {
     uint32_t rows, cols; kc_getmaxyx(&rows, &cols);
     if (y >= rows) y = (rows ? rows - 1 : 0);
@@ -197,6 +275,8 @@ int top_main(int argc, char** argv) {
     static char diag_lines[5][160];
     static uint32_t diag_count = 0;
     static int diag_enabled = 0; // toggled by 'D'
+    static int lat_enabled = 0;  // toggled by 'L'
+    static struct LatInfo lat[LAT_PRIOS];
     // For CPU meter based on scheduler time deltas
     static uint32_t prev_sum_time = 0;
     static uint32_t prev_idle_time = 0;
@@ -319,10 +399,10 @@ int top_main(int argc, char** argv) {
             // Write labels centered-ish
             kc_set_color(15, 11); // white on cyan
             kc_move(table_x + 2, table_y + 1);
-            const char* chead = "PID  STATE   PRIO  TIME   NAME";
+            const char* chead = "  PID  STATE    PRIO  TICKS   RUNms  WAITms  VCSW  ICSW  NAME";
             int chlen = (int)strlen(chead);
             if (chlen > (int)inner_w) chlen = (int)inner_w;
-            char chbuf[64];
+            char chbuf[80];
             int ccopy = chlen;
             if (ccopy >= (int)sizeof(chbuf)) ccopy = (int)sizeof(chbuf) - 1;
             memcpy(chbuf, chead, (size_t)ccopy);
@@ -361,6 +441,16 @@ int top_main(int argc, char** argv) {
                 if (*pp == '\n' && savedc == '\r') ++pp;
             }
         }
+        // Latency trailer lines sit after the task rows; scan for them up front
+        // so a full table does not cut them off
+        {
+            const char* lp = buffer;
+            while (*lp) {
+                if (*lp == '#') parse_lat_line(lp, lat);
+                while (*lp && *lp != '\n') ++lp;
+                if (*lp == '\n') ++lp;
+            }
+        }
         // Iterate lines & accumulate CPU times (for meter)
         // Render rows inside box with fixed positions (diff-based updates)
         uint32_t max_rows = (table_h >= 3) ? (table_h - 3) : 0; // header + top/bottom borders
@@ -377,9 +467,13 @@ int top_main(int argc, char** argv) {
             char saved = *p; *p = 0;
 
             struct ProcInfo info;
-            if (parse_line(line, &info) == 5) {
-                sum_time += (uint64_t)info.time;
-                if (strcmp(info.name, "idle-thread") == 0) idle_time = (uint64_t)info.time;
+            if (line[0] == '#') {
+                // Scheduler statistics trailer, not a table row
+            } else if (parse_line(line, &info) == 5) {
+                // Prefer cycle-accurate run time; tick counts miss short bursts
+                uint32_t t = info.has_acct ? info.run_ms : info.time;
+                sum_time += t;
+                if (strcmp(info.name, "idle-thread") == 0) idle_time = t;
                 uint8_t fg = 7;
                 if (strcmp(info.state, "RUNNING") == 0) fg = 10;
                 else if (strcmp(info.state, "READY") == 0) fg = 11;
@@ -392,17 +486,10 @@ int top_main(int argc, char** argv) {
                 uint32_t x = table_x + 2;
                 // Compose a single row string for diff comparison
                 char rowtxt[128];
-                // Build a comparable row text with manual padding to avoid unsupported printf widths
-                {
-                    char pid_s[16]; snprintf(pid_s, sizeof(pid_s), "%u", (unsigned)info.pid);
-                    char prio_s[16]; snprintf(prio_s, sizeof(prio_s), "%u", (unsigned)info.prio);
-                    char time_s[16]; snprintf(time_s, sizeof(time_s), "%u", (unsigned)info.time);
-                    // left pad to widths 5,2,6
-                    char pid_p[8]; int pid_pad = 5 - (int)strlen(pid_s); if (pid_pad < 0) pid_pad = 0; int pi = 0; for (; pi < pid_pad && pi < 7; ++pi) pid_p[pi] = ' '; pid_p[pi] = 0; strncat(pid_p, pid_s, sizeof(pid_p)-1 - (size_t)pi);
-                    char prio_p[4]; int pr_pad = 2 - (int)strlen(prio_s); if (pr_pad < 0) pr_pad = 0; int ppi = 0; for (; ppi < pr_pad && ppi < 3; ++ppi) prio_p[ppi] = ' '; prio_p[ppi] = 0; strncat(prio_p, prio_s, sizeof(prio_p)-1 - (size_t)ppi);
-                    char time_p[10]; int t_pad = 6 - (int)strlen(time_s); if (t_pad < 0) t_pad = 0; int ti = 0; for (; ti < t_pad && ti < 9; ++ti) time_p[ti] = ' '; time_p[ti] = 0; strncat(time_p, time_s, sizeof(time_p)-1 - (size_t)ti);
-                    snprintf(rowtxt, sizeof(rowtxt), "%s  %-8s  %s   %s  %s", pid_p, info.state, prio_p, time_p, info.name);
-                }
+                snprintf(rowtxt, sizeof(rowtxt), "%u %s %u %u %u %u %u %u %s",
+                         (unsigned)info.pid, info.state, (unsigned)info.prio, (unsigned)info.time,
+                         (unsigned)info.run_ms, (unsigned)info.wait_ms,
+                         (unsigned)info.vol, (unsigned)info.invol, info.name);
                 // Only rewrite if content changed
                 if (row_index >= prev_rows_count || strcmp(prev_rows_buf[row_index], rowtxt) != 0) {
                     // Update stored copy
@@ -411,26 +498,26 @@ int top_main(int argc, char** argv) {
                     memcpy(prev_rows_buf[row_index], rowtxt, rl);
                     prev_rows_buf[row_index][rl] = 0;
 
-                    // Draw with minimal color changes and prevent wrapping
+                    uint32_t inner_w = (table_w > 4) ? (table_w - 4) : table_w; // width inside box
+                    uint32_t name_x = x + COL_NAME;
+                    // Blank the numeric columns first so the gaps never keep stale digits
                     kc_set_color(fg, 0);
                     kc_move(x, y);
-                    // PID
-                    print_uint_padded_at(x, y, (unsigned)info.pid, 5);
-                    kc_move(x + 5, y); kc_addstr("  ");
-                    // STATE
-                    print_padded_at(x + 7, y, info.state, 8);
+                    for (uint32_t i = x; i < name_x && i < table_x + 2 + inner_w; ++i) kc_addch(' ');
+                    print_uint_padded_at(x + COL_PID, y, (unsigned)info.pid, 5);
+                    print_padded_at(x + COL_STATE, y, info.state, 8);
                     // PRIO (colorized)
                     uint8_t prfg = (info.prio <= 1 ? 10 : (info.prio <= 3 ? 14 : 12));
                     kc_set_color(prfg, 0);
-                    print_uint_padded_at(x + 7 + 8 + 2, y, (unsigned)info.prio, 2);
-                    // TIME and NAME
+                    print_uint_padded_at(x + COL_PRIO, y, (unsigned)info.prio, 4);
                     kc_set_color(fg, 0);
-                    // TIME
-                    char spaces3[] = "   "; kc_move(x + 7 + 8 + 2, y); kc_addstr(spaces3);
-                    print_uint_padded_at(x + 7 + 8 + 2 + 3, y, (unsigned)info.time, 6);
-                    kc_move(x + 7 + 8 + 2 + 3 + 6, y); kc_addstr("  ");
-                    uint32_t inner_w = (table_w > 4) ? (table_w - 4) : table_w; // width inside box
-                    uint32_t name_x = x + 7 + 8 + 2 + 3 + 8 + 2; // after time and two spaces
+                    print_uint_padded_at(x + COL_TICKS, y, (unsigned)info.time, 6);
+                    if (info.has_acct) {
+                        print_uint_padded_at(x + COL_RUN, y, (unsigned)info.run_ms, 7);
+                        print_uint_padded_at(x + COL_WAIT, y, (unsigned)info.wait_ms, 7);
+                        print_uint_padded_at(x + COL_VCSW, y, (unsigned)info.vol, 5);
+                        print_uint_padded_at(x + COL_ICSW, y, (unsigned)info.invol, 5);
+                    }
                     kc_move(name_x, y);
                     // Truncate and pad NAME to avoid wrapping beyond box
                     int remaining = (int)(table_x + 2 + inner_w - name_x);
@@ -581,7 +668,7 @@ int top_main(int argc, char** argv) {
         // Write key labels with contrasting colors
         kc_set_color(15, 9); // white on blue
         kc_move(1, fy);
-        const char* keys = "F1 Help  F2 Setup  F3 Search  F4 Filter  F5 Tree  F6 SortBy  F7 Nice -  F8 Nice +  F9 Kill  F10 Quit   D Diagnostics";
+        const char* keys = "F1 Help  F2 Setup  F3 Search  F4 Filter  F5 Tree  F6 SortBy  F7 Nice -  F8 Nice +  F9 Kill  F10 Quit   D Diagnostics  L Latency";
         int klen = (int)strlen(keys);
         // keep at most cols-2 to avoid touching last column on bottom row
         if (klen > (int)cols - 2) klen = (int)cols - 2;
@@ -594,8 +681,28 @@ int top_main(int argc, char** argv) {
             kc_addstr(kbuf);
         }
         kc_set_color(7, 0);
+        // Latency area: one line per priority with wakeup-to-run percentiles
+        if (lat_enabled && rows >= LAT_PRIOS + 1) {
+            for (int i = 0; i < LAT_PRIOS; ++i) {
+                uint32_t dy = fy - (uint32_t)(LAT_PRIOS - i);
+                const struct LatInfo* l = &lat[i];
+                char lbuf[160];
+                snprintf(lbuf, sizeof(lbuf), "LAT P%u  n=%u  p50<=%uus  p99<=%uus  max=%uus",
+                         (unsigned)i, (unsigned)l->samples,
+                         (unsigned)lat_percentile_us(l, 50), (unsigned)lat_percentile_us(l, 99),
+                         (unsigned)l->max_us);
+                int maxlen = (int)cols - 1; // avoid last column
+                int llen = (int)strlen(lbuf);
+                if (llen > maxlen) { llen = maxlen; lbuf[llen] = 0; }
+                kc_set_color(15, 0);
+                kc_move(0, dy);
+                kc_addstr(lbuf);
+                for (int j = llen; j < maxlen; ++j) kc_addch(' ');
+            }
+            kc_set_color(7, 0);
+        }
         // Diagnostics area: show up to 5 raw lines when enabled
-        if (diag_enabled && rows >= 2) {
+        if (diag_enabled && !lat_enabled && rows >= 2) {
             if (diag_count == 0) {
                 // Show placeholder to confirm diagnostics are enabled
                 uint32_t dy = (fy > 0) ? (fy - 1) : 0;
@@ -650,6 +757,11 @@ int top_main(int argc, char** argv) {
         if (kos_key_poll(&ch)) {
             if (ch == 'q' || ch == 'Q' || ch == 3) { kc_set_color(7,0); kc_move(0, rows-1); kc_addstr("Exiting top    "); kc_refresh(); return 0; }
             if (ch == 'd' || ch == 'D') { diag_enabled = !diag_enabled; }
+            if (ch == 'l' || ch == 'L') {
+                lat_enabled = !lat_enabled;
+                // Force a full redraw so the overlay does not linger in the table
+                prev_rows = 0; prev_rows_count = 0;
+            }
         }
     }
     return 0;
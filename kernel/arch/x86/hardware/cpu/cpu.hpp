@@ -28,6 +28,20 @@ namespace kos {
                             static void GetCpuInfo(CpuInfo& info);
                             static void PrintCpuInfo();
 
+                            // CPUID.1:EDX bit 4 reports a time stamp counter
+                            static inline bool HasTSC() {
+                                uint32_t a = 1, b, c = 0, d;
+                                __asm__ __volatile__("cpuid" : "+a"(a), "=b"(b), "+c"(c), "=d"(d));
+                                return (d & (1u << 4)) != 0;
+                            }
+
+                            // Raw cycle counter; callers must check HasTSC() first
+                            static inline uint64_t ReadTSC() {
+                                uint32_t lo, hi;
+                                __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+                                return ((uint64_t)hi << 32) | lo;
+                            }
+
                     };
                 } // namespace cpu
             } // namespace hardware
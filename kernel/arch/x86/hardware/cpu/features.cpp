@@ -0,0 +1,173 @@
+// features.cpp - CPU feature registry and boot-time dispatch for KOS
+#include <arch/x86/hardware/cpu/features.hpp>
+#include <arch/x86/hardware/cpu/fpu.hpp>
+#include <console/logger.hpp>
+#include <console/tty.hpp>
+
+using namespace kos::arch::x86::hardware::cpu;
+using namespace kos::console;
+
+bool CpuFeatures::s_detected = false;
+uint32_t CpuFeatures::s_present = 1u << CPU_FEATURE_NONE;
+uint32_t CpuFeatures::s_usable = 1u << CPU_FEATURE_NONE;
+CpuDispatch* CpuDispatch::s_first = nullptr;
+
+namespace {
+    const char* const s_names[CPU_FEATURE_COUNT] = {
+        "base", "fpu", "tsc", "pse", "pat", "fxsr", "sse", "sse2", "sse3", "ssse3",
+        "sse4.1", "sse4.2", "popcnt", "pclmul", "avx", "avx2", "erms", "invtsc", "x2apic"
+    };
+
+    // Where each feature lives in CPUID
+    enum CpuidReg { LEAF1_EDX, LEAF1_ECX, LEAF7_EBX, EXT7_EDX };
+    struct FeatureBit {
+        CpuFeature feature;
+        CpuidReg reg;
+        uint8_t bit;
+    };
+    const FeatureBit s_bits[] = {
+        { CPU_FEATURE_FPU,           LEAF1_EDX, 0 },
+        { CPU_FEATURE_TSC,           LEAF1_EDX, 4 },
+        { CPU_FEATURE_PSE,           LEAF1_EDX, 3 },
+        { CPU_FEATURE_PAT,           LEAF1_EDX, 16 },
+        { CPU_FEATURE_FXSR,          LEAF1_EDX, 24 },
+        { CPU_FEATURE_SSE,           LEAF1_EDX, 25 },
+        { CPU_FEATURE_SSE2,          LEAF1_EDX, 26 },
+        { CPU_FEATURE_SSE3,          LEAF1_ECX, 0 },
+        { CPU_FEATURE_PCLMUL,        LEAF1_ECX, 1 },
+        { CPU_FEATURE_SSSE3,         LEAF1_ECX, 9 },
+        { CPU_FEATURE_SSE4_1,        LEAF1_ECX, 19 },
+        { CPU_FEATURE_SSE4_2,        LEAF1_ECX, 20 },
+        { CPU_FEATURE_X2APIC,        LEAF1_ECX, 21 },
+        { CPU_FEATURE_POPCNT,        LEAF1_ECX, 23 },
+        { CPU_FEATURE_AVX,           LEAF1_ECX, 28 },
+        { CPU_FEATURE_AVX2,          LEAF7_EBX, 5 },
+        { CPU_FEATURE_ERMS,          LEAF7_EBX, 9 },
+        { CPU_FEATURE_INVARIANT_TSC, EXT7_EDX,  8 },
+    };
+
+    const uint32_t LEAF1_ECX_OSXSAVE = 1u << 27;
+    const uint32_t XCR0_SSE_AVX = 0x6;          // XMM and YMM state enabled
+
+    // Features that touch XMM registers and so need the OS to save them
+    const uint32_t SSE_CLASS = (1u << CPU_FEATURE_SSE) | (1u << CPU_FEATURE_SSE2) | (1u << CPU_FEATURE_SSE3) |
+                               (1u << CPU_FEATURE_SSSE3) | (1u << CPU_FEATURE_SSE4_1) | (1u << CPU_FEATURE_SSE4_2) |
+                               (1u << CPU_FEATURE_PCLMUL);
+    const uint32_t AVX_CLASS = (1u << CPU_FEATURE_AVX) | (1u << CPU_FEATURE_AVX2);
+
+    // CPUID exists if EFLAGS.ID (bit 21) can be toggled
+    bool HasCpuid() {
+        uint32_t before, after;
+        __asm__ __volatile__(
+            "pushfl\n\t"
+            "popl %0\n\t"
+            "movl %0, %1\n\t"
+            "xorl $0x200000, %1\n\t"
+            "pushl %1\n\t"
+            "popfl\n\t"
+            "pushfl\n\t"
+            "popl %1\n\t"
+            "pushl %0\n\t"
+            "popfl"
+            : "=&r"(before), "=&r"(after) : : "cc");
+        return ((before ^ after) & 0x200000) != 0;
+    }
+
+    inline void Cpuid(uint32_t leaf, uint32_t subleaf, uint32_t* regs) {
+        __asm__ __volatile__("cpuid"
+                             : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3])
+                             : "a"(leaf), "c"(subleaf));
+    }
+}
+
+void CpuFeatures::Detect() {
+    uint32_t raw[4] = {0, 0, 0, 0};     // Indexed by CpuidReg
+    if (HasCpuid()) {
+        uint32_t regs[4];
+        Cpuid(0, 0, regs);
+        uint32_t max_leaf = regs[0];
+        if (max_leaf >= 1) {
+            Cpuid(1, 0, regs);
+            raw[LEAF1_EDX] = regs[3];
+            raw[LEAF1_ECX] = regs[2];
+        }
+        if (max_leaf >= 7) {
+            Cpuid(7, 0, regs);
+            raw[LEAF7_EBX] = regs[1];
+        }
+        Cpuid(0x80000000, 0, regs);
+        if (regs[0] >= 0x80000007) {
+            Cpuid(0x80000007, 0, regs);
+            raw[EXT7_EDX] = regs[3];
+        }
+    }
+
+    uint32_t present = 1u << CPU_FEATURE_NONE;
+    for (uint32_t i = 0; i < sizeof(s_bits) / sizeof(s_bits[0]); ++i) {
+        if (raw[s_bits[i].reg] & (1u << s_bits[i].bit)) present |= 1u << s_bits[i].feature;
+    }
+
+    uint32_t usable = present;
+    if (!FPU::HasSSE()) usable &= ~SSE_CLASS;
+    bool avx_state = false;
+    if (raw[LEAF1_ECX] & LEAF1_ECX_OSXSAVE) {
+        uint32_t lo, hi;
+        __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        avx_state = (lo & XCR0_SSE_AVX) == XCR0_SSE_AVX;
+    }
+    if (!avx_state) usable &= ~AVX_CLASS;
+
+    s_present = present;
+    s_usable = usable;
+    s_detected = true;
+
+    CpuDispatch::ResolveAll();
+}
+
+const char* CpuFeatures::Name(CpuFeature f) {
+    return (f < CPU_FEATURE_COUNT) ? s_names[f] : "?";
+}
+
+void CpuFeatures::Print() {
+    TTY::Write("CPU features:");
+    for (uint32_t f = CPU_FEATURE_NONE + 1; f < CPU_FEATURE_COUNT; ++f) {
+        if (!IsPresent((CpuFeature)f)) continue;
+        TTY::Write(" ");
+        TTY::Write(s_names[f]);
+        if (!Has((CpuFeature)f)) TTY::Write("(off)");
+    }
+    TTY::Write("\n");
+    CpuDispatch::PrintAll();
+}
+
+CpuDispatch::CpuDispatch(const char* dispatch_name, void** target, const CpuVariant* list, uint32_t n)
+    : name(dispatch_name), slot(target), variants(list), count(n), chosen("default"), next(s_first) {
+    s_first = this;
+}
+
+void CpuDispatch::Resolve() {
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!CpuFeatures::Has(variants[i].feature)) continue;
+        *slot = variants[i].fn;
+        chosen = variants[i].name;
+        return;
+    }
+    // No baseline listed: keep the static initializer
+}
+
+void CpuDispatch::ResolveAll() {
+    for (CpuDispatch* d = s_first; d; d = d->next) {
+        d->Resolve();
+        Logger::LogKV(d->name, d->chosen);
+    }
+}
+
+void CpuDispatch::PrintAll() {
+    for (CpuDispatch* d = s_first; d; d = d->next) {
+        TTY::Write("  ");
+        TTY::Write(d->name);
+        TTY::Write(" -> ");
+        TTY::Write(d->chosen);
+        TTY::Write("\n");
+    }
+}
@@ -0,0 +1,100 @@
+// features.hpp - CPU feature registry and boot-time dispatch for KOS
+#pragma once
+#ifndef KOS_ARCH_X86_HARDWARE__CPU__FEATURES_HPP
+#define KOS_ARCH_X86_HARDWARE__CPU__FEATURES_HPP
+#include <common/types.hpp>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace arch {
+        namespace x86 {
+            namespace hardware {
+                namespace cpu {
+
+                    enum CpuFeature {
+                        CPU_FEATURE_NONE = 0,       // Baseline i386; always "present"
+                        CPU_FEATURE_FPU,
+                        CPU_FEATURE_TSC,
+                        CPU_FEATURE_PSE,            // 4 MiB pages
+                        CPU_FEATURE_PAT,
+                        CPU_FEATURE_FXSR,
+                        CPU_FEATURE_SSE,
+                        CPU_FEATURE_SSE2,
+                        CPU_FEATURE_SSE3,
+                        CPU_FEATURE_SSSE3,
+                        CPU_FEATURE_SSE4_1,
+                        CPU_FEATURE_SSE4_2,
+                        CPU_FEATURE_POPCNT,
+                        CPU_FEATURE_PCLMUL,
+                        CPU_FEATURE_AVX,
+                        CPU_FEATURE_AVX2,
+                        CPU_FEATURE_ERMS,           // Fast REP MOVSB/STOSB
+                        CPU_FEATURE_INVARIANT_TSC,
+                        CPU_FEATURE_X2APIC,
+                        CPU_FEATURE_COUNT
+                    };
+
+                    // One place to ask what the CPU can do. A feature is
+                    // "present" when CPUID reports it and "usable" when the
+                    // kernel has also enabled the state it needs (SSE needs
+                    // CR4.OSFXSR, AVX needs XSAVE, which KOS does not enable).
+                    class CpuFeatures {
+                        public:
+                            // Run CPUID once (after FPU::Initialize) and resolve every CpuDispatch
+                            static void Detect();
+                            static bool IsDetected() { return s_detected; }
+
+                            static bool Has(CpuFeature f) { return (s_usable & (1u << f)) != 0; }
+                            static bool IsPresent(CpuFeature f) { return (s_present & (1u << f)) != 0; }
+                            static const char* Name(CpuFeature f);
+                            static void Print();
+
+                        private:
+                            static bool s_detected;
+                            static uint32_t s_present;
+                            static uint32_t s_usable;
+                    };
+
+                    struct CpuVariant {
+                        CpuFeature feature;         // Required feature; CPU_FEATURE_NONE = baseline
+                        void* fn;
+                        const char* name;
+                    };
+
+                    // A function pointer bound once at boot to the best variant
+                    // the CPU supports, in place of GNU ifuncs. Define one at
+                    // namespace scope next to the variants, listed best first
+                    // and ending with a baseline. Its constructor links it into
+                    // the registry before kernelMain; until Detect() runs the
+                    // slot keeps its static initializer, so callers always get a
+                    // working function.
+                    class CpuDispatch {
+                        public:
+                            CpuDispatch(const char* name, void** slot, const CpuVariant* variants, uint32_t count);
+
+                            const char* GetName() const { return name; }
+                            const char* GetChosen() const { return chosen; }
+
+                            static void ResolveAll();
+                            static void PrintAll();
+
+                        private:
+                            const char* name;
+                            void** slot;
+                            const CpuVariant* variants;
+                            uint32_t count;
+                            const char* chosen;
+                            CpuDispatch* next;
+
+                            static CpuDispatch* s_first;
+
+                            void Resolve();
+                    };
+                } // namespace cpu
+            } // namespace hardware
+        } // namespace x86
+    } // namespace arch
+} // namespace kos
+
+#endif // KOS_ARCH_X86_HARDWARE__CPU__FEATURES_HPP
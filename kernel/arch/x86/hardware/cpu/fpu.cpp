@@ -0,0 +1,227 @@
+// fpu.cpp - lazy x87/SSE context switching for KOS
+#include <arch/x86/hardware/cpu/fpu.hpp>
+#include <arch/x86/hardware/interrupts/interrupt_manager.hpp>
+#include <arch/x86/hardware/interrupts/interrupt_handler.hpp>
+#include <arch/x86/hardware/interrupts/interrupt_constants.hpp>
+#include <memory/heap.hpp>
+#include <console/logger.hpp>
+#include <console/tty.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
+
+using namespace kos::arch::x86::hardware::cpu;
+using namespace kos::arch::x86::hardware::interrupts;
+using namespace kos::console;
+
+bool FPU::s_ready = false;
+bool FPU::s_fxsr = false;
+bool FPU::s_sse = false;
+bool FPU::s_sse2 = false;
+FpuContext* FPU::s_owner = nullptr;
+FpuContext* FPU::s_current = nullptr;
+uint32_t FPU::s_traps = 0;
+uint32_t FPU::s_saves = 0;
+
+namespace {
+    const uint32_t CR0_MP = 1u << 1;        // WAIT/FWAIT honour TS
+    const uint32_t CR0_EM = 1u << 2;        // No FPU: trap every FPU instruction
+    const uint32_t CR0_TS = 1u << 3;        // Task switched: next FPU use raises #NM
+    const uint32_t CR0_NE = 1u << 5;        // Report x87 errors as #MF, not IRQ13
+    const uint32_t CR4_OSFXSR = 1u << 9;    // FXSAVE/FXRSTOR save XMM state, SSE enabled
+    const uint32_t CR4_OSXMMEXCPT = 1u << 10; // Unmasked SIMD FP errors raise #XM
+
+    const uint32_t CPUID_EDX_FPU = 1u << 0;
+    const uint32_t CPUID_EDX_FXSR = 1u << 24;
+    const uint32_t CPUID_EDX_SSE = 1u << 25;
+    const uint32_t CPUID_EDX_SSE2 = 1u << 26;
+
+    const uint32_t MXCSR_DEFAULT = 0x1F80;  // All SIMD exceptions masked, round to nearest
+    const uint32_t MXCSR_MASKS = 0x1F80;
+    const uint32_t MXCSR_FLAGS = 0x003F;
+    const uint16_t FCW_MASKS = 0x003F;
+
+    // State every context starts from, and the boot context's own save area
+    uint8_t s_initial[FPU_STATE_SIZE] __attribute__((aligned(16)));
+    uint8_t s_boot_area[FPU_STATE_SIZE] __attribute__((aligned(16)));
+    FpuContext s_boot = { s_boot_area, true };
+    bool s_warned_no_area = false;
+
+    inline uint32_t ReadCR0() {
+        uint32_t v;
+        __asm__ __volatile__("mov %%cr0, %0" : "=r"(v));
+        return v;
+    }
+
+    inline void WriteCR0(uint32_t v) {
+        __asm__ __volatile__("mov %0, %%cr0" : : "r"(v) : "memory");
+    }
+
+    inline uint32_t ReadCR4() {
+        uint32_t v;
+        __asm__ __volatile__("mov %%cr4, %0" : "=r"(v));
+        return v;
+    }
+
+    inline void WriteCR4(uint32_t v) {
+        __asm__ __volatile__("mov %0, %%cr4" : : "r"(v) : "memory");
+    }
+
+    inline void Clts() {
+        __asm__ __volatile__("clts" : : : "memory");
+    }
+
+    inline void Stts() {
+        WriteCR0(ReadCR0() | CR0_TS);
+    }
+
+    // Routes #NM, #MF and #XM to the FPU code
+    class FpuTrapHandler : public InterruptHandler {
+    public:
+        FpuTrapHandler(InterruptManager* manager, uint8_t vector)
+            : InterruptHandler(manager, vector) {}
+        virtual uint32_t HandleInterrupt(uint32_t esp) {
+            if (InterruptNumber == EXCEPTION_DEVICE_NOT_AVAILABLE) FPU::HandleDeviceNotAvailable();
+            else FPU::HandleFloatingPointError(InterruptNumber);
+            return esp;
+        }
+    };
+}
+
+void FPU::Initialize(InterruptManager* manager) {
+    uint32_t a = 1, b, c = 0, d;
+    __asm__ __volatile__("cpuid" : "+a"(a), "=b"(b), "+c"(c), "=d"(d));
+    if (!(d & CPUID_EDX_FPU)) {
+        Logger::Log("FPU: no x87 unit, lazy switching disabled");
+        return;
+    }
+    s_fxsr = (d & CPUID_EDX_FXSR) != 0;
+    s_sse = s_fxsr && (d & CPUID_EDX_SSE);
+    s_sse2 = s_sse && (d & CPUID_EDX_SSE2);
+
+    WriteCR0((ReadCR0() & ~(CR0_EM | CR0_TS)) | CR0_MP | CR0_NE);
+    if (s_fxsr) {
+        uint32_t cr4 = ReadCR4() | CR4_OSFXSR;
+        if (s_sse) cr4 |= CR4_OSXMMEXCPT;
+        WriteCR4(cr4);
+    }
+
+    // Snapshot the reset state new contexts are loaded from
+    __asm__ __volatile__("fninit");
+    if (s_sse) {
+        uint32_t mxcsr = MXCSR_DEFAULT;
+        __asm__ __volatile__("ldmxcsr %0" : : "m"(mxcsr));
+    }
+    if (s_fxsr) __asm__ __volatile__("fxsave (%0)" : : "r"(s_initial) : "memory");
+    else __asm__ __volatile__("fnsave (%0); fwait" : : "r"(s_initial) : "memory");
+    __asm__ __volatile__("fninit");
+
+    // The boot context owns the registers until the first switch
+    s_owner = &s_boot;
+    s_current = &s_boot;
+
+    new FpuTrapHandler(manager, EXCEPTION_DEVICE_NOT_AVAILABLE);
+    new FpuTrapHandler(manager, EXCEPTION_FPU_ERROR);
+    new FpuTrapHandler(manager, EXCEPTION_SIMD_ERROR);
+    s_ready = true;
+
+    Logger::LogKV("FPU", s_sse2 ? "fxsr+sse2" : s_sse ? "fxsr+sse" : s_fxsr ? "fxsr" : "x87");
+}
+
+bool FPU::InitContext(FpuContext* ctx) {
+    ctx->used = false;
+    ctx->area = (uint8_t*)kos::memory::Heap::Alloc(FPU_STATE_SIZE, FPU_STATE_ALIGN);
+    return ctx->area != nullptr;
+}
+
+void FPU::FreeContext(FpuContext* ctx) {
+    uint32_t flags = IrqSave();
+    if (s_owner == ctx) s_owner = nullptr;
+    if (s_current == ctx) s_current = &s_boot;
+    uint8_t* area = ctx->area;
+    ctx->area = nullptr;
+    ctx->used = false;
+    IrqRestore(flags);
+    if (area) kos::memory::Heap::Free(area);
+}
+
+void FPU::SwitchTo(FpuContext* next) {
+    if (!s_ready) return;
+    s_current = next ? next : &s_boot;
+    if (s_current == s_owner) Clts();
+    else Stts();
+}
+
+void FPU::Save(FpuContext* ctx) {
+    if (s_fxsr) __asm__ __volatile__("fxsave (%0)" : : "r"(ctx->area) : "memory");
+    else __asm__ __volatile__("fnsave (%0); fwait" : : "r"(ctx->area) : "memory");
+    s_saves++;
+}
+
+void FPU::Restore(FpuContext* ctx) {
+    const uint8_t* src = ctx->used ? ctx->area : s_initial;
+    if (s_fxsr) __asm__ __volatile__("fxrstor (%0)" : : "r"(src) : "memory");
+    else __asm__ __volatile__("frstor (%0)" : : "r"(src) : "memory");
+}
+
+void FPU::HandleDeviceNotAvailable() {
+    s_traps++;
+    Clts();
+    FpuContext* ctx = s_current;
+    if (ctx == s_owner) return;
+    if (s_owner) Save(s_owner);
+    if (!ctx || !ctx->area) {
+        // No save area (allocation failed): let it run on fresh registers
+        // without an owner, so its state is simply not preserved
+        if (!s_warned_no_area) {
+            s_warned_no_area = true;
+            Logger::Log("FPU: context without save area, state will not be preserved");
+        }
+        __asm__ __volatile__("fninit");
+        s_owner = nullptr;
+        return;
+    }
+    Restore(ctx);
+    ctx->used = true;
+    s_owner = ctx;
+}
+
+void FPU::HandleFloatingPointError(uint8_t vector) {
+    if (vector == EXCEPTION_SIMD_ERROR) {
+        uint32_t mxcsr;
+        __asm__ __volatile__("stmxcsr %0" : "=m"(mxcsr));
+        Logger::LogKV("FPU: #XM, masking SIMD exceptions", (mxcsr & MXCSR_FLAGS) ? "flags set" : "no flags");
+        mxcsr = (mxcsr | MXCSR_MASKS) & ~MXCSR_FLAGS;
+        __asm__ __volatile__("ldmxcsr %0" : : "m"(mxcsr));
+    } else {
+        uint16_t fcw;
+        __asm__ __volatile__("fnstcw %0" : "=m"(fcw));
+        Logger::Log("FPU: #MF, masking x87 exceptions");
+        fcw |= FCW_MASKS;
+        __asm__ __volatile__("fnclex; fldcw %0" : : "m"(fcw));
+    }
+}
+
+uint32_t FPU::KernelBegin() {
+    uint32_t flags = IrqSave();
+    if (!s_ready) return flags;
+    Clts();
+    if (s_owner) {
+        Save(s_owner);
+        s_owner = nullptr;
+    }
+    return flags;
+}
+
+void FPU::KernelEnd(uint32_t flags) {
+    if (s_ready) Stts();
+    IrqRestore(flags);
+}
+
+void FPU::PrintStats() {
+    TTY::Write("FPU: ");
+    TTY::Write(!s_ready ? "off" : s_sse2 ? "fxsr+sse2" : s_sse ? "fxsr+sse" : s_fxsr ? "fxsr" : "x87");
+    TTY::Write(" nm_traps=");
+    TTY::WriteHex(s_traps);
+    TTY::Write(" saves=");
+    TTY::WriteHex(s_saves);
+    TTY::Write("\n");
+}
@@ -0,0 +1,85 @@
+// fpu.hpp - lazy x87/SSE context switching for KOS
+#pragma once
+#ifndef KOS_ARCH_X86_HARDWARE__CPU__FPU_HPP
+#define KOS_ARCH_X86_HARDWARE__CPU__FPU_HPP
+#include <common/types.hpp>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace arch {
+        namespace x86 {
+            namespace hardware {
+                namespace interrupts {
+                    class InterruptManager;
+                }
+                namespace cpu {
+
+                    // FXSAVE image size; FNSAVE (no FXSR) only uses the first 108 bytes
+                    constexpr uint32_t FPU_STATE_SIZE = 512;
+                    constexpr uint32_t FPU_STATE_ALIGN = 16;
+
+                    // Per-thread FPU/SSE register image
+                    struct FpuContext {
+                        uint8_t* area;      // FPU_STATE_SIZE bytes, 16-byte aligned; null = never allocated
+                        bool used;          // Holds real state (has touched the FPU at least once)
+                    };
+
+                    // Lazy FPU switching. The registers stay with whichever
+                    // context last used them; a switch only sets CR0.TS, and
+                    // the first FPU/SSE instruction afterwards raises #NM, which
+                    // saves the previous owner and loads the current context.
+                    // Threads that never touch the FPU never pay for a save.
+                    class FPU {
+                        public:
+                            // Set CR0/CR4 (FXSR, OSXMMEXCPT), capture the clean
+                            // initial state and install the #NM/#MF/#XM handlers
+                            static void Initialize(interrupts::InterruptManager* manager);
+
+                            static bool IsReady() { return s_ready; }
+                            static bool HasFXSR() { return s_fxsr; }
+                            static bool HasSSE() { return s_sse; }
+                            static bool HasSSE2() { return s_sse2; }
+
+                            // Thread lifecycle: allocate / drop a save area
+                            static bool InitContext(FpuContext* ctx);
+                            static void FreeContext(FpuContext* ctx);
+
+                            // Called on every context switch; null = boot context
+                            static void SwitchTo(FpuContext* next);
+
+                            // #NM: hand the registers to the running context
+                            static void HandleDeviceNotAvailable();
+                            // #MF/#XM: log, then mask and clear so the thread can continue
+                            static void HandleFloatingPointError(uint8_t vector);
+
+                            // Kernel SIMD sections. Saves the owner's registers
+                            // and runs with interrupts off; End() sets TS so the
+                            // owner reloads on its next FPU use.
+                            static uint32_t KernelBegin();
+                            static void KernelEnd(uint32_t flags);
+
+                            static uint32_t GetTrapCount() { return s_traps; }
+                            static uint32_t GetSaveCount() { return s_saves; }
+                            static void PrintStats();
+
+                        private:
+                            static bool s_ready;
+                            static bool s_fxsr;
+                            static bool s_sse;
+                            static bool s_sse2;
+                            static FpuContext* s_owner;     // Context whose state is in the registers
+                            static FpuContext* s_current;   // Context currently running
+                            static uint32_t s_traps;
+                            static uint32_t s_saves;
+
+                            static void Save(FpuContext* ctx);
+                            static void Restore(FpuContext* ctx);
+                    };
+                } // namespace cpu
+            } // namespace hardware
+        } // namespace x86
+    } // namespace arch
+} // namespace kos
+
+#endif // KOS_ARCH_X86_HARDWARE__CPU__FPU_HPP
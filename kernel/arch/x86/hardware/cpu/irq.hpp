@@ -0,0 +1,43 @@
+// irq.hpp - interrupt flag save/restore for short critical sections
+#pragma once
+#ifndef KOS_ARCH_X86_HARDWARE__CPU__IRQ_HPP
+#define KOS_ARCH_X86_HARDWARE__CPU__IRQ_HPP
+#include <common/types.hpp>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace arch {
+        namespace x86 {
+            namespace hardware {
+                namespace cpu {
+
+                    constexpr uint32_t EFLAGS_IF = 0x200;
+
+                    // Mask interrupts and return the previous EFLAGS. On the
+                    // single CPU KOS runs on this is the atomic section that
+                    // i386 (no cmpxchg/xadd) otherwise lacks.
+                    inline uint32_t IrqSave() {
+                        uint32_t flags;
+                        __asm__ __volatile__("pushfl; popl %0; cli" : "=r"(flags) : : "memory");
+                        return flags;
+                    }
+
+                    // Put IF back the way IrqSave() found it
+                    inline void IrqRestore(uint32_t flags) {
+                        __asm__ __volatile__("pushl %0; popfl" : : "r"(flags) : "memory", "cc");
+                    }
+
+                    inline bool InterruptsEnabled() {
+                        uint32_t flags;
+                        __asm__ __volatile__("pushfl; popl %0" : "=r"(flags));
+                        return (flags & EFLAGS_IF) != 0;
+                    }
+
+                } // namespace cpu
+            } // namespace hardware
+        } // namespace x86
+    } // namespace arch
+} // namespace kos
+
+#endif // KOS_ARCH_X86_HARDWARE__CPU__IRQ_HPP
@@ -6,6 +6,7 @@
 #include <common/panic.hpp>
 #include <kernel/input_debug.hpp>
 #include <lib/serial.hpp>
+#include <process/trace.hpp>
 using namespace kos::common;
 using namespace kos::arch::x86::hardware::interrupts;
 
@@ -263,6 +264,9 @@ uint32_t InterruptManager::DoHandleInterrupt(uint8_t interrupt, uint32_t esp)
     }
 #endif
 
+    const bool isIrq = hardwareInterruptOffset <= interrupt && interrupt < hardwareInterruptOffset + IRQ_COUNT;
+    if (isIrq) kos::process::Tracer::IrqEnter(interrupt - hardwareInterruptOffset);
+
     if(handlers[interrupt] !=0)
     {
         esp= handlers[interrupt]->HandleInterrupt(esp);
@@ -326,12 +330,13 @@ uint32_t InterruptManager::DoHandleInterrupt(uint8_t interrupt, uint32_t esp)
     }
 
     // hardarware interrupts must be acknowleged
-    if(hardwareInterruptOffset <= interrupt && interrupt < hardwareInterruptOffset + IRQ_COUNT)
+    if(isIrq)
     {
         // Acknowledge slave first if it originated there, then master
         if(hardwareInterruptOffset + 8 <= interrupt)
             programmableInterruptControllerSlaveCommandPort.Write(PIC_EOI);
         programmableInterruptControllerMasterCommandPort.Write(PIC_EOI);
+        kos::process::Tracer::IrqExit(interrupt - hardwareInterruptOffset);
     }
     return esp;
 }
\ No newline at end of file
@@ -76,8 +76,10 @@ int_bottom:
     pushl %fs
     pushl %gs
 
+    # C code expects DF clear (the interrupted code may have set it)
+    cld
+
     # ring 0 segment register laden
-    #cld
     #mov $0x10, %eax
     #mov %eax, %eds
     #mov %eax, %ees
@@ -11,7 +11,9 @@ using namespace kos::arch::x86::memory;
 GlobalDescriptorTable::GlobalDescriptorTable():nullSegmentSelector(0, 0, 0),
         unusedSegmentSelector(0, 0, 0),
         codeSegmentSelector(0, GDT_SEGMENT_LIMIT, GDT_CODE_SEGMENT_TYPE),
-        dataSegmentSelector(0, GDT_SEGMENT_LIMIT, GDT_DATA_SEGMENT_TYPE)
+        dataSegmentSelector(0, GDT_SEGMENT_LIMIT, GDT_DATA_SEGMENT_TYPE),
+        // 4 GiB limit so negative %gs offsets (TLS variant II) wrap around
+        tlsSegmentSelector(0, GDT_TLS_SEGMENT_LIMIT, GDT_DATA_SEGMENT_TYPE)
 {
     uint32_t i[2];
     i[1] = (uint32_t)this;
@@ -28,6 +30,16 @@ uint16_t GlobalDescriptorTable::DataSegmentSelector()
     return (uint8_t*)&dataSegmentSelector - (uint8_t*)this;
 }
 
+uint16_t GlobalDescriptorTable::TlsSegmentSelector()
+{
+    return (uint8_t*)&tlsSegmentSelector - (uint8_t*)this;
+}
+
+void GlobalDescriptorTable::SetTlsBase(uint32_t base)
+{
+    tlsSegmentSelector.SetBase(base);
+}
+
 uint16_t GlobalDescriptorTable::CodeSegmentSelector()
 {
     return (uint8_t*)&codeSegmentSelector - (uint8_t*)this;
@@ -90,6 +102,15 @@ uint32_t GlobalDescriptorTable::SegmentDescriptor::Base()
     return result;
 }
 
+void GlobalDescriptorTable::SegmentDescriptor::SetBase(uint32_t base)
+{
+    uint8_t* target = (uint8_t*)this;
+    target[2] = base & 0xFF;
+    target[3] = (base >> 8) & 0xFF;
+    target[4] = (base >> 16) & 0xFF;
+    target[7] = (base >> 24) & 0xFF;
+}
+
 uint32_t GlobalDescriptorTable::SegmentDescriptor::Limit()
 {
     uint8_t* target = (uint8_t*)this;
@@ -54,6 +54,12 @@ namespace kos{
                                 * @return The limit.
                                 */
                                 uint32_t Limit();
+
+                                /*
+                                * @brief Rewrites the base address; takes effect on the next selector load.
+                                * @param base The new base address.
+                                */
+                                void SetBase(uint32_t base);
                         } __attribute__((packed));
 
                     private:
@@ -61,6 +67,7 @@ namespace kos{
                         SegmentDescriptor unusedSegmentSelector; // Unused segment
                         SegmentDescriptor codeSegmentSelector; // Code segment
                         SegmentDescriptor dataSegmentSelector; // Data segment
+                        SegmentDescriptor tlsSegmentSelector; // Thread pointer segment (%gs), rebased per thread
 
                     public:
                         /*
@@ -85,6 +92,18 @@ namespace kos{
                         * @return The data segment selector.
                         */
                         uint16_t DataSegmentSelector();
+
+                        /*
+                        * @brief Returns the thread-local storage segment selector.
+                        * @return The TLS segment selector.
+                        */
+                        uint16_t TlsSegmentSelector();
+
+                        /*
+                        * @brief Points the TLS segment at a thread's control block.
+                        * @param base Linear address of the thread pointer.
+                        */
+                        void SetTlsBase(uint32_t base);
                 };
             }
         }
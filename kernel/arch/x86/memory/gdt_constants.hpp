@@ -17,6 +17,7 @@ namespace kos {
                 constexpr uint8_t  GDT_TSS_SEGMENT        = 5;
                 constexpr uint8_t  GDT_ENTRIES            = 6;
                 constexpr uint32_t GDT_SEGMENT_LIMIT      = 64 * 1024 * 1024; // 64 MB
+                constexpr uint32_t GDT_TLS_SEGMENT_LIMIT  = 0xFFFFFFFF;       // 4 GB, wraps for negative offsets
                 constexpr uint8_t  GDT_CODE_SEGMENT_TYPE  = 0x9A; // Code segment: execute/read, ring 0
                 constexpr uint8_t  GDT_DATA_SEGMENT_TYPE  = 0x92; // Data segment: read/write, ring 0
                 
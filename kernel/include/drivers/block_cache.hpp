@@ -0,0 +1,146 @@
+#ifndef __KOS__DRIVERS__BLOCK_CACHE_H
+#define __KOS__DRIVERS__BLOCK_CACHE_H
+
+#include <common/types.hpp>
+#include <drivers/blockdevice.hpp>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace drivers {
+
+        static const uint32_t BCACHE_SECTOR_SIZE = 512;
+        static const uint32_t BCACHE_DEFAULT_BUFFERS = 128;
+        static const uint32_t BCACHE_FLUSH_INTERVAL_MS = 1000;
+        // Dirty buffers older than this are written back by the flusher
+        static const uint32_t BCACHE_DIRTY_EXPIRE_MS = 3000;
+        // Largest readahead staged in one device command (64 KiB)
+        static const uint32_t BCACHE_PREFETCH_MAX_SECTORS = 128;
+
+        struct BlockCacheStats {
+            uint32_t hits;
+            uint32_t misses;
+            uint32_t writebacks;        // Blocks written to the backing device
+            uint32_t evictions;
+            uint32_t prefetched;        // Blocks read ahead of use
+            uint32_t direct_reads;      // Bulk reads that bypassed the cache
+            uint32_t dirty;             // Currently dirty buffers
+            uint32_t pinned;            // Currently pinned buffers
+        };
+
+        // One cached block. Data is valid while the buffer is pinned; pinned
+        // buffers are never evicted.
+        struct BlockBuffer {
+            uint32_t block;             // Block number (lba / sectors per block)
+            uint8_t* data;
+            uint32_t pin_count;
+            uint32_t dirty_since;       // Uptime (ms) of the first write since the last flush
+            bool valid;
+            bool dirty;
+            BlockBuffer* hash_next;
+            BlockBuffer* lru_prev;      // Towards most recently used
+            BlockBuffer* lru_next;
+        };
+
+        // Write-back buffer cache in front of another block device. Reads
+        // and writes are served from a hashed LRU of fixed-size blocks (512 B
+        // or 4 KiB); dirty blocks reach the disk on Sync(), on eviction, or
+        // from a periodic flusher once they are BCACHE_DIRTY_EXPIRE_MS old.
+        // Buffers are allocated on first use, so instances can be static; if
+        // that allocation fails the cache passes requests straight through.
+        // Reads longer than a block fetch uncached runs straight into the
+        // caller's buffer, so streaming a large file neither splits into
+        // per-block commands nor evicts the metadata everyone else shares.
+        class CachedBlockDevice : public BlockDevice {
+        public:
+            CachedBlockDevice(BlockDevice* backing, const char* name,
+                              uint32_t sectors_per_block = 8,
+                              uint32_t buffer_count = BCACHE_DEFAULT_BUFFERS);
+            ~CachedBlockDevice();
+
+            virtual void Activate();
+            virtual bool ReadSectors(uint32_t lba, uint8_t sectorCount, uint8_t* buffer);
+            virtual bool WriteSectors(uint32_t lba, uint8_t sectorCount, const uint8_t* buffer);
+            // Updates the cached blocks and writes them back before returning
+            virtual bool WriteSectorsThrough(uint32_t lba, uint8_t sectorCount, const uint8_t* buffer);
+            virtual bool Flush() { return Sync(); }
+            // Read uncached blocks of the range in one command and keep them;
+            // skipped while the cache is busy
+            virtual void Prefetch(uint32_t lba, uint32_t sectorCount);
+            virtual bool IsBusy() const { return busy; }
+
+            // Pin the block holding lba, reading it in on a miss; null on I/O
+            // error or when every buffer is pinned. Pair with Unpin().
+            BlockBuffer* Pin(uint32_t lba);
+            void Unpin(BlockBuffer* buf);
+            void MarkDirty(BlockBuffer* buf);
+            // Address of lba's sector inside a pinned buffer
+            uint8_t* SectorData(BlockBuffer* buf, uint32_t lba) const;
+
+            // Write back every dirty block; returns false on any write error
+            bool Sync();
+            // Write back dirty blocks older than max_age_ms; returns blocks written
+            uint32_t FlushExpired(uint32_t max_age_ms);
+            // Sync, then drop every unpinned block
+            bool Invalidate();
+
+            BlockDevice* GetBacking() const { return backing; }
+            const char* GetName() const { return name; }
+            uint32_t GetBlockSize() const { return sectors_per_block * BCACHE_SECTOR_SIZE; }
+            BlockCacheStats GetStats() const;
+            void PrintStats() const;
+
+            // Registry of caches that have allocated their buffers
+            static CachedBlockDevice* First() { return s_first; }
+            CachedBlockDevice* Next() const { return next_cache; }
+
+        private:
+            BlockDevice* backing;
+            const char* name;
+            uint32_t sectors_per_block;
+            uint32_t buffer_count;
+            BlockBuffer* buffers;
+            uint8_t* buffer_data;
+            uint8_t* prefetch_data;     // Staging for Prefetch, allocated on first use
+            BlockBuffer** buckets;
+            uint32_t bucket_mask;
+            BlockBuffer* lru_head;      // Most recently used
+            BlockBuffer* lru_tail;
+            volatile bool busy;
+            volatile bool flush_armed;
+            bool setup_failed;
+            BlockCacheStats stats;
+            CachedBlockDevice* next_cache;
+
+            static CachedBlockDevice* s_first;
+
+            bool EnsureBuffers();
+            void Lock();
+            bool TryLock();
+            void Unlock();
+
+            BlockBuffer* Lookup(uint32_t block) const;
+            BlockBuffer* PinLocked(uint32_t block, bool fill);
+            bool WriteRange(uint32_t lba, uint8_t sectorCount, const uint8_t* buffer, bool through);
+            bool PrefetchRun(uint32_t first_block, uint32_t blocks);
+            BlockBuffer* Reclaim();
+            void HashInsert(BlockBuffer* buf);
+            void HashRemove(BlockBuffer* buf);
+            void Touch(BlockBuffer* buf);
+            void MarkDirtyLocked(BlockBuffer* buf);
+            bool WriteBack(BlockBuffer* buf);
+            bool SyncLocked();
+            void ArmFlusher();
+            static void FlushWork(void* arg);
+        };
+
+        namespace BlockCacheAPI {
+            // Write back every cache; used by sync and before reboot/power off
+            bool SyncAll();
+            void PrintAll();
+        }
+
+    } // namespace drivers
+} // namespace kos
+
+#endif // __KOS__DRIVERS__BLOCK_CACHE_H
@@ -25,6 +25,29 @@ namespace kos {
             virtual bool WriteSectors(uint32_t lba,
                                uint8_t sectorCount,
                                const uint8_t* buffer) = 0;
+
+            // Hint that these sectors will be read soon. Devices without a
+            // cache ignore it.
+            virtual void Prefetch(uint32_t lba, uint32_t sectorCount) {
+                (void)lba;
+                (void)sectorCount;
+            }
+
+            // Like WriteSectors, but the data is on the medium when it
+            // returns, even behind a write-back cache. For writes that must
+            // land before the ones that follow, such as a dirty flag.
+            virtual bool WriteSectorsThrough(uint32_t lba,
+                                      uint8_t sectorCount,
+                                      const uint8_t* buffer) {
+                return WriteSectors(lba, sectorCount, buffer);
+            }
+
+            // Push every write accepted so far to the medium
+            virtual bool Flush() { return true; }
+
+            // True while a request is in progress. Background work checks it
+            // to back off rather than wait on a caller it may have interrupted.
+            virtual bool IsBusy() const { return false; }
             };
 
     } // namespace drivers
@@ -9,6 +9,7 @@
 #include <drivers/driver.hpp>
 #include <drivers/keyboard/keyboard_handler.hpp>
 #include <lib/serial.hpp>
+#include <process/workqueue.hpp>
 
 using namespace kos::arch::x86::hardware::interrupts;
 
@@ -70,6 +71,15 @@ namespace kos
                     // Modifier state
                     bool ctrlLeft = false;
                     bool ctrlRight = false;
+                    // Scancodes latched by the IRQ, decoded on kworker-hi
+                    static const uint32_t RAW_RING_SIZE = 64;
+                    uint8_t rawRing[RAW_RING_SIZE];
+                    volatile uint32_t rawHead = 0;
+                    volatile uint32_t rawTail = 0;
+                    kos::process::WorkItem decodeWork;
+                    
+                    void Decode(uint8_t key);
+                    static void DecodeWork(void* arg);
             };
     
         }   // namespace keyboard
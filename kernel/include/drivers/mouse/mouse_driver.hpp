@@ -8,6 +8,7 @@
 #include <arch/x86/hardware/port/port8bit.hpp>
 #include <drivers/driver.hpp>
 #include <drivers/mouse/mouse_event_handler.hpp>
+#include <process/workqueue.hpp>
 
 using namespace kos::common;
 using namespace kos::arch::x86::hardware::interrupts;
@@ -38,6 +39,15 @@ namespace kos{
                 // Debug: dump raw bytes for a short duration
                 bool dumpEnabled = false;
                 uint32_t dumpCount = 0; // number of bytes dumped
+                // Bytes latched by the IRQ, decoded on kworker-hi
+                static const uint32_t RAW_RING_SIZE = 64;
+                uint8_t rawRing[RAW_RING_SIZE];
+                volatile uint32_t rawHead = 0;
+                volatile uint32_t rawTail = 0;
+                kos::process::WorkItem decodeWork;
+
+                void Decode(uint8_t b);
+                static void DecodeWork(void* arg);
         
                 public:
                     /*
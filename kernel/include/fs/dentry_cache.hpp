@@ -0,0 +1,99 @@
+#ifndef __KOS__FS__DENTRY_CACHE_H
+#define __KOS__FS__DENTRY_CACHE_H
+
+#include <common/types.hpp>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace fs {
+
+        static const uint32_t DENTRY_DEFAULT_CAPACITY = 256;
+        static const uint32_t DENTRY_NAME_MAX = 13;     // 8.3 name + NUL
+
+        // Parent key for a root directory that has no cluster (FAT16)
+        static const uint32_t DENTRY_ROOT_NO_CLUSTER = 0;
+
+        struct DentryStats {
+            uint32_t hits;
+            uint32_t negative_hits;     // Lookups answered "does not exist"
+            uint32_t misses;
+            uint32_t evictions;
+            uint32_t entries;
+        };
+
+        // Cached result of looking up one path component in one directory
+        struct Dentry {
+            uint32_t parent;            // Directory cluster the name lives in
+            uint32_t hash;
+            uint32_t start_cluster;
+            uint32_t size;
+            uint8_t attr;
+            bool negative;              // Name is known to be absent
+            int8_t name[DENTRY_NAME_MAX];
+            Dentry* hash_next;
+            Dentry* lru_prev;           // Towards most recently used
+            Dentry* lru_next;
+        };
+
+        // Hashed LRU of directory lookups keyed by (parent directory
+        // cluster, upper-case 8.3 component). Resolving a path walks it one
+        // component at a time, so entries stay valid when an ancestor is
+        // renamed. Filesystems insert what their directory scans find (or
+        // fail to find) and invalidate a name whenever they change its
+        // directory entry. Storage comes from the heap on first insert, so
+        // instances can be static. Not locked: the filesystem serializes.
+        class DentryCache {
+        public:
+            enum Result { MISS = 0, HIT = 1, NEGATIVE = 2 };
+
+            DentryCache(const char* label, uint32_t capacity = DENTRY_DEFAULT_CAPACITY);
+            ~DentryCache();
+
+            Result Lookup(uint32_t parent, const int8_t* name,
+                          uint32_t& outStartCluster, uint32_t& outSize, uint8_t& outAttr);
+            void Insert(uint32_t parent, const int8_t* name,
+                        uint32_t startCluster, uint32_t size, uint8_t attr);
+            void InsertNegative(uint32_t parent, const int8_t* name);
+            // Forget one name (created, resized, renamed or removed)
+            void Invalidate(uint32_t parent, const int8_t* name);
+            // Same, for a name in 11-byte directory entry form; callers pass
+            // both spellings since packing may shorten the requested name
+            void Invalidate(uint32_t parent, const uint8_t shortName11[11]);
+            void Clear();
+
+            DentryStats GetStats() const;
+            void PrintStats() const;
+
+            static DentryCache* First() { return s_first; }
+            DentryCache* Next() const { return next_cache; }
+
+        private:
+            const char* label;
+            uint32_t capacity;
+            Dentry* entries;
+            Dentry** buckets;
+            uint32_t bucket_mask;
+            Dentry* lru_head;
+            Dentry* lru_tail;
+            bool setup_failed;
+            DentryStats stats;
+            DentryCache* next_cache;
+
+            static DentryCache* s_first;
+
+            bool EnsureStorage();
+            Dentry* Find(uint32_t parent, const int8_t* name, uint32_t hash) const;
+            Dentry* Store(uint32_t parent, const int8_t* name);
+            void Unhash(Dentry* d);
+            void Touch(Dentry* d);
+        };
+
+        namespace DentryCacheAPI {
+            void PrintAll();
+        }
+
+    } // namespace fs
+} // namespace kos
+
+#endif // __KOS__FS__DENTRY_CACHE_H
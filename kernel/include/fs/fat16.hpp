@@ -4,6 +4,7 @@
 #include <common/types.hpp>
 #include <drivers/blockdevice.hpp>
 #include <fs/filesystem.hpp>
+#include <fs/dentry_cache.hpp>
 
 using namespace kos::common;
 using namespace kos::drivers;
@@ -45,6 +46,7 @@ namespace kos {
                 uint32_t rootDirSectors;
                 uint32_t dataStartLBA;
                 bool mounted;
+                DentryCache dentries;   // Root entries use DENTRY_ROOT_NO_CLUSTER
 
                 bool ReadSector(uint32_t lba, uint8_t* buf);
                 bool ReadSectors(uint32_t lba, uint32_t count, uint8_t* buf);
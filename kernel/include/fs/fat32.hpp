@@ -4,6 +4,7 @@
 #include <common/types.hpp>
 #include <drivers/blockdevice.hpp>
 #include <fs/filesystem.hpp>
+#include <fs/dentry_cache.hpp>
 
 using namespace kos::common;
 using namespace kos::drivers;
@@ -19,6 +20,28 @@ namespace kos {
             uint32_t sectorsPerFAT;
             uint32_t rootCluster;
             uint32_t totalSectors;
+            uint16_t fsInfoSector;   // Relative to the volume; 0/0xFFFF = none
+        };
+
+        // Delayed appends: open streams, bytes held per stream before they
+        // are written, and how long the oldest held byte may wait
+        static const uint32_t FAT32_APPEND_STREAMS = 4;
+        static const uint32_t FAT32_APPEND_BUFFER = 16 * 1024;
+        static const uint32_t FAT32_APPEND_DELAY_MS = 1000;
+
+        // A file that WriteFile has appended to: its tail cluster is kept in
+        // memory and new bytes wait in 'pending' until a threshold, when
+        // they get clusters in one contiguous run
+        struct FAT32AppendStream {
+            bool used;
+            uint8_t name[11];         // Directory entry form
+            FileHandle file;          // Size and start cluster as on disk
+            uint32_t lastCluster;     // Tail of the chain; 0 while the file has none
+            uint8_t* tail;            // Contents of lastCluster
+            uint8_t* pending;
+            uint32_t pendingLen;
+            uint32_t pendingSince;    // Uptime (ms) of the oldest pending byte
+            uint32_t lastUse;
         };
 
     class FAT32 : public Filesystem {
@@ -38,6 +61,16 @@ namespace kos {
             //  - Same-directory rename for files and directories
             //  - Cross-directory move for files only (no overwrite)
             virtual int32_t Rename(const int8_t* src, const int8_t* dst) override;
+            // Write pending appends, then dirty FAT sectors to every FAT copy
+            virtual bool Sync() override;
+            // FAT sectors and FSInfo only; pending appends stay buffered
+            bool SyncFAT();
+            // Constant time: the free count comes from FSInfo or the mount scan
+            virtual bool GetStats(FsStats& out) override;
+            virtual bool IsBusy() const override { return opDepth || dev->IsBusy(); }
+            virtual bool Open(const int8_t* path, FileHandle& out, bool create) override;
+            virtual int32_t ReadAt(FileHandle& file, uint32_t offset, uint8_t* buf, uint32_t len) override;
+            virtual int32_t WriteAt(FileHandle& file, uint32_t offset, const uint8_t* buf, uint32_t len) override;
 
         private:
             BlockDevice* dev;
@@ -47,6 +80,38 @@ namespace kos {
             uint32_t dataStartLBA;
             bool mountedFlag;
 
+            // In-memory FAT: 4 KiB pages read on first use (or all at mount for
+            // small volumes), a free-cluster bitmap built at mount and one dirty
+            // bit per FAT sector. Null fatPages means direct FAT sector access.
+            uint32_t** fatPages;
+            uint32_t fatPageCount;
+            uint32_t fatEntryCount;   // Data clusters + 2
+            uint32_t* fatDirty;       // One bit per FAT sector
+            uint32_t* freeMap;        // One bit per cluster, set = free
+            uint32_t freeClusters;
+            uint32_t nextFreeHint;    // Allocation resumes here
+            // With a trusted FSInfo the bitmap is built on first allocation
+            bool freeMapBuilt;
+            bool fsInfoDirty;         // Free count or hint changed since the last Sync
+            // FAT[1]'s clean-shutdown bit is clear on disk: cleared before the
+            // first FAT change, set again by Sync() once FSInfo matches the FAT
+            bool volumeDirty;
+
+            DentryCache dentries;     // Keyed by directory cluster; root = rootCluster
+
+            FAT32AppendStream streams[FAT32_APPEND_STREAMS];
+            volatile uint32_t opDepth;        // Public operations in progress
+            volatile bool appendFlushArmed;
+
+            // Marks an operation in progress, so the timed append flush
+            // backs off, and first makes pending appends visible
+            struct OpGuard {
+                enum Mode { KEEP = 0, FLUSH = 1, FORGET = 2 };
+                FAT32* fs;
+                OpGuard(FAT32* f, Mode mode);
+                ~OpGuard();
+            };
+
             bool ReadSector(uint32_t lba, uint8_t* buf);
             bool WriteSector(uint32_t lba, const uint8_t* buf);
             uint32_t ClusterToLBA(uint32_t cluster);
@@ -59,6 +124,19 @@ namespace kos {
             uint32_t NextCluster(uint32_t cluster);
             bool UpdateFAT(uint32_t cluster, uint32_t value);
             uint32_t AllocateCluster();
+            // Up to 'want' chained clusters in one run, at 'goal' if it is free;
+            // returns the first (0 if none) and the count in 'got'
+            uint32_t AllocateRun(uint32_t goal, uint32_t want, uint32_t& got);
+            bool EnsureFreeMap();
+            bool LoadFATCache();
+            void FreeFATCache();
+            uint32_t* FATPage(uint32_t page);
+            uint32_t FindFreeCluster();
+            bool BuildFreeMap();
+            bool ReadFSInfo(uint32_t& outFree, uint32_t& outNextFree);
+            bool WriteFSInfo();
+            void MarkVolumeDirty();
+            bool WriteCleanFlag(bool clean);
             bool FindShortNameInDirCluster(uint32_t dirCluster, const int8_t* shortName83, uint32_t& outStartCluster, uint32_t& outFileSize);
             bool AddEntryToDirCluster(uint32_t dirCluster, const uint8_t shortName11[11], uint32_t startCluster, bool isDir);
             void PackShortName11(const int8_t* name83, uint8_t out11[11], bool& okIs83, bool upperOnly = true);
@@ -67,6 +145,31 @@ namespace kos {
             // return the cluster that contains the entry plus the byte offset inside that cluster.
             bool FindShortEntryWithOffset(uint32_t dirCluster, const uint8_t shortName11[11], uint32_t& outClusterContaining, uint32_t& outEntryOffset, uint32_t& outStartCluster, uint32_t& outFileSize, uint8_t& outAttr);
             bool AddFileEntryToDir(uint32_t dirCluster, const uint8_t shortName11[11], uint32_t startCluster, uint32_t initialSize);
+            // Walk every component but the last; the last is returned upper-cased
+            bool ResolveParent(const int8_t* path, uint32_t& outDirCluster, int8_t outName[13]);
+            // Cluster number 'index' of an open file's chain (0 past the end),
+            // walking on from the handle's cached position when possible
+            uint32_t FileCluster(FileHandle& file, uint32_t index);
+            // Store an open file's start cluster and size in its directory entry
+            bool WriteFileEntry(FileHandle& file);
+            bool RefreshFileEntry(FileHandle& file);
+            // Ask the device to cache 'bytes' of the file from 'offset', one
+            // request per run of consecutive clusters
+            void Readahead(const FileHandle& file, uint32_t offset, uint32_t bytes);
+
+            FAT32AppendStream* FindStream(uint32_t dirCluster, const uint8_t name[11]);
+            FAT32AppendStream* OpenStream(uint32_t dirCluster, const uint8_t name[11], uint32_t entryCluster,
+                                          uint32_t entryOffset, uint32_t startCluster, uint32_t size);
+            int32_t AppendToStream(FAT32AppendStream* st, const uint8_t* data, uint32_t len);
+            // Write bytes after the stream's end; returns how many reached the disk
+            uint32_t StreamWrite(FAT32AppendStream* st, const uint8_t* src, uint32_t len);
+            bool FlushStream(FAT32AppendStream* st);
+            void ForgetStream(FAT32AppendStream* st);
+            // Write every stream's pending bytes (older than minAge ms);
+            // 'forget' also drops the streams, for changes made around them
+            bool FlushAppends(bool forget, uint32_t minAge = 0);
+            void ArmAppendFlush();
+            static void AppendFlushWork(void* arg);
         public:
             virtual int32_t ReadFile(const int8_t* path, uint8_t* outBuf, uint32_t maxLen) override;
             virtual int32_t Mkdir(const int8_t* path, int32_t parents) override;
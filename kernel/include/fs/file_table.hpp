@@ -0,0 +1,71 @@
+#ifndef __KOS__FS__FILE_TABLE_H
+#define __KOS__FS__FILE_TABLE_H
+
+#include <common/types.hpp>
+#include <fs/filesystem.hpp>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace fs {
+
+        static const uint32_t FD_PER_PROCESS = 16;
+        static const int32_t FD_FIRST = 3;          // 0-2 are left for stdio
+
+        enum FileOpenFlags {
+            FD_READ = 1u << 0,
+            FD_WRITE = 1u << 1,
+            FD_CREATE = 1u << 2,                    // Create the file if missing
+            FD_APPEND = 1u << 3                     // Every write goes to the end
+        };
+
+        enum FileSeekWhence {
+            FD_SEEK_SET = 0,
+            FD_SEEK_CUR = 1,
+            FD_SEEK_END = 2
+        };
+
+        // One open() call: the filesystem handle with its cached cluster
+        // position, plus the offset read()/write() continue from
+        struct OpenFile {
+            Filesystem* fs;
+            FileHandle handle;
+            uint32_t flags;
+            uint32_t offset;
+            uint32_t sequence;                      // Open order, see FileAPI::Mark
+        };
+
+        // Descriptor table of one process (pid, else thread id; 0 = kernel
+        // and apps run from the shell)
+        struct FileTable {
+            uint32_t owner;
+            uint32_t open_count;
+            OpenFile* files[FD_PER_PROCESS];
+            FileTable* next;
+        };
+
+        namespace FileAPI {
+            // Descriptor (>= FD_FIRST) or -1. Paths are absolute and normalized.
+            int32_t Open(const int8_t* path, uint32_t flags);
+            int32_t Close(int32_t fd);
+            // Sequential I/O from the descriptor offset, which advances
+            int32_t Read(int32_t fd, uint8_t* buf, uint32_t len);
+            int32_t Write(int32_t fd, const uint8_t* buf, uint32_t len);
+            // Positional I/O; the descriptor offset is left alone
+            int32_t PRead(int32_t fd, uint8_t* buf, uint32_t len, uint32_t offset);
+            int32_t PWrite(int32_t fd, const uint8_t* buf, uint32_t len, uint32_t offset);
+            // New offset or -1; offsets past the end are refused
+            int32_t Seek(int32_t fd, int32_t offset, uint32_t whence);
+            int32_t Size(int32_t fd);
+
+            // Apps run on their caller's thread, so the ELF loader takes a
+            // mark before entry and closes what the app left open after it
+            uint32_t Mark();
+            void CloseSince(uint32_t mark);
+            void PrintAll();
+        }
+
+    } // namespace fs
+} // namespace kos
+
+#endif // __KOS__FS__FILE_TABLE_H
@@ -15,6 +15,34 @@ namespace kos {
             bool isDir;         // Convenience flag
         };
         
+        // Volume usage in clusters; clusterBytes converts to bytes
+        struct FsStats {
+            uint32_t clusterBytes;
+            uint32_t totalClusters;
+            uint32_t freeClusters;
+            uint32_t usedClusters;
+        };
+
+        // An open regular file. Open() fills in the entry location; ReadAt
+        // and WriteAt keep the last cluster they reached, so sequential
+        // access never rewalks the chain from the start. The size is the
+        // one seen at open plus this handle's own writes.
+        struct FileHandle {
+            uint32_t startCluster;      // 0 while the file is empty
+            uint32_t size;
+            uint8_t attr;
+            uint32_t dirCluster;        // Directory holding the entry
+            uint32_t entryCluster;      // Cluster and byte offset of the entry
+            uint32_t entryOffset;
+            uint32_t posCluster;        // Cluster number posIndex of the chain; 0 = none
+            uint32_t posIndex;
+            // Readahead: where a sequential read would start next, how far
+            // ahead has been requested and the current window in bytes
+            uint32_t raNext;
+            uint32_t raEnd;
+            uint32_t raWindow;
+        };
+
         // Callback type for directory enumeration
         // Returns true to continue enumeration, false to stop
         typedef bool (*DirEnumCallback)(const DirEntry* entry, void* userdata);
@@ -45,6 +73,27 @@ namespace kos {
             virtual int32_t EnumDir(const int8_t* path, DirEnumCallback callback, void* userdata) {
                 (void)path; (void)callback; (void)userdata; return -1;
             }
+            // Write metadata kept in memory back to the device. Default: none kept.
+            virtual bool Sync() { return true; }
+            // An operation or device request is in progress. Deferred writers
+            // check it and retry later instead of re-entering the filesystem.
+            virtual bool IsBusy() const { return false; }
+            // Volume usage without scanning; false if the filesystem cannot tell
+            virtual bool GetStats(FsStats& out) { (void)out; return false; }
+            // Open a regular file (8.3 path), creating it empty if asked.
+            // Default: unsupported.
+            virtual bool Open(const int8_t* path, FileHandle& out, bool create) {
+                (void)path; (void)out; (void)create; return false;
+            }
+            // Positional I/O on an open file; bytes transferred or -1. Reads
+            // stop at the end of file; writes may start at most at the end
+            // (no holes) and grow the file.
+            virtual int32_t ReadAt(FileHandle& file, uint32_t offset, uint8_t* buf, uint32_t len) {
+                (void)file; (void)offset; (void)buf; (void)len; return -1;
+            }
+            virtual int32_t WriteAt(FileHandle& file, uint32_t offset, const uint8_t* buf, uint32_t len) {
+                (void)file; (void)offset; (void)buf; (void)len; return -1;
+            }
         };
         extern Filesystem* g_fs_ptr;
         // ...existing code...
@@ -57,6 +57,40 @@ typedef struct ApiTableC {
     int32_t (*net_list_sockets)(void* out, int32_t max, int32_t want_tcp, int32_t want_udp, int32_t listening_only);
     // Enumerate directory entries. Calls callback for each entry. Returns count or <0 on error.
     int32_t (*enumdir)(const int8_t* path, int32_t (*callback)(const void* entry, void* userdata), void* userdata);
+    // Record a user marker in the scheduler trace (no-op while tracing is off).
+    void (*trace_mark)(const int8_t* label, uint32_t value);
+    // Batched pipe/message queue IPC; see kos_pipe_writev / kos_mq_send_batch
+    uint32_t (*pipe_find)(const int8_t* name);
+    uint32_t (*pipe_writev)(uint32_t pipe_id, void* vec, uint32_t count, int32_t block);
+    uint32_t (*pipe_readv)(uint32_t pipe_id, void* vec, uint32_t count, int32_t block);
+    uint32_t (*mq_find)(const int8_t* name);
+    uint32_t (*mq_send_batch)(uint32_t queue_id, const void* entries, uint32_t count, int32_t block);
+    uint32_t (*mq_receive_batch)(uint32_t queue_id, void* entries, uint32_t count, int32_t block);
+    // Readiness multiplexing; see kos_poll_wait
+    uint32_t (*poll_create)(void);
+    int32_t (*poll_destroy)(uint32_t poller_id);
+    int32_t (*poll_ctl)(uint32_t poller_id, uint32_t op, const void* reg);
+    int32_t (*poll_wait)(uint32_t poller_id, void* out, uint32_t max, int32_t timeout_ms);
+    // Named shared memory and futexes; see kos_shm_map / kos_futex_wait
+    uint32_t (*shm_create)(const int8_t* name, uint32_t size);
+    uint32_t (*shm_open)(const int8_t* name);
+    void* (*shm_map)(uint32_t region_id, uint32_t* size_out);
+    int32_t (*shm_unmap)(uint32_t region_id);
+    int32_t (*shm_destroy)(uint32_t region_id);
+    int32_t (*futex_wait)(volatile uint32_t* addr, uint32_t expected, int32_t timeout_ms);
+    uint32_t (*futex_wake)(volatile uint32_t* addr, uint32_t count);
+    // Flush the disk block cache; see kos_sync
+    int32_t (*sync)(void);
+    int32_t (*fs_stats)(void* out);
+    // File descriptors; see kos_open
+    int32_t (*open)(const int8_t* path, uint32_t flags);
+    int32_t (*close)(int32_t fd);
+    int32_t (*read)(int32_t fd, uint8_t* buf, uint32_t len);
+    int32_t (*write)(int32_t fd, const uint8_t* buf, uint32_t len);
+    int32_t (*pread)(int32_t fd, uint8_t* buf, uint32_t len, uint32_t offset);
+    int32_t (*pwrite)(int32_t fd, const uint8_t* buf, uint32_t len, uint32_t offset);
+    int32_t (*seek)(int32_t fd, int32_t offset, uint32_t whence);
+    int32_t (*fsize)(int32_t fd);
 } ApiTableC;
 
 static inline ApiTableC* kos_sys_table(void) {
@@ -180,6 +214,214 @@ static inline int32_t kos_enumdir(const int8_t* path, kos_enumdir_callback_t cal
     return -1;
 }
 
+// Scheduler trace marker; shows up as an instant event in the Chrome trace dump
+static inline void kos_trace_mark(const int8_t* label, uint32_t value) {
+    if (kos_sys_table()->trace_mark) kos_sys_table()->trace_mark(label, value);
+}
+
+// One element of a vectored pipe call (matches kernel PipeVec). For writes
+// size is the payload length; for reads it is the buffer capacity.
+// transferred reports the bytes moved.
+typedef struct kos_pipe_vec_t {
+    void*    data;
+    uint32_t size;
+    uint32_t transferred;
+} kos_pipe_vec_t;
+
+// One message of a batched queue call (matches kernel MessageBatchEntry).
+// Send uses receiver_id, type, data, size; receive fills length, type,
+// sender_id and message_id.
+typedef struct kos_mq_entry_t {
+    uint32_t receiver_id;
+    uint32_t type;
+    void*    data;
+    uint32_t size;
+    uint32_t length;
+    uint32_t sender_id;
+    uint32_t message_id;
+} kos_mq_entry_t;
+
+static inline uint32_t kos_pipe_find(const int8_t* name) {
+    return kos_sys_table()->pipe_find ? kos_sys_table()->pipe_find(name) : 0;
+}
+
+// Send count messages (or stream chunks) with one lock and one wakeup;
+// returns how many went through, stopping at the first failure
+static inline uint32_t kos_pipe_writev(uint32_t pipe_id, kos_pipe_vec_t* vec, uint32_t count, int32_t block) {
+    return kos_sys_table()->pipe_writev ? kos_sys_table()->pipe_writev(pipe_id, (void*)vec, count, block) : 0;
+}
+
+// Read up to count messages; with block set, waits only for the first
+static inline uint32_t kos_pipe_readv(uint32_t pipe_id, kos_pipe_vec_t* vec, uint32_t count, int32_t block) {
+    return kos_sys_table()->pipe_readv ? kos_sys_table()->pipe_readv(pipe_id, (void*)vec, count, block) : 0;
+}
+
+static inline uint32_t kos_mq_find(const int8_t* name) {
+    return kos_sys_table()->mq_find ? kos_sys_table()->mq_find(name) : 0;
+}
+
+static inline uint32_t kos_mq_send_batch(uint32_t queue_id, const kos_mq_entry_t* entries, uint32_t count, int32_t block) {
+    return kos_sys_table()->mq_send_batch ? kos_sys_table()->mq_send_batch(queue_id, (const void*)entries, count, block) : 0;
+}
+
+static inline uint32_t kos_mq_receive_batch(uint32_t queue_id, kos_mq_entry_t* entries, uint32_t count, int32_t block) {
+    return kos_sys_table()->mq_receive_batch ? kos_sys_table()->mq_receive_batch(queue_id, (void*)entries, count, block) : 0;
+}
+
+// Poller sources, control ops and readiness bits (match kernel poller.hpp)
+#define KOS_POLL_SOURCE_PIPE   1u   // id = pipe id
+#define KOS_POLL_SOURCE_QUEUE  2u   // id = queue id, arg = receiver id (0 = any)
+#define KOS_POLL_SOURCE_SOCKET 3u   // id = socket fd
+#define KOS_POLL_SOURCE_INPUT  4u   // id = 0
+#define KOS_POLL_CTL_ADD 1u
+#define KOS_POLL_CTL_MOD 2u
+#define KOS_POLL_CTL_DEL 3u
+#define KOS_POLL_IN   0x001u
+#define KOS_POLL_OUT  0x004u
+#define KOS_POLL_ERR  0x008u
+#define KOS_POLL_HUP  0x010u
+#define KOS_POLL_EDGE 0x80000000u   // Report once per change, not while ready
+
+typedef struct kos_poll_reg_t {
+    uint32_t source;
+    uint32_t id;
+    uint32_t arg;
+    uint32_t events;
+    uint32_t user_data;
+} kos_poll_reg_t;
+
+typedef struct kos_poll_event_t {
+    uint32_t source;
+    uint32_t id;
+    uint32_t events;
+    uint32_t user_data;
+} kos_poll_event_t;
+
+static inline uint32_t kos_poll_create(void) {
+    return kos_sys_table()->poll_create ? kos_sys_table()->poll_create() : 0;
+}
+
+static inline int32_t kos_poll_destroy(uint32_t poller_id) {
+    return kos_sys_table()->poll_destroy ? kos_sys_table()->poll_destroy(poller_id) : -1;
+}
+
+// Returns 0 on success, -1 on failure
+static inline int32_t kos_poll_ctl(uint32_t poller_id, uint32_t op, const kos_poll_reg_t* reg) {
+    return kos_sys_table()->poll_ctl ? kos_sys_table()->poll_ctl(poller_id, op, (const void*)reg) : -1;
+}
+
+// Wait up to timeout_ms (<0 = forever, 0 = just check) for a registered
+// source to become ready; returns the number of events filled in
+static inline int32_t kos_poll_wait(uint32_t poller_id, kos_poll_event_t* out, uint32_t max, int32_t timeout_ms) {
+    return kos_sys_table()->poll_wait ? kos_sys_table()->poll_wait(poller_id, (void*)out, max, timeout_ms) : -1;
+}
+
+// Create a zeroed shared region of at least size bytes; returns its id
+static inline uint32_t kos_shm_create(const int8_t* name, uint32_t size) {
+    return kos_sys_table()->shm_create ? kos_sys_table()->shm_create(name, size) : 0;
+}
+
+static inline uint32_t kos_shm_open(const int8_t* name) {
+    return kos_sys_table()->shm_open ? kos_sys_table()->shm_open(name) : 0;
+}
+
+// Address of the region (identical in every task), or 0
+static inline void* kos_shm_map(uint32_t region_id, uint32_t* size_out) {
+    return kos_sys_table()->shm_map ? kos_sys_table()->shm_map(region_id, size_out) : 0;
+}
+
+static inline int32_t kos_shm_unmap(uint32_t region_id) {
+    return kos_sys_table()->shm_unmap ? kos_sys_table()->shm_unmap(region_id) : -1;
+}
+
+// Remove the name; memory is freed once the last mapper unmaps
+static inline int32_t kos_shm_destroy(uint32_t region_id) {
+    return kos_sys_table()->shm_destroy ? kos_sys_table()->shm_destroy(region_id) : -1;
+}
+
+#define KOS_FUTEX_WOKEN     0
+#define KOS_FUTEX_AGAIN    -1
+#define KOS_FUTEX_TIMEDOUT -2
+#define KOS_FUTEX_INVALID  -3
+
+// Sleep while *addr == expected (timeout_ms < 0 = forever). Wakeups may be
+// spurious, so re-check the word after it returns.
+static inline int32_t kos_futex_wait(volatile uint32_t* addr, uint32_t expected, int32_t timeout_ms) {
+    return kos_sys_table()->futex_wait ? kos_sys_table()->futex_wait(addr, expected, timeout_ms) : KOS_FUTEX_INVALID;
+}
+
+static inline uint32_t kos_futex_wake(volatile uint32_t* addr, uint32_t count) {
+    return kos_sys_table()->futex_wake ? kos_sys_table()->futex_wake(addr, count) : 0;
+}
+
+// Write every dirty cached disk block back; 0 on success
+static inline int32_t kos_sync(void) {
+    return kos_sys_table()->sync ? kos_sys_table()->sync() : -1;
+}
+
+// Volume usage in clusters (matches kernel FsStats)
+typedef struct kos_fs_stats_t {
+    uint32_t cluster_bytes;
+    uint32_t total_clusters;
+    uint32_t free_clusters;
+    uint32_t used_clusters;
+} kos_fs_stats_t;
+
+// Constant-time free space query; -1 if no filesystem can answer
+static inline int32_t kos_fs_stats(kos_fs_stats_t* out) {
+    return kos_sys_table()->fs_stats ? kos_sys_table()->fs_stats((void*)out) : -1;
+}
+
+// Open flags (match kernel FileOpenFlags); neither READ nor WRITE means READ
+#define KOS_O_READ   (1u << 0)
+#define KOS_O_WRITE  (1u << 1)
+#define KOS_O_CREATE (1u << 2)
+#define KOS_O_APPEND (1u << 3)
+
+#define KOS_SEEK_SET 0
+#define KOS_SEEK_CUR 1
+#define KOS_SEEK_END 2
+
+// Open a file for streaming I/O; descriptor or -1. Each descriptor keeps
+// its cluster position, so reading a large file in small chunks costs the
+// same as reading it whole. Descriptors an app leaves open are closed when
+// it exits.
+static inline int32_t kos_open(const int8_t* path, uint32_t flags) {
+    return kos_sys_table()->open ? kos_sys_table()->open(path, flags) : -1;
+}
+
+static inline int32_t kos_close(int32_t fd) {
+    return kos_sys_table()->close ? kos_sys_table()->close(fd) : -1;
+}
+
+// Bytes read (0 at end of file) or -1; advances the descriptor offset
+static inline int32_t kos_read(int32_t fd, uint8_t* buf, uint32_t len) {
+    return kos_sys_table()->read ? kos_sys_table()->read(fd, buf, len) : -1;
+}
+
+static inline int32_t kos_write(int32_t fd, const uint8_t* buf, uint32_t len) {
+    return kos_sys_table()->write ? kos_sys_table()->write(fd, buf, len) : -1;
+}
+
+// Positional variants leave the descriptor offset alone. Writes may start
+// at most at the end of the file.
+static inline int32_t kos_pread(int32_t fd, uint8_t* buf, uint32_t len, uint32_t offset) {
+    return kos_sys_table()->pread ? kos_sys_table()->pread(fd, buf, len, offset) : -1;
+}
+
+static inline int32_t kos_pwrite(int32_t fd, const uint8_t* buf, uint32_t len, uint32_t offset) {
+    return kos_sys_table()->pwrite ? kos_sys_table()->pwrite(fd, buf, len, offset) : -1;
+}
+
+// New offset or -1; seeking past the end is refused
+static inline int32_t kos_seek(int32_t fd, int32_t offset, uint32_t whence) {
+    return kos_sys_table()->seek ? kos_sys_table()->seek(fd, offset, whence) : -1;
+}
+
+static inline int32_t kos_fsize(int32_t fd) {
+    return kos_sys_table()->fsize ? kos_sys_table()->fsize(fd) : -1;
+}
+
 // Flags for kos_listdir_ex
 #define KOS_LS_FLAG_LONG  (1u << 0)  // Show long listing: attrs, size, date
 #define KOS_LS_FLAG_ALL   (1u << 1)  // Include hidden and dot entries
@@ -0,0 +1,32 @@
+#ifndef KOS_LIB_MEMOPS_HPP
+#define KOS_LIB_MEMOPS_HPP
+
+#include <lib/libc/string.h>
+#include <common/types.hpp>
+
+using namespace kos::common;
+
+// Slots behind large kernel memcpy/memset calls (lib/libc/string.c),
+// bound at boot by CpuDispatch to the best variant for the CPU
+extern "C" {
+    extern void* (*kos_memcpy_fast)(void* dest, const void* src, size_t n);
+    extern void* (*kos_memset_fast)(void* s, int c, size_t n);
+}
+
+namespace kos {
+    namespace lib {
+        class MemOps {
+            public:
+                // Bulk copy into memory the CPU will not read back soon (the
+                // framebuffer, VRAM). Uses non-temporal SSE2 stores when
+                // usable so the copy does not evict the working set.
+                static void StreamCopy(void* dest, const void* src, uint32_t n);
+
+                // Time every usable memcpy/memset variant over a range of
+                // sizes and print the throughput (shell: membench)
+                static void Benchmark();
+        };
+    }
+}
+
+#endif
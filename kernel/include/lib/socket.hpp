@@ -114,6 +114,11 @@ namespace kos {
 
         int SocketEnumerate(SocketEnumEntry* out, int max);
 
+        // Readiness of fd as process::POLL_* bits: writable while connected,
+        // POLL_HUP once the socket is gone. Arrivals are posted to pollers by
+        // send(), since sockets keep no receive buffer yet.
+        unsigned SocketPollState(int fd);
+
         // Register INET sockets (testing stubs until real TCP/UDP stack exists)
         int SocketListenInet(SocketType type, unsigned port);
         int SocketConnectInet(SocketType type, const char* raddr, unsigned rport, unsigned lport);
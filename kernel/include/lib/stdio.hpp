@@ -78,6 +78,49 @@ namespace kos {
             int32_t (*net_list_sockets)(void* out, int32_t max, int32_t want_tcp, int32_t want_udp, int32_t listening_only);
             // Enumerate directory entries. Calls callback for each entry. Returns count or <0 on error.
             int32_t (*enumdir)(const int8_t* path, int32_t (*callback)(const void*, void*), void* userdata);
+            // Record a user marker in the scheduler trace (no-op while tracing is off).
+            void (*trace_mark)(const int8_t* label, uint32_t value);
+            // Batched pipe/message queue IPC. find returns an id (0 = not found);
+            // vec/entries are PipeVec / MessageBatchEntry arrays. Each call returns
+            // the number of elements completed.
+            uint32_t (*pipe_find)(const int8_t* name);
+            uint32_t (*pipe_writev)(uint32_t pipe_id, void* vec, uint32_t count, int32_t block);
+            uint32_t (*pipe_readv)(uint32_t pipe_id, void* vec, uint32_t count, int32_t block);
+            uint32_t (*mq_find)(const int8_t* name);
+            uint32_t (*mq_send_batch)(uint32_t queue_id, const void* entries, uint32_t count, int32_t block);
+            uint32_t (*mq_receive_batch)(uint32_t queue_id, void* entries, uint32_t count, int32_t block);
+            // Readiness multiplexing over pipes, queues, sockets and input.
+            // reg is a PollRegistration, out a PollEvent array; wait returns
+            // the ready count, 0 on timeout, -1 on error.
+            uint32_t (*poll_create)();
+            int32_t (*poll_destroy)(uint32_t poller_id);
+            int32_t (*poll_ctl)(uint32_t poller_id, uint32_t op, const void* reg);
+            int32_t (*poll_wait)(uint32_t poller_id, void* out, uint32_t max, int32_t timeout_ms);
+            // Named shared memory (ids, 0 = failure) and futex wait/wake on a
+            // word inside it. shm_map returns the region address, the same
+            // in every task. futex_wait returns 0 woken, -1 value changed,
+            // -2 timeout, -3 bad address.
+            uint32_t (*shm_create)(const int8_t* name, uint32_t size);
+            uint32_t (*shm_open)(const int8_t* name);
+            void* (*shm_map)(uint32_t region_id, uint32_t* size_out);
+            int32_t (*shm_unmap)(uint32_t region_id);
+            int32_t (*shm_destroy)(uint32_t region_id);
+            int32_t (*futex_wait)(volatile uint32_t* addr, uint32_t expected, int32_t timeout_ms);
+            uint32_t (*futex_wake)(volatile uint32_t* addr, uint32_t count);
+            // Write cached disk blocks back; 0 on success
+            int32_t (*sync)();
+            // Volume usage of the mounted filesystem into a kos_fs_stats_t
+            int32_t (*fs_stats)(void* out);
+            // File descriptors (>= 3, -1 on failure) for streaming reads and
+            // positional writes; flags are the KOS_O_* values
+            int32_t (*open)(const int8_t* path, uint32_t flags);
+            int32_t (*close)(int32_t fd);
+            int32_t (*read)(int32_t fd, uint8_t* buf, uint32_t len);
+            int32_t (*write)(int32_t fd, const uint8_t* buf, uint32_t len);
+            int32_t (*pread)(int32_t fd, uint8_t* buf, uint32_t len, uint32_t offset);
+            int32_t (*pwrite)(int32_t fd, const uint8_t* buf, uint32_t len, uint32_t offset);
+            int32_t (*seek)(int32_t fd, int32_t offset, uint32_t whence);
+            int32_t (*fsize)(int32_t fd);
         };
 
         /*
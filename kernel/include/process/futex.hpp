@@ -0,0 +1,36 @@
+#ifndef __KOS__PROCESS__FUTEX_H
+#define __KOS__PROCESS__FUTEX_H
+
+#include <common/types.hpp>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace process {
+
+        static const uint32_t FUTEX_MAX_WAITERS = 64;
+
+        enum FutexResult {
+            FUTEX_WOKEN = 0,
+            FUTEX_AGAIN = -1,           // *addr no longer held the expected value
+            FUTEX_TIMEDOUT = -2,
+            FUTEX_INVALID = -3          // Null or misaligned word
+        };
+
+        // Wait/wake on a 32-bit word, the building block for locks and
+        // producer/consumer rings in shared memory. The kernel only parks
+        // and wakes tasks; the protocol on the word belongs to the caller.
+        // Waiters are keyed by physical address, so every mapping of a
+        // shared region reaches the same queue.
+        namespace Futex {
+            // Sleep while *addr == expected, up to timeout_ms (< 0 = forever).
+            // Wakeups may be spurious: callers re-check the word.
+            int32_t Wait(volatile uint32_t* addr, uint32_t expected, int32_t timeout_ms);
+            // Wake up to count waiters on addr; returns how many were woken
+            uint32_t Wake(volatile uint32_t* addr, uint32_t count);
+        }
+
+    } // namespace process
+} // namespace kos
+
+#endif // __KOS__PROCESS__FUTEX_H
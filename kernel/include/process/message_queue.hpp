@@ -3,6 +3,7 @@
 
 #include <common/types.hpp>
 #include <process/sync.hpp>
+#include <process/object_table.hpp>
 
 using namespace kos::common;
 
@@ -17,40 +18,94 @@ namespace kos {
             MSG_TYPE_SYSTEM = 4,
         };
 
-        struct QueueMessage {
+        // Payloads up to this size are stored in the slot itself; larger
+        // ones (up to the queue's max_message_size) are heap copies
+        static const uint32_t MQ_INLINE_PAYLOAD = 64;
+        // Lane 0 holds messages for any receiver; the rest are per receiver.
+        // Once all are bound, a drained lane is rebound to the next receiver.
+        static const uint32_t MQ_MAX_LANES = 16;
+
+        // One entry of a lane ring. sequence is the Vyukov turn counter: it
+        // equals the ring position when the slot is free for that position
+        // and position + 1 once the message in it is published.
+        struct QueueSlot {
+            volatile uint32_t sequence;
             uint32_t message_id;
             uint32_t sender_id;
-            uint32_t receiver_id;    // 0 means broadcast/any receiver
+            uint32_t receiver_id;
             MessageType type;
             uint32_t data_size;
-            uint8_t* data;
-            QueueMessage* next;
+            uint8_t* heap_data;                    // Set for payloads above MQ_INLINE_PAYLOAD
+            uint8_t inline_data[MQ_INLINE_PAYLOAD];
+        };
+
+        // One element of SendBatch/ReceiveBatch. SendBatch reads receiver_id,
+        // type, data and size; ReceiveBatch fills data (capacity size) and
+        // reports length, type, sender_id and message_id.
+        struct MessageBatchEntry {
+            uint32_t receiver_id;
+            MessageType type;
+            void* data;
+            uint32_t size;
+            uint32_t length;
+            uint32_t sender_id;
+            uint32_t message_id;
+        };
 
-            QueueMessage(uint32_t id, uint32_t sender, uint32_t receiver,
-                         MessageType msg_type, uint32_t size, const void* payload);
-            ~QueueMessage();
+        // Bounded multi-producer/multi-consumer ring for one receiver id
+        struct QueueLane {
+            volatile uint32_t receiver_id;
+            mutable volatile uint32_t users;       // Held from lookup until the ring access is done
+            volatile uint32_t enqueue_pos;
+            volatile uint32_t dequeue_pos;
+            uint32_t mask;
+            QueueSlot* slots;
         };
 
+        // Message queue built from sequence-numbered slot rings. Senders and
+        // receivers claim ring positions with a compare-and-swap, so neither
+        // side takes the queue mutex unless it has to sleep. Each receiver id
+        // gets its own lane, so a directed Receive never walks past other
+        // receivers' messages; FIFO order holds within a lane.
         class MessageQueue {
         private:
             uint32_t queue_id;
             char name[32];
             uint32_t max_messages;
             uint32_t max_message_size;
-            uint32_t message_count;
+            volatile uint32_t message_count;       // Reserved by Send, released by Receive
 
-            QueueMessage* message_head;
-            QueueMessage* message_tail;
-            uint32_t next_message_id;
+            QueueLane lanes[MQ_MAX_LANES];
+            volatile uint32_t lane_count;          // Lanes [0, lane_count) are initialized
+            uint32_t lane_capacity;                // Slots per lane: max_messages rounded up to a power of two
+            volatile uint32_t next_message_id;
 
-            Mutex* queue_mutex;
+            Mutex* queue_mutex;                    // Lane creation and sleeping only
             ConditionVariable* read_cv;
             ConditionVariable* write_cv;
 
             bool is_closed;
             bool blocking_mode;
 
-            QueueMessage* FindMatchingMessage(uint32_t receiver_id, QueueMessage** prev_out) const;
+            bool InitLane(QueueLane* lane, uint32_t receiver_id);
+            QueueLane* FindLane(uint32_t receiver_id) const;
+            // Both return the lane held (users raised); drop it with ReleaseLane()
+            QueueLane* AcquireLane(uint32_t receiver_id) const;
+            QueueLane* GetOrCreateLane(uint32_t receiver_id);
+            static void ReleaseLane(const QueueLane* lane);
+            bool TryReserve();
+            void ReleaseReservation();
+            bool LanePush(QueueLane* lane, uint32_t sender_id, uint32_t receiver_id, MessageType type,
+                          const void* data, uint32_t size, uint8_t* heap_data);
+            bool LanePop(QueueLane* lane, MessageType* out_type, void* buffer, uint32_t buffer_size,
+                         uint32_t* bytes_read, uint32_t* out_sender_id, uint32_t* out_message_id);
+            bool Enqueue(uint32_t sender_id, uint32_t receiver_id, MessageType type,
+                         const void* data, uint32_t size, bool block, bool notify_before_wait);
+            bool Take(uint32_t receiver_id, MessageType* out_type, void* buffer, uint32_t buffer_size,
+                      uint32_t* bytes_read, uint32_t* out_sender_id, uint32_t* out_message_id, bool block);
+            void NotifyReceivers();
+            bool LanePeek(const QueueLane* lane, MessageType* out_type, void* buffer, uint32_t buffer_size,
+                          uint32_t* bytes_available, uint32_t* out_sender_id, uint32_t* out_message_id) const;
 
         public:
             MessageQueue(uint32_t id, const char* queue_name,
@@ -59,6 +114,8 @@ namespace kos {
 
             bool Send(uint32_t sender_id, uint32_t receiver_id, MessageType type,
                       const void* data, uint32_t size, bool block = true);
+            // receiver_id 0 takes any message; otherwise its own lane is
+            // drained before messages addressed to any receiver
             bool Receive(uint32_t receiver_id, MessageType* out_type,
                          void* buffer, uint32_t buffer_size, uint32_t* bytes_read,
                          uint32_t* out_sender_id = nullptr,
@@ -69,6 +126,15 @@ namespace kos {
                       uint32_t* out_sender_id = nullptr,
                       uint32_t* out_message_id = nullptr) const;
 
+            // Batched Send/Receive with one wakeup per batch. Each entry
+            // behaves like its own Send/Receive and the batch stops at the
+            // first one that fails; ReceiveBatch blocks only for the first
+            // message. Returns the number of entries completed.
+            uint32_t SendBatch(uint32_t sender_id, const MessageBatchEntry* entries,
+                               uint32_t count, bool block = true);
+            uint32_t ReceiveBatch(uint32_t receiver_id, MessageBatchEntry* entries,
+                                  uint32_t count, bool block = true);
+
             void Close();
             void Flush();
             void SetBlockingMode(bool blocking) { blocking_mode = blocking; }
@@ -78,23 +144,24 @@ namespace kos {
             uint32_t GetMessageCount() const { return message_count; }
             uint32_t GetMaxMessages() const { return max_messages; }
             uint32_t GetMaxMessageSize() const { return max_message_size; }
+            uint32_t GetLaneCount() const { return lane_count; }
             bool IsEmpty() const { return message_count == 0; }
+            // True if Receive(receiver_id) would find a message now
+            bool HasMessageFor(uint32_t receiver_id) const;
             bool IsFull() const { return message_count >= max_messages; }
             bool IsClosed() const { return is_closed; }
             bool IsBlocking() const { return blocking_mode; }
 
             void PrintInfo() const;
+
+            // Uncontended Send/Receive cost in cycles (shell: mqbench)
+            static void Benchmark();
         };
 
         class MessageQueueManager {
         private:
-            MessageQueue* queues[64];
-            uint32_t queue_count;
-            uint32_t next_queue_id;
-            Mutex* manager_mutex;
-
-            int FindQueueIndex(uint32_t queue_id) const;
-            int FindQueueIndex(const char* name) const;
+            ObjectTable queues;         // Queue IDs are generation-checked handles
+            RwLock* manager_lock;       // Lookups share, create/destroy is exclusive
 
         public:
             MessageQueueManager();
@@ -110,7 +177,7 @@ namespace kos {
 
             void CloseAllQueues();
             void PrintAllQueues() const;
-            uint32_t GetQueueCount() const { return queue_count; }
+            uint32_t GetQueueCount() const { return queues.GetCount(); }
         };
 
         extern MessageQueueManager* g_message_queue_manager;
@@ -137,6 +204,11 @@ namespace kos {
                          uint32_t* out_message_id = nullptr,
                          bool block = true);
 
+            uint32_t SendBatch(uint32_t queue_id, const MessageBatchEntry* entries,
+                               uint32_t count, bool block = true);
+            uint32_t ReceiveBatch(uint32_t queue_id, MessageBatchEntry* entries,
+                                  uint32_t count, bool block = true);
+
             uint32_t FindQueue(const char* name);
             bool GetQueueInfo(uint32_t queue_id, uint32_t* message_count,
                               uint32_t* max_messages, uint32_t* max_message_size);
@@ -0,0 +1,75 @@
+#ifndef __KOS__PROCESS__OBJECT_TABLE_H
+#define __KOS__PROCESS__OBJECT_TABLE_H
+
+#include <common/types.hpp>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace process {
+
+        // Growable registry of named kernel objects (pipes, message queues).
+        // IDs are handles: the low OBJECT_INDEX_BITS pick a slot and the high
+        // bits carry that slot's generation, which changes on every reuse, so
+        // a stale ID fails on one compare instead of reaching a new object.
+        // Names are kept in an open-addressing hash (linear probing) that
+        // grows with the table. Not locked: the owning manager serializes
+        // changes.
+        class ObjectTable {
+        public:
+            static const uint32_t OBJECT_INDEX_BITS = 20;
+            static const uint32_t OBJECT_INDEX_MASK = (1u << OBJECT_INDEX_BITS) - 1;
+            static const uint32_t OBJECT_GENERATION_MASK = 0xFFFFFFFFu >> OBJECT_INDEX_BITS;
+
+            ObjectTable();
+            ~ObjectTable();
+
+            // Claim an ID for an object about to be built; 0 if out of memory
+            uint32_t Reserve();
+            // Attach the object to a reserved ID. name must stay valid while
+            // the object is registered (it normally points into the object).
+            bool Publish(uint32_t id, void* object, const char* name);
+            // Drop a reserved or published ID; its slot's generation moves on
+            void Release(uint32_t id);
+
+            void* Find(uint32_t id) const;
+            void* Find(const char* name) const;
+            // Published ID for a name, 0 if none
+            uint32_t FindId(const char* name) const;
+
+            // Slot iteration for listings: At() is null for unused slots
+            uint32_t SlotCount() const { return slot_count; }
+            void* At(uint32_t index) const { return index < slot_count ? slots[index].object : nullptr; }
+            uint32_t IdAt(uint32_t index) const;
+            uint32_t GetCount() const { return object_count; }
+
+        private:
+            struct Slot {
+                void* object;
+                const char* name;
+                uint32_t hash;
+                uint32_t generation;
+                uint32_t next_free;        // Free list link, index + 1
+                bool reserved;
+            };
+
+            Slot* slots;
+            uint32_t slot_count;
+            uint32_t free_head;            // index + 1, 0 = empty
+            uint32_t object_count;
+
+            uint32_t* buckets;             // slot index + 1; 0 empty, BUCKET_DELETED tombstone
+            uint32_t bucket_mask;
+            uint32_t bucket_used;          // Live entries plus tombstones
+
+            Slot* SlotFor(uint32_t id) const;
+            bool GrowSlots();
+            bool RebuildBuckets(uint32_t capacity);
+            void InsertBucket(uint32_t index);
+            uint32_t* FindBucket(const char* name, uint32_t hash) const;
+        };
+
+    } // namespace process
+} // namespace kos
+
+#endif // __KOS__PROCESS__OBJECT_TABLE_H
@@ -4,6 +4,7 @@
 #include <common/types.hpp>
 #include <process/thread.h>
 #include <process/sync.hpp>
+#include <process/object_table.hpp>
 
 using namespace kos::common;
 
@@ -26,6 +27,21 @@ namespace kos {
             ~PipeMessage();
         };
 
+        // One element of a vectored pipe call: WriteV sends size bytes from
+        // data, ReadV reads into data (capacity size). transferred reports
+        // the bytes moved for the element.
+        struct PipeVec {
+            void* data;
+            uint32_t size;
+            uint32_t transferred;
+        };
+
+        // How a pipe carries data
+        enum PipeMode {
+            PIPE_MODE_MESSAGE = 0,     // Each Write is one framed message (heap copy per write)
+            PIPE_MODE_STREAM = 1       // Byte stream through a fixed power-of-two ring
+        };
+
         // Pipe for inter-task communication
         class Pipe {
         private:
@@ -50,10 +66,35 @@ namespace kos {
             
             bool is_closed;                // Whether pipe is closed
             bool blocking_mode;            // Blocking or non-blocking mode
+            PipeMode mode;                 // Message framing or byte stream
+
+            // Stream mode ring. head is only written by the producer and tail
+            // only by the consumer, so one writer and one reader never share a
+            // lock; the mutex is taken only to sleep on an empty or full ring.
+            uint8_t* ring;                 // Power-of-two sized buffer
+            uint32_t ring_mask;            // Capacity - 1
+            volatile uint32_t ring_head;   // Free-running write position
+            volatile uint32_t ring_tail;   // Free-running read position
+            volatile uint32_t write_guard; // Serializes extra producers (uncontended in SPSC use)
+            volatile uint32_t read_guard;  // Serializes extra consumers
+            volatile uint32_t writer_waiting; // Producer sleeping on a full ring
+            volatile uint32_t reader_waiting; // Consumer sleeping on an empty ring
+
+            uint32_t RingUsed() const { return ring_head - ring_tail; }
+            uint32_t RingWrite(const uint8_t* src, uint32_t size);
+            uint32_t RingRead(uint8_t* dst, uint32_t size, bool consume);
+            void WaitForSpace();
+            void WaitForData();
+
+            // Message mode helpers; pipe_mutex held, space or a message present
+            bool AppendMessage(uint32_t sender_id, const void* data, uint32_t size);
+            void PopMessage(void* buffer, uint32_t buffer_size, uint32_t* bytes_read, uint32_t* sender_id);
 
         public:
+            // In stream mode buffer_sz is rounded up to a power of two and
+            // max_msgs is ignored
             Pipe(uint32_t id, const char* pipe_name, uint32_t buffer_sz = 4096, 
-                 uint32_t max_msgs = 64);
+                 uint32_t max_msgs = 64, PipeMode pipe_mode = PIPE_MODE_MESSAGE);
             ~Pipe();
 
             // Pipe operations
@@ -62,6 +103,24 @@ namespace kos {
                      uint32_t* bytes_read, uint32_t* sender_id = nullptr, bool block = true);
             bool Peek(void* buffer, uint32_t buffer_size, uint32_t* bytes_available,
                      uint32_t* sender_id = nullptr);
+
+            // Stream mode: move as many bytes as possible. A blocking write
+            // returns once everything is queued (or the pipe closes); a
+            // blocking read returns once at least one byte arrived. Through
+            // Write/Read a stream pipe keeps all-or-nothing writes and reports
+            // sender 0, since bytes of different writes are not framed.
+            bool WriteStream(uint32_t sender_id, const void* data, uint32_t size,
+                             uint32_t* bytes_written, bool block = true);
+            bool ReadStream(uint32_t reader_id, void* buffer, uint32_t buffer_size,
+                            uint32_t* bytes_read, bool block = true);
+
+            // Batched Write/Read: up to count elements for one lock (or
+            // guard) acquisition and one wakeup. Each element behaves like
+            // its own Write/Read call; the batch stops at the first element
+            // that fails. ReadV blocks only until the first element can be
+            // read. Returns the number of elements completed.
+            uint32_t WriteV(uint32_t sender_id, PipeVec* vec, uint32_t count, bool block = true);
+            uint32_t ReadV(uint32_t reader_id, PipeVec* vec, uint32_t count, bool block = true);
             
             // Permission management
             bool AddReader(Thread* thread);
@@ -79,35 +138,37 @@ namespace kos {
             // Information
             uint32_t GetId() const { return pipe_id; }
             const char* GetName() const { return name; }
+            PipeMode GetMode() const { return mode; }
             uint32_t GetMessageCount() const { return message_count; }
-            uint32_t GetCurrentSize() const { return current_size; }
-            uint32_t GetAvailableSpace() const { return buffer_size - current_size; }
-            bool IsEmpty() const { return message_count == 0; }
-            bool IsFull() const { return current_size >= buffer_size || message_count >= max_messages; }
+            uint32_t GetCurrentSize() const { return (mode == PIPE_MODE_STREAM) ? RingUsed() : current_size; }
+            uint32_t GetAvailableSpace() const { return buffer_size - GetCurrentSize(); }
+            bool IsEmpty() const { return (mode == PIPE_MODE_STREAM) ? RingUsed() == 0 : message_count == 0; }
+            bool IsFull() const {
+                if (mode == PIPE_MODE_STREAM) return RingUsed() >= buffer_size;
+                return current_size >= buffer_size || message_count >= max_messages;
+            }
             bool IsClosed() const { return is_closed; }
             bool IsBlocking() const { return blocking_mode; }
             
             void PrintInfo() const;
+
+            // Compare message and stream throughput (shell: pipebench)
+            static void Benchmark();
         };
 
         // Pipe manager for system-wide pipe management
         class PipeManager {
         private:
-            Pipe* pipes[64];               // Array of pipes
-            uint32_t pipe_count;           // Number of active pipes
-            uint32_t next_pipe_id;         // For generating unique pipe IDs
-            Mutex* manager_mutex;          // Mutex for thread-safe access
-            
-            // Internal helpers
-            int FindPipeIndex(uint32_t pipe_id) const;
-            int FindPipeIndex(const char* name) const;
+            ObjectTable pipes;             // Pipe IDs are generation-checked handles
+            RwLock* manager_lock;          // Lookups share, create/destroy is exclusive
             
         public:
             PipeManager();
             ~PipeManager();
             
             // Pipe creation and destruction
-            Pipe* CreatePipe(const char* name, uint32_t buffer_size = 4096, uint32_t max_messages = 64);
+            Pipe* CreatePipe(const char* name, uint32_t buffer_size = 4096, uint32_t max_messages = 64,
+                             PipeMode mode = PIPE_MODE_MESSAGE);
             bool DestroyPipe(uint32_t pipe_id);
             bool DestroyPipe(const char* name);
             
@@ -118,7 +179,7 @@ namespace kos {
             // System operations
             void CloseAllPipes();
             void PrintAllPipes() const;
-            uint32_t GetPipeCount() const { return pipe_count; }
+            uint32_t GetPipeCount() const { return pipes.GetCount(); }
         };
 
         // Global pipe manager instance
@@ -127,7 +188,8 @@ namespace kos {
         // Pipe API for applications
         namespace PipeAPI {
             // Pipe creation
-            uint32_t CreatePipe(const char* name, uint32_t buffer_size = 4096, uint32_t max_messages = 64);
+            uint32_t CreatePipe(const char* name, uint32_t buffer_size = 4096, uint32_t max_messages = 64,
+                                PipeMode mode = PIPE_MODE_MESSAGE);
             bool DestroyPipe(uint32_t pipe_id);
             bool DestroyPipe(const char* name);
             
@@ -138,6 +200,8 @@ namespace kos {
                          uint32_t* bytes_read, uint32_t* sender_id = nullptr, bool block = true);
             bool ReadPipe(const char* name, void* buffer, uint32_t buffer_size, 
                          uint32_t* bytes_read, uint32_t* sender_id = nullptr, bool block = true);
+            uint32_t WritePipeV(uint32_t pipe_id, PipeVec* vec, uint32_t count, bool block = true);
+            uint32_t ReadPipeV(uint32_t pipe_id, PipeVec* vec, uint32_t count, bool block = true);
             
             // Pipe management
             bool AddPipeReader(uint32_t pipe_id, uint32_t thread_id);
@@ -0,0 +1,127 @@
+#ifndef __KOS__PROCESS__POLLER_H
+#define __KOS__PROCESS__POLLER_H
+
+#include <common/types.hpp>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace process {
+
+        // Kinds of object a Poller can watch
+        enum PollSource {
+            POLL_SOURCE_PIPE = 1,       // id = pipe id
+            POLL_SOURCE_QUEUE = 2,      // id = queue id, arg = receiver id (0 = any)
+            POLL_SOURCE_SOCKET = 3,     // id = socket fd
+            POLL_SOURCE_INPUT = 4       // id = 0, the global input event queue
+        };
+
+        enum PollCtlOp {
+            POLL_CTL_ADD = 1,
+            POLL_CTL_MOD = 2,
+            POLL_CTL_DEL = 3
+        };
+
+        // Readiness bits, same values as poll(2)
+        static const uint32_t POLL_IN = 0x001;
+        static const uint32_t POLL_OUT = 0x004;
+        static const uint32_t POLL_ERR = 0x008;
+        static const uint32_t POLL_HUP = 0x010;
+        // Registration flag: report a source once per readiness change
+        // instead of on every Wait while it stays ready
+        static const uint32_t POLL_EDGE = 0x80000000;
+
+        static const uint32_t POLL_MAX_ENTRIES = 32;
+        static const uint32_t POLL_MAX_POLLERS = 64;
+
+        // What to watch. events is a mask of POLL_IN/POLL_OUT (plus
+        // POLL_EDGE); POLL_ERR and POLL_HUP are always reported.
+        struct PollRegistration {
+            uint32_t source;
+            uint32_t id;
+            uint32_t arg;
+            uint32_t events;
+            uint32_t user_data;
+        };
+
+        // One ready source returned by Wait
+        struct PollEvent {
+            uint32_t source;
+            uint32_t id;
+            uint32_t events;
+            uint32_t user_data;
+        };
+
+        struct PollEntry {
+            PollRegistration reg;
+            volatile uint32_t signalled;    // Bits posted by Notify since the last Wait saw them
+            bool in_use;
+        };
+
+        // epoll-style readiness set. Sources post changes through Notify();
+        // a Wait that finds nothing ready sleeps on the scheduler until a
+        // notification for one of its entries wakes it or the timeout ends,
+        // so one thread can serve many pipes, queues and sockets.
+        class Poller {
+        public:
+            Poller(uint32_t id, uint32_t owner_id);
+            ~Poller();
+
+            bool Add(const PollRegistration& reg);
+            bool Modify(const PollRegistration& reg);
+            bool Remove(uint32_t source, uint32_t id);
+
+            // Fill out with up to max ready sources. timeout_ms < 0 waits
+            // forever, 0 only checks. Returns the count, 0 on timeout, -1 on
+            // bad arguments.
+            int32_t Wait(PollEvent* out, uint32_t max, int32_t timeout_ms);
+            // End a Wait early (e.g. to shut an event loop down)
+            void Wake();
+
+            uint32_t GetId() const { return poller_id; }
+            uint32_t GetOwnerId() const { return owner_id; }
+            uint32_t GetEntryCount() const { return entry_count; }
+
+            // Called by sources when they may have become ready; cheap when
+            // no poller exists. Safe from interrupt handlers.
+            static void Notify(uint32_t source, uint32_t id, uint32_t events) {
+                if (s_first) NotifyAll(source, id, events);
+            }
+
+            // Registry: Create links a new poller in, Destroy unlinks and frees it
+            static Poller* Create(uint32_t owner_id);
+            static bool Destroy(uint32_t id);
+            static Poller* Find(uint32_t id);
+            static void PrintAll();
+
+        private:
+            uint32_t poller_id;
+            uint32_t owner_id;
+            PollEntry entries[POLL_MAX_ENTRIES];
+            uint32_t entry_count;
+            volatile uint32_t wake_seq;     // Bumped by every notification for this poller
+            volatile uint32_t waiter_id;    // Task sleeping in Wait, 0 if none
+            volatile bool kicked;           // Wake() was called
+            uint32_t scan_pos;              // Where Collect starts, so no entry is starved
+            Poller* next;
+
+            static Poller* volatile s_first;
+
+            PollEntry* FindEntry(uint32_t source, uint32_t id);
+            uint32_t Collect(PollEvent* out, uint32_t max);
+            void Sleep(uint32_t seq, uint32_t timeout_ms);
+            static uint32_t QueryLevel(const PollRegistration& reg);
+            static void NotifyAll(uint32_t source, uint32_t id, uint32_t events);
+        };
+
+        namespace PollerAPI {
+            uint32_t Create();
+            bool Destroy(uint32_t poller_id);
+            bool Control(uint32_t poller_id, uint32_t op, const PollRegistration* reg);
+            int32_t Wait(uint32_t poller_id, PollEvent* out, uint32_t max, int32_t timeout_ms);
+        }
+
+    } // namespace process
+} // namespace kos
+
+#endif // __KOS__PROCESS__POLLER_H
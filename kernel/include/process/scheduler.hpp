@@ -28,21 +28,73 @@ namespace kos {
 
         // Round-robin scheduler
         class Scheduler {
+        public:
+            // Latency histogram bucket b counts samples in [2^(b-1), 2^b) us;
+            // bucket 0 is sub-microsecond and the last bucket is open-ended.
+            static const int LATENCY_BUCKETS = 16;
+            // Admission limit for the deadline class, in per-mille of the CPU;
+            // the rest is left for the priority queues
+            static const uint32_t DEADLINE_MAX_UTILIZATION = 800;
+
+            // Fair class weights: PRIORITY_NORMAL and PRIORITY_LOW threads share
+            // the CPU in proportion to these (nice 0 and nice 5 in CFS terms)
+            static const uint32_t FAIR_WEIGHT_NORMAL = 1024;
+            static const uint32_t FAIR_WEIGHT_LOW = 335;
+
         private:
             Thread* current_task;             // Currently running task
             Thread* ready_queues[5];          // Priority-based ready queues (one per priority)
             Thread* ready_queue_tails[5];     // Tail pointers for each priority queue
             Thread* sleeping_tasks;           // List of sleeping tasks
+            Thread* deadline_queue;           // Runnable deadline-class tasks, earliest deadline first
+            Thread* throttled_tasks;          // Deadline-class tasks out of budget until their next period
+            uint32_t deadline_utilization;    // Sum of admitted budget/period, per-mille
+            Thread** fair_heap;               // Runnable fair-class tasks, min-heap on vruntime
+            uint32_t fair_count;
+            uint32_t fair_capacity;
+            uint64_t min_vruntime;            // Monotonic floor of runnable vruntimes
             uint32_t next_task_id;          // For generating unique task IDs
             uint32_t current_tick;          // Current timer tick count
             TimerHandler* timer_handler;    // Timer interrupt handler
             bool scheduling_enabled;        // Whether preemptive scheduling is active
 
+            // TSC-based accounting
+            bool tsc_available;             // CPU has a usable time stamp counter
+            uint32_t cycles_per_us;         // Calibrated against the PIT; 0 until calibrated
+            uint64_t calib_start_tsc;       // TSC at the start of the calibration window
+            uint32_t calib_start_tick;      // Tick at the start of the calibration window
+            uint32_t wake_latency_hist[5][LATENCY_BUCKETS]; // Wakeup-to-run latency per priority
+            uint32_t wake_latency_samples[5];
+            uint32_t wake_latency_max_us[5];
+
             // Internal helper methods
             void AddToReadyQueue(Thread* task);
             Thread* RemoveFromReadyQueue();
             Thread* GetHighestPriorityTask();
+            bool HasReadyTask() const;
             void ProcessSleepingTasks();
+            uint64_t ReadCycles() const;
+            void CalibrateCycles();
+            void AccountSwitch(Thread* prev, Thread* next, bool voluntary);
+            void RecordWakeLatency(int priority, uint64_t cycles);
+            void AssignTimeSlice(Thread* task);
+            bool UnlinkReadyTask(Thread* task);
+            void AddToDeadlineQueue(Thread* task);
+            void StartDeadlinePeriod(Thread* task);
+            void DeadlineTick();
+            void ReleaseDeadline(Thread* task);
+            bool IsFairTask(const Thread* task) const;
+            uint32_t FairWeight(const Thread* task) const;
+            uint32_t GroupRunnable(uint32_t group_id) const;
+            bool ReserveFair(uint32_t capacity);
+            bool FairPush(Thread* task);
+            Thread* FairPop();
+            void FairRemove(Thread* task);
+            void FairSiftUp(uint32_t index);
+            void FairSiftDown(uint32_t index);
+            void UpdateCurrentFair();
+            void UpdateMinVruntime();
+            bool FairShouldPreempt() const;
 
         public:
             Scheduler();
@@ -62,7 +114,14 @@ namespace kos {
             bool ResumeTask(uint32_t task_id);
             bool KillTask(uint32_t task_id);
             bool SleepTask(uint32_t task_id, uint32_t milliseconds);
+            bool WakeTask(uint32_t task_id);        // End a sleep early; false if not sleeping
             bool SetTaskPriority(uint32_t task_id, ThreadPriority new_priority);
+            // Put a task in the deadline class with budget_ms of CPU every
+            // period_ms (rounded to timer ticks); period_ms == 0 returns it to
+            // the priority class. Fails if admission would exceed
+            // DEADLINE_MAX_UTILIZATION.
+            bool SetDeadlineParams(uint32_t task_id, uint32_t period_ms, uint32_t budget_ms);
+            uint32_t GetDeadlineUtilization() const { return deadline_utilization; }
             
             // Thread information
             Thread* FindTask(uint32_t task_id);
@@ -79,8 +138,18 @@ namespace kos {
             void SaveContextFromInterrupt(CPUContext* context, uint32_t esp);
             uint32_t RestoreContextToInterrupt(CPUContext* context);
 
+            // Cycle accounting
+            uint64_t CyclesToMicroseconds(uint64_t cycles) const;
+            uint32_t CyclesToMilliseconds(uint64_t cycles) const; // saturates at 0xFFFFFFFF
+            uint64_t GetRunCycles(const Thread* task) const;      // includes the in-progress slice
+            uint32_t GetCyclesPerMicrosecond() const { return cycles_per_us; }
+            uint32_t GetWakeLatencyBucket(int prio, int bucket) const;
+            uint32_t GetWakeLatencySamples(int prio) const;
+            uint32_t GetWakeLatencyMaxMicroseconds(int prio) const;
+
             // Getters
             Thread* GetCurrentTask() const { return current_task; }
+            uint32_t GetCurrentTick() const { return current_tick; }
             bool IsSchedulingEnabled() const { return scheduling_enabled; }
 
             // Public accessor for ready queues
@@ -89,6 +158,15 @@ namespace kos {
 
             // Public accessor for sleeping tasks
             Thread* GetSleepingTasks() const { return sleeping_tasks; }
+
+            // Public accessors for deadline-class tasks
+            Thread* GetDeadlineQueue() const { return deadline_queue; }
+            Thread* GetThrottledTasks() const { return throttled_tasks; }
+
+            // Public accessors for fair-class tasks (heap order, not sorted)
+            uint32_t GetFairTaskCount() const { return fair_count; }
+            Thread* GetFairTask(uint32_t index) const { return index < fair_count ? fair_heap[index] : nullptr; }
+            uint64_t GetMinVruntime() const { return min_vruntime; }
         };
 
         // Global scheduler instance
@@ -103,8 +181,10 @@ namespace kos {
             void SleepThread(uint32_t milliseconds);
             bool SuspendThread(uint32_t thread_id);
             bool ResumeThread(uint32_t thread_id);
+            bool WakeThread(uint32_t thread_id);
             bool KillThread(uint32_t thread_id);
             bool SetThreadPriority(uint32_t thread_id, ThreadPriority priority);
+            bool SetThreadDeadline(uint32_t thread_id, uint32_t period_ms, uint32_t budget_ms);
             uint32_t GetCurrentThreadId();
             uint32_t GetThreadCount();
         }
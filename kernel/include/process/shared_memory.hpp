@@ -0,0 +1,108 @@
+#ifndef __KOS__PROCESS__SHARED_MEMORY_H
+#define __KOS__PROCESS__SHARED_MEMORY_H
+
+#include <common/types.hpp>
+#include <memory/memory.hpp>
+#include <process/sync.hpp>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace process {
+
+        static const uint32_t SHM_MAX_REGIONS = 32;
+        static const uint32_t SHM_MAX_MAPPERS = 16;
+        static const uint32_t SHM_MAX_SIZE = 16 * 1024 * 1024;
+        // Virtual window regions are placed in. Every task runs on the one
+        // kernel page directory, so a region has the same address for all
+        // of its mappers and pointers into it can be passed around as is.
+        static const uint32_t SHM_WINDOW_BASE = 0x18000000u;    // 384 MiB
+        static const uint32_t SHM_WINDOW_SIZE = 0x04000000u;    // 64 MiB
+
+        // Named block of physical frames shared without copying. Frames are
+        // zeroed and mapped when the region is created; Map/Unmap track which
+        // tasks use it so a destroyed region lives until its last mapper
+        // lets go (like shm_unlink).
+        class SharedMemoryRegion {
+        private:
+            uint32_t region_id;
+            char name[32];
+            uint32_t owner_id;
+            uint32_t size;                 // Page multiple
+            uint32_t page_count;
+            phys_addr_t* frames;
+            virt_addr_t base;
+            uint32_t mappers[SHM_MAX_MAPPERS];
+            uint32_t mapper_count;
+            bool unlinked;                 // Destroyed while still mapped
+
+        public:
+            SharedMemoryRegion(uint32_t id, const char* region_name, uint32_t bytes, uint32_t owner);
+            ~SharedMemoryRegion();
+
+            // Take frames and map them at vaddr; false if memory ran out
+            bool Populate(virt_addr_t vaddr);
+
+            void* Map(uint32_t task_id);
+            bool Unmap(uint32_t task_id);
+            bool IsMappedBy(uint32_t task_id) const;
+
+            uint32_t GetId() const { return region_id; }
+            const char* GetName() const { return name; }
+            uint32_t GetOwnerId() const { return owner_id; }
+            uint32_t GetSize() const { return size; }
+            virt_addr_t GetBase() const { return base; }
+            uint32_t GetMapperCount() const { return mapper_count; }
+            bool IsUnlinked() const { return unlinked; }
+            void MarkUnlinked() { unlinked = true; }
+
+            void PrintInfo() const;
+        };
+
+        class SharedMemoryManager {
+        private:
+            SharedMemoryRegion* regions[SHM_MAX_REGIONS];
+            uint32_t region_count;
+            uint32_t next_region_id;
+            RwLock* manager_lock;
+
+            int FindRegionIndex(uint32_t region_id) const;
+            int FindRegionIndex(const char* name) const;
+            // First free page run in the window, 0 if none
+            virt_addr_t FindWindowSpace(uint32_t bytes) const;
+            void Release(int index);
+
+        public:
+            SharedMemoryManager();
+            ~SharedMemoryManager();
+
+            SharedMemoryRegion* CreateRegion(const char* name, uint32_t size, uint32_t owner_id);
+            // Unlinks the name; frames go once nobody has the region mapped
+            bool DestroyRegion(uint32_t region_id);
+
+            SharedMemoryRegion* FindRegion(uint32_t region_id) const;
+            SharedMemoryRegion* FindRegion(const char* name) const;
+
+            void* MapRegion(uint32_t region_id, uint32_t task_id, uint32_t* size_out);
+            bool UnmapRegion(uint32_t region_id, uint32_t task_id);
+
+            void PrintAllRegions() const;
+            uint32_t GetRegionCount() const { return region_count; }
+        };
+
+        extern SharedMemoryManager* g_shm_manager;
+
+        // Shared memory API for applications. Map returns the region's
+        // address (identical in every task) or nullptr.
+        namespace SharedMemoryAPI {
+            uint32_t Create(const char* name, uint32_t size);
+            uint32_t Open(const char* name);
+            void* Map(uint32_t region_id, uint32_t* size_out = nullptr);
+            bool Unmap(uint32_t region_id);
+            bool Destroy(uint32_t region_id);
+        }
+
+    } // namespace process
+} // namespace kos
+
+#endif // __KOS__PROCESS__SHARED_MEMORY_H
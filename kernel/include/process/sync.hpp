@@ -81,6 +81,78 @@ namespace kos {
             void Broadcast();
         };
 
+        // Reader-writer lock for read-mostly data. Up to MAX_READERS threads
+        // may hold the read side at once; a writer gets exclusive access.
+        // Once a writer is waiting new readers back off, so writers cannot be
+        // starved. A thread that already holds the read side may take it again
+        // without backing off, so nested reads cannot deadlock behind a
+        // waiting writer. The write side is recursive for its owner (like
+        // Mutex), and the owning writer may also take the read side.
+        class RwLock {
+        public:
+            static const uint32_t MAX_READERS = 8;
+
+        private:
+            volatile uint32_t guard;           // Short spin guarding the fields below
+            volatile uint32_t reader_count;    // Active read holds, nested ones included
+            uint32_t reader_ids[MAX_READERS];  // Threads holding the read side
+            uint32_t reader_depth[MAX_READERS];// Their hold counts (0 = free slot)
+            volatile uint32_t writers_waiting; // Writers blocked in WriteLock()
+            volatile uint32_t writer_id;       // Thread holding the write side (0 = none)
+            uint32_t write_depth;              // Recursion depth of the owning writer
+            bool writer_held;                  // Write side held (writer_id may be 0 before threading)
+
+            void Acquire();
+            void Release();
+            // Reader slot of a thread, or -1; call with the guard held
+            int FindReader(uint32_t thread_id) const;
+            // Take the read side if allowed; call with the guard held
+            bool TryReadLocked(uint32_t thread_id);
+
+        public:
+            RwLock();
+            ~RwLock();
+
+            // Shared (read) side
+            void ReadLock();
+            bool TryReadLock();
+            void ReadUnlock();
+
+            // Exclusive (write) side
+            void WriteLock();
+            bool TryWriteLock();
+            void WriteUnlock();
+
+            uint32_t GetReaderCount() const { return reader_count; }
+            bool IsWriteLocked() const { return writer_held; }
+        };
+
+        // Sequence lock for small, frequently read records. Readers never
+        // block a writer: they snapshot the data between ReadBegin() and
+        // ReadRetry() and try again if a write raced with them. Writers run
+        // with interrupts disabled so a reader can never spin on a writer
+        // that was preempted mid-update on this CPU.
+        class SeqLock {
+        private:
+            volatile uint32_t sequence;        // Odd while a write is in progress
+            volatile uint32_t writer_lock;     // Serializes writers
+            uint32_t saved_flags;              // EFLAGS of the current writer
+
+        public:
+            SeqLock();
+
+            // Start a read section; returns the sequence to pass to ReadRetry()
+            uint32_t ReadBegin() const;
+
+            // True if the data read since ReadBegin() may be torn and must be re-read
+            bool ReadRetry(uint32_t start) const;
+
+            void WriteLock();
+            void WriteUnlock();
+
+            uint32_t GetSequence() const { return sequence; }
+        };
+
         // RAII lock guard for automatic unlocking
         class LockGuard {
         private:
@@ -100,6 +172,41 @@ namespace kos {
             LockGuard& operator=(const LockGuard&) = delete;
         };
 
+        // RAII guards for RwLock
+        class ReadLockGuard {
+        private:
+            RwLock& lock;
+
+        public:
+            explicit ReadLockGuard(RwLock& l) : lock(l) {
+                lock.ReadLock();
+            }
+
+            ~ReadLockGuard() {
+                lock.ReadUnlock();
+            }
+
+            ReadLockGuard(const ReadLockGuard&) = delete;
+            ReadLockGuard& operator=(const ReadLockGuard&) = delete;
+        };
+
+        class WriteLockGuard {
+        private:
+            RwLock& lock;
+
+        public:
+            explicit WriteLockGuard(RwLock& l) : lock(l) {
+                lock.WriteLock();
+            }
+
+            ~WriteLockGuard() {
+                lock.WriteUnlock();
+            }
+
+            WriteLockGuard(const WriteLockGuard&) = delete;
+            WriteLockGuard& operator=(const WriteLockGuard&) = delete;
+        };
+
     } // namespace process
 } // namespace kos
 
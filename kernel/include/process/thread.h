@@ -3,12 +3,16 @@
 
 #include <common/types.hpp>
 #include <memory/memory.hpp>
+#include <arch/x86/hardware/cpu/fpu.hpp>
 
 using namespace kos::common;
+using kos::arch::x86::hardware::cpu::FpuContext;
 
 namespace kos {
     namespace process {
 
+        struct ThreadControlBlock;
+
         // Thread/Task states
         enum TaskState {
             TASK_READY = 0,      // Ready to run
@@ -28,6 +32,13 @@ namespace kos {
             PRIORITY_IDLE = 4       // Idle/background threads
         };
 
+        // Scheduling classes. Deadline threads always run before any
+        // priority-queue thread, earliest deadline first.
+        enum SchedClass {
+            SCHED_CLASS_PRIORITY = 0,   // Static priority queues with fixed slices
+            SCHED_CLASS_DEADLINE = 1    // Periodic reservation: dl_budget ticks every dl_period ticks
+        };
+
         // CPU context structure - all registers that need to be saved/restored
         struct CPUContext {
             // General purpose registers (saved by pusha/popa)
@@ -56,6 +67,27 @@ namespace kos {
             uint32_t time_slice;            // Remaining time quantum (in timer ticks)
             uint32_t sleep_until;           // Timer tick when thread should wake up (if sleeping)
             uint32_t total_runtime;         // Total CPU time used (in timer ticks)
+            uint64_t run_cycles;            // TSC cycles spent running
+            uint64_t wait_cycles;           // TSC cycles spent runnable but not running
+            uint64_t run_start_tsc;         // TSC when the thread last got the CPU
+            uint64_t ready_since_tsc;       // TSC when the thread last entered a ready queue
+            uint32_t voluntary_switches;    // Gave up the CPU (yield, sleep, block)
+            uint32_t involuntary_switches;  // Preempted by the timer
+            bool woken;                     // Made ready by a wakeup; next dispatch records latency
+            SchedClass sched_class;         // Which run queue the thread lives on
+            uint32_t dl_period;             // Deadline class: reservation period in ticks
+            uint32_t dl_budget;             // Deadline class: CPU ticks per period
+            uint32_t dl_deadline;           // Tick the current period's work must finish by
+            uint32_t dl_budget_left;        // Ticks left in the current period
+            uint32_t dl_misses;             // Periods that ended runnable with budget unspent
+            bool dl_throttled;              // Budget used up; parked until the next period
+            uint64_t vruntime;              // Fair class: weighted run time in microseconds
+            int32_t fair_index;             // Slot in the scheduler's fair heap, -1 when not queued
+            uint32_t group_id;              // Process the thread belongs to; 0 = ungrouped
+            uint64_t fair_mark_tsc;         // TSC when vruntime was last charged
+            uint32_t fair_mark_tick;        // Tick when vruntime was last charged (no calibrated TSC)
+            FpuContext fpu;                 // Lazily saved x87/SSE registers
+            ThreadControlBlock* tcb;        // Thread pointer block (%gs base), see tls.hpp
             const char* name;               // Thread name for debugging
             Thread* next;                   // Next task in queue (for linked list)
             
@@ -88,6 +120,15 @@ namespace kos {
             // Runtime statistics
             void IncrementRuntime() { total_runtime++; }
             uint32_t GetTotalRuntime() const { return total_runtime; }
+            uint64_t GetRunCycles() const { return run_cycles; }
+            uint64_t GetWaitCycles() const { return wait_cycles; }
+            uint32_t GetVoluntarySwitches() const { return voluntary_switches; }
+            uint32_t GetInvoluntarySwitches() const { return involuntary_switches; }
+            SchedClass GetSchedClass() const { return sched_class; }
+            uint32_t GetDeadlineMisses() const { return dl_misses; }
+            uint64_t GetVruntime() const { return vruntime; }
+            uint32_t GetGroupId() const { return group_id; }
+            void SetGroupId(uint32_t id) { group_id = id; }
             
             // Sleep management
             void SetSleepUntil(uint32_t tick) { sleep_until = tick; }
@@ -47,7 +47,7 @@ namespace kos {
             uint32_t system_thread_count;   // Number of system threads
             uint32_t user_thread_count;     // Number of user threads
             
-            Mutex* manager_mutex;           // Thread-safe access
+            RwLock* registry_lock;          // Readers (ps/top/viewer) share, creation/exit is exclusive
             Thread* main_thread;            // Main kernel thread
             Thread* shell_thread;           // Shell thread
             Thread* idle_thread;            // Idle thread
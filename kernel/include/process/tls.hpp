@@ -0,0 +1,71 @@
+#ifndef __KOS__PROCESS__TLS_H
+#define __KOS__PROCESS__TLS_H
+
+#include <common/types.hpp>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace arch { namespace x86 { namespace memory { class GlobalDescriptorTable; } } }
+
+    namespace process {
+
+        class Thread;
+
+        // Per-thread control block at the thread pointer (%gs base), using the
+        // i386 "variant II" TLS layout:
+        //
+        //   [ static TLS reserve (app __thread data) ][ ThreadControlBlock ]
+        //                                             ^ thread pointer, %gs:0
+        //
+        // App __thread variables sit at negative offsets below the thread
+        // pointer as laid out by the linker (PT_TLS). Kernel per-thread state
+        // lives in the control block above it, read through TLS::Current(),
+        // so it never collides with the image of the app running on the thread.
+        struct ThreadControlBlock {
+            ThreadControlBlock* self;   // Must be first: %gs:0 holds the thread pointer
+            Thread* thread;             // Owning thread; null for the boot context
+            uint32_t pid;               // Process id for spawned processes, else 0
+            uint32_t list_flags;        // Directory listing flags of the running app
+            uint32_t static_size;       // Bytes of the static reserve used by the app's PT_TLS
+        };
+
+        class TLS {
+        public:
+            static const uint32_t STATIC_RESERVE = 512;     // Largest app PT_TLS block
+            static const uint32_t BLOCK_ALIGN = 64;         // Thread pointer alignment
+
+            // Add the boot context's block and load %gs; call right after the GDT
+            static void Initialize(kos::arch::x86::memory::GlobalDescriptorTable* gdt);
+            static bool IsReady() { return s_ready; }
+            static uint16_t Selector();
+
+            static ThreadControlBlock* Create(Thread* thread);
+            static void Destroy(ThreadControlBlock* tcb);
+
+            // Called where the scheduler switches stacks; null = boot context
+            static void SwitchTo(ThreadControlBlock* tcb);
+
+            // Control block of the running context (one %gs load)
+            static inline ThreadControlBlock* Current() {
+                if (!s_ready) return nullptr;
+                ThreadControlBlock* tcb;
+                __asm__ __volatile__("movl %%gs:0, %0" : "=r"(tcb));
+                return tcb;
+            }
+
+            // App PT_TLS: copy the init image below the thread pointer and zero
+            // the .tbss part. False if the block does not fit the reserve.
+            static bool LoadStaticImage(const uint8_t* init, uint32_t filesz, uint32_t memsz, uint32_t align);
+            // Nested app runs: stash the caller's static block and put it back
+            static void* SaveStatic();
+            static void RestoreStatic(void* saved);
+
+        private:
+            static bool s_ready;
+        };
+
+    } // namespace process
+} // namespace kos
+
+#endif // __KOS__PROCESS__TLS_H
@@ -0,0 +1,77 @@
+#ifndef __KOS__PROCESS__TRACE_H
+#define __KOS__PROCESS__TRACE_H
+
+#include <common/types.hpp>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace process {
+
+        // Event kinds recorded by the tracer
+        enum TraceEventType {
+            TRACE_SWITCH = 0,       // arg0 = previous tid (0 = idle), arg1 = next tid
+            TRACE_WAKEUP = 1,       // arg0 = tid made ready
+            TRACE_BLOCK = 2,        // arg0 = tid, arg1 = TaskState it left the CPU in
+            TRACE_IRQ_ENTER = 3,    // arg0 = IRQ line
+            TRACE_IRQ_EXIT = 4,     // arg0 = IRQ line
+            TRACE_MARK = 5          // arg0 = label slot, arg1 = caller-supplied value
+        };
+
+        struct TraceEvent {
+            uint64_t tsc;           // Time stamp counter at record time
+            uint16_t type;          // TraceEventType
+            uint16_t cpu;           // CPU that recorded the event
+            uint32_t arg0;
+            uint32_t arg1;
+        };
+
+        // Flight recorder for scheduler activity. Each CPU owns one ring and
+        // only ever writes to its own, with interrupts masked for the few
+        // instructions it takes to claim a slot, so recording never takes a
+        // lock and is safe from IRQ context. Full rings overwrite the oldest
+        // events. Dump() stops tracing and writes Chrome Trace Event JSON to
+        // the serial port (see tools/trace2json.py).
+        class Tracer {
+        public:
+            static const uint32_t MAX_CPUS = 1;         // Uniprocessor for now
+            static const uint32_t RING_SIZE = 4096;     // Events per CPU, power of two
+            static const uint32_t MAX_LABELS = 32;      // Distinct marker labels
+            static const uint32_t LABEL_LEN = 24;       // Including terminator
+
+            static bool Start();                        // false when there is no TSC
+            static void Stop();
+            static void Clear();
+            static bool IsEnabled() { return s_enabled; }
+            static uint32_t GetEventCount();            // Events currently buffered
+            static uint32_t GetOverwrittenCount();      // Events lost to wraparound
+            static uint32_t Dump();                     // Returns events written
+
+            // Hooks; cheap no-ops while tracing is off
+            static inline void Switch(uint32_t prev_tid, uint32_t next_tid) {
+                if (s_enabled) Record(TRACE_SWITCH, prev_tid, next_tid);
+            }
+            static inline void Wakeup(uint32_t tid) {
+                if (s_enabled) Record(TRACE_WAKEUP, tid, 0);
+            }
+            static inline void Block(uint32_t tid, uint32_t state) {
+                if (s_enabled) Record(TRACE_BLOCK, tid, state);
+            }
+            static inline void IrqEnter(uint32_t irq) {
+                if (s_enabled) Record(TRACE_IRQ_ENTER, irq, 0);
+            }
+            static inline void IrqExit(uint32_t irq) {
+                if (s_enabled) Record(TRACE_IRQ_EXIT, irq, 0);
+            }
+            // User marker; the label is copied, so callers may pass temporaries
+            static void Mark(const char* label, uint32_t value);
+
+        private:
+            static volatile bool s_enabled;
+            static void Record(uint16_t type, uint32_t arg0, uint32_t arg1);
+        };
+
+    } // namespace process
+} // namespace kos
+
+#endif // __KOS__PROCESS__TRACE_H
@@ -0,0 +1,131 @@
+#ifndef __KOS__PROCESS__WORKQUEUE_H
+#define __KOS__PROCESS__WORKQUEUE_H
+
+#include <common/types.hpp>
+#include <process/thread.h>
+
+using namespace kos::common;
+
+namespace kos {
+    namespace process {
+
+        typedef void (*WorkFn)(void* arg);
+
+        // Unit of deferred work. Drivers that queue the same job repeatedly
+        // (e.g. from an IRQ) should embed one of these and use QueueItem();
+        // QueueWork() takes a slot from the queue's preallocated pool instead.
+        //
+        // Until a queue's worker thread runs, its items are drained inline
+        // from task context (the service event loop or the text shell's
+        // idle loop). Items that do disk I/O, take sleeping locks or call
+        // into a filesystem must still be flagged blocking, so a drain that
+        // cannot block can leave them for the worker.
+        struct WorkItem {
+            WorkFn fn;
+            void* arg;
+            uint32_t queued_tick;       // Tick it became runnable (latency stats)
+            uint32_t due_tick;          // Delayed work: tick it becomes runnable
+            WorkItem* next;
+            volatile bool queued;       // On the pending or delayed list
+            bool pooled;                // Returned to the pool after it runs
+            bool blocking;              // Never run from interrupt context
+
+            WorkItem(WorkFn f = nullptr, void* a = nullptr, bool block = false)
+                : fn(f), arg(a), queued_tick(0), due_tick(0), next(nullptr), queued(false), pooled(false),
+                  blocking(block) {}
+        };
+
+        struct WorkQueueStats {
+            uint32_t queued;            // Items accepted
+            uint32_t executed;          // Items run
+            uint32_t dropped;           // Rejected because the pool was empty
+            uint32_t depth;             // Currently pending (not counting delayed)
+            uint32_t max_depth;
+            uint32_t max_latency_ticks; // Worst queue-to-run delay
+            uint64_t busy_cycles;       // TSC cycles spent running items
+        };
+
+        // A FIFO of deferred work drained by a dedicated kernel thread.
+        // Queue operations mask interrupts briefly instead of taking a lock,
+        // so they are safe to call from interrupt handlers.
+        class WorkQueue {
+        public:
+            WorkQueue(const char* name, ThreadPriority priority = PRIORITY_NORMAL, uint32_t pool_size = 32);
+            ~WorkQueue();
+
+            // Spawn the worker thread. Items queued earlier run once it starts.
+            bool Start();
+            // True once the worker thread has actually been dispatched. Until
+            // then, WorkQueueAPI::DrainInline() runs the queue's items.
+            bool IsRunning() const { return worker_alive; }
+
+            bool QueueWork(WorkFn fn, void* arg, bool blocking = false);
+            bool QueueDelayedWork(WorkFn fn, void* arg, uint32_t delay_ms, bool blocking = false);
+            // Caller-owned items; false if the item is already queued
+            bool QueueItem(WorkItem* item);
+            bool QueueDelayedItem(WorkItem* item, uint32_t delay_ms);
+            bool Cancel(WorkItem* item);
+
+            // Promote due delayed items and run everything pending; returns items
+            // run. Without allow_blocking, blocking items go back on the delayed
+            // list for the next tick instead.
+            uint32_t RunPending(bool allow_blocking = true);
+
+            const char* GetName() const { return name; }
+            ThreadPriority GetPriority() const { return priority; }
+            uint32_t GetWorkerId() const { return worker_id; }
+            WorkQueueStats GetStats() const;
+            void PrintStats() const;
+
+            // Registry of all queues (for the worker lookup and the shell)
+            static WorkQueue* First() { return s_first; }
+            WorkQueue* Next() const { return next_queue; }
+
+        private:
+            const char* name;
+            ThreadPriority priority;
+            uint32_t worker_id;
+            volatile bool worker_alive;
+            WorkItem* pending_head;
+            WorkItem* pending_tail;
+            WorkItem* delayed;          // Sorted by due_tick
+            WorkItem* pool;
+            WorkItem* free_items;
+            uint32_t pool_size;
+            WorkQueueStats stats;
+            WorkQueue* next_queue;
+
+            static WorkQueue* s_first;
+
+            WorkItem* AllocItem();
+            void FreeItem(WorkItem* item);
+            void EnqueuePendingLocked(WorkItem* item, uint32_t now);
+            void InsertDelayedLocked(WorkItem* item);
+            static void WorkerEntry();
+        };
+
+        // Kernel-wide queues: "kworker" at normal priority for general
+        // deferral and "kworker-hi" for latency-sensitive driver work.
+        extern WorkQueue* g_system_workqueue;
+        extern WorkQueue* g_highpri_workqueue;
+
+        namespace WorkQueueAPI {
+            void Initialize();          // Create the kernel queues (heap must be up)
+            void StartWorkers();        // Spawn their threads (after StartMultitasking)
+            bool QueueWork(WorkFn fn, void* arg, bool blocking = false);
+            bool QueueDelayedWork(WorkFn fn, void* arg, uint32_t delay_ms, bool blocking = false);
+            // Run pending items of every queue whose worker has not started.
+            // Called from the service event loop and the text-mode shell's
+            // idle loop, never from interrupt context; without allow_blocking,
+            // blocking items wait for a later drain. Only one drain runs at a
+            // time: a call that nests inside another returns 0 at once.
+            // Returns how many queues needed it, so the caller knows to come
+            // back within a tick.
+            uint32_t DrainInline(bool allow_blocking);
+            void PrintAll();
+        }
+
+    } // namespace process
+} // namespace kos
+
+#endif // __KOS__PROCESS__WORKQUEUE_H
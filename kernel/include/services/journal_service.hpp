@@ -6,11 +6,37 @@
 #include "service.hpp"
 #include "lib/string.hpp"
 #include "lib/socket.hpp"
+#include <process/workqueue.hpp>
 
 
 namespace kos {
     namespace services {
+        struct JournalStats {
+            uint32_t accepted;          // Lines taken into the ring
+            uint32_t dropped;           // Lines refused because the ring was full
+            uint32_t waits;             // Producers held back until the writer made room
+            uint32_t commits;           // Batches written
+            uint32_t committed_bytes;
+            uint32_t max_batch_bytes;
+            uint32_t write_errors;
+            uint32_t rotations;
+            uint32_t pending_bytes;     // In the ring, not yet written
+            uint32_t lag_ms;            // Age of the oldest pending line
+            uint32_t max_lag_ms;        // Worst age of a batch's oldest line when written
+        };
+
+        // What log() does when the ring is full
+        enum JournalOverflowPolicy {
+            JOURNAL_OVERFLOW_DROP = 0,  // Drop the new line
+            JOURNAL_OVERFLOW_WAIT = 1   // Wait (bounded) for the writer, then drop
+        };
+
         // Journal service: logs system events to the systemd journal via a Unix socket.
+        // Lines are appended to /var/log/system.log by a writer on the system
+        // work queue, which commits everything queued since its last run in
+        // one append once enough bytes or enough time have gathered. log()
+        // only copies the line into a ring with interrupts masked, so it can
+        // be called from any context and never touches the disk.
         class JournalService : public IService {
             public:
                 JournalService();
@@ -20,29 +46,59 @@ namespace kos {
                 bool Start() override;
                 void Stop() override;
                 void log(const char* message);
-                // Force flushing buffered messages to disk
+                // Write everything queued so far now, on the caller's thread;
+                // from an interrupt handler the writer is only woken
                 void Flush();
-                // Rotate current log file (close/rename/reopen)
+                // Move the current log to /var/log/system.N and start a new
+                // one; done by the writer, so callers do not wait for it
                 void Rotate();
-                void Tick() override;
+                void SetOverflowPolicy(JournalOverflowPolicy policy) { overflowPolicy = policy; }
+                JournalStats GetStats() const;
+                void PrintStats() const;
+                // Socket receive is not implemented, so there is nothing to poll;
+                // queued lines are written once the filesystem comes up.
+                uint32_t TickIntervalMs() const override { return 0; }
+                uint32_t EventMask() const override { return ServiceEventBit(SERVICE_EVENT_FS_READY); }
+                void OnEvent(const ServiceEvent& ev) override;
 
             private:
-        void sendToSocket(const char* message);
-        void readFromSocket();
-        void persistLog(const char* message);
-        void ensureLogDir();
-        void openLogFile();
-        void writeRaw(const char* line);
-                static constexpr int LOG_BUFFER_SIZE = 128;
-                static constexpr int LOG_ENTRY_SIZE = 256;
-                char logBuffer[LOG_BUFFER_SIZE][LOG_ENTRY_SIZE];
-                int logCount;
+                static constexpr uint32_t RING_BYTES = 32 * 1024;      // Power of two
+                static constexpr uint32_t LINE_MAX = 255;              // Longer lines are cut
+                static constexpr uint32_t COMMIT_BYTES = 4 * 1024;     // Commit now past this
+                static constexpr uint32_t COMMIT_DELAY_MS = 250;       // Else this long after the first line
+                static constexpr uint32_t WAIT_MAX_MS = 20;            // JOURNAL_OVERFLOW_WAIT bound
+
+                void sendToSocket(const char* message);
+                void readFromSocket();
+                void enqueue(const char* message);
+                bool canWait(uint32_t irqFlags, uint32_t waitStart) const;
+                void kick(bool now);
+                bool commit();
+                bool appendFile(const uint8_t* data, uint32_t len);
+                void rotateFile();
+                void ensureLogDir();
+                static void WriterWork(void* arg);
+
                 kos::lib::Socket* journalSocket;
-        int logFileFd;
-        uint32_t logSeq;
-    bool fsReady;            // Filesystem available at Start()
-    bool pendingFlush;       // Need to flush buffered logs when FS becomes ready
+                uint8_t ring[RING_BYTES];
+                volatile uint32_t ringHead;     // Free-running; producers advance it
+                volatile uint32_t ringTail;     // Free-running; the writer advances it
+                uint32_t pendingSince;          // Uptime (ms) of the oldest pending line
+                uint32_t droppedUnreported;     // Dropped since the writer last noted it
+                volatile bool writerBusy;
+                uint32_t writerThread;          // Thread running commit() while busy
+                volatile bool rotateRequested;
+                bool fsReady;                   // Filesystem mounted
+                bool logDirReady;               // /var/log created this mount
+                uint32_t logSeq;
+                JournalOverflowPolicy overflowPolicy;
+                JournalStats stats;
+                kos::process::WorkItem commitWork;  // Size trigger and Rotate()
+                kos::process::WorkItem timerWork;   // Time trigger
         };
+
+        // Registered instance, or nullptr
+        JournalService* GetJournalService();
     } // namespace services
 } // namespace kos
-#endif // KOS_SERVICES_JOURNAL_SERVICE_HPP
\ No newline at end of file
+#endif // KOS_SERVICES_JOURNAL_SERVICE_HPP
@@ -2,6 +2,7 @@
 #define KOS_SERVICES_NETWORK_MANAGER_HPP
 
 #include <services/service.hpp>
+#include <process/workqueue.hpp>
 
 namespace kos {
     namespace services {
@@ -109,25 +110,21 @@ namespace kos {
             */
             NetConfig cfg_{};
             
-            // Optional worker thread so the service is visible in 'top'
             /*
-            * @brief The thread ID for the worker thread
-            * @return The thread ID for the worker thread
-            * The thread ID for the worker thread.
+            * @brief Period of the NIC RX poll in milliseconds (one timer tick)
             */
-            unsigned int threadId_ = 0;
-            
+            static const unsigned int RX_POLL_INTERVAL_MS = 10;
+
             /*
-            * @brief The worker thread function
-            * The worker thread function for handling network tasks.
+            * @brief Self-rearming work item that polls the NIC RX ring
+            * Runs on the high-priority kernel work queue.
             */
-            static void worker_trampoline();
+            static kos::process::WorkItem s_rx_work;
 
             /*
-            * @brief The instance of the network manager service
-            * The instance of the network manager service.
+            * @brief Work function behind s_rx_work
             */
-            static NetworkManagerService* s_self; // for simple trampoline capture
+            static void rx_poll_work(void*);
         };
 
     } // namespace services
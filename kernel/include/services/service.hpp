@@ -10,6 +10,23 @@ using namespace kos::process;
 namespace kos {
     namespace services {
 
+        // Things a service can wait for instead of polling
+        enum ServiceEventType : uint32_t {
+            SERVICE_EVENT_TIMER = 0,        // TickIntervalMs() elapsed
+            SERVICE_EVENT_MESSAGE = 1,      // data = id of the message queue that received a message
+            SERVICE_EVENT_FS_READY = 2,     // Root filesystem mounted and standard dirs exist
+            SERVICE_EVENT_NET_RX = 3,       // data = length of the last received frame
+            SERVICE_EVENT_COUNT
+        };
+
+        inline uint32_t ServiceEventBit(ServiceEventType type) { return 1u << (uint32_t)type; }
+
+        struct ServiceEvent {
+            ServiceEventType type;
+            uint32_t data;
+            uint32_t count;                 // Posts coalesced into this delivery
+        };
+
         // Basic service interface for kernel/system services started at boot.
         class IService {
         public:
@@ -31,7 +48,17 @@ namespace kos {
             virtual bool DefaultEnabled() const { return true; }
 
             // Desired tick interval in milliseconds for periodic work (if Tick is overridden).
+            // Return 0 to get no timer events at all.
             virtual uint32_t TickIntervalMs() const { return 1000; }
+
+            // Non-timer events to deliver, as a mask of ServiceEventBit() values.
+            virtual uint32_t EventMask() const { return 0; }
+
+            // Called from the service event loop. The default turns timer events
+            // into Tick() so periodic services need no changes.
+            virtual void OnEvent(const ServiceEvent& ev) {
+                if (ev.type == SERVICE_EVENT_TIMER) Tick();
+            }
         };
 
     } // namespace services
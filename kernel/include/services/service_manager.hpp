@@ -16,6 +16,13 @@ namespace kos {
             IService* svc;
             bool enabled;
             uint32_t last_tick_ms;
+            uint32_t event_mask;                            // svc->EventMask() at registration
+            uint32_t pending;                               // ServiceEventBit()s awaiting delivery
+            uint32_t pending_data[SERVICE_EVENT_COUNT];     // Latest data per pending type
+            uint32_t pending_count[SERVICE_EVENT_COUNT];    // Posts since last delivery
+            uint32_t events;                                // Events delivered
+            uint32_t late_timers;                           // Timer events that came a full period late
+            uint64_t busy_cycles;                           // TSC cycles in Start() and OnEvent()
             ServiceNode* next;
         };
 
@@ -32,8 +39,25 @@ namespace kos {
             // Lines starting with '#' are comments.
             static void InitAndStart();
 
-            // Run service ticks periodically. Should be called from a system thread.
-            static void TickAll();
+            // Returned by DispatchEvents() when no enabled service has a timer
+            static const uint32_t NO_TIMER = 0xFFFFFFFFu;
+
+            // Queue an event for every enabled service whose EventMask() includes it.
+            // Repeated posts before delivery coalesce into one OnEvent() call.
+            // Safe from interrupt handlers; wakes the event loop.
+            static void PostEvent(ServiceEventType type, uint32_t data = 0);
+
+            // Deliver pending events and due timers once. Returns milliseconds
+            // until the next timer is due, or NO_TIMER.
+            static uint32_t DispatchEvents();
+
+            // Turn the calling thread into the service event loop: dispatch, then
+            // sleep until the next timer or until PostEvent() wakes it. Never returns.
+            static void RunEventLoop();
+            static bool IsEventLoopRunning() { return s_loop_running; }
+
+            // Print per-service event counts and CPU time to the TTY.
+            static void PrintStats();
 
             // Returns true if service exists and is enabled.
             static bool IsEnabled(const char* name);
@@ -47,13 +71,19 @@ namespace kos {
 
         private:
             static ServiceNode* s_head;
+            static kos::process::SeqLock s_list_lock; // Guards s_head and node->enabled
             static bool s_debugCfg;
             static uint32_t s_boot_ms;
+            static volatile uint32_t s_event_mask;      // Union of registered EventMask()s
+            static volatile bool s_events_pending;
+            static volatile uint32_t s_loop_tid;        // Thread running RunEventLoop()
+            static volatile bool s_loop_running;        // Also set on the boot context (tid 0)
 
             static void ApplyConfig();
+            static void Deliver(ServiceNode* node, const ServiceEvent& ev);
         };
 
-        // API to run the ServiceManager loop as a system service thread.
+        // API to run the ServiceManager event loop as a system service thread.
         namespace ServiceAPI {
             bool StartManagerThread();
         }
@@ -11,7 +11,8 @@ namespace kos {
             virtual const char* Name() const override { return "TIME"; }
             virtual bool Start() override { return true; }
             virtual void Tick() override;
-            virtual uint32_t TickIntervalMs() const override { return 1000; }
+            // Tick() only logs in debug mode; stay off the event loop otherwise
+            virtual uint32_t TickIntervalMs() const override;
             virtual bool DefaultEnabled() const override { return false; } // off by default
         };
 
@@ -2,6 +2,7 @@
 #define KOS_UI_WINDOW_REGISTRY_HPP
 
 #include <common/types.hpp>
+#include <process/sync.hpp>
 
 using namespace kos::common;
 
@@ -12,7 +13,8 @@ class IUIComponent;
 /**
  * Dynamic window registry - replaces static window IDs.
  * Manages window lifecycle and tracks UI components.
- * Single-threaded, no locks required (runs in window manager context only).
+ * Mutated by the window manager only; read from input and monitoring paths.
+ * Readers go through a SeqLock and never block registration.
  */
 class WindowRegistry {
 public:
@@ -42,10 +44,24 @@ public:
      */
     template<typename Callback>
     void ForEachWindowInZOrder(Callback cb) const {
+        // Iterate a consistent snapshot so callbacks may (un)register windows.
         // Simple linear order for now (components registered in order)
         // In future: track proper z-order
-        for (uint32_t i = 0; i < num_components_; ++i) {
-            if (!cb(component_ids_[i], components_[i])) {
+        IUIComponent* components[MAX_WINDOWS];
+        uint32_t ids[MAX_WINDOWS];
+        uint32_t count;
+        uint32_t seq;
+        do {
+            seq = lock_.ReadBegin();
+            count = num_components_;
+            for (uint32_t i = 0; i < count; ++i) {
+                components[i] = components_[i];
+                ids[i] = component_ids_[i];
+            }
+        } while (lock_.ReadRetry(seq));
+
+        for (uint32_t i = 0; i < count; ++i) {
+            if (!cb(ids[i], components[i])) {
                 break;
             }
         }
@@ -70,6 +86,7 @@ protected:
     IUIComponent* components_[MAX_WINDOWS] = {};
     uint32_t component_ids_[MAX_WINDOWS] = {};
     uint32_t num_components_ = 0;
+    mutable kos::process::SeqLock lock_;
     
     WindowRegistry() = default;
     WindowRegistry(const WindowRegistry&) = delete;
@@ -3,6 +3,7 @@
 #include <console/tty.hpp>
 #include <lib/string.hpp>
 #include <drivers/keyboard/keyboard.hpp>
+#include <drivers/keyboard/keyboard_driver.hpp>
 #include <fs/filesystem.hpp>
 #include <lib/elfloader.hpp>
 // sys API utilities are declared in stdio.hpp
@@ -19,14 +20,27 @@
 // Pipe management
 #include <process/pipe.hpp>
 #include <process/message_queue.hpp>
+#include <process/poller.hpp>
+#include <process/shared_memory.hpp>
+#include <process/trace.hpp>
+#include <process/workqueue.hpp>
+#include <arch/x86/hardware/cpu/fpu.hpp>
+#include <arch/x86/hardware/cpu/features.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
+#include <lib/memops.hpp>
 #include <services/user_service.hpp>
 #include <services/service_manager.hpp>
+#include <services/journal_service.hpp>
+#include <drivers/block_cache.hpp>
+#include <fs/dentry_cache.hpp>
+#include <fs/file_table.hpp>
 
 using namespace kos::console;
 using namespace kos::lib;
 using namespace kos::drivers;
 using namespace kos::sys;
 using namespace kos::process;
+using kos::arch::x86::hardware::cpu::InterruptsEnabled;
 
 // File-local TTY instance for output
 static TTY tty;
@@ -49,6 +63,18 @@ static void shell_reboot_hw() {
     for(;;) { __asm__ __volatile__("hlt"); }
 }
 
+// Right-aligned decimal for tabular output
+static void shell_write_dec(uint32_t v, int width) {
+    int8_t digits[10];
+    int n = 0;
+    do {
+        digits[n++] = (int8_t)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    for (int i = n; i < width; ++i) tty.PutChar(' ');
+    while (n) tty.PutChar(digits[--n]);
+}
+
 // Optional filesystem access from shell
 namespace kos { 
     namespace fs { 
@@ -120,8 +146,20 @@ void Shell::Run() {
     SetCwd((const int8_t*)"/");
     // Welcome will be printed after successful login
     while (true) {
-        // In a real kernel, input would come from keyboard interrupts
-        // Here, input is handled via InputChar() called by the keyboard handler
+        // Input reaches InputChar() through the keyboard handler, which the
+        // driver runs from kworker-hi. Until a worker thread runs, this loop
+        // is the one place in text mode that drains the queues, so input,
+        // commands and blocking deferred work (disk writeback, appends, the
+        // journal) all run here, with interrupts on.
+        // Poll as a fallback for a missing IRQ1; graphics mode leaves that
+        // to the window manager.
+        if (::kos::g_kbd_poll_enabled && ::kos::g_keyboard_driver_ptr) {
+            for (int i = 0; i < 4; ++i) {
+                if (!::kos::g_keyboard_driver_ptr->PollOnce()) break;
+            }
+        }
+        WorkQueueAPI::DrainInline(true);
+        if (InterruptsEnabled()) __asm__ __volatile__("hlt");
     }
 }
 
@@ -571,6 +609,9 @@ void Shell::ExecuteCommand(const int8_t* command) {
             tty.Write("permission denied (root required)\n");
             return;
         }
+        // The apps reset or power off directly; get cached writes to disk first
+        if (kos::fs::g_fs_ptr) kos::fs::g_fs_ptr->Sync();
+        BlockCacheAPI::SyncAll();
         // fallthrough: allow execution as external app
     }
 
@@ -579,6 +620,7 @@ void Shell::ExecuteCommand(const int8_t* command) {
         (prog[7] == 0)) {
         if (g_scheduler) {
             g_scheduler->PrintTaskList();
+            kos::arch::x86::hardware::cpu::FPU::PrintStats();
         } else {
             tty.Write("Scheduler not initialized\n");
         }
@@ -687,6 +729,71 @@ void Shell::ExecuteCommand(const int8_t* command) {
         return;
     }
 
+    // Built-in: per-service event counts and CPU time
+    if (String::strcmp(prog, (const int8_t*)"services", 8) == 0 &&
+        (prog[8] == 0)) {
+        kos::services::ServiceManager::PrintStats();
+        return;
+    }
+
+    // Built-in: CPU feature registry and dispatch choices
+    if (String::strcmp(prog, (const int8_t*)"cpufeatures", 11) == 0 &&
+        (prog[11] == 0)) {
+        kos::arch::x86::hardware::cpu::CpuFeatures::Print();
+        return;
+    }
+
+    // Built-in: memcpy/memset throughput per variant and size
+    if (String::strcmp(prog, (const int8_t*)"membench", 8) == 0 &&
+        (prog[8] == 0)) {
+        kos::lib::MemOps::Benchmark();
+        return;
+    }
+
+    // Built-in: deferred work queue statistics
+    if (String::strcmp(prog, (const int8_t*)"workqueues", 10) == 0 &&
+        (prog[10] == 0)) {
+        kos::process::WorkQueueAPI::PrintAll();
+        return;
+    }
+
+    // Built-in: scheduler tracing (start|stop|status|clear|dump|mark <label> [value])
+    if (String::strcmp(prog, (const int8_t*)"trace", 5) == 0 &&
+        (prog[5] == 0)) {
+        const int8_t* sub = (argc >= 2) ? argv[1] : (const int8_t*)"status";
+        if (String::strcmp(sub, (const int8_t*)"start", 5) == 0 && sub[5] == 0) {
+            if (Tracer::Start()) tty.Write("Tracing started\n");
+            else tty.Write("Tracing unavailable: CPU has no TSC\n");
+        } else if (String::strcmp(sub, (const int8_t*)"stop", 4) == 0 && sub[4] == 0) {
+            Tracer::Stop();
+            tty.Write("Tracing stopped\n");
+        } else if (String::strcmp(sub, (const int8_t*)"clear", 5) == 0 && sub[5] == 0) {
+            Tracer::Clear();
+            tty.Write("Trace buffer cleared\n");
+        } else if (String::strcmp(sub, (const int8_t*)"dump", 4) == 0 && sub[4] == 0) {
+            uint32_t n = Tracer::Dump();
+            tty.Write("Trace written to serial, events: ");
+            tty.WriteHex(n);
+            tty.Write("\n");
+        } else if (String::strcmp(sub, (const int8_t*)"mark", 4) == 0 && sub[4] == 0 && argc >= 3) {
+            uint32_t value = 0;
+            if (argc >= 4) {
+                for (int i = 0; argv[3][i] >= '0' && argv[3][i] <= '9'; i++) {
+                    value = value * 10 + (argv[3][i] - '0');
+                }
+            }
+            Tracer::Mark((const char*)argv[2], value);
+        } else {
+            tty.Write(Tracer::IsEnabled() ? "Tracing: on" : "Tracing: off");
+            tty.Write(", buffered: ");
+            tty.WriteHex(Tracer::GetEventCount());
+            tty.Write(", overwritten: ");
+            tty.WriteHex(Tracer::GetOverwrittenCount());
+            tty.Write("\n");
+        }
+        return;
+    }
+
     // Built-in: pipes command (show all pipes)
     if (String::strcmp(prog, (const int8_t*)"pipes", 5) == 0 &&
         (prog[5] == 0)) {
@@ -702,7 +809,7 @@ void Shell::ExecuteCommand(const int8_t* command) {
     if (String::strcmp(prog, (const int8_t*)"mkpipe", 6) == 0 &&
         (prog[6] == ' ' || prog[6] == 0)) {
         if (prog[6] == 0) {
-            tty.Write("Usage: mkpipe <name> [buffer_size]\n");
+            tty.Write("Usage: mkpipe <name> [stream]\n");
             return;
         }
         
@@ -711,7 +818,7 @@ void Shell::ExecuteCommand(const int8_t* command) {
         while (*name_start == ' ') name_start++; // Skip spaces
         
         if (*name_start == 0) {
-            tty.Write("Usage: mkpipe <name> [buffer_size]\n");
+            tty.Write("Usage: mkpipe <name> [stream]\n");
             return;
         }
         
@@ -727,8 +834,13 @@ void Shell::ExecuteCommand(const int8_t* command) {
             pipe_name[i] = name_start[i];
         }
         pipe_name[name_len] = 0;
+
+        // Optional "stream": byte-stream ring instead of framed messages
+        const int8_t* opt = name_end;
+        while (*opt == ' ') opt++;
+        PipeMode mode = (String::strcmp(opt, (const int8_t*)"stream", 6) == 0) ? PIPE_MODE_STREAM : PIPE_MODE_MESSAGE;
         
-        uint32_t pipe_id = PipeAPI::CreatePipe(pipe_name);
+        uint32_t pipe_id = PipeAPI::CreatePipe(pipe_name, 4096, 64, mode);
         if (pipe_id) {
             tty.Write("Created pipe: ");
             tty.Write(pipe_name);
@@ -741,6 +853,13 @@ void Shell::ExecuteCommand(const int8_t* command) {
         return;
     }
 
+    // Built-in: pipebench (message vs stream pipe throughput)
+    if (String::strcmp(prog, (const int8_t*)"pipebench", 9) == 0 &&
+        (prog[9] == 0)) {
+        Pipe::Benchmark();
+        return;
+    }
+
     // Built-in: rmpipe command (remove pipe)
     if (String::strcmp(prog, (const int8_t*)"rmpipe", 6) == 0 &&
         (prog[6] == ' ' || prog[6] == 0)) {
@@ -792,6 +911,105 @@ void Shell::ExecuteCommand(const int8_t* command) {
         return;
     }
 
+    // Built-in: pollers (show readiness sets)
+    if (String::strcmp(prog, (const int8_t*)"pollers", 7) == 0 &&
+        (prog[7] == 0)) {
+        Poller::PrintAll();
+        return;
+    }
+
+    // Built-in: shm (show shared memory regions)
+    if (String::strcmp(prog, (const int8_t*)"shm", 3) == 0 &&
+        (prog[3] == 0)) {
+        if (g_shm_manager) {
+            g_shm_manager->PrintAllRegions();
+        } else {
+            tty.Write("Shared memory manager not initialized\n");
+        }
+        return;
+    }
+
+    // Built-in: sync (write dirty cached disk blocks back)
+    if (String::strcmp(prog, (const int8_t*)"sync", 4) == 0 &&
+        (prog[4] == 0)) {
+        bool ok = !kos::fs::g_fs_ptr || kos::fs::g_fs_ptr->Sync();
+        if (!BlockCacheAPI::SyncAll() || !ok) {
+            tty.Write("sync: write-back failed\n");
+        }
+        return;
+    }
+
+    // Built-in: df (filesystem usage)
+    if (String::strcmp(prog, (const int8_t*)"df", 2) == 0 &&
+        (prog[2] == 0)) {
+        kos::fs::FsStats st;
+        if (!kos::fs::g_fs_ptr || !kos::fs::g_fs_ptr->GetStats(st)) {
+            tty.Write("df: filesystem usage not available\n");
+            return;
+        }
+        tty.Write("Size(KB)  Used(KB)  Free(KB)  Use%\n");
+        shell_write_dec((uint32_t)((uint64_t)st.totalClusters * st.clusterBytes / 1024), 8);
+        tty.Write("  ");
+        shell_write_dec((uint32_t)((uint64_t)st.usedClusters * st.clusterBytes / 1024), 8);
+        tty.Write("  ");
+        shell_write_dec((uint32_t)((uint64_t)st.freeClusters * st.clusterBytes / 1024), 8);
+        tty.Write("  ");
+        shell_write_dec(st.totalClusters ? (uint32_t)((uint64_t)st.usedClusters * 100 / st.totalClusters) : 0, 3);
+        tty.Write("%\n");
+        return;
+    }
+
+    // Built-in: bcache (block cache hit/miss/write-back counters)
+    if (String::strcmp(prog, (const int8_t*)"bcache", 6) == 0 &&
+        (prog[6] == 0)) {
+        BlockCacheAPI::PrintAll();
+        return;
+    }
+
+    // Built-in: dcache (directory lookup cache counters)
+    if (String::strcmp(prog, (const int8_t*)"dcache", 6) == 0 &&
+        (prog[6] == 0)) {
+        kos::fs::DentryCacheAPI::PrintAll();
+        return;
+    }
+
+    // Built-in: lsof (open file descriptors)
+    if (String::strcmp(prog, (const int8_t*)"lsof", 4) == 0 &&
+        (prog[4] == 0)) {
+        kos::fs::FileAPI::PrintAll();
+        return;
+    }
+
+    // Built-in: journal [sync|rotate|wait|drop] - writer stats and control
+    if (String::strcmp(prog, (const int8_t*)"journal", 7) == 0 && (prog[7] == 0)) {
+        kos::services::JournalService* journal = kos::services::GetJournalService();
+        if (!journal) { tty.Write("Journal service not registered\n"); return; }
+        if (argc == 1) {
+            journal->PrintStats();
+            return;
+        }
+        const int8_t* arg = argv[1];
+        if (String::strcmp(arg, (const int8_t*)"sync", 4) == 0 && arg[4] == 0) {
+            journal->Flush();
+        } else if (String::strcmp(arg, (const int8_t*)"rotate", 6) == 0 && arg[6] == 0) {
+            journal->Rotate();
+        } else if (String::strcmp(arg, (const int8_t*)"wait", 4) == 0 && arg[4] == 0) {
+            journal->SetOverflowPolicy(kos::services::JOURNAL_OVERFLOW_WAIT);
+        } else if (String::strcmp(arg, (const int8_t*)"drop", 4) == 0 && arg[4] == 0) {
+            journal->SetOverflowPolicy(kos::services::JOURNAL_OVERFLOW_DROP);
+        } else {
+            tty.Write("Usage: journal [sync|rotate|wait|drop]\n");
+        }
+        return;
+    }
+
+    // Built-in: mqbench (uncontended message queue Send/Receive cost)
+    if (String::strcmp(prog, (const int8_t*)"mqbench", 7) == 0 &&
+        (prog[7] == 0)) {
+        MessageQueue::Benchmark();
+        return;
+    }
+
     // Built-in: mkmq <name> [max_messages] [max_message_size]
     if (String::strcmp(prog, (const int8_t*)"mkmq", 4) == 0 &&
         (prog[4] == 0)) {
@@ -976,6 +1194,12 @@ void Shell::ExecuteCommand(const int8_t* command) {
     tty.Write("  mousedbg on/off- Dump raw mouse bytes (IRQ/POLL)\n");
     tty.Write("  cursor [style] - Show or set cursor style (crosshair|triangle)\n");
         tty.Write("  lshw           - Hardware info: CPU, memory, PCI\n");
+    tty.Write("  sync           - Write cached disk blocks back\n");
+    tty.Write("  bcache         - Show block cache statistics\n");
+    tty.Write("  dcache         - Show directory lookup cache statistics\n");
+    tty.Write("  lsof           - List open file descriptors\n");
+    tty.Write("  journal [cmd]  - Journal writer stats; sync|rotate|wait|drop\n");
+    tty.Write("  df             - Show filesystem usage\n");
     tty.Write("  reboot         - Reboot (root only)\n");
     tty.Write("  shutdown       - Power off (root only)\n");
         
@@ -987,12 +1211,21 @@ void Shell::ExecuteCommand(const int8_t* command) {
         tty.Write("  suspend <id>   - Suspend thread by ID (hex)\n");
         tty.Write("  resume <id>    - Resume thread by ID (hex)\n");
         tty.Write("  sleep <ms>     - Sleep current thread (decimal ms)\n");
+        tty.Write("  trace <cmd>    - start|stop|status|clear|dump|mark <l> [v]\n");
+        tty.Write("  services       - Show service events and CPU time\n");
+        tty.Write("  workqueues     - Show deferred work queue statistics\n");
+        tty.Write("  cpufeatures    - Show CPU features and selected kernel variants\n");
+        tty.Write("  membench       - Measure memcpy/memset throughput (GB/s)\n");
         tty.Write("  pipes          - Show all active pipes\n");
-        tty.Write("  mkpipe <name>  - Create a new pipe\n");
+        tty.Write("  mkpipe <name> [stream] - Create a new pipe (stream = byte ring)\n");
         tty.Write("  rmpipe <name>  - Remove a pipe\n");
+        tty.Write("  pipebench      - Compare message and stream pipe throughput\n");
         tty.Write("  mqueues        - Show all active message queues\n");
         tty.Write("  mkmq <n> [m] [s]- Create message queue\n");
+        tty.Write("  mqbench        - Measure message queue Send/Receive cycles\n");
         tty.Write("  rmmq <name>    - Remove message queue\n");
+        tty.Write("  pollers        - Show pollers and their waiters\n");
+        tty.Write("  shm            - Show shared memory regions\n");
         tty.Write("  mqsend <q> <r> <msg> - Send IPC message\n");
         tty.Write("  mqrecv <q> [n] - Receive IPC message\n");
         tty.Write("  <cmd>          - Execute /bin/<cmd>.elf from filesystem\n");
@@ -0,0 +1,524 @@
+#include <drivers/block_cache.hpp>
+#include <memory/heap.hpp>
+#include <lib/string.hpp>
+#include <process/scheduler.hpp>
+#include <process/workqueue.hpp>
+#include <services/service_manager.hpp>
+#include <console/logger.hpp>
+#include <console/tty.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
+
+using namespace kos::drivers;
+using namespace kos::memory;
+using namespace kos::lib;
+using namespace kos::console;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
+
+CachedBlockDevice* CachedBlockDevice::s_first = nullptr;
+
+namespace {
+    inline uint32_t NowMs() {
+        return kos::services::ServiceManager::UptimeMs();
+    }
+
+    void WriteDec(uint32_t v) {
+        int8_t digits[11];
+        int n = 0;
+        do {
+            digits[n++] = (int8_t)('0' + v % 10);
+            v /= 10;
+        } while (v);
+        while (n) TTY::PutChar(digits[--n]);
+    }
+}
+
+CachedBlockDevice::CachedBlockDevice(BlockDevice* backing_dev, const char* cache_name,
+                                     uint32_t block_sectors, uint32_t count)
+    : backing(backing_dev), name(cache_name),
+      sectors_per_block(block_sectors ? block_sectors : 1),
+      buffer_count(count ? count : 1),
+      buffers(nullptr), buffer_data(nullptr), prefetch_data(nullptr), buckets(nullptr), bucket_mask(0),
+      lru_head(nullptr), lru_tail(nullptr), busy(false), flush_armed(false),
+      setup_failed(false), next_cache(nullptr) {
+    String::memset(&stats, 0, sizeof(stats));
+}
+
+CachedBlockDevice::~CachedBlockDevice() {
+    if (!buffers) return;
+    Sync();
+
+    uint32_t flags = IrqSave();
+    for (CachedBlockDevice** link = &s_first; *link; link = &(*link)->next_cache) {
+        if (*link != this) continue;
+        *link = next_cache;
+        break;
+    }
+    IrqRestore(flags);
+
+    Heap::Free(buckets);
+    Heap::Free(buffer_data);
+    Heap::Free(buffers);
+    if (prefetch_data) Heap::Free(prefetch_data);
+}
+
+bool CachedBlockDevice::EnsureBuffers() {
+    if (buffers) return true;
+    if (setup_failed) return false;
+
+    uint32_t bucket_count = 1;
+    while (bucket_count < buffer_count) bucket_count <<= 1;
+
+    buffers = (BlockBuffer*)Heap::Alloc(sizeof(BlockBuffer) * buffer_count);
+    buffer_data = (uint8_t*)Heap::Alloc(GetBlockSize() * buffer_count, 16);
+    buckets = (BlockBuffer**)Heap::Alloc(sizeof(BlockBuffer*) * bucket_count);
+    if (!buffers || !buffer_data || !buckets) {
+        if (buffers) Heap::Free(buffers);
+        if (buffer_data) Heap::Free(buffer_data);
+        if (buckets) Heap::Free(buckets);
+        buffers = nullptr;
+        buffer_data = nullptr;
+        buckets = nullptr;
+        setup_failed = true;
+        Logger::LogKV("Block cache disabled (out of memory) for", name);
+        return false;
+    }
+    String::memset(buckets, 0, sizeof(BlockBuffer*) * bucket_count);
+    bucket_mask = bucket_count - 1;
+
+    // Every buffer starts empty on the LRU list, so Reclaim sees them first
+    for (uint32_t i = 0; i < buffer_count; ++i) {
+        BlockBuffer& b = buffers[i];
+        b.block = 0;
+        b.data = buffer_data + i * GetBlockSize();
+        b.pin_count = 0;
+        b.dirty_since = 0;
+        b.valid = false;
+        b.dirty = false;
+        b.hash_next = nullptr;
+        b.lru_prev = (i > 0) ? &buffers[i - 1] : nullptr;
+        b.lru_next = (i + 1 < buffer_count) ? &buffers[i + 1] : nullptr;
+    }
+    lru_head = &buffers[0];
+    lru_tail = &buffers[buffer_count - 1];
+
+    uint32_t flags = IrqSave();
+    next_cache = s_first;
+    s_first = this;
+    IrqRestore(flags);
+    return true;
+}
+
+// The flusher may run from the timer interrupt, where a yield-based mutex
+// would see its own thread as the owner; a plain busy flag lets it back off.
+void CachedBlockDevice::Lock() {
+    while (!TryLock()) {
+        kos::process::SchedulerAPI::YieldThread();
+    }
+}
+
+bool CachedBlockDevice::TryLock() {
+    uint32_t flags = IrqSave();
+    bool acquired = !busy;
+    busy = true;
+    IrqRestore(flags);
+    return acquired;
+}
+
+void CachedBlockDevice::Unlock() {
+    busy = false;
+}
+
+void CachedBlockDevice::Activate() {
+    if (backing) backing->Activate();
+}
+
+BlockBuffer* CachedBlockDevice::Lookup(uint32_t block) const {
+    BlockBuffer* b = buckets[(block ^ (block >> 10)) & bucket_mask];
+    while (b && b->block != block) b = b->hash_next;
+    return b;
+}
+
+void CachedBlockDevice::HashInsert(BlockBuffer* buf) {
+    BlockBuffer** bucket = &buckets[(buf->block ^ (buf->block >> 10)) & bucket_mask];
+    buf->hash_next = *bucket;
+    *bucket = buf;
+    buf->valid = true;
+}
+
+void CachedBlockDevice::HashRemove(BlockBuffer* buf) {
+    BlockBuffer** link = &buckets[(buf->block ^ (buf->block >> 10)) & bucket_mask];
+    while (*link && *link != buf) link = &(*link)->hash_next;
+    if (*link) *link = buf->hash_next;
+    buf->hash_next = nullptr;
+    buf->valid = false;
+}
+
+void CachedBlockDevice::Touch(BlockBuffer* buf) {
+    if (buf == lru_head) return;
+    // Unlink
+    buf->lru_prev->lru_next = buf->lru_next;
+    if (buf->lru_next) buf->lru_next->lru_prev = buf->lru_prev;
+    else lru_tail = buf->lru_prev;
+    // Push front
+    buf->lru_prev = nullptr;
+    buf->lru_next = lru_head;
+    lru_head->lru_prev = buf;
+    lru_head = buf;
+}
+
+BlockBuffer* CachedBlockDevice::Reclaim() {
+    for (BlockBuffer* b = lru_tail; b; b = b->lru_prev) {
+        if (b->pin_count) continue;
+        if (b->valid) {
+            // A block that cannot be written back stays cached
+            if (b->dirty && !WriteBack(b)) continue;
+            HashRemove(b);
+            stats.evictions++;
+        }
+        return b;
+    }
+    return nullptr;
+}
+
+BlockBuffer* CachedBlockDevice::PinLocked(uint32_t block, bool fill) {
+    BlockBuffer* b = Lookup(block);
+    if (b) {
+        stats.hits++;
+        b->pin_count++;
+        Touch(b);
+        return b;
+    }
+
+    stats.misses++;
+    b = Reclaim();
+    if (!b) return nullptr;
+    b->block = block;
+    b->dirty = false;
+    if (fill && !backing->ReadSectors(block * sectors_per_block, (uint8_t)sectors_per_block, b->data)) {
+        return nullptr;
+    }
+    HashInsert(b);
+    b->pin_count = 1;
+    Touch(b);
+    return b;
+}
+
+bool CachedBlockDevice::ReadSectors(uint32_t lba, uint8_t sectorCount, uint8_t* buffer) {
+    if (!backing) return false;
+    if (!EnsureBuffers()) return backing->ReadSectors(lba, sectorCount, buffer);
+
+    Lock();
+    bool ok = true;
+    uint32_t remaining = sectorCount;
+    while (remaining && ok) {
+        uint32_t offset = lba % sectors_per_block;
+        uint32_t n = sectors_per_block - offset;
+        if (n > remaining) n = remaining;
+
+        if (sectorCount > sectors_per_block && !Lookup(lba / sectors_per_block)) {
+            // Bulk read: take the following uncached blocks too and go to the
+            // device once. Uncached blocks have no newer copy here, so
+            // reading them around the cache stays coherent.
+            while (n < remaining && !Lookup((lba + n) / sectors_per_block)) {
+                uint32_t step = remaining - n;
+                n += (step > sectors_per_block) ? sectors_per_block : step;
+            }
+            ok = backing->ReadSectors(lba, (uint8_t)n, buffer);
+            stats.direct_reads++;
+            lba += n;
+            buffer += n * BCACHE_SECTOR_SIZE;
+            remaining -= n;
+            continue;
+        }
+
+        BlockBuffer* b = PinLocked(lba / sectors_per_block, true);
+        if (b) {
+            String::memmove(buffer, b->data + offset * BCACHE_SECTOR_SIZE, n * BCACHE_SECTOR_SIZE);
+            b->pin_count--;
+        } else {
+            // No free buffer, or the whole block is unreadable (e.g. it runs
+            // past the end of the disk): the block is not cached, so going
+            // to the device for just these sectors is coherent
+            ok = backing->ReadSectors(lba, (uint8_t)n, buffer);
+        }
+        lba += n;
+        buffer += n * BCACHE_SECTOR_SIZE;
+        remaining -= n;
+    }
+    Unlock();
+    return ok;
+}
+
+bool CachedBlockDevice::WriteSectors(uint32_t lba, uint8_t sectorCount, const uint8_t* buffer) {
+    return WriteRange(lba, sectorCount, buffer, false);
+}
+
+bool CachedBlockDevice::WriteSectorsThrough(uint32_t lba, uint8_t sectorCount, const uint8_t* buffer) {
+    return WriteRange(lba, sectorCount, buffer, true);
+}
+
+bool CachedBlockDevice::WriteRange(uint32_t lba, uint8_t sectorCount, const uint8_t* buffer, bool through) {
+    if (!backing) return false;
+    if (!EnsureBuffers()) return backing->WriteSectors(lba, sectorCount, buffer);
+
+    Lock();
+    bool ok = true;
+    uint32_t remaining = sectorCount;
+    while (remaining && ok) {
+        uint32_t offset = lba % sectors_per_block;
+        uint32_t n = sectors_per_block - offset;
+        if (n > remaining) n = remaining;
+
+        // A whole-block overwrite needs no read from the disk first
+        bool partial = (n != sectors_per_block);
+        BlockBuffer* b = PinLocked(lba / sectors_per_block, partial);
+        if (b) {
+            String::memmove(b->data + offset * BCACHE_SECTOR_SIZE, buffer, n * BCACHE_SECTOR_SIZE);
+            MarkDirtyLocked(b);
+            // A failed write-back leaves the block dirty for the flusher
+            if (through) ok = WriteBack(b);
+            b->pin_count--;
+        } else {
+            ok = backing->WriteSectors(lba, (uint8_t)n, buffer);
+        }
+        lba += n;
+        buffer += n * BCACHE_SECTOR_SIZE;
+        remaining -= n;
+    }
+    Unlock();
+    return ok;
+}
+
+void CachedBlockDevice::Prefetch(uint32_t lba, uint32_t sectorCount) {
+    if (!backing || !sectorCount || !EnsureBuffers()) return;
+    // Readahead never waits and never takes more than a quarter of the cache
+    uint32_t max_blocks = BCACHE_PREFETCH_MAX_SECTORS / sectors_per_block;
+    if (max_blocks > buffer_count / 4) max_blocks = buffer_count / 4;
+    if (!max_blocks || !TryLock()) return;
+    if (!prefetch_data) {
+        prefetch_data = (uint8_t*)Heap::Alloc(BCACHE_PREFETCH_MAX_SECTORS * BCACHE_SECTOR_SIZE, 16);
+    }
+
+    uint32_t block = lba / sectors_per_block;
+    uint32_t last = (lba + sectorCount - 1) / sectors_per_block;
+    if (last - block >= max_blocks) last = block + max_blocks - 1;
+    while (prefetch_data && block <= last) {
+        if (Lookup(block)) {
+            block++;
+            continue;
+        }
+        uint32_t run = 1;
+        while (block + run <= last && !Lookup(block + run)) run++;
+        if (!PrefetchRun(block, run)) break;
+        block += run;
+    }
+    Unlock();
+}
+
+// Read blocks that are all uncached through the staging buffer in one command
+bool CachedBlockDevice::PrefetchRun(uint32_t first_block, uint32_t blocks) {
+    if (!backing->ReadSectors(first_block * sectors_per_block, (uint8_t)(blocks * sectors_per_block), prefetch_data)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < blocks; ++i) {
+        BlockBuffer* b = Reclaim();
+        if (!b) return false;
+        b->block = first_block + i;
+        b->dirty = false;
+        String::memmove(b->data, prefetch_data + i * GetBlockSize(), GetBlockSize());
+        HashInsert(b);
+        Touch(b);
+        stats.prefetched++;
+    }
+    return true;
+}
+
+BlockBuffer* CachedBlockDevice::Pin(uint32_t lba) {
+    if (!backing || !EnsureBuffers()) return nullptr;
+    Lock();
+    BlockBuffer* b = PinLocked(lba / sectors_per_block, true);
+    Unlock();
+    return b;
+}
+
+void CachedBlockDevice::Unpin(BlockBuffer* buf) {
+    if (!buf) return;
+    Lock();
+    if (buf->pin_count) buf->pin_count--;
+    Unlock();
+}
+
+void CachedBlockDevice::MarkDirty(BlockBuffer* buf) {
+    if (!buf) return;
+    Lock();
+    MarkDirtyLocked(buf);
+    Unlock();
+}
+
+uint8_t* CachedBlockDevice::SectorData(BlockBuffer* buf, uint32_t lba) const {
+    return buf->data + (lba % sectors_per_block) * BCACHE_SECTOR_SIZE;
+}
+
+void CachedBlockDevice::MarkDirtyLocked(BlockBuffer* buf) {
+    if (buf->dirty) return;
+    buf->dirty = true;
+    buf->dirty_since = NowMs();
+    stats.dirty++;
+    ArmFlusher();
+}
+
+bool CachedBlockDevice::WriteBack(BlockBuffer* buf) {
+    if (!backing->WriteSectors(buf->block * sectors_per_block, (uint8_t)sectors_per_block, buf->data)) {
+        Logger::LogKV("Block cache write-back failed on", name);
+        return false;
+    }
+    buf->dirty = false;
+    stats.dirty--;
+    stats.writebacks++;
+    return true;
+}
+
+bool CachedBlockDevice::SyncLocked() {
+    // Write in ascending block order so the disk sees one forward sweep
+    bool ok = true;
+    uint32_t next = 0;
+    while (stats.dirty) {
+        BlockBuffer* lowest = nullptr;
+        for (uint32_t i = 0; i < buffer_count; ++i) {
+            BlockBuffer& b = buffers[i];
+            if (!b.dirty || b.block < next) continue;
+            if (!lowest || b.block < lowest->block) lowest = &b;
+        }
+        if (!lowest) break;
+        if (!WriteBack(lowest)) ok = false;
+        if (lowest->block == 0xFFFFFFFFu) break;
+        next = lowest->block + 1;
+    }
+    return ok;
+}
+
+bool CachedBlockDevice::Sync() {
+    if (!buffers) return true;
+    Lock();
+    bool ok = SyncLocked();
+    Unlock();
+    return ok;
+}
+
+uint32_t CachedBlockDevice::FlushExpired(uint32_t max_age_ms) {
+    if (!buffers) return 0;
+    Lock();
+    uint32_t written = 0;
+    uint32_t now = NowMs();
+    for (uint32_t i = 0; i < buffer_count && stats.dirty; ++i) {
+        BlockBuffer& b = buffers[i];
+        if (!b.dirty || now - b.dirty_since < max_age_ms) continue;
+        if (WriteBack(&b)) written++;
+    }
+    Unlock();
+    return written;
+}
+
+bool CachedBlockDevice::Invalidate() {
+    if (!buffers) return true;
+    Lock();
+    bool ok = SyncLocked();
+    for (uint32_t i = 0; i < buffer_count; ++i) {
+        BlockBuffer& b = buffers[i];
+        if (b.valid && !b.pin_count && !b.dirty) HashRemove(&b);
+    }
+    Unlock();
+    return ok;
+}
+
+void CachedBlockDevice::ArmFlusher() {
+    uint32_t flags = IrqSave();
+    bool arm = !flush_armed;
+    flush_armed = true;
+    IrqRestore(flags);
+    if (!arm) return;
+    if (!kos::process::WorkQueueAPI::QueueDelayedWork(&CachedBlockDevice::FlushWork, this, BCACHE_FLUSH_INTERVAL_MS, true)) {
+        // No work queue yet: dirty data waits for the next write or Sync
+        flush_armed = false;
+    }
+}
+
+void CachedBlockDevice::FlushWork(void* arg) {
+    CachedBlockDevice* self = (CachedBlockDevice*)arg;
+    // Busy means a caller is mid-request (possibly the one this tick
+    // interrupted); try again next interval
+    if (!self->TryLock()) {
+        self->flush_armed = false;
+        self->ArmFlusher();
+        return;
+    }
+    uint32_t now = NowMs();
+    for (uint32_t i = 0; i < self->buffer_count && self->stats.dirty; ++i) {
+        BlockBuffer& b = self->buffers[i];
+        if (b.dirty && now - b.dirty_since >= BCACHE_DIRTY_EXPIRE_MS) self->WriteBack(&b);
+    }
+    bool still_dirty = self->stats.dirty != 0;
+    self->flush_armed = false;
+    self->Unlock();
+    if (still_dirty) self->ArmFlusher();
+}
+
+BlockCacheStats CachedBlockDevice::GetStats() const {
+    BlockCacheStats copy = stats;
+    copy.pinned = 0;
+    for (uint32_t i = 0; buffers && i < buffer_count; ++i) {
+        if (buffers[i].pin_count) copy.pinned++;
+    }
+    return copy;
+}
+
+void CachedBlockDevice::PrintStats() const {
+    BlockCacheStats s = GetStats();
+    uint32_t lookups = s.hits + s.misses;
+    TTY::Write(name);
+    TTY::Write(": ");
+    WriteDec(buffer_count);
+    TTY::Write(" x ");
+    WriteDec(GetBlockSize());
+    TTY::Write("B hits=");
+    WriteDec(s.hits);
+    TTY::Write(" misses=");
+    WriteDec(s.misses);
+    TTY::Write(" (");
+    WriteDec(lookups ? (uint32_t)((uint64_t)s.hits * 100 / lookups) : 0);
+    TTY::Write("% hit) writebacks=");
+    WriteDec(s.writebacks);
+    TTY::Write(" evictions=");
+    WriteDec(s.evictions);
+    TTY::Write(" readahead=");
+    WriteDec(s.prefetched);
+    TTY::Write(" direct=");
+    WriteDec(s.direct_reads);
+    TTY::Write(" dirty=");
+    WriteDec(s.dirty);
+    TTY::Write(" pinned=");
+    WriteDec(s.pinned);
+    TTY::Write("\n");
+}
+
+namespace kos::drivers::BlockCacheAPI {
+    bool SyncAll() {
+        bool ok = true;
+        for (CachedBlockDevice* c = CachedBlockDevice::First(); c; c = c->Next()) {
+            if (!c->Sync()) ok = false;
+        }
+        return ok;
+    }
+
+    void PrintAll() {
+        TTY::Write("=== Block Cache ===\n");
+        if (!CachedBlockDevice::First()) {
+            TTY::Write("No caches in use\n");
+            return;
+        }
+        for (CachedBlockDevice* c = CachedBlockDevice::First(); c; c = c->Next()) {
+            c->PrintStats();
+        }
+    }
+}
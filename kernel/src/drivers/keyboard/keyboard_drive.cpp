@@ -6,10 +6,23 @@
 #include <kernel/input_debug.hpp>
 #include <lib/serial.hpp>
 #include <input/event_queue.hpp>
+#include <process/workqueue.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
 using namespace kos::drivers::keyboard;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
 using namespace kos::console;
 
 namespace {
+// Keep the serial/TTY/journal write out of the IRQ handler
+static void log_work(void* msg) {
+    Logger::Log((const char*)msg);
+}
+
+static void log_deferred(const char* msg) {
+    if (!kos::process::WorkQueueAPI::QueueWork(log_work, (void*)msg)) Logger::Log(msg);
+}
+
 static inline uint32_t kbd_modifiers(bool ctrlLeft, bool ctrlRight) {
     uint32_t mods = 0;
     if (ctrlLeft || ctrlRight) mods |= 0x01u;
@@ -100,7 +113,8 @@ static int8_t map_set2_make(uint8_t key) {
 
 
 KeyboardDriver::KeyboardDriver(InterruptManager* manager, KeyboardEventHandler *handler)
-:InterruptHandler(manager, 0x21),dataport(0x60),commandport(0x64){
+:InterruptHandler(manager, 0x21),dataport(0x60),commandport(0x64),
+ decodeWork(&KeyboardDriver::DecodeWork, this){
     this->handler = handler;
     // PS/2 controller already initialized in InitDrivers
 };
@@ -203,6 +217,38 @@ uint32_t KeyboardDriver::HandleInterrupt(uint32_t esp)
     auto& ps2 = kos::drivers::ps2::PS2Controller::Instance();
     uint8_t key = ps2.ReadData();
 
+    // Only latch the byte here. Decoding and the handlers (the text shell
+    // runs a whole command from OnKeyDown) happen on kworker-hi.
+    if (!kos::process::g_highpri_workqueue) {
+        Decode(key);
+        return esp;
+    }
+    if (rawHead - rawTail < RAW_RING_SIZE) {
+        rawRing[rawHead % RAW_RING_SIZE] = key;
+        rawHead = rawHead + 1;
+    }
+    kos::process::g_highpri_workqueue->QueueItem(&decodeWork);
+    return esp;
+};
+
+void KeyboardDriver::DecodeWork(void* arg)
+{
+    KeyboardDriver* self = (KeyboardDriver*)arg;
+    while (true) {
+        uint32_t flags = IrqSave();
+        if (self->rawTail == self->rawHead) {
+            IrqRestore(flags);
+            break;
+        }
+        uint8_t key = self->rawRing[self->rawTail % RAW_RING_SIZE];
+        self->rawTail = self->rawTail + 1;
+        IrqRestore(flags);
+        self->Decode(key);
+    }
+}
+
+void KeyboardDriver::Decode(uint8_t key)
+{
 #if KOS_INPUT_DEBUG
     const char* hex = "0123456789ABCDEF";
 #endif
@@ -219,7 +265,7 @@ uint32_t KeyboardDriver::HandleInterrupt(uint32_t esp)
         else if (key == 0xAA) kos::lib::serial_write("=SELF_TEST_OK");
         kos::lib::serial_write(" (ignored)\n");
 #endif
-        return esp;  // Ignore and return immediately
+        return;  // Ignore and return immediately
     }
     
     // Mark that we received actual keyboard activity (scancodes/releases, not control bytes)
@@ -243,24 +289,24 @@ uint32_t KeyboardDriver::HandleInterrupt(uint32_t esp)
     KeyboardEventHandler* activeHandler = ::kos::g_keyboard_handler_override ? ::kos::g_keyboard_handler_override : handler;
     
     if(activeHandler == 0)
-        return esp;
+        return;
 
     // Handle set-2 break prefix: F0 <make-code>
     // SET 2 is still used for break codes but primary char decoding is SET 1
     static bool s_set2_break = false;
     if (key == 0xF0) {
         s_set2_break = true;
-        return esp;
+        return;
     }
     if (s_set2_break) {
         s_set2_break = false;
-        return esp;
+        return;
     }
 
     // Handle extended scancode prefix 0xE0 (for extended keys like right Ctrl, keypad '/').
     if (key == 0xE0) {
         e0Prefix = true;
-        return esp;
+        return;
     }
 
     // Handle key release (break) codes to maintain modifier state
@@ -277,7 +323,7 @@ uint32_t KeyboardDriver::HandleInterrupt(uint32_t esp)
                 ctrlLeft = false;
             }
         }
-        return esp;
+        return;
     }
 
     // Make (key press) codes are < 0x80
@@ -295,7 +341,7 @@ uint32_t KeyboardDriver::HandleInterrupt(uint32_t esp)
                     enqueue_key_event(kos::input::EventType::KeyPress, (uint8_t)'\n', kbd_modifiers(ctrlLeft, ctrlRight));
                     {
                         static bool s_first_irq_logged = false;
-                        if (!s_first_irq_logged) { Logger::LogKV("KBD", "first-irq"); s_first_irq_logged = true; }
+                        if (!s_first_irq_logged) { log_deferred("KBD: first-irq"); s_first_irq_logged = true; }
                     }
                     break;
                 case 0x49: // Page Up (E0 49)
@@ -303,7 +349,7 @@ uint32_t KeyboardDriver::HandleInterrupt(uint32_t esp)
                     enqueue_key_event(kos::input::EventType::KeyPress, 0xF1u, kbd_modifiers(ctrlLeft, ctrlRight));
                     {
                         static bool s_first_irq_logged = false;
-                        if (!s_first_irq_logged) { Logger::LogKV("KBD", "first-irq"); s_first_irq_logged = true; }
+                        if (!s_first_irq_logged) { log_deferred("KBD: first-irq"); s_first_irq_logged = true; }
                     }
                     break;
                 case 0x51: // Page Down (E0 51)
@@ -311,7 +357,7 @@ uint32_t KeyboardDriver::HandleInterrupt(uint32_t esp)
                     enqueue_key_event(kos::input::EventType::KeyPress, 0xF2u, kbd_modifiers(ctrlLeft, ctrlRight));
                     {
                         static bool s_first_irq_logged = false;
-                        if (!s_first_irq_logged) { Logger::LogKV("KBD", "first-irq"); s_first_irq_logged = true; }
+                        if (!s_first_irq_logged) { log_deferred("KBD: first-irq"); s_first_irq_logged = true; }
                     }
                     break;
                 case 0x35:
@@ -327,7 +373,7 @@ uint32_t KeyboardDriver::HandleInterrupt(uint32_t esp)
                     // tty.Write("E0 "); tty.WriteHex(key);
                     break;
             }
-            return esp;
+            return;
         }
 
         int8_t ch = 0;
@@ -455,12 +501,11 @@ uint32_t KeyboardDriver::HandleInterrupt(uint32_t esp)
             // mark source as IRQ
             ::kos::g_kbd_input_source = 1;
             static bool s_first_irq_logged = false;
-            if (!s_first_irq_logged) { Logger::LogKV("KBD", "first-irq"); s_first_irq_logged = true; }
+            if (!s_first_irq_logged) { log_deferred("KBD: first-irq"); s_first_irq_logged = true; }
         }
     }
 
-    return esp;
-};
+}
 
 // Fallback: poll controller status and process one scancode identically to interrupt path.
 bool KeyboardDriver::PollOnce() {
@@ -12,13 +12,28 @@
 #include <graphics/framebuffer.hpp>
 #include <ui/input.hpp>
 #include <input/event_queue.hpp>
+#include <process/workqueue.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
 
 using namespace kos::common;
 using namespace kos::console;
 using namespace kos::drivers;
 using namespace kos::drivers::mouse;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
 
 namespace {
+// Logger writes to serial, the TTY and the journal, which is too slow for
+// IRQ context. Hand constant messages to kworker; log inline only when the
+// queue cannot take them.
+static void log_work(void* msg) {
+    Logger::Log((const char*)msg);
+}
+
+static void log_deferred(const char* msg) {
+    if (!kos::process::WorkQueueAPI::QueueWork(log_work, (void*)msg)) Logger::Log(msg);
+}
+
 static inline void enqueue_mouse_event(kos::input::EventType type) {
     int mx = 0, my = 0;
     uint8_t buttons = 0;
@@ -356,8 +371,8 @@ static void UpdateOrientationCalibration(int baseDx, int baseDy) {
 
         uint32_t best = PickBestOrientationByTotals();
         s_orient_mode = (MouseOrientMode)(best + 1);
-        Logger::Log((const int8_t*)"MOUSE: orientation calibrated");
-        Logger::Log((const int8_t*)OrientModeName(s_orient_mode));
+        log_deferred("MOUSE: orientation calibrated");
+        log_deferred(OrientModeName(s_orient_mode));
         s_orient_pending_idx = 0;
         s_orient_pending_windows = 0;
         ResetOrientationWindowStats();
@@ -411,8 +426,8 @@ static void UpdateOrientationCalibration(int baseDx, int baseDy) {
             s_orient_mode = (MouseOrientMode)(candidate + 1);
             s_orient_pending_idx = 0;
             s_orient_pending_windows = 0;
-            Logger::Log((const int8_t*)"MOUSE: orientation recalibrated");
-            Logger::Log((const int8_t*)OrientModeName(s_orient_mode));
+            log_deferred("MOUSE: orientation recalibrated");
+            log_deferred(OrientModeName(s_orient_mode));
         }
     } else {
         s_orient_pending_idx = 0;
@@ -493,8 +508,8 @@ static void UpdateDecodeCalibration(uint8_t b0, uint8_t b1, uint8_t b2) {
             best = 1;
         }
         s_decode_mode = DecodeIndexToMode(best);
-        Logger::Log((const int8_t*)"MOUSE: decode calibrated");
-        Logger::Log((const int8_t*)DecodeModeName(s_decode_mode));
+        log_deferred("MOUSE: decode calibrated");
+        log_deferred(DecodeModeName(s_decode_mode));
         s_decode_pending_idx = 0;
         s_decode_pending_windows = 0;
         ResetDecodeWindowStats();
@@ -532,8 +547,8 @@ static void UpdateDecodeCalibration(uint8_t b0, uint8_t b1, uint8_t b2) {
             s_decode_mode = DecodeIndexToMode(other);
             s_decode_pending_idx = 0;
             s_decode_pending_windows = 0;
-            Logger::Log((const int8_t*)"MOUSE: decode recalibrated");
-            Logger::Log((const int8_t*)DecodeModeName(s_decode_mode));
+            log_deferred("MOUSE: decode recalibrated");
+            log_deferred(DecodeModeName(s_decode_mode));
         }
     } else {
         s_decode_pending_idx = 0;
@@ -553,7 +568,8 @@ static void DecodeDeltasSelected(uint8_t b0, uint8_t b1, uint8_t b2, int& dx, in
 MouseDriver::MouseDriver(InterruptManager* manager, MouseEventHandler* handler)
 : InterruptHandler(manager, MOUSE_IRQ_VECTOR),
 dataport(MOUSE_DATA_PORT),
-commandport(MOUSE_COMMAND_PORT)
+commandport(MOUSE_COMMAND_PORT),
+decodeWork(&MouseDriver::DecodeWork, this)
 {
     this->handler = handler;
     // PS/2 controller already initialized in InitDrivers
@@ -660,10 +676,42 @@ uint32_t MouseDriver::HandleInterrupt(uint32_t esp)
 
     uint8_t b = ps2.ReadData();
 
+    // Only latch the byte here; packet assembly and the handler callbacks
+    // happen on kworker-hi.
+    if (!kos::process::g_highpri_workqueue) {
+        Decode(b);
+        return esp;
+    }
+    if (rawHead - rawTail < RAW_RING_SIZE) {
+        rawRing[rawHead % RAW_RING_SIZE] = b;
+        rawHead = rawHead + 1;
+    }
+    kos::process::g_highpri_workqueue->QueueItem(&decodeWork);
+    return esp;
+}
+
+void MouseDriver::DecodeWork(void* arg)
+{
+    MouseDriver* self = (MouseDriver*)arg;
+    while (true) {
+        uint32_t flags = IrqSave();
+        if (self->rawTail == self->rawHead) {
+            IrqRestore(flags);
+            break;
+        }
+        uint8_t b = self->rawRing[self->rawTail % RAW_RING_SIZE];
+        self->rawTail = self->rawTail + 1;
+        IrqRestore(flags);
+        self->Decode(b);
+    }
+}
+
+void MouseDriver::Decode(uint8_t b)
+{
     // ACK/RESEND/SELF_TEST are control bytes, not packet payload.
     if (b == 0xFA || b == 0xFE || b == 0xAA) {
         offset = 0;
-        return esp;
+        return;
     }
 
     // Log first few non-control IRQ12 bytes to serial.
@@ -681,7 +729,7 @@ uint32_t MouseDriver::HandleInterrupt(uint32_t esp)
 
     // If we are waiting for the first byte of a packet, require sync bit set.
     if (offset == 0 && (b & MOUSE_SYNC_BIT) == 0) {
-        return esp;
+        return;
     }
 
     buffer[offset] = b;
@@ -696,21 +744,21 @@ uint32_t MouseDriver::HandleInterrupt(uint32_t esp)
     }
 
     if (handler == 0)
-        return esp;
+        return;
 
     offset = (offset + 1) % 3;
     if (offset != 0)
-        return esp;
+        return;
 
     // Ensure packet is aligned: bit3 in first byte must be 1.
     if ((buffer[0] & MOUSE_SYNC_BIT) == 0) {
         offset = 0;
-        return esp;
+        return;
     }
 
     // Discard packets with X/Y overflow (bits 6 and 7)
     if (buffer[0] & 0xC0) {
-        return esp;
+        return;
     }
 
     UpdateDecodeCalibration(buffer[0], buffer[1], buffer[2]);
@@ -747,12 +795,11 @@ uint32_t MouseDriver::HandleInterrupt(uint32_t esp)
 
     static uint32_t pkt = 0; ++pkt;
     if (pkt == 1) {
-        Logger::LogKV("MOUSE", "first-packet");
+        log_deferred("MOUSE: first-packet");
     } else if ((pkt & 63u) == 0 && Logger::IsDebugEnabled()) {
-        Logger::Log("[MOUSE] pkt");
+        log_deferred("[MOUSE] pkt");
     }
 
-    return esp;
 }
 
 // Fallback polling logic when IRQ12 is not firing.
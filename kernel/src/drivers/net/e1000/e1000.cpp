@@ -266,9 +266,7 @@ bool E1000Driver::tx_send(const uint8_t* data, uint32_t len) {
     }
     
     // Copy data to TX buffer
-    for (uint32_t i = 0; i < len; ++i) {
-        tx_buffers_[tail][i] = data[i];
-    }
+    kos::lib::String::memmove(tx_buffers_[tail], data, len);
     
     // Setup descriptor
     desc->length = (uint16_t)len;
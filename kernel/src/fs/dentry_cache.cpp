@@ -0,0 +1,267 @@
+#include <fs/dentry_cache.hpp>
+#include <memory/heap.hpp>
+#include <lib/string.hpp>
+#include <console/logger.hpp>
+#include <console/tty.hpp>
+
+using namespace kos::fs;
+using namespace kos::memory;
+using namespace kos::lib;
+using namespace kos::console;
+
+DentryCache* DentryCache::s_first = nullptr;
+
+namespace {
+    // Upper-case copy. Names longer than any 8.3 name are not cached: a
+    // truncated key could alias a real entry.
+    bool Normalize(const int8_t* in, int8_t out[DENTRY_NAME_MAX]) {
+        if (!in || !in[0]) return false;
+        uint32_t i = 0;
+        for (; in[i]; ++i) {
+            if (i == DENTRY_NAME_MAX - 1) return false;
+            int8_t c = in[i];
+            out[i] = (c >= 'a' && c <= 'z') ? (int8_t)(c - ('a' - 'A')) : c;
+        }
+        out[i] = 0;
+        return true;
+    }
+
+    // FNV-1a over the name, mixed with the parent cluster
+    uint32_t HashKey(uint32_t parent, const int8_t* name) {
+        uint32_t h = 2166136261u;
+        while (*name) {
+            h ^= (uint8_t)*name++;
+            h *= 16777619u;
+        }
+        return h ^ (parent * 2654435761u);
+    }
+
+    bool NamesEqual(const int8_t* a, const int8_t* b) {
+        while (*a && *a == *b) {
+            ++a;
+            ++b;
+        }
+        return *a == *b;
+    }
+
+    void WriteDec(uint32_t v) {
+        int8_t digits[10];
+        int n = 0;
+        do {
+            digits[n++] = (int8_t)('0' + v % 10);
+            v /= 10;
+        } while (v);
+        while (n) TTY::PutChar(digits[--n]);
+    }
+}
+
+DentryCache::DentryCache(const char* cache_label, uint32_t max_entries)
+    : label(cache_label), capacity(max_entries ? max_entries : 1),
+      entries(nullptr), buckets(nullptr), bucket_mask(0),
+      lru_head(nullptr), lru_tail(nullptr), setup_failed(false), next_cache(nullptr) {
+    String::memset(&stats, 0, sizeof(stats));
+}
+
+DentryCache::~DentryCache() {
+    if (!entries) return;
+    for (DentryCache** link = &s_first; *link; link = &(*link)->next_cache) {
+        if (*link != this) continue;
+        *link = next_cache;
+        break;
+    }
+    Heap::Free(buckets);
+    Heap::Free(entries);
+}
+
+bool DentryCache::EnsureStorage() {
+    if (entries) return true;
+    if (setup_failed) return false;
+
+    uint32_t bucket_count = 1;
+    while (bucket_count < capacity) bucket_count <<= 1;
+    entries = (Dentry*)Heap::Alloc(sizeof(Dentry) * capacity);
+    buckets = (Dentry**)Heap::Alloc(sizeof(Dentry*) * bucket_count);
+    if (!entries || !buckets) {
+        if (entries) Heap::Free(entries);
+        if (buckets) Heap::Free(buckets);
+        entries = nullptr;
+        buckets = nullptr;
+        setup_failed = true;
+        Logger::LogKV("Dentry cache disabled (out of memory) for", label);
+        return false;
+    }
+    String::memset(entries, 0, sizeof(Dentry) * capacity);
+    String::memset(buckets, 0, sizeof(Dentry*) * bucket_count);
+    bucket_mask = bucket_count - 1;
+
+    // Unused entries (empty name) sit on the LRU list and are taken first
+    for (uint32_t i = 0; i < capacity; ++i) {
+        entries[i].lru_prev = (i > 0) ? &entries[i - 1] : nullptr;
+        entries[i].lru_next = (i + 1 < capacity) ? &entries[i + 1] : nullptr;
+    }
+    lru_head = &entries[0];
+    lru_tail = &entries[capacity - 1];
+
+    next_cache = s_first;
+    s_first = this;
+    return true;
+}
+
+Dentry* DentryCache::Find(uint32_t parent, const int8_t* name, uint32_t hash) const {
+    for (Dentry* d = buckets[hash & bucket_mask]; d; d = d->hash_next) {
+        if (d->hash == hash && d->parent == parent && NamesEqual(d->name, name)) return d;
+    }
+    return nullptr;
+}
+
+void DentryCache::Unhash(Dentry* d) {
+    Dentry** link = &buckets[d->hash & bucket_mask];
+    while (*link && *link != d) link = &(*link)->hash_next;
+    if (*link) *link = d->hash_next;
+    d->hash_next = nullptr;
+    d->name[0] = 0;
+    stats.entries--;
+}
+
+void DentryCache::Touch(Dentry* d) {
+    if (d == lru_head) return;
+    d->lru_prev->lru_next = d->lru_next;
+    if (d->lru_next) d->lru_next->lru_prev = d->lru_prev;
+    else lru_tail = d->lru_prev;
+    d->lru_prev = nullptr;
+    d->lru_next = lru_head;
+    lru_head->lru_prev = d;
+    lru_head = d;
+}
+
+Dentry* DentryCache::Store(uint32_t parent, const int8_t* name) {
+    if (!EnsureStorage()) return nullptr;
+    int8_t key[DENTRY_NAME_MAX];
+    if (!Normalize(name, key)) return nullptr;
+    uint32_t hash = HashKey(parent, key);
+
+    Dentry* d = Find(parent, key, hash);
+    if (!d) {
+        d = lru_tail;
+        if (d->name[0]) {
+            Unhash(d);
+            stats.evictions++;
+        }
+        d->parent = parent;
+        d->hash = hash;
+        String::memmove(d->name, key, DENTRY_NAME_MAX);
+        Dentry** bucket = &buckets[hash & bucket_mask];
+        d->hash_next = *bucket;
+        *bucket = d;
+        stats.entries++;
+    }
+    Touch(d);
+    return d;
+}
+
+DentryCache::Result DentryCache::Lookup(uint32_t parent, const int8_t* name,
+                                        uint32_t& outStartCluster, uint32_t& outSize, uint8_t& outAttr) {
+    int8_t key[DENTRY_NAME_MAX];
+    if (!entries || !Normalize(name, key)) {
+        stats.misses++;
+        return MISS;
+    }
+    Dentry* d = Find(parent, key, HashKey(parent, key));
+    if (!d) {
+        stats.misses++;
+        return MISS;
+    }
+    Touch(d);
+    if (d->negative) {
+        stats.negative_hits++;
+        return NEGATIVE;
+    }
+    stats.hits++;
+    outStartCluster = d->start_cluster;
+    outSize = d->size;
+    outAttr = d->attr;
+    return HIT;
+}
+
+void DentryCache::Insert(uint32_t parent, const int8_t* name,
+                         uint32_t startCluster, uint32_t size, uint8_t attr) {
+    Dentry* d = Store(parent, name);
+    if (!d) return;
+    d->negative = false;
+    d->start_cluster = startCluster;
+    d->size = size;
+    d->attr = attr;
+}
+
+void DentryCache::InsertNegative(uint32_t parent, const int8_t* name) {
+    Dentry* d = Store(parent, name);
+    if (!d) return;
+    d->negative = true;
+    d->start_cluster = 0;
+    d->size = 0;
+    d->attr = 0;
+}
+
+void DentryCache::Invalidate(uint32_t parent, const int8_t* name) {
+    int8_t key[DENTRY_NAME_MAX];
+    if (!entries || !Normalize(name, key)) return;
+    Dentry* d = Find(parent, key, HashKey(parent, key));
+    if (d) Unhash(d);
+}
+
+void DentryCache::Invalidate(uint32_t parent, const uint8_t shortName11[11]) {
+    // Directory entry form "NAME    EXT" -> "NAME.EXT"
+    int8_t name[DENTRY_NAME_MAX];
+    uint32_t n = 0;
+    for (int i = 0; i < 8 && shortName11[i] != ' '; ++i) name[n++] = (int8_t)shortName11[i];
+    if (shortName11[8] != ' ') {
+        name[n++] = '.';
+        for (int i = 8; i < 11 && shortName11[i] != ' '; ++i) name[n++] = (int8_t)shortName11[i];
+    }
+    name[n] = 0;
+    Invalidate(parent, name);
+}
+
+void DentryCache::Clear() {
+    if (!entries) return;
+    for (uint32_t i = 0; i < capacity; ++i) {
+        if (entries[i].name[0]) Unhash(&entries[i]);
+    }
+}
+
+DentryStats DentryCache::GetStats() const {
+    return stats;
+}
+
+void DentryCache::PrintStats() const {
+    uint32_t lookups = stats.hits + stats.negative_hits + stats.misses;
+    TTY::Write(label);
+    TTY::Write(": entries=");
+    WriteDec(stats.entries);
+    TTY::Write("/");
+    WriteDec(capacity);
+    TTY::Write(" hits=");
+    WriteDec(stats.hits);
+    TTY::Write(" negative=");
+    WriteDec(stats.negative_hits);
+    TTY::Write(" misses=");
+    WriteDec(stats.misses);
+    TTY::Write(" (");
+    WriteDec(lookups ? (uint32_t)((uint64_t)(stats.hits + stats.negative_hits) * 100 / lookups) : 0);
+    TTY::Write("% hit) evictions=");
+    WriteDec(stats.evictions);
+    TTY::Write("\n");
+}
+
+namespace kos::fs::DentryCacheAPI {
+    void PrintAll() {
+        TTY::Write("=== Dentry Cache ===\n");
+        if (!DentryCache::First()) {
+            TTY::Write("No caches in use\n");
+            return;
+        }
+        for (DentryCache* c = DentryCache::First(); c; c = c->Next()) {
+            c->PrintStats();
+        }
+    }
+}
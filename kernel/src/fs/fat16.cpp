@@ -28,6 +28,10 @@ int32_t FAT16::WriteFile(const int8_t* path, const uint8_t* data, uint32_t len)
     }
     if (finalName[0] == 0) return -1;
     uint8_t short11[11]; bool ok83=false; PackShortName11(finalName, short11, ok83, true); if (!ok83) return -1;
+    // The entry is created or its size changes below
+    uint32_t parentKey = atRoot ? DENTRY_ROOT_NO_CLUSTER : dirCl;
+    dentries.Invalidate(parentKey, finalName);
+    dentries.Invalidate(parentKey, short11);
     uint32_t entryCl=0, entryOff=0, startCl=0, fileSize=0; uint8_t attr=0;
     bool exists = FindShortEntryWithOffset(dirCl, short11, atRoot, entryCl, entryOff, startCl, fileSize, attr);
     uint32_t bytesPerCluster = bpb.bytesPerSector * bpb.sectorsPerCluster;
@@ -145,7 +149,7 @@ static TTY tty;
 namespace kos { namespace sys { uint32_t CurrentListFlags(); } }
 
 FAT16::FAT16(BlockDevice* dev, uint32_t startLBA)
-    : dev(dev), volumeStartLBA(startLBA), mounted(false) {
+    : dev(dev), volumeStartLBA(startLBA), mounted(false), dentries("FAT16") {
     bpb = {};
 }
 
@@ -159,6 +163,7 @@ bool FAT16::WriteSector(uint32_t lba, const uint8_t* buf) {
 
 bool FAT16::Mount() {
     uint8_t sector[512];
+    dentries.Clear();
     // If startLBA not provided, attempt to detect a FAT16 partition in MBR
     if (volumeStartLBA == 0) {
         uint8_t mbr[512];
@@ -595,6 +600,9 @@ int32_t FAT16::Mkdir(const int8_t* path, int32_t parents) {
         if (!parents && !final) { tty.Write((const int8_t*)"FAT16: parent missing and -p not set\n"); return -1; }
         uint8_t short11[11]; bool ok83=false; PackShortName11(comp, short11, ok83, true);
         if (!ok83) { tty.Write((const int8_t*)"FAT16: invalid 8.3 name\n"); return -1; }
+        // Drop the negative entry the lookup above just cached
+        dentries.Invalidate(atRoot ? DENTRY_ROOT_NO_CLUSTER : curCl, comp);
+        dentries.Invalidate(atRoot ? DENTRY_ROOT_NO_CLUSTER : curCl, short11);
         uint32_t newCl = AllocateCluster(); if (newCl < 2) { tty.Write((const int8_t*)"FAT16: no free clusters\n"); return -1; }
         if (!InitDirCluster(newCl, atRoot ? 0 : curCl)) { tty.Write((const int8_t*)"FAT16: init dir failed\n"); return -1; }
         bool ok = false;
@@ -651,12 +659,22 @@ int32_t FAT16::Mkdir(const int8_t* path, int32_t parents) {
 }
 
 bool FAT16::FindShortNameInRoot(const int8_t* shortName83, uint32_t& outStartCluster, uint32_t& outFileSize, bool& isDir) {
+    uint8_t cachedAttr = 0;
+    DentryCache::Result cached = dentries.Lookup(DENTRY_ROOT_NO_CLUSTER, shortName83, outStartCluster, outFileSize, cachedAttr);
+    if (cached == DentryCache::HIT) {
+        isDir = (cachedAttr & 0x10) != 0;
+        return true;
+    }
+    if (cached == DentryCache::NEGATIVE) return false;
     uint8_t sec[512];
     for (uint32_t s = 0; s < rootDirSectors; ++s) {
         if (!ReadSector(rootDirLBA + s, sec)) return false;
         for (int i = 0; i < 512; i += 32) {
             uint8_t first = sec[i];
-            if (first == 0x00) return false;
+            if (first == 0x00) {
+                dentries.InsertNegative(DENTRY_ROOT_NO_CLUSTER, shortName83);
+                return false;
+            }
             if (first == 0xE5) continue;
             uint8_t attr = sec[i + 11];
             if (attr == 0x0F) continue;
@@ -676,14 +694,23 @@ bool FAT16::FindShortNameInRoot(const int8_t* shortName83, uint32_t& outStartClu
                 outStartCluster = cl;
                 outFileSize = (uint32_t)sec[i+28] | ((uint32_t)sec[i+29]<<8) | ((uint32_t)sec[i+30]<<16) | ((uint32_t)sec[i+31]<<24);
                 isDir = (attr & 0x10) != 0;
+                dentries.Insert(DENTRY_ROOT_NO_CLUSTER, shortName83, outStartCluster, outFileSize, attr);
                 return true;
             }
         }
     }
+    dentries.InsertNegative(DENTRY_ROOT_NO_CLUSTER, shortName83);
     return false;
 }
 
 bool FAT16::FindShortNameInDirCluster(uint32_t dirCluster, const int8_t* shortName83, uint32_t& outStartCluster, uint32_t& outFileSize, bool& isDir) {
+    uint8_t cachedAttr = 0;
+    DentryCache::Result cached = dentries.Lookup(dirCluster, shortName83, outStartCluster, outFileSize, cachedAttr);
+    if (cached == DentryCache::HIT) {
+        isDir = (cachedAttr & 0x10) != 0;
+        return true;
+    }
+    if (cached == DentryCache::NEGATIVE) return false;
     uint8_t* buf = (uint8_t*)0x24000;
     uint32_t cl = dirCluster;
     while (cl >= 2 && cl < 0xFFF8) {
@@ -707,6 +734,7 @@ bool FAT16::FindShortNameInDirCluster(uint32_t dirCluster, const int8_t* shortNa
             outStartCluster = cl;
             outFileSize = (uint32_t)buf[i+28] | ((uint32_t)buf[i+29]<<8) | ((uint32_t)buf[i+30]<<16) | ((uint32_t)buf[i+31]<<24);
             isDir = (attr & 0x10) != 0;
+            dentries.Insert(dirCluster, shortName83, outStartCluster, outFileSize, attr);
             return true;
         }
         }
@@ -714,6 +742,7 @@ bool FAT16::FindShortNameInDirCluster(uint32_t dirCluster, const int8_t* shortNa
         if (next >= 0xFFF8 || next == 0) break;
         cl = next;
     }
+    dentries.InsertNegative(dirCluster, shortName83);
     return false;
 }
 
@@ -3,12 +3,19 @@
 #include <console/logger.hpp>
 #include <lib/string.hpp>
 #include <lib/stdio.hpp>
+#include <memory/heap.hpp>
+#include <process/workqueue.hpp>
+#include <services/service_manager.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
 
 using namespace kos::fs;
 using namespace kos::drivers;
 using namespace kos::common;
 using namespace kos::console;
 using namespace kos::lib;
+using namespace kos::memory;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
 
 static TTY tty;
 namespace kos { namespace sys { uint32_t CurrentListFlags(); } }
@@ -28,12 +35,77 @@ static void printHex32(uint32_t v) {
     tty.WriteHex((uint8_t)(v & 0xFF));
 }
 
+namespace {
+    // FAT cache pages: 8 sectors = 1024 entries
+    const uint32_t FAT_PAGE_SECTORS = 8;
+    const uint32_t FAT_PAGE_ENTRIES = FAT_PAGE_SECTORS * 128;
+    const uint32_t FAT_ENTRY_MASK = 0x0FFFFFFF;
+    // FATs up to this size stay resident after the mount scan; larger ones
+    // keep only the pages touched later
+    const uint32_t FAT_RESIDENT_MAX_BYTES = 512 * 1024;
+    // FAT[1] bit set by a clean unmount; when clear FSInfo may be stale
+    const uint32_t FAT_CLEAN_SHUTDOWN = 0x08000000;
+
+    // Longest single device read (BlockDevice takes a uint8_t count)
+    const uint32_t FAT_MAX_IO_SECTORS = 255;
+    // Sequential readers start with this readahead window and double it
+    // on every window they consume
+    const uint32_t READAHEAD_MIN_BYTES = 16 * 1024;
+    const uint32_t READAHEAD_MAX_BYTES = 64 * 1024;
+
+    // FSInfo sector layout
+    const uint32_t FSINFO_LEAD_SIG = 0x41615252;
+    const uint32_t FSINFO_STRUCT_SIG = 0x61417272;
+    const uint32_t FSINFO_TRAIL_SIG = 0xAA550000;
+    const uint32_t FSINFO_UNKNOWN = 0xFFFFFFFF;
+
+    inline uint32_t Le32(const uint8_t* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    inline void PutLe32(uint8_t* p, uint32_t v) {
+        p[0] = (uint8_t)(v & 0xFF);
+        p[1] = (uint8_t)((v >> 8) & 0xFF);
+        p[2] = (uint8_t)((v >> 16) & 0xFF);
+        p[3] = (uint8_t)((v >> 24) & 0xFF);
+    }
+
+    // Batches an operation's FAT updates into one write per dirty run
+    struct FATSyncGuard {
+        FAT32* fs;
+        explicit FATSyncGuard(FAT32* f) : fs(f) {}
+        ~FATSyncGuard() { fs->SyncFAT(); }
+    };
+
+    inline uint32_t NowMs() {
+        return kos::services::ServiceManager::UptimeMs();
+    }
+}
+
+FAT32::OpGuard::OpGuard(FAT32* f, Mode mode) : fs(f) {
+    fs->opDepth++;
+    // Nested calls run inside an operation that already flushed
+    if (mode != KEEP && fs->opDepth == 1) fs->FlushAppends(mode == FORGET);
+}
+
+FAT32::OpGuard::~OpGuard() {
+    fs->opDepth--;
+}
+
 kos::fs::FAT32::FAT32(BlockDevice* dev)
-    : dev(dev), volumeStartLBA(0), fatStartLBA(0), dataStartLBA(0), mountedFlag(false) {
+    : dev(dev), volumeStartLBA(0), fatStartLBA(0), dataStartLBA(0), mountedFlag(false),
+      fatPages(nullptr), fatPageCount(0), fatEntryCount(0), fatDirty(nullptr),
+      freeMap(nullptr), freeClusters(0), nextFreeHint(2), freeMapBuilt(false), fsInfoDirty(false),
+      volumeDirty(false), dentries("FAT32"), opDepth(0), appendFlushArmed(false) {
     bpb = {};
+    String::memset(streams, 0, sizeof(streams));
 }
 
-kos::fs::FAT32::~FAT32() {}
+kos::fs::FAT32::~FAT32() {
+    Sync();
+    for (uint32_t i = 0; i < FAT32_APPEND_STREAMS; ++i) ForgetStream(&streams[i]);
+    FreeFATCache();
+}
 
 bool FAT32::ReadSector(uint32_t lba, uint8_t* buf) {
     return dev->ReadSectors(lba, 1, buf);
@@ -128,6 +200,9 @@ uint32_t FAT32::DetectFAT32PartitionStart() {
 
 bool FAT32::Mount() {
     uint8_t sector[512];
+    dentries.Clear();
+    // Buffered appends belong to whatever volume was mounted before
+    for (uint32_t i = 0; i < FAT32_APPEND_STREAMS; ++i) ForgetStream(&streams[i]);
     // Detect partition; if none, assume superfloppy (volume at LBA 0)
     volumeStartLBA = DetectFAT32PartitionStart();
     if (volumeStartLBA == 0xFFFFFFFF) {
@@ -192,6 +267,7 @@ bool FAT32::Mount() {
     bpb.rootCluster      = (uint32_t)sector[44] | ((uint32_t)sector[45] << 8) | ((uint32_t)sector[46] << 16) | ((uint32_t)sector[47] << 24);
     // Total sectors (FAT32: 32-bit at offset 32)
     bpb.totalSectors     = (uint32_t)sector[32] | ((uint32_t)sector[33] << 8) | ((uint32_t)sector[34] << 16) | ((uint32_t)sector[35] << 24);
+    bpb.fsInfoSector     = sector[48] | (sector[49] << 8);
 
     fatStartLBA = volumeStartLBA + bpb.reservedSectors;
     dataStartLBA = fatStartLBA + bpb.numFATs * bpb.sectorsPerFAT;
@@ -239,10 +315,264 @@ bool FAT32::Mount() {
         tty.PutChar('\n');
         return false;
     }
+    if (!LoadFATCache()) {
+        tty.Write("FAT32: FAT cache unavailable, using direct FAT access\n");
+    }
     mountedFlag = true;
     return true;
 }
 
+void FAT32::FreeFATCache() {
+    if (fatPages) {
+        for (uint32_t p = 0; p < fatPageCount; ++p) {
+            if (fatPages[p]) Heap::Free(fatPages[p]);
+        }
+        Heap::Free(fatPages);
+    }
+    if (fatDirty) Heap::Free(fatDirty);
+    if (freeMap) Heap::Free(freeMap);
+    fatPages = nullptr;
+    fatDirty = nullptr;
+    freeMap = nullptr;
+    fatPageCount = 0;
+    fatEntryCount = 0;
+    freeClusters = 0;
+    nextFreeHint = 2;
+    freeMapBuilt = false;
+    fsInfoDirty = false;
+    volumeDirty = false;
+}
+
+bool FAT32::LoadFATCache() {
+    FreeFATCache();
+    // Only entries backed by data clusters count; the FAT is usually longer
+    uint32_t fatEntries = bpb.sectorsPerFAT * 128;
+    uint32_t metaSectors = dataStartLBA - volumeStartLBA;
+    uint32_t clusters = (bpb.totalSectors > metaSectors) ? (bpb.totalSectors - metaSectors) / bpb.sectorsPerCluster : 0;
+    uint32_t entryCount = clusters ? clusters + 2 : fatEntries;
+    if (entryCount > fatEntries) entryCount = fatEntries;
+    if (entryCount < 3) return false;
+
+    uint32_t pageCount = (bpb.sectorsPerFAT + FAT_PAGE_SECTORS - 1) / FAT_PAGE_SECTORS;
+    uint32_t mapBytes = ((entryCount + 31) / 32) * 4;
+    uint32_t dirtyBytes = ((bpb.sectorsPerFAT + 31) / 32) * 4;
+    fatPages = (uint32_t**)Heap::Alloc(pageCount * sizeof(uint32_t*));
+    freeMap = (uint32_t*)Heap::Alloc(mapBytes);
+    fatDirty = (uint32_t*)Heap::Alloc(dirtyBytes);
+    fatPageCount = pageCount;
+    if (!fatPages || !freeMap || !fatDirty) {
+        FreeFATCache();
+        return false;
+    }
+    String::memset(fatPages, 0, pageCount * sizeof(uint32_t*));
+    String::memset(freeMap, 0, mapBytes);
+    String::memset(fatDirty, 0, dirtyBytes);
+    fatEntryCount = entryCount;
+
+    // A valid FSInfo on a cleanly unmounted volume saves the FAT scan
+    uint32_t reportedFree = 0, reportedNext = 0;
+    uint32_t* first = FATPage(0);
+    bool clean = first && (first[1] & FAT_CLEAN_SHUTDOWN);
+    volumeDirty = !clean;
+    if (clean && ReadFSInfo(reportedFree, reportedNext)) {
+        freeClusters = reportedFree;
+        nextFreeHint = reportedNext;
+        return true;
+    }
+    if (!BuildFreeMap()) {
+        FreeFATCache();
+        return false;
+    }
+    // Missing or untrusted FSInfo: store the recount on the next Sync
+    fsInfoDirty = true;
+    return true;
+}
+
+bool FAT32::BuildFreeMap() {
+    // One pass over the FAT; pages of a large FAT are dropped again unless dirty
+    bool resident = bpb.sectorsPerFAT * 512 <= FAT_RESIDENT_MAX_BYTES;
+    uint32_t lastPage = (fatEntryCount - 1) / FAT_PAGE_ENTRIES;
+    uint32_t counted = 0;
+    String::memset(freeMap, 0, ((fatEntryCount + 31) / 32) * 4);
+    for (uint32_t p = 0; p <= lastPage; ++p) {
+        bool wasLoaded = fatPages[p] != nullptr;
+        uint32_t* page = FATPage(p);
+        if (!page) return false;
+        uint32_t first = p * FAT_PAGE_ENTRIES;
+        uint32_t end = first + FAT_PAGE_ENTRIES;
+        if (end > fatEntryCount) end = fatEntryCount;
+        for (uint32_t cl = (first < 2 ? 2 : first); cl < end; ++cl) {
+            if ((page[cl - first] & FAT_ENTRY_MASK) != 0) continue;
+            freeMap[cl >> 5] |= 1u << (cl & 31);
+            counted++;
+        }
+        uint32_t pageSector = p * FAT_PAGE_SECTORS;
+        bool dirty = ((fatDirty[pageSector >> 5] >> (pageSector & 31)) & 0xFF) != 0;
+        if (!resident && !wasLoaded && !dirty) {
+            Heap::Free(page);
+            fatPages[p] = nullptr;
+        }
+    }
+    freeClusters = counted;
+    freeMapBuilt = true;
+    return true;
+}
+
+bool FAT32::ReadFSInfo(uint32_t& outFree, uint32_t& outNextFree) {
+    if (bpb.fsInfoSector == 0 || bpb.fsInfoSector >= bpb.reservedSectors) return false;
+    uint8_t sec[512];
+    if (!ReadSector(volumeStartLBA + bpb.fsInfoSector, sec)) return false;
+    if (Le32(sec) != FSINFO_LEAD_SIG || Le32(sec + 484) != FSINFO_STRUCT_SIG ||
+        Le32(sec + 508) != FSINFO_TRAIL_SIG) {
+        return false;
+    }
+    uint32_t freeCount = Le32(sec + 488);
+    if (freeCount == FSINFO_UNKNOWN || freeCount > fatEntryCount - 2) return false;
+    // The hint is advisory; an unset or out-of-range one just restarts at 2
+    uint32_t nextFree = Le32(sec + 492);
+    outFree = freeCount;
+    outNextFree = (nextFree >= 2 && nextFree < fatEntryCount) ? nextFree : 2;
+    return true;
+}
+
+bool FAT32::WriteFSInfo() {
+    if (bpb.fsInfoSector == 0 || bpb.fsInfoSector >= bpb.reservedSectors) return true;
+    uint8_t sec[512];
+    uint32_t lba = volumeStartLBA + bpb.fsInfoSector;
+    if (!ReadSector(lba, sec)) return false;
+    // Never format a sector that does not already hold FSInfo
+    if (Le32(sec) != FSINFO_LEAD_SIG || Le32(sec + 484) != FSINFO_STRUCT_SIG) return true;
+    PutLe32(sec + 488, freeClusters);
+    PutLe32(sec + 492, nextFreeHint);
+    return WriteSector(lba, sec);
+}
+
+uint32_t* FAT32::FATPage(uint32_t page) {
+    if (page >= fatPageCount) return nullptr;
+    if (fatPages[page]) return fatPages[page];
+    uint32_t* buf = (uint32_t*)Heap::Alloc(FAT_PAGE_SECTORS * 512);
+    if (!buf) return nullptr;
+    uint32_t firstSector = page * FAT_PAGE_SECTORS;
+    uint32_t count = bpb.sectorsPerFAT - firstSector;
+    if (count > FAT_PAGE_SECTORS) count = FAT_PAGE_SECTORS;
+    if (count < FAT_PAGE_SECTORS) String::memset(buf, 0, FAT_PAGE_SECTORS * 512);
+    if (!ReadSectors(fatStartLBA + firstSector, count, (uint8_t*)buf)) {
+        Heap::Free(buf);
+        return nullptr;
+    }
+    fatPages[page] = buf;
+    return buf;
+}
+
+bool FAT32::Sync() {
+    OpGuard op(this, OpGuard::KEEP);
+    bool ok = FlushAppends(false);
+    ok = SyncFAT() && ok;
+    // FSInfo now matches the FAT, so the next mount may trust it again. The
+    // uncached path never maintains FSInfo and leaves the bit clear.
+    if (ok && volumeDirty && fatPages) {
+        if (WriteCleanFlag(true)) volumeDirty = false;
+        else ok = false;
+    }
+    return ok;
+}
+
+void FAT32::MarkVolumeDirty() {
+    if (volumeDirty) return;
+    // On disk before the FAT change that makes FSInfo stale: a crash from
+    // here until the next Sync() forces a recount at mount
+    if (WriteCleanFlag(false)) volumeDirty = true;
+}
+
+// The flag orders the writes around it, so it goes past the block cache:
+// cleared before any change reaches the disk, set only after all of them.
+bool FAT32::WriteCleanFlag(bool clean) {
+    if (clean && !dev->Flush()) return false;
+    uint8_t sec[512];
+    const uint8_t* src = sec;
+    if (fatPages) {
+        uint32_t* page = FATPage(0);
+        if (!page) return false;
+        if (clean) page[1] |= FAT_CLEAN_SHUTDOWN;
+        else page[1] &= ~FAT_CLEAN_SHUTDOWN;
+        src = (const uint8_t*)page;
+    } else {
+        if (!ReadSector(fatStartLBA, sec)) return false;
+        uint32_t v = Le32(sec + 4);
+        PutLe32(sec + 4, clean ? (v | FAT_CLEAN_SHUTDOWN) : (v & ~FAT_CLEAN_SHUTDOWN));
+    }
+    bool ok = true;
+    for (uint8_t f = 0; f < bpb.numFATs; ++f) {
+        if (!dev->WriteSectorsThrough(fatStartLBA + f * bpb.sectorsPerFAT, 1, src)) ok = false;
+    }
+    return ok;
+}
+
+bool FAT32::SyncFAT() {
+    if (!fatDirty) return true;
+    bool ok = true;
+    uint32_t s = 0;
+    while (s < bpb.sectorsPerFAT) {
+        if (!fatDirty[s >> 5]) {
+            s = (s | 31) + 1;
+            continue;
+        }
+        if (!(fatDirty[s >> 5] & (1u << (s & 31)))) {
+            ++s;
+            continue;
+        }
+        // Extend over consecutive dirty sectors of the same page; they are
+        // contiguous in memory, so each FAT copy takes one write
+        uint32_t page = s / FAT_PAGE_SECTORS;
+        uint32_t run = 1;
+        while (s + run < bpb.sectorsPerFAT && (s + run) / FAT_PAGE_SECTORS == page &&
+               (fatDirty[(s + run) >> 5] & (1u << ((s + run) & 31)))) {
+            ++run;
+        }
+        const uint8_t* src = (const uint8_t*)fatPages[page] + (s % FAT_PAGE_SECTORS) * 512;
+        bool written = true;
+        for (uint8_t f = 0; f < bpb.numFATs; ++f) {
+            if (!WriteSectors(fatStartLBA + f * bpb.sectorsPerFAT + s, run, src)) written = false;
+        }
+        if (written) {
+            for (uint32_t i = s; i < s + run; ++i) fatDirty[i >> 5] &= ~(1u << (i & 31));
+        } else {
+            ok = false;
+        }
+        s += run;
+    }
+    if (fsInfoDirty && ok) {
+        if (WriteFSInfo()) fsInfoDirty = false;
+        else ok = false;
+    }
+    return ok;
+}
+
+bool FAT32::GetStats(FsStats& out) {
+    if (!mountedFlag || !freeMap) return false;
+    OpGuard op(this, OpGuard::FLUSH);
+    out.clusterBytes = (uint32_t)bpb.bytesPerSector * bpb.sectorsPerCluster;
+    out.totalClusters = fatEntryCount - 2;
+    out.freeClusters = freeClusters;
+    out.usedClusters = out.totalClusters - freeClusters;
+    return true;
+}
+
+uint32_t FAT32::FindFreeCluster() {
+    if (!freeClusters) return 0;
+    uint32_t words = (fatEntryCount + 31) / 32;
+    uint32_t start = (nextFreeHint >= 2 && nextFreeHint < fatEntryCount) ? nextFreeHint : 2;
+    // From the hint to the end, then wrap around to the start
+    uint32_t w = start >> 5;
+    uint32_t bits = freeMap[w] & (~0u << (start & 31));
+    for (uint32_t scanned = 0; scanned <= words; ++scanned) {
+        if (bits) return (w << 5) + (uint32_t)__builtin_ctz(bits);
+        w = (w + 1 < words) ? w + 1 : 0;
+        bits = freeMap[w];
+    }
+    return 0;
+}
+
 uint32_t FAT32::ClusterToLBA(uint32_t cluster) {
     return dataStartLBA + (cluster - 2) * bpb.sectorsPerCluster;
 }
@@ -253,6 +583,12 @@ bool FAT32::ReadCluster(uint32_t cluster, uint8_t* buf) {
 
 // Read next cluster from FAT (FAT32). Very minimal and unoptimized.
 uint32_t FAT32::NextCluster(uint32_t cluster) {
+    if (fatPages) {
+        if (cluster >= fatEntryCount) return 0x0FFFFFFF;
+        // A page that cannot be loaded was never modified; read the disk
+        uint32_t* page = FATPage(cluster / FAT_PAGE_ENTRIES);
+        if (page) return page[cluster % FAT_PAGE_ENTRIES] & FAT_ENTRY_MASK;
+    }
     // FAT entries are 32-bit, but upper 4 bits reserved. Need to read from FAT region.
     // Compute FAT sector and offset
     uint32_t fatOffset = cluster * 4;
@@ -268,6 +604,29 @@ uint32_t FAT32::NextCluster(uint32_t cluster) {
 }
 
 bool FAT32::UpdateFAT(uint32_t cluster, uint32_t value) {
+    MarkVolumeDirty();
+    if (fatPages) {
+        if (cluster >= fatEntryCount) return false;
+        uint32_t* page = FATPage(cluster / FAT_PAGE_ENTRIES);
+        if (!page) return false;
+        uint32_t& entry = page[cluster % FAT_PAGE_ENTRIES];
+        bool wasFree = (entry & FAT_ENTRY_MASK) == 0;
+        bool isFree = (value & FAT_ENTRY_MASK) == 0;
+        entry = (entry & 0xF0000000) | (value & FAT_ENTRY_MASK);
+        uint32_t sector = cluster / 128;
+        fatDirty[sector >> 5] |= 1u << (sector & 31);
+        if (cluster >= 2 && wasFree != isFree) {
+            if (freeMapBuilt) freeMap[cluster >> 5] ^= 1u << (cluster & 31);
+            fsInfoDirty = true;
+            if (isFree) {
+                freeClusters++;
+                if (cluster < nextFreeHint) nextFreeHint = cluster;
+            } else {
+                freeClusters--;
+            }
+        }
+        return true;
+    }
     // Update a single FAT entry for FAT32 (lower 28 bits used)
     uint32_t fatOffset = cluster * 4;
     uint32_t fatSector = fatStartLBA + (fatOffset / 512);
@@ -297,7 +656,27 @@ bool FAT32::WriteCluster(uint32_t cluster, const uint8_t* buf) {
     return WriteSectors(ClusterToLBA(cluster), bpb.sectorsPerCluster, buf);
 }
 
+bool FAT32::EnsureFreeMap() {
+    if (!freeMap) return false;
+    if (freeMapBuilt) return true;
+    // The count FSInfo reported (plus our own changes) must match
+    uint32_t expected = freeClusters;
+    if (!BuildFreeMap()) return false;
+    if (freeClusters != expected) {
+        tty.Write("FAT32: FSInfo free count was stale, recounted\n");
+        fsInfoDirty = true;
+    }
+    return true;
+}
+
 uint32_t FAT32::AllocateCluster() {
+    if (freeMap) {
+        if (!EnsureFreeMap()) return 0;
+        uint32_t cl = FindFreeCluster();
+        if (cl < 2 || !UpdateFAT(cl, 0x0FFFFFF8)) return 0;
+        nextFreeHint = cl + 1;
+        return cl;
+    }
     // Scan FAT entries directly based on FAT size (more robust than deriving totalClusters)
     uint32_t entries = bpb.sectorsPerFAT * 512 / 4; // 4 bytes per FAT32 entry
     if (entries < 3) return 0; // not valid
@@ -321,6 +700,62 @@ uint32_t FAT32::AllocateCluster() {
     return 0;
 }
 
+uint32_t FAT32::AllocateRun(uint32_t goal, uint32_t want, uint32_t& got) {
+    got = 0;
+    if (!want) return 0;
+    if (!freeMap) {
+        // No cached FAT to search; fall back to single clusters
+        uint32_t cl = AllocateCluster();
+        if (cl >= 2) got = 1;
+        return cl;
+    }
+    if (!EnsureFreeMap() || !freeClusters) return 0;
+    auto isFree = [&](uint32_t c) {
+        return c >= 2 && c < fatEntryCount && ((freeMap[c >> 5] >> (c & 31)) & 1);
+    };
+
+    uint32_t start = 0, len = 0;
+    if (isFree(goal)) {
+        // Right after the file's last cluster: the chain stays one extent
+        start = goal;
+        while (len < want && isFree(start + len)) ++len;
+    } else {
+        // First run long enough from the hint on (then from the start),
+        // else the longest one seen
+        uint32_t hint = (nextFreeHint >= 2 && nextFreeHint < fatEntryCount) ? nextFreeHint : 2;
+        for (uint32_t pass = 0; pass < 2 && len < want; ++pass) {
+            uint32_t c = pass ? 2 : hint;
+            uint32_t end = pass ? hint : fatEntryCount;
+            while (c < end && len < want) {
+                uint32_t bits = freeMap[c >> 5] >> (c & 31);
+                if (!bits) {
+                    c = (c | 31) + 1;
+                    continue;
+                }
+                c += (uint32_t)__builtin_ctz(bits);
+                if (c >= end) break;
+                uint32_t runStart = c;
+                while (c < end && c - runStart < want && isFree(c)) ++c;
+                if (c - runStart > len) {
+                    start = runStart;
+                    len = c - runStart;
+                }
+            }
+        }
+        if (!len) return 0;
+    }
+
+    for (uint32_t i = 0; i < len; ++i) {
+        uint32_t value = (i + 1 < len) ? start + i + 1 : 0x0FFFFFF8;
+        if (UpdateFAT(start + i, value)) continue;
+        while (i--) UpdateFAT(start + i, 0);
+        return 0;
+    }
+    nextFreeHint = start + len;
+    got = len;
+    return start;
+}
+
 void FAT32::PackShortName11(const int8_t* name83, uint8_t out11[11], bool& okIs83, bool upperOnly) {
     // Convert NAME[.EXT] into padded 8 + 3 upper-case, truncating when needed.
     for (int i = 0; i < 11; ++i) out11[i] = ' ';
@@ -344,7 +779,7 @@ void FAT32::PackShortName11(const int8_t* name83, uint8_t out11[11], bool& okIs8
 bool FAT32::InitDirCluster(uint32_t newDirCluster, uint32_t parentCluster) {
     uint8_t cl[4096]; // assume max cluster size of 8*512 for simplicity; will only write first sectors actually used by bpb.sectorsPerCluster
     uint32_t bytesPerCluster = bpb.bytesPerSector * bpb.sectorsPerCluster;
-    for (uint32_t i = 0; i < bytesPerCluster; ++i) cl[i] = 0;
+    String::memset(cl, 0, bytesPerCluster);
     // Create "." and ".." entries (short entries)
     auto writeEntry = [&](uint32_t off, const char* name, uint32_t startCl, bool isDir) {
         // Fill short name: 11 bytes (space-padded). For '.' and '..', just the dots at beginning.
@@ -435,6 +870,8 @@ bool FAT32::AddFileEntryToDir(uint32_t dirCluster, const uint8_t shortName11[11]
 
 int32_t FAT32::WriteFile(const int8_t* path, const uint8_t* data, uint32_t len) {
     if (!mountedFlag || !path || !data || len == 0) return -1;
+    OpGuard op(this, OpGuard::KEEP);
+    FATSyncGuard fatSync(this);
     if (path[0] != '/') return -1;
     // Traverse directories to the parent directory of target file
     uint32_t dirCl = bpb.rootCluster;
@@ -458,6 +895,13 @@ int32_t FAT32::WriteFile(const int8_t* path, const uint8_t* data, uint32_t len)
     if (finalName[0]==0) return -1; // no file name
     // Build short 11-byte name (upper-case); allow truncation.
     uint8_t short11[11]; bool ok83=false; PackShortName11(finalName, short11, ok83, true); if(!ok83) return -1;
+    // Repeated appends to one file are buffered and leave the entry alone
+    // until they are flushed
+    FAT32AppendStream* st = FindStream(dirCl, short11);
+    if (st) return AppendToStream(st, data, len);
+    // The entry is created or its size changes below
+    dentries.Invalidate(dirCl, finalName);
+    dentries.Invalidate(dirCl, short11);
     uint32_t entryCl=0, entryOff=0, startCl=0, fileSize=0; uint8_t attr=0;
     bool exists = FindShortEntryWithOffset(dirCl, short11, entryCl, entryOff, startCl, fileSize, attr);
     uint32_t bytesPerCluster = bpb.bytesPerSector * bpb.sectorsPerCluster;
@@ -472,10 +916,10 @@ int32_t FAT32::WriteFile(const int8_t* path, const uint8_t* data, uint32_t len)
         uint32_t remaining = len; const uint8_t* src = data; uint32_t current = newCl;
         while (remaining) {
             uint8_t* buf = (uint8_t*)0x38000; // scratch
-            // Zero fresh buffer
-            for (uint32_t i=0;i<bytesPerCluster;++i) buf[i]=0;
+            // Copy the chunk and zero the rest of the cluster
             uint32_t chunk = (remaining > bytesPerCluster) ? bytesPerCluster : remaining;
-            for (uint32_t i=0;i<chunk;++i) buf[i] = src[i];
+            String::memmove(buf, src, chunk);
+            String::memset(buf + chunk, 0, bytesPerCluster - chunk);
             if (!WriteCluster(current, buf)) return -1;
             src += chunk; remaining -= chunk;
             if (remaining) {
@@ -492,9 +936,15 @@ int32_t FAT32::WriteFile(const int8_t* path, const uint8_t* data, uint32_t len)
     }
     // Append to existing file
     if (!(attr & 0x20)) return -1; // not a regular file
+    st = OpenStream(dirCl, short11, entryCl, entryOff, startCl, fileSize);
+    if (st) return AppendToStream(st, data, len);
+    // No stream (out of memory or an odd chain): append synchronously.
+    // A file created empty by Open() has no cluster yet; the first one
+    // allocated below becomes its start cluster.
+    if (startCl < 2 && fileSize) return -1;
     uint32_t lastCluster = startCl;
     // Walk to end of cluster chain
-    while (true) {
+    while (lastCluster >= 2) {
         uint32_t nxt = NextCluster(lastCluster);
         if (nxt >= 0x0FFFFFF8 || nxt == 0) break;
         lastCluster = nxt;
@@ -507,7 +957,7 @@ int32_t FAT32::WriteFile(const int8_t* path, const uint8_t* data, uint32_t len)
         if (!ReadCluster(lastCluster, buf)) return -1;
         uint32_t space = bytesPerCluster - offsetInLast;
         uint32_t chunk = (remaining > space) ? space : remaining;
-        for (uint32_t i=0;i<chunk;++i) buf[offsetInLast + i] = src[i];
+        String::memmove(buf + offsetInLast, src, chunk);
         if (!WriteCluster(lastCluster, buf)) return -1;
         src += chunk; remaining -= chunk; fileSize += chunk;
         offsetInLast += chunk;
@@ -515,20 +965,24 @@ int32_t FAT32::WriteFile(const int8_t* path, const uint8_t* data, uint32_t len)
     // Allocate new clusters if more data remains
     while (remaining) {
         uint32_t newCl = AllocateCluster(); if (newCl < 2) return -1;
-        if (!UpdateFAT(lastCluster, newCl)) return -1;
+        if (lastCluster < 2) startCl = newCl;
+        else if (!UpdateFAT(lastCluster, newCl)) return -1;
         if (!UpdateFAT(newCl, 0x0FFFFFF8)) return -1;
         uint8_t* buf = (uint8_t*)0x3A000;
-        // Zero-init
-        for (uint32_t i=0;i<bytesPerCluster;++i) buf[i]=0;
         uint32_t chunk = (remaining > bytesPerCluster) ? bytesPerCluster : remaining;
-        for (uint32_t i=0;i<chunk;++i) buf[i] = src[i];
+        String::memmove(buf, src, chunk);
+        String::memset(buf + chunk, 0, bytesPerCluster - chunk);
         if (!WriteCluster(newCl, buf)) return -1;
         src += chunk; remaining -= chunk; fileSize += chunk;
         lastCluster = newCl;
     }
-    // Update directory entry size and (low/high) cluster fields if they were zero (should not change start cluster for append)
+    // Update directory entry size, and the start cluster if the file was empty
     uint8_t* dirBuf = (uint8_t*)0x3B000;
     if (!ReadCluster(entryCl, dirBuf)) return -1;
+    dirBuf[entryOff + 26] = (uint8_t)(startCl & 0xFF);
+    dirBuf[entryOff + 27] = (uint8_t)((startCl >> 8) & 0xFF);
+    dirBuf[entryOff + 20] = (uint8_t)((startCl >> 16) & 0xFF);
+    dirBuf[entryOff + 21] = (uint8_t)((startCl >> 24) & 0xFF);
     dirBuf[entryOff + 28] = (uint8_t)(fileSize & 0xFF);
     dirBuf[entryOff + 29] = (uint8_t)((fileSize >> 8) & 0xFF);
     dirBuf[entryOff + 30] = (uint8_t)((fileSize >> 16) & 0xFF);
@@ -537,6 +991,215 @@ int32_t FAT32::WriteFile(const int8_t* path, const uint8_t* data, uint32_t len)
     return (int32_t)len;
 }
 
+FAT32AppendStream* FAT32::FindStream(uint32_t dirCluster, const uint8_t name[11]) {
+    for (uint32_t i = 0; i < FAT32_APPEND_STREAMS; ++i) {
+        FAT32AppendStream* st = &streams[i];
+        if (st->used && st->file.dirCluster == dirCluster && String::memcmp(st->name, name, 11) == 0) return st;
+    }
+    return nullptr;
+}
+
+FAT32AppendStream* FAT32::OpenStream(uint32_t dirCluster, const uint8_t name[11], uint32_t entryCluster,
+                                     uint32_t entryOffset, uint32_t startCluster, uint32_t size) {
+    uint32_t bytesPerCluster = bpb.sectorsPerCluster * 512;
+    // The tail cluster is the one holding the last byte; a chain that runs
+    // past it (or a size without a chain) is left to the plain append path
+    uint32_t lastCluster = 0;
+    if (startCluster >= 2) {
+        FileHandle probe = {};
+        probe.startCluster = startCluster;
+        lastCluster = FileCluster(probe, size ? (size - 1) / bytesPerCluster : 0);
+        if (lastCluster < 2) return nullptr;
+        uint32_t next = NextCluster(lastCluster);
+        if (next != 0 && next < 0x0FFFFFF8) return nullptr;
+    } else if (size) {
+        return nullptr;
+    }
+
+    // A free slot, else the least recently used stream
+    FAT32AppendStream* st = &streams[0];
+    for (uint32_t i = 0; i < FAT32_APPEND_STREAMS; ++i) {
+        if (!streams[i].used) {
+            st = &streams[i];
+            break;
+        }
+        if (streams[i].lastUse < st->lastUse) st = &streams[i];
+    }
+    if (st->used) {
+        FlushStream(st);
+        ForgetStream(st);
+    }
+
+    st->tail = (uint8_t*)Heap::Alloc(bytesPerCluster);
+    st->pending = (uint8_t*)Heap::Alloc(FAT32_APPEND_BUFFER);
+    if (!st->tail || !st->pending || (lastCluster >= 2 && !ReadCluster(lastCluster, st->tail))) {
+        ForgetStream(st);
+        return nullptr;
+    }
+    String::memmove(st->name, name, 11);
+    st->file = {};
+    st->file.startCluster = startCluster;
+    st->file.size = size;
+    st->file.attr = 0x20;
+    st->file.dirCluster = dirCluster;
+    st->file.entryCluster = entryCluster;
+    st->file.entryOffset = entryOffset;
+    st->lastCluster = lastCluster;
+    st->pendingLen = 0;
+    st->used = true;
+    return st;
+}
+
+int32_t FAT32::AppendToStream(FAT32AppendStream* st, const uint8_t* data, uint32_t len) {
+    uint32_t now = NowMs();
+    st->lastUse = now;
+    if (st->pendingLen + len > FAT32_APPEND_BUFFER) {
+        if (!FlushStream(st)) return -1;
+        // Nothing gained by copying a write that fills the buffer alone
+        if (len >= FAT32_APPEND_BUFFER) {
+            uint32_t n = StreamWrite(st, data, len);
+            if (n < len) ForgetStream(st);
+            return n ? (int32_t)n : -1;
+        }
+    }
+    if (!st->pendingLen) st->pendingSince = now;
+    String::memmove(st->pending + st->pendingLen, data, len);
+    st->pendingLen += len;
+    if (st->pendingLen == FAT32_APPEND_BUFFER) return FlushStream(st) ? (int32_t)len : -1;
+    ArmAppendFlush();
+    return (int32_t)len;
+}
+
+uint32_t FAT32::StreamWrite(FAT32AppendStream* st, const uint8_t* src, uint32_t len) {
+    FileHandle& file = st->file;
+    uint32_t bytesPerCluster = bpb.sectorsPerCluster * 512;
+    uint32_t done = 0;
+
+    // Fill the tail cluster first, rewriting only the sectors that change
+    uint32_t used = file.size % bytesPerCluster;
+    if (st->lastCluster >= 2 && (used || !file.size)) {
+        uint32_t chunk = bytesPerCluster - used;
+        if (chunk > len) chunk = len;
+        String::memmove(st->tail + used, src, chunk);
+        uint32_t first = used / 512;
+        uint32_t count = (used + chunk - 1) / 512 - first + 1;
+        if (!WriteSectors(ClusterToLBA(st->lastCluster) + first, count, st->tail + first * 512)) return 0;
+        done = chunk;
+    }
+
+    // The rest gets clusters in as few runs as the free space allows,
+    // each run starting right after the current tail when possible
+    while (done < len) {
+        uint32_t want = (len - done + bytesPerCluster - 1) / bytesPerCluster;
+        uint32_t goal = (st->lastCluster >= 2) ? st->lastCluster + 1 : nextFreeHint;
+        uint32_t got = 0;
+        uint32_t run = AllocateRun(goal, want, got);
+        if (run < 2) break;
+        if (st->lastCluster >= 2 && !UpdateFAT(st->lastCluster, run)) {
+            for (uint32_t i = 0; i < got; ++i) UpdateFAT(run + i, 0);
+            break;
+        }
+        if (st->lastCluster < 2) file.startCluster = run;
+        st->lastCluster = run + got - 1;
+
+        uint32_t bytes = got * bytesPerCluster;
+        if (bytes > len - done) bytes = len - done;
+        // Whole clusters go straight from the caller's buffer; the last
+        // one, full or not, through the tail copy
+        uint32_t tailBytes = bytes - (got - 1) * bytesPerCluster;
+        uint32_t sectors = (got - 1) * bpb.sectorsPerCluster;
+        uint32_t lba = ClusterToLBA(run);
+        const uint8_t* p = src + done;
+        bool ok = true;
+        while (sectors && ok) {
+            uint32_t n = (sectors > FAT_MAX_IO_SECTORS) ? FAT_MAX_IO_SECTORS : sectors;
+            ok = WriteSectors(lba, n, p);
+            lba += n;
+            p += n * 512;
+            sectors -= n;
+        }
+        String::memmove(st->tail, p, tailBytes);
+        String::memset(st->tail + tailBytes, 0, bytesPerCluster - tailBytes);
+        if (!ok || !WriteCluster(st->lastCluster, st->tail)) break;
+        done += bytes;
+    }
+
+    if (!done) return 0;
+    file.size += done;
+    if (!WriteFileEntry(file)) return 0;
+    return done;
+}
+
+bool FAT32::FlushStream(FAT32AppendStream* st) {
+    if (!st->used || !st->pendingLen) return true;
+    uint32_t len = st->pendingLen;
+    if (StreamWrite(st, st->pending, len) == len) {
+        st->pendingLen = 0;
+        return true;
+    }
+    tty.Write("FAT32: delayed append failed, buffered data dropped\n");
+    ForgetStream(st);
+    return false;
+}
+
+void FAT32::ForgetStream(FAT32AppendStream* st) {
+    if (st->tail) Heap::Free(st->tail);
+    if (st->pending) Heap::Free(st->pending);
+    st->tail = nullptr;
+    st->pending = nullptr;
+    st->pendingLen = 0;
+    st->used = false;
+}
+
+bool FAT32::FlushAppends(bool forget, uint32_t minAge) {
+    bool ok = true;
+    bool wrote = false;
+    uint32_t now = NowMs();
+    for (uint32_t i = 0; i < FAT32_APPEND_STREAMS; ++i) {
+        FAT32AppendStream* st = &streams[i];
+        if (st->used && st->pendingLen && now - st->pendingSince >= minAge) {
+            wrote = true;
+            if (!FlushStream(st)) ok = false;
+        }
+        if (forget && st->used) ForgetStream(st);
+    }
+    if (wrote && !SyncFAT()) ok = false;
+    return ok;
+}
+
+void FAT32::ArmAppendFlush() {
+    uint32_t flags = IrqSave();
+    bool arm = !appendFlushArmed;
+    appendFlushArmed = true;
+    IrqRestore(flags);
+    if (!arm) return;
+    if (!kos::process::WorkQueueAPI::QueueDelayedWork(&FAT32::AppendFlushWork, this, FAT32_APPEND_DELAY_MS, true)) {
+        // No work queue yet: appends wait for the buffer to fill or a Sync
+        appendFlushArmed = false;
+    }
+}
+
+void FAT32::AppendFlushWork(void* arg) {
+    FAT32* self = (FAT32*)arg;
+    self->appendFlushArmed = false;
+    // An operation or a cache request (a sync outside any operation, say)
+    // is in progress, possibly the one this work interrupted; waiting for
+    // the cache lock could spin forever, so try again next interval
+    if (self->opDepth || self->dev->IsBusy()) {
+        self->ArmAppendFlush();
+        return;
+    }
+    bool pending = false;
+    {
+        OpGuard op(self, OpGuard::KEEP);
+        self->FlushAppends(false, FAT32_APPEND_DELAY_MS);
+        for (uint32_t i = 0; i < FAT32_APPEND_STREAMS; ++i) {
+            if (self->streams[i].used && self->streams[i].pendingLen) pending = true;
+        }
+    }
+    if (pending) self->ArmAppendFlush();
+}
+
 bool FAT32::AddEntryToDirCluster(uint32_t dirCluster, const uint8_t shortName11[11], uint32_t startCluster, bool isDir) {
     uint8_t* cl = (uint8_t*)0x40000; // scratch
     uint32_t bytesPerCluster = bpb.bytesPerSector * bpb.sectorsPerCluster;
@@ -585,6 +1248,7 @@ void FAT32::ListRoot() {
         tty.Write("FAT32 not mounted\n");
         return;
     }
+    OpGuard op(this, OpGuard::FLUSH);
     uint32_t flags = kos::sys::CurrentListFlags();
 
     uint8_t sector[512];
@@ -662,6 +1326,7 @@ void FAT32::ListRoot() {
 void FAT32::ListDir(const int8_t* path) {
     if (!mountedFlag) { tty.Write((const int8_t*)"FAT32 not mounted\n"); return; }
     if (!path || (path[0] == '/' && path[1] == 0)) { ListRoot(); return; }
+    OpGuard op(this, OpGuard::FLUSH);
     uint32_t flags = kos::sys::CurrentListFlags();
     // Traverse path components from root cluster
     uint32_t dirCl = bpb.rootCluster;
@@ -724,6 +1389,7 @@ bool FAT32::DirExists(const int8_t* path) {
     if (!mountedFlag) return false;
     if (!path) return false;
     if (path[0] == '/' && path[1] == 0) return true; // root always exists
+    OpGuard op(this, OpGuard::KEEP);
     // Traverse path components from root cluster
     uint32_t dirCl = bpb.rootCluster;
     const int8_t* p = (path[0] == '/') ? (path + 1) : path;
@@ -741,6 +1407,9 @@ bool FAT32::DirExists(const int8_t* path) {
 
 // Find short 8.3 name in a single directory cluster (no subdir traversal beyond one hop)
 bool FAT32::FindShortNameInDirCluster(uint32_t dirCluster, const int8_t* shortName83, uint32_t& outStartCluster, uint32_t& outFileSize) {
+    uint8_t cachedAttr = 0;
+    DentryCache::Result cached = dentries.Lookup(dirCluster, shortName83, outStartCluster, outFileSize, cachedAttr);
+    if (cached != DentryCache::MISS) return cached == DentryCache::HIT;
     uint8_t* clusterBuf = (uint8_t*)0x20000; // scratch area
     uint32_t cl = dirCluster;
     while (cl >= 2 && cl < 0x0FFFFFF8) {
@@ -766,6 +1435,7 @@ bool FAT32::FindShortNameInDirCluster(uint32_t dirCluster, const int8_t* shortNa
                 uint16_t hi = (uint16_t)clusterBuf[i + 20] | ((uint16_t)clusterBuf[i + 21] << 8);
                 outStartCluster = ((uint32_t)hi << 16) | lo;
                 outFileSize = (uint32_t)clusterBuf[i + 28] | ((uint32_t)clusterBuf[i + 29] << 8) | ((uint32_t)clusterBuf[i + 30] << 16) | ((uint32_t)clusterBuf[i + 31] << 24);
+                dentries.Insert(dirCluster, shortName83, outStartCluster, outFileSize, attr);
                 return true;
             }
         }
@@ -773,12 +1443,15 @@ bool FAT32::FindShortNameInDirCluster(uint32_t dirCluster, const int8_t* shortNa
         if (next >= 0x0FFFFFF8 || next == 0) break;
         cl = next;
     }
+    // Only a completed scan proves absence; read errors returned above
+    dentries.InsertNegative(dirCluster, shortName83);
     return false;
 }
 
 int32_t FAT32::ReadFile(const int8_t* path, uint8_t* outBuf, uint32_t maxLen) {
     if (!mountedFlag) return -1;
     if (!path || path[0] != '/') return -1;
+    OpGuard op(this, OpGuard::FLUSH);
 
     // Traverse arbitrary path components from root cluster
     uint32_t dirCluster = bpb.rootCluster;
@@ -806,33 +1479,301 @@ int32_t FAT32::ReadFile(const int8_t* path, uint8_t* outBuf, uint32_t maxLen) {
             continue;
         }
 
-        // Last component: treat as file and read its FAT chain
-        uint32_t toRead = (entrySize < maxLen) ? entrySize : maxLen;
-        uint32_t bytesRead = 0;
-        uint8_t* dst = outBuf;
-        uint32_t cluster = entryCl;
-        uint32_t bytesPerCluster = bpb.bytesPerSector * bpb.sectorsPerCluster;
-        uint8_t* clBuf = (uint8_t*)0x30000; // scratch
-        while (cluster >= 2 && cluster < 0x0FFFFFF8 && bytesRead < toRead) {
-            if (!ReadCluster(cluster, clBuf)) break;
-            uint32_t chunk = bytesPerCluster;
-            if (bytesRead + chunk > toRead) chunk = toRead - bytesRead;
-            kos::lib::String::memmove(dst + bytesRead, clBuf, chunk);
-            bytesRead += chunk;
-            uint32_t next = NextCluster(cluster);
-            if (next >= 0x0FFFFFF8 || next == 0) break;
-            cluster = next;
-        }
-        return (int32_t)bytesRead;
+        // Last component: treat as file and read its FAT chain in runs
+        FileHandle file = {};
+        file.startCluster = entryCl;
+        file.size = entrySize;
+        file.raNext = 0xFFFFFFFF; // one-shot read, nothing to read ahead
+        return ReadAt(file, 0, outBuf, maxLen);
     }
     return -1; // empty path
 }
 
+bool FAT32::ResolveParent(const int8_t* path, uint32_t& outDirCluster, int8_t outName[13]) {
+    if (!path || path[0] != '/') return false;
+    uint32_t dirCl = bpb.rootCluster;
+    const int8_t* p = path + 1;
+    int8_t comp[13];
+    outName[0] = 0;
+    while (*p) {
+        int ci = 0; while (*p && *p != '/' && ci < 12) comp[ci++] = *p++;
+        comp[ci] = 0;
+        if (*p == '/') ++p;
+        if (ci == 0) continue;
+        const int8_t* q = p; while (*q == '/') ++q; bool isLast = (*q == 0);
+        for (int i = 0; comp[i]; ++i) if (comp[i] >= 'a' && comp[i] <= 'z') comp[i] -= ('a' - 'A');
+        if (isLast) {
+            String::memmove(outName, comp, (uint32_t)ci + 1);
+            break;
+        }
+        uint32_t childCl = 0, childSz = 0;
+        if (!FindShortNameInDirCluster(dirCl, comp, childCl, childSz)) return false;
+        dirCl = childCl;
+    }
+    outDirCluster = dirCl;
+    return outName[0] != 0;
+}
+
+bool FAT32::Open(const int8_t* path, FileHandle& out, bool create) {
+    if (!mountedFlag) return false;
+    OpGuard op(this, OpGuard::FLUSH);
+    uint32_t dirCl = 0;
+    int8_t name[13];
+    if (!ResolveParent(path, dirCl, name)) return false;
+    uint8_t short11[11]; bool ok83 = false;
+    PackShortName11(name, short11, ok83, true);
+    if (!ok83) return false;
+    uint32_t entryCl = 0, entryOff = 0, startCl = 0, size = 0; uint8_t attr = 0;
+    if (!FindShortEntryWithOffset(dirCl, short11, entryCl, entryOff, startCl, size, attr)) {
+        if (!create) return false;
+        // Empty files own no cluster; the first write allocates one
+        FATSyncGuard fatSync(this);
+        dentries.Invalidate(dirCl, name);
+        dentries.Invalidate(dirCl, short11);
+        if (!AddFileEntryToDir(dirCl, short11, 0, 0)) return false;
+        if (!FindShortEntryWithOffset(dirCl, short11, entryCl, entryOff, startCl, size, attr)) return false;
+    }
+    if (attr & 0x10) return false; // directories are not opened as files
+    out.startCluster = startCl;
+    out.size = size;
+    out.attr = attr;
+    out.dirCluster = dirCl;
+    out.entryCluster = entryCl;
+    out.entryOffset = entryOff;
+    out.posCluster = 0;
+    out.posIndex = 0;
+    out.raNext = 0;
+    out.raEnd = 0;
+    out.raWindow = 0;
+    return true;
+}
+
+uint32_t FAT32::FileCluster(FileHandle& file, uint32_t index) {
+    if (file.startCluster < 2) return 0;
+    if (file.posCluster < 2 || index < file.posIndex) {
+        file.posCluster = file.startCluster;
+        file.posIndex = 0;
+    }
+    while (file.posIndex < index) {
+        uint32_t next = NextCluster(file.posCluster);
+        if (next < 2 || next >= 0x0FFFFFF8) return 0;
+        file.posCluster = next;
+        file.posIndex++;
+    }
+    return file.posCluster;
+}
+
+int32_t FAT32::ReadAt(FileHandle& file, uint32_t offset, uint8_t* buf, uint32_t len) {
+    if (!mountedFlag || !buf) return -1;
+    if (offset >= file.size) return 0;
+    if (len > file.size - offset) len = file.size - offset;
+    // Appends buffered since Open lie past file.size, so nothing to flush
+    OpGuard op(this, OpGuard::KEEP);
+    uint32_t bytesPerCluster = bpb.sectorsPerCluster * 512;
+    uint32_t done = 0;
+    while (done < len) {
+        uint32_t pos = offset + done;
+        uint32_t cl = FileCluster(file, pos / bytesPerCluster);
+        if (cl < 2) break; // chain shorter than the recorded size
+        uint32_t sector = (pos % bytesPerCluster) / 512;
+        uint32_t inSector = pos % 512;
+        uint32_t lba = ClusterToLBA(cl) + sector;
+        uint32_t want = len - done;
+        if (inSector == 0 && want >= 512) {
+            // Whole sectors go straight to the caller; physically consecutive
+            // clusters are merged into one device read
+            uint32_t count = want / 512;
+            uint32_t avail = bpb.sectorsPerCluster - sector;
+            uint32_t runEnd = cl;
+            uint32_t runIndex = file.posIndex;
+            while (avail < count && avail + bpb.sectorsPerCluster <= FAT_MAX_IO_SECTORS) {
+                uint32_t next = NextCluster(runEnd);
+                if (next != runEnd + 1) break;
+                runEnd = next;
+                runIndex++;
+                avail += bpb.sectorsPerCluster;
+            }
+            if (count > avail) count = avail;
+            if (!ReadSectors(lba, count, buf + done)) break;
+            // The run's last cluster was read into, so resume from there
+            file.posCluster = runEnd;
+            file.posIndex = runIndex;
+            done += count * 512;
+        } else {
+            uint8_t sec[512];
+            if (!ReadSector(lba, sec)) break;
+            uint32_t chunk = 512 - inSector;
+            if (chunk > want) chunk = want;
+            String::memmove(buf + done, sec + inSector, chunk);
+            done += chunk;
+        }
+    }
+
+    // A reader that picks up where it stopped gets the next window cached
+    // before it asks; a jump resets the window
+    uint32_t end = offset + done;
+    if (done && offset == file.raNext) {
+        if (end >= file.raEnd && end < file.size) {
+            if (!file.raWindow) file.raWindow = READAHEAD_MIN_BYTES;
+            else if (file.raWindow < READAHEAD_MAX_BYTES) file.raWindow *= 2;
+            Readahead(file, end, file.raWindow);
+            file.raEnd = end + file.raWindow;
+        }
+    } else {
+        file.raWindow = 0;
+        file.raEnd = 0;
+    }
+    file.raNext = end;
+    return (done || len == 0) ? (int32_t)done : -1;
+}
+
+void FAT32::Readahead(const FileHandle& file, uint32_t offset, uint32_t bytes) {
+    if (offset >= file.size) return;
+    if (bytes > file.size - offset) bytes = file.size - offset;
+    uint32_t bytesPerCluster = bpb.sectorsPerCluster * 512;
+    // Walk a copy so the handle keeps its own position
+    FileHandle probe = file;
+    uint32_t cl = FileCluster(probe, offset / bytesPerCluster);
+    if (cl < 2) return;
+    uint32_t firstSector = (offset % bytesPerCluster) / 512;
+    uint32_t left = (offset + bytes - 1) / 512 - offset / 512 + 1;
+    uint32_t lba = ClusterToLBA(cl) + firstSector;
+    uint32_t runSectors = bpb.sectorsPerCluster - firstSector;
+    while (left) {
+        uint32_t next = NextCluster(cl);
+        while (runSectors < left && next == cl + 1) {
+            cl = next;
+            runSectors += bpb.sectorsPerCluster;
+            next = NextCluster(cl);
+        }
+        uint32_t n = (runSectors < left) ? runSectors : left;
+        dev->Prefetch(lba, n);
+        left -= n;
+        if (next < 2 || next >= 0x0FFFFFF8) break;
+        cl = next;
+        lba = ClusterToLBA(cl);
+        runSectors = bpb.sectorsPerCluster;
+    }
+}
+
+bool FAT32::RefreshFileEntry(FileHandle& file) {
+    uint8_t sec[512];
+    if (!ReadSector(ClusterToLBA(file.entryCluster) + file.entryOffset / 512, sec)) return false;
+    const uint8_t* e = sec + file.entryOffset % 512;
+    // The entry may have been removed or moved since the file was opened
+    if (e[0] == 0x00 || e[0] == 0xE5 || (e[11] & 0x10)) return false;
+    // Other handles and the append path only ever grow a file, so the
+    // larger size and the first start cluster recorded are the current ones
+    uint32_t startCl = (uint32_t)e[26] | ((uint32_t)e[27] << 8) | ((uint32_t)e[20] << 16) | ((uint32_t)e[21] << 24);
+    uint32_t size = Le32(e + 28);
+    if (file.startCluster < 2 && startCl >= 2) {
+        file.startCluster = startCl;
+        file.posCluster = 0;
+        file.posIndex = 0;
+    }
+    if (size > file.size) file.size = size;
+    return true;
+}
+
+bool FAT32::WriteFileEntry(FileHandle& file) {
+    uint8_t sec[512];
+    uint32_t lba = ClusterToLBA(file.entryCluster) + file.entryOffset / 512;
+    if (!ReadSector(lba, sec)) return false;
+    uint8_t* e = sec + file.entryOffset % 512;
+    // The entry may have been removed or moved since the file was opened
+    if (e[0] == 0x00 || e[0] == 0xE5 || (e[11] & 0x10)) return false;
+    // Never shrink what another handle wrote since this one last looked
+    uint32_t size = Le32(e + 28);
+    if (size > file.size) file.size = size;
+    dentries.Invalidate(file.dirCluster, e);
+    e[26] = (uint8_t)(file.startCluster & 0xFF);
+    e[27] = (uint8_t)((file.startCluster >> 8) & 0xFF);
+    e[20] = (uint8_t)((file.startCluster >> 16) & 0xFF);
+    e[21] = (uint8_t)((file.startCluster >> 24) & 0xFF);
+    PutLe32(e + 28, file.size);
+    return WriteSector(lba, sec);
+}
+
+int32_t FAT32::WriteAt(FileHandle& file, uint32_t offset, const uint8_t* buf, uint32_t len) {
+    if (!mountedFlag || !buf || (file.attr & 0x10)) return -1;
+    if (len > 0xFFFFFFFFu - offset) return -1;
+    if (len == 0) return 0;
+    OpGuard op(this, OpGuard::FLUSH);
+    // A stream on the same file would keep a stale tail and size
+    for (uint32_t i = 0; i < FAT32_APPEND_STREAMS; ++i) {
+        FAT32AppendStream* st = &streams[i];
+        if (st->used && st->file.entryCluster == file.entryCluster && st->file.entryOffset == file.entryOffset) {
+            ForgetStream(st);
+        }
+    }
+    // Appends and other handles may have grown the file since it was opened
+    if (!RefreshFileEntry(file) || offset > file.size) return -1;
+    FATSyncGuard fatSync(this);
+    uint32_t bytesPerCluster = bpb.sectorsPerCluster * 512;
+    bool entryChanged = false;
+    bool failed = false;
+    uint32_t done = 0;
+    while (done < len) {
+        uint32_t pos = offset + done;
+        uint32_t index = pos / bytesPerCluster;
+        uint32_t cl = FileCluster(file, index);
+        if (cl < 2) {
+            // Writes start at or before the end, so the chain is at most one cluster short
+            bool empty = file.startCluster < 2;
+            if (empty ? index != 0 : file.posIndex + 1 != index) { failed = true; break; }
+            cl = AllocateCluster();
+            if (cl < 2) { failed = true; break; }
+            if (empty) {
+                file.startCluster = cl;
+                entryChanged = true;
+            } else if (!UpdateFAT(file.posCluster, cl)) {
+                UpdateFAT(cl, 0);
+                failed = true;
+                break;
+            }
+            file.posCluster = cl;
+            file.posIndex = index;
+        }
+        uint32_t sector = (pos % bytesPerCluster) / 512;
+        uint32_t inSector = pos % 512;
+        uint32_t lba = ClusterToLBA(cl) + sector;
+        uint32_t want = len - done;
+        if (inSector == 0 && want >= 512) {
+            uint32_t count = want / 512;
+            if (count > bpb.sectorsPerCluster - sector) count = bpb.sectorsPerCluster - sector;
+            if (!WriteSectors(lba, count, buf + done)) { failed = true; break; }
+            done += count * 512;
+        } else {
+            // Partial sector: keep whatever file data surrounds the write
+            uint8_t sec[512];
+            if (pos - inSector < file.size) {
+                if (!ReadSector(lba, sec)) { failed = true; break; }
+            } else {
+                String::memset(sec, 0, sizeof(sec));
+            }
+            uint32_t chunk = 512 - inSector;
+            if (chunk > want) chunk = want;
+            String::memmove(sec + inSector, buf + done, chunk);
+            if (!WriteSector(lba, sec)) { failed = true; break; }
+            done += chunk;
+        }
+    }
+    if (offset + done > file.size) {
+        file.size = offset + done;
+        entryChanged = true;
+    }
+    if (entryChanged && !WriteFileEntry(file)) return -1;
+    if (failed && done == 0) return -1;
+    return (int32_t)done;
+}
+
 int32_t FAT32::Mkdir(const int8_t* path, int32_t parents) {
     if (!mountedFlag || !path) {
         tty.Write((const int8_t*)"FAT32: Mkdir invalid (not mounted or null path)\n");
         return -1;
     }
+    OpGuard op(this, OpGuard::KEEP);
+    FATSyncGuard fatSync(this);
     // Accept both absolute and relative paths; treat relative as root-relative for now
     uint32_t curDir = bpb.rootCluster;
     const int8_t* p = (path[0] == '/') ? (path + 1) : path;
@@ -862,6 +1803,9 @@ int32_t FAT32::Mkdir(const int8_t* path, int32_t parents) {
         // Pack 8.3 short name
         uint8_t short11[11]; bool ok83 = false; PackShortName11(comp, short11, ok83, true);
         if (!ok83) { tty.Write((const int8_t*)"FAT32: invalid 8.3 name\n"); return -1; }
+        // Drop the negative entry the lookup above just cached
+        dentries.Invalidate(curDir, comp);
+        dentries.Invalidate(curDir, short11);
         // Allocate a cluster for the new dir
         uint32_t newCl = AllocateCluster();
         if (newCl < 2) { tty.Write((const int8_t*)"FAT32: no free clusters\n"); return -1; }
@@ -908,12 +1852,22 @@ void FAT32::DebugInfo() {
     tty.Write(" dataStartLBA="); 
     printHex32(dataStartLBA); 
     tty.PutChar('\n');
+    if (freeMap) {
+        tty.Write(" clusters libres="); 
+        printHex32(freeClusters); 
+        tty.Write(" / "); 
+        printHex32(fatEntryCount - 2); 
+        tty.PutChar('\n');
+    }
 }
 
 // (No DebugInfo method; detailed logs are printed during Mount())
 
 int32_t FAT32::Rename(const int8_t* src, const int8_t* dst) {
     if (!mountedFlag || !src || !dst) return -1;
+    // Streams remember where their entries live
+    OpGuard op(this, OpGuard::FORGET);
+    FATSyncGuard fatSync(this);
     if (src[0] != '/' || dst[0] != '/') return -1;
 
     auto split_parent_basename = [](const int8_t* path, int8_t* parentOut, int parentCap, int8_t* baseOut, int baseCap) {
@@ -965,6 +1919,10 @@ int32_t FAT32::Rename(const int8_t* src, const int8_t* dst) {
 
     // Fail if destination name exists in dest directory (no overwrite for now)
     uint32_t tmpCl=0, tmpSz=0; if (FindShortNameInDirCluster(dstDirCl, (const int8_t*)dstBase, tmpCl, tmpSz)) return -1;
+    dentries.Invalidate(srcDirCl, srcBase);
+    dentries.Invalidate(srcDirCl, src11);
+    dentries.Invalidate(dstDirCl, dstBase);
+    dentries.Invalidate(dstDirCl, dst11);
 
     // Same directory rename: modify name in place
     if (srcDirCl == dstDirCl) {
@@ -988,6 +1946,7 @@ int32_t FAT32::Rename(const int8_t* src, const int8_t* dst) {
 
 int32_t FAT32::EnumDir(const int8_t* path, DirEnumCallback callback, void* userdata) {
     if (!mountedFlag || !callback) return -1;
+    OpGuard op(this, OpGuard::FLUSH);
     
     // Resolve directory cluster
     uint32_t dirCl = bpb.rootCluster;
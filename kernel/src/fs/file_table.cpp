@@ -0,0 +1,227 @@
+#include <fs/file_table.hpp>
+#include <memory/heap.hpp>
+#include <lib/string.hpp>
+#include <console/tty.hpp>
+#include <process/scheduler.hpp>
+#include <process/thread_manager.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
+
+using namespace kos::fs;
+using namespace kos::memory;
+using namespace kos::lib;
+using namespace kos::console;
+using namespace kos::process;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
+
+namespace {
+    FileTable* g_tables = nullptr;
+    uint32_t g_next_sequence = 1;
+
+    // Owned by the scheduler's current task. %gs only moves with the stack,
+    // which Schedule() does not switch, so the thread pointer can disagree.
+    uint32_t CurrentOwner() {
+        if (!g_scheduler) return 0;
+        Thread* current = g_scheduler->GetCurrentTask();
+        if (!current) return 0;
+
+        if (g_thread_manager) {
+            uint32_t pid = g_thread_manager->GetPid(current->task_id);
+            if (pid != 0) return pid;
+        }
+
+        return current->task_id;
+    }
+
+    FileTable* FindTable(uint32_t owner) {
+        for (FileTable* t = g_tables; t; t = t->next) {
+            if (t->owner == owner) return t;
+        }
+        return nullptr;
+    }
+
+    // Caller holds interrupts off
+    FileTable* TableFor(uint32_t owner) {
+        FileTable* t = FindTable(owner);
+        if (t) return t;
+        t = (FileTable*)Heap::Alloc(sizeof(FileTable));
+        if (!t) return nullptr;
+        String::memset(t, 0, sizeof(FileTable));
+        t->owner = owner;
+        t->next = g_tables;
+        g_tables = t;
+        return t;
+    }
+
+    // Clear a slot; the table goes away with its last descriptor. Caller
+    // holds interrupts off and frees the returned file.
+    OpenFile* TakeSlot(FileTable* t, uint32_t slot) {
+        OpenFile* file = t->files[slot];
+        t->files[slot] = nullptr;
+        if (file && --t->open_count == 0) {
+            for (FileTable** link = &g_tables; *link; link = &(*link)->next) {
+                if (*link != t) continue;
+                *link = t->next;
+                break;
+            }
+            Heap::Free(t);
+        }
+        return file;
+    }
+
+    OpenFile* Lookup(int32_t fd) {
+        if (fd < FD_FIRST || fd >= FD_FIRST + (int32_t)FD_PER_PROCESS) return nullptr;
+        FileTable* t = FindTable(CurrentOwner());
+        return t ? t->files[fd - FD_FIRST] : nullptr;
+    }
+
+    void WriteDec(uint32_t v) {
+        int8_t digits[10];
+        int n = 0;
+        do {
+            digits[n++] = (int8_t)('0' + v % 10);
+            v /= 10;
+        } while (v);
+        while (n) TTY::PutChar(digits[--n]);
+    }
+}
+
+namespace kos::fs::FileAPI {
+
+    int32_t Open(const int8_t* path, uint32_t flags) {
+        Filesystem* fs = g_fs_ptr;
+        if (!fs || !path) return -1;
+        if (!(flags & (FD_READ | FD_WRITE))) flags |= FD_READ;
+
+        OpenFile* file = (OpenFile*)Heap::Alloc(sizeof(OpenFile));
+        if (!file) return -1;
+        if (!fs->Open(path, file->handle, (flags & FD_CREATE) != 0)) {
+            Heap::Free(file);
+            return -1;
+        }
+        file->fs = fs;
+        file->flags = flags;
+        file->offset = 0;
+
+        int32_t fd = -1;
+        uint32_t irq = IrqSave();
+        FileTable* t = TableFor(CurrentOwner());
+        for (uint32_t i = 0; t && i < FD_PER_PROCESS; ++i) {
+            if (t->files[i]) continue;
+            t->files[i] = file;
+            t->open_count++;
+            file->sequence = g_next_sequence++;
+            fd = FD_FIRST + (int32_t)i;
+            break;
+        }
+        IrqRestore(irq);
+        if (fd < 0) Heap::Free(file);
+        return fd;
+    }
+
+    int32_t Close(int32_t fd) {
+        if (fd < FD_FIRST || fd >= FD_FIRST + (int32_t)FD_PER_PROCESS) return -1;
+        uint32_t irq = IrqSave();
+        FileTable* t = FindTable(CurrentOwner());
+        OpenFile* file = t ? TakeSlot(t, (uint32_t)(fd - FD_FIRST)) : nullptr;
+        IrqRestore(irq);
+        if (!file) return -1;
+        Heap::Free(file);
+        return 0;
+    }
+
+    int32_t Read(int32_t fd, uint8_t* buf, uint32_t len) {
+        OpenFile* file = Lookup(fd);
+        if (!file || !buf || !(file->flags & FD_READ)) return -1;
+        int32_t n = file->fs->ReadAt(file->handle, file->offset, buf, len);
+        if (n > 0) file->offset += (uint32_t)n;
+        return n;
+    }
+
+    int32_t Write(int32_t fd, const uint8_t* buf, uint32_t len) {
+        OpenFile* file = Lookup(fd);
+        if (!file || !buf || !(file->flags & FD_WRITE)) return -1;
+        if (file->flags & FD_APPEND) file->offset = file->handle.size;
+        int32_t n = file->fs->WriteAt(file->handle, file->offset, buf, len);
+        if (n > 0) file->offset += (uint32_t)n;
+        return n;
+    }
+
+    int32_t PRead(int32_t fd, uint8_t* buf, uint32_t len, uint32_t offset) {
+        OpenFile* file = Lookup(fd);
+        if (!file || !buf || !(file->flags & FD_READ)) return -1;
+        return file->fs->ReadAt(file->handle, offset, buf, len);
+    }
+
+    int32_t PWrite(int32_t fd, const uint8_t* buf, uint32_t len, uint32_t offset) {
+        OpenFile* file = Lookup(fd);
+        if (!file || !buf || !(file->flags & FD_WRITE)) return -1;
+        return file->fs->WriteAt(file->handle, offset, buf, len);
+    }
+
+    int32_t Seek(int32_t fd, int32_t offset, uint32_t whence) {
+        OpenFile* file = Lookup(fd);
+        if (!file) return -1;
+        int64_t base;
+        switch (whence) {
+            case FD_SEEK_SET: base = 0; break;
+            case FD_SEEK_CUR: base = file->offset; break;
+            case FD_SEEK_END: base = file->handle.size; break;
+            default: return -1;
+        }
+        int64_t target = base + offset;
+        // FAT files cannot have holes, so the end is as far as a seek goes
+        if (target < 0 || target > (int64_t)file->handle.size || target > 0x7FFFFFFF) return -1;
+        file->offset = (uint32_t)target;
+        return (int32_t)target;
+    }
+
+    int32_t Size(int32_t fd) {
+        OpenFile* file = Lookup(fd);
+        return file ? (int32_t)file->handle.size : -1;
+    }
+
+    uint32_t Mark() {
+        return g_next_sequence;
+    }
+
+    void CloseSince(uint32_t mark) {
+        uint32_t irq = IrqSave();
+        FileTable* t = FindTable(CurrentOwner());
+        for (uint32_t i = 0; t && i < FD_PER_PROCESS; ++i) {
+            OpenFile* file = t->files[i];
+            if (!file || file->sequence < mark) continue;
+            bool last = (t->open_count == 1);
+            Heap::Free(TakeSlot(t, i));
+            if (last) break;
+        }
+        IrqRestore(irq);
+    }
+
+    void PrintAll() {
+        TTY::Write("=== Open Files ===\n");
+        if (!g_tables) {
+            TTY::Write("No open files\n");
+            return;
+        }
+        uint32_t irq = IrqSave();
+        for (FileTable* t = g_tables; t; t = t->next) {
+            for (uint32_t i = 0; i < FD_PER_PROCESS; ++i) {
+                OpenFile* file = t->files[i];
+                if (!file) continue;
+                TTY::Write("owner=");
+                WriteDec(t->owner);
+                TTY::Write(" fd=");
+                WriteDec(FD_FIRST + i);
+                TTY::Write(file->flags & FD_READ ? " r" : " -");
+                TTY::Write(file->flags & FD_WRITE ? (file->flags & FD_APPEND ? "a" : "w") : "-");
+                TTY::Write(" offset=");
+                WriteDec(file->offset);
+                TTY::Write(" size=");
+                WriteDec(file->handle.size);
+                TTY::Write("\n");
+            }
+        }
+        IrqRestore(irq);
+    }
+}
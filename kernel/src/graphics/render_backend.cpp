@@ -5,6 +5,9 @@
 #include <console/logger.hpp>
 #include <lib/string.hpp>
 #include <memory/heap.hpp>
+#include <lib/memops.hpp>
+#include <arch/x86/hardware/cpu/features.hpp>
+#include <arch/x86/hardware/cpu/fpu.hpp>
 
 namespace kos {
 namespace gfx {
@@ -30,6 +33,53 @@ BackendState g_state = {false, false, 0, 0, 0, 0, nullptr, nullptr};
 
 static inline uint32_t MinU32(uint32_t a, uint32_t b) { return (a < b) ? a : b; }
 
+using kos::arch::x86::hardware::cpu::CpuDispatch;
+using kos::arch::x86::hardware::cpu::CpuVariant;
+using kos::arch::x86::hardware::cpu::FPU;
+using kos::arch::x86::hardware::cpu::CPU_FEATURE_NONE;
+using kos::arch::x86::hardware::cpu::CPU_FEATURE_SSE2;
+
+// --- Span fill kernels, picked at boot by CpuDispatch ---
+
+typedef void (*FillSpanFn)(uint32_t* dst, uint32_t color, uint32_t count);
+typedef uint32_t Vec4u32 __attribute__((vector_size(16)));
+
+// Spans shorter than this are not worth claiming the FPU for
+const uint32_t SSE_FILL_MIN_PIXELS = 64;
+
+void FillSpanRep(uint32_t* dst, uint32_t color, uint32_t count) {
+    __asm__ __volatile__("cld; rep stosl" : "+D"(dst), "+c"(count) : "a"(color) : "memory", "cc");
+}
+
+// Separate from the wrapper so no XMM use can be scheduled outside KernelBegin/End
+__attribute__((target("sse2"), noinline))
+void FillSpanSse2Body(uint32_t* dst, uint32_t color, uint32_t count) {
+    while (((uint32_t)dst & 15u) && count) { *dst++ = color; --count; }
+    const Vec4u32 v = {color, color, color, color};
+    Vec4u32* vdst = (Vec4u32*)dst;
+    const uint32_t blocks = count / 4u;
+    for (uint32_t i = 0; i < blocks; ++i) vdst[i] = v;
+    dst += blocks * 4u;
+    for (count &= 3u; count; --count) *dst++ = color;
+}
+
+void FillSpanSse2(uint32_t* dst, uint32_t color, uint32_t count) {
+    if (count < SSE_FILL_MIN_PIXELS) {
+        FillSpanRep(dst, color, count);
+        return;
+    }
+    uint32_t flags = FPU::KernelBegin();
+    FillSpanSse2Body(dst, color, count);
+    FPU::KernelEnd(flags);
+}
+
+FillSpanFn s_fill_span = FillSpanRep;
+const CpuVariant s_fill_variants[] = {
+    { CPU_FEATURE_SSE2, (void*)&FillSpanSse2, "sse2" },
+    { CPU_FEATURE_NONE, (void*)&FillSpanRep, "rep-stosl" },
+};
+CpuDispatch s_fill_dispatch("render.fill32", (void**)&s_fill_span, s_fill_variants, 2);
+
 } // namespace
 
 bool Initialize(uint32_t width,
@@ -54,9 +104,7 @@ bool Initialize(uint32_t width,
         return false;
     }
 
-    for (uint32_t i = 0; i < width * height; ++i) {
-        g_state.backbuffer[i] = 0xFF000000u;
-    }
+    s_fill_span(g_state.backbuffer, 0xFF000000u, width * height);
 
     if (gpu_backend && kos::drivers::gpu::vmsvga::IsReady()) {
         kos::drivers::gpu::vmsvga::BindFramebuffer(framebuffer_base, width, height, pitch_bytes, bpp);
@@ -90,10 +138,7 @@ void Fill(uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t color) {
     h = MinU32(h, g_state.height - y);
 
     for (uint32_t row = 0; row < h; ++row) {
-        uint32_t* dst = g_state.backbuffer + (y + row) * g_state.width + x;
-        for (uint32_t col = 0; col < w; ++col) {
-            dst[col] = color;
-        }
+        s_fill_span(g_state.backbuffer + (y + row) * g_state.width + x, color, w);
     }
 
     if (g_state.gpu_backend && kos::drivers::gpu::vmsvga::IsReady()) {
@@ -168,7 +213,8 @@ void Present() {
         for (uint32_t y = 0; y < g_state.height; ++y) {
             uint32_t* dst = (uint32_t*)(g_state.framebuffer_base + y * g_state.pitch_bytes);
             uint32_t* src = g_state.backbuffer + y * g_state.width;
-            kos::lib::String::memmove(dst, src, g_state.width * 4u);
+            // The framebuffer is never read back: stream past the cache
+            kos::lib::MemOps::StreamCopy(dst, src, g_state.width * 4u);
         }
     } else {
         for (uint32_t y = 0; y < g_state.height; ++y) {
@@ -1,4 +1,5 @@
 #include <input/event_queue.hpp>
+#include <process/poller.hpp>
 
 namespace kos { namespace input {
 
@@ -17,6 +18,7 @@ bool InputEventQueue::Enqueue(const InputEvent& event) {
     write_idx_ = (write_idx_ + 1) % MAX_EVENTS;
     ++count_;
     
+    kos::process::Poller::Notify(kos::process::POLL_SOURCE_INPUT, 0, kos::process::POLL_IN);
     return true;
 }
 
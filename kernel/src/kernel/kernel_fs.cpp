@@ -1,5 +1,6 @@
 #include <kernel/fs.hpp>
 #include <drivers/ata/ata.hpp>
+#include <drivers/block_cache.hpp>
 #include <fs/fat16.hpp>
 #include <fs/fat32.hpp>
 #include <console/logger.hpp>
@@ -18,16 +19,23 @@ static ATADriver g_ata_p0s(ATADriver::Primary, ATADriver::Slave);
 static ATADriver g_ata_p1m(ATADriver::Secondary, ATADriver::Master);
 static ATADriver g_ata_p1s(ATADriver::Secondary, ATADriver::Slave);
 
-static FAT32 g_fs32_p0m(&g_ata_p0m);
-static FAT32 g_fs32_p0s(&g_ata_p0s);
-static FAT32 g_fs32_p1m(&g_ata_p1m);
-static FAT32 g_fs32_p1s(&g_ata_p1s);
+// Filesystems go through a write-back block cache; its buffers are only
+// allocated once a filesystem on that disk first touches it
+static CachedBlockDevice g_cache_p0m(&g_ata_p0m, "Primary Master");
+static CachedBlockDevice g_cache_p0s(&g_ata_p0s, "Primary Slave");
+static CachedBlockDevice g_cache_p1m(&g_ata_p1m, "Secondary Master");
+static CachedBlockDevice g_cache_p1s(&g_ata_p1s, "Secondary Slave");
+
+static FAT32 g_fs32_p0m(&g_cache_p0m);
+static FAT32 g_fs32_p0s(&g_cache_p0s);
+static FAT32 g_fs32_p1m(&g_cache_p1m);
+static FAT32 g_fs32_p1s(&g_cache_p1s);
 
 // Simple FAT16 instances with no pre-known startLBA
-static FAT16 g_fs16_p0m(&g_ata_p0m);
-static FAT16 g_fs16_p0s(&g_ata_p0s);
-static FAT16 g_fs16_p1m(&g_ata_p1m);
-static FAT16 g_fs16_p1s(&g_ata_p1s);
+static FAT16 g_fs16_p0m(&g_cache_p0m);
+static FAT16 g_fs16_p0s(&g_cache_p0s);
+static FAT16 g_fs16_p1m(&g_cache_p1m);
+static FAT16 g_fs16_p1s(&g_cache_p1s);
 
 bool ScanAndMountFilesystems()
 {
@@ -7,7 +7,11 @@
 #include <process/timer.hpp>
 #include <process/pipe.hpp>
 #include <process/message_queue.hpp>
+#include <process/shared_memory.hpp>
+#include <process/workqueue.hpp>
 #include <process/thread_manager.hpp>
+#include <arch/x86/hardware/cpu/fpu.hpp>
+#include <arch/x86/hardware/cpu/features.hpp>
 #include <console/logger.hpp>
 
 // Extern hook to expose timer handler to ServiceManager for uptime profiling
@@ -41,6 +45,14 @@ namespace kos {
             kos::memory::Heap::Init((virt_addr_t)0x02000000, 2);
             Logger::LogStatus("Kernel heap initialized", true);
 
+            // FPU/SSE enable and lazy-switch traps; threads allocate save areas from the heap
+            kos::arch::x86::hardware::cpu::FPU::Initialize(interrupts);
+            Logger::LogStatus("FPU initialized", kos::arch::x86::hardware::cpu::FPU::IsReady());
+
+            // Feature registry; binds every CpuDispatch to its best variant
+            kos::arch::x86::hardware::cpu::CpuFeatures::Detect();
+            Logger::LogStatus("CPU features detected", true);
+
             // Initialize scheduler and timer for preemptive multitasking
             kos::process::g_scheduler = new kos::process::Scheduler();
             kos::process::SchedulerTimerHandler* timer_handler = new kos::process::SchedulerTimerHandler(interrupts, kos::process::g_scheduler);
@@ -56,6 +68,14 @@ namespace kos {
             kos::process::g_message_queue_manager = new kos::process::MessageQueueManager();
             Logger::LogStatus("Message queue manager initialized", true);
 
+            // Named shared memory regions for zero-copy IPC
+            kos::process::g_shm_manager = new kos::process::SharedMemoryManager();
+            Logger::LogStatus("Shared memory manager initialized", true);
+
+            // Deferred work queues; their worker threads start with multitasking
+            kos::process::WorkQueueAPI::Initialize();
+            Logger::LogStatus("Work queues initialized", true);
+
             // Temporary VBox-safe path: defer thread manager bootstrap.
             // Early threading init is currently a boot blocker on some VBox runs
             // (serial log stops around "Thr..."). Keep the kernel progressing so
@@ -39,6 +39,8 @@
 #include <process/pipe.hpp>
 #include <process/thread_manager.hpp>
 #include <process/timer.hpp>
+#include <process/workqueue.hpp>
+#include <process/tls.hpp>
 #include <console/threaded_shell.hpp>
 #include <services/service_manager.hpp>
 #include <services/service_manager.hpp>
@@ -165,6 +167,8 @@ extern "C" void kernelMain(const void* multiboot_structure, uint32_t multiboot_m
     Logger::LogStatus("Initializing core subsystems", true);
 
     GlobalDescriptorTable gdt;
+    // Thread pointer (%gs) for the boot context; must precede any TLS use
+    TLS::Initialize(&gdt);
     // Initialize system API table for apps
     InitSysApi();
     // Initialise power/battery backend — captures APM table from Multiboot1
@@ -218,8 +222,10 @@ extern "C" void kernelMain(const void* multiboot_structure, uint32_t multiboot_m
     // Start the threading system and threaded shell
     ThreadManagerAPI::StartMultitasking();
     Logger::LogStatus("Multitasking environment started", true);
-    // Now that multitasking is active, use a single ServiceManager tick driver per mode:
-    // - Graphics mode: main kernel loop (reliable and already confirmed running)
+    kos::process::WorkQueueAPI::StartWorkers();
+    Logger::LogStatus("Work queue workers started", true);
+    // Now that multitasking is active, run a single ServiceManager event loop per mode:
+    // - Graphics mode: main kernel thread (reliable and already confirmed running)
     // - Text mode: background service-manager thread
     bool mgrStarted = false;
     if (kos::g_display_mode != kos::kernel::DisplayMode::Graphics) {
@@ -246,13 +252,13 @@ extern "C" void kernelMain(const void* multiboot_structure, uint32_t multiboot_m
     }
 
     // Main kernel thread continues to run.
-    // Fallback ticking only: when manager thread is alive, avoid concurrent TickAll().
+    // Host the event loop here unless the manager thread already does.
     boot.Advance(BootStage::Complete);
     boot.LogTimingSummary();
+    if (!mgrStarted) {
+        kos::services::ServiceManager::RunEventLoop(); // Drives GUI, kbd/mouse polling; never returns
+    }
     while(1) {
-        if (!mgrStarted) {
-            kos::services::ServiceManager::TickAll();
-        }
-        SchedulerAPI::SleepThread(16); // ~60 Hz — drives GUI, kbd/mouse polling
+        SchedulerAPI::SleepThread(1000);
     }
 }
@@ -5,6 +5,8 @@
 #include <memory/pmm.hpp>
 #include <memory/paging.hpp>
 #include <common/panic.hpp>
+#include <process/tls.hpp>
+#include <fs/file_table.hpp>
 
 using namespace kos::lib;
 using namespace kos::common;
@@ -40,6 +42,7 @@ struct Elf32_Phdr {
 };
 
 static const uint32_t PT_LOAD = 1;
+static const uint32_t PT_TLS = 7;
 static const uint16_t EM_386 = 3;
 
 bool ELFLoader::LoadAndExecute(const uint8_t* image, uint32_t size) {
@@ -203,6 +206,23 @@ bool ELFLoader::LoadAndExecute(const uint8_t* image, uint32_t size) {
     }
     if (!entryOK) { TTY::Write((int8_t*)"ELF: entry not in PT_LOAD\n"); return false; }
 
+    // __thread data: the app runs on the caller's thread, so its PT_TLS block
+    // goes below that thread's pointer; a calling app's block is put back after
+    const Elf32_Phdr* tls = 0;
+    for (uint16_t i = 0; i < eh->e_phnum; ++i) {
+        if (ph[i].p_type == PT_TLS) { tls = &ph[i]; break; }
+    }
+    void* savedTls = 0;
+    if (tls) {
+        if (tls->p_offset + tls->p_filesz > size) { TTY::Write((int8_t*)"ELF: TLS segment exceeds image\n"); return false; }
+        savedTls = kos::process::TLS::SaveStatic();
+        if (!kos::process::TLS::LoadStaticImage(image + tls->p_offset, tls->p_filesz, tls->p_memsz, tls->p_align)) {
+            kos::process::TLS::RestoreStatic(savedTls);
+            TTY::Write((int8_t*)"ELF: TLS segment too large or misaligned\n");
+            return false;
+        }
+    }
+
     // Ensure all new mappings are visible to the CPU
     Paging::FlushAll();
 
@@ -277,9 +297,14 @@ bool ELFLoader::LoadAndExecute(const uint8_t* image, uint32_t size) {
     int (*entry)() = (int (*)())entryVA;
     // Transfer control to program entry and execute
     if (entry) {
+        uint32_t fdMark = kos::fs::FileAPI::Mark();
         (void)entry();
+        // Descriptors the app left open die with it
+        kos::fs::FileAPI::CloseSince(fdMark);
+        if (tls) kos::process::TLS::RestoreStatic(savedTls);
         return true;
     }
+    if (tls) kos::process::TLS::RestoreStatic(savedTls);
     TTY::Write((int8_t*)"ELF: null entry\n");
     return false;
 }
\ No newline at end of file
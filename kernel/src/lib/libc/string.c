@@ -1,30 +1,95 @@
 // C-only implementations of minimal string/memory functions for applications.
 #include <lib/libc/string.h>
 
-void* memcpy(void* dest, const void* src, size_t n) {
-    unsigned char*       d = (unsigned char*)dest;
-    const unsigned char* s = (const unsigned char*)src;
-    for (size_t i = 0; i < n; ++i) {
-        d[i] = s[i];
-    }
+// Word-at-a-time cores (rep movsl/stosl plus a byte tail), plain i386 so
+// apps share them. Everything goes through string instructions: gcc may turn
+// a byte loop in here back into a call to memcpy/memset.
+void* kos_memcpy_words(void* dest, const void* src, size_t n) {
+    void* d = dest;
+    const void* s = src;
+    size_t words = n >> 2;
+    __asm__ __volatile__("cld\n\t"
+                         "rep movsl\n\t"
+                         "movl %3, %%ecx\n\t"
+                         "rep movsb"
+                         : "+D"(d), "+S"(s), "+c"(words)
+                         : "r"(n & 3)
+                         : "memory", "cc");
     return dest;
 }
 
+void* kos_memset_words(void* s, int c, size_t n) {
+    void* d = s;
+    size_t words = n >> 2;
+    unsigned int pattern = (unsigned int)(unsigned char)c * 0x01010101u;
+    __asm__ __volatile__("cld\n\t"
+                         "rep stosl\n\t"
+                         "movl %3, %%ecx\n\t"
+                         "rep stosb"
+                         : "+D"(d), "+c"(words)
+                         : "a"(pattern), "r"(n & 3)
+                         : "memory", "cc");
+    return s;
+}
+
+// Overlapping move with dest above src: walk down with DF set, the odd
+// tail bytes first so the word copy below them stays dword-sized.
+// Interrupts are masked while DF is set: handlers run compiler-generated
+// string ops that assume it is clear.
+static void copy_backward(unsigned char* d, const unsigned char* s, size_t n) {
+    unsigned char* de = d + n - 1;
+    const unsigned char* se = s + n - 1;
+    size_t tail = n & 3;
+    __asm__ __volatile__("pushfl\n\t"
+                         "cli\n\t"
+                         "std\n\t"
+                         "rep movsb\n\t"
+                         "subl $3, %%edi\n\t"
+                         "subl $3, %%esi\n\t"
+                         "movl %3, %%ecx\n\t"
+                         "rep movsl\n\t"
+                         "cld\n\t"
+                         "popfl"
+                         : "+D"(de), "+S"(se), "+c"(tail)
+                         : "r"(n >> 2)
+                         : "memory", "cc");
+}
+
+#ifndef KOS_BUILD_APPS
+// Kernel only: large operations go through these slots, which CpuDispatch
+// rebinds at boot to the best variant for the CPU (lib/memops.cpp)
+void* (*kos_memcpy_fast)(void*, const void*, size_t) = kos_memcpy_words;
+void* (*kos_memset_fast)(void*, int, size_t) = kos_memset_words;
+#define KOS_MEMCPY_LARGE(d, s, n) kos_memcpy_fast((d), (s), (n))
+#define KOS_MEMSET_LARGE(p, c, n) kos_memset_fast((p), (c), (n))
+#else
+#define KOS_MEMCPY_LARGE(d, s, n) kos_memcpy_words((d), (s), (n))
+#define KOS_MEMSET_LARGE(p, c, n) kos_memset_words((p), (c), (n))
+#endif
+
+// Below this the indirect call costs more than any variant saves
+#define KOS_MEM_LARGE_MIN 256
+
+void* memcpy(void* dest, const void* src, size_t n) {
+    if (n >= KOS_MEM_LARGE_MIN) return KOS_MEMCPY_LARGE(dest, src, n);
+    return kos_memcpy_words(dest, src, n);
+}
+
 void* memmove(void* dest, const void* src, size_t n) {
     unsigned char*       d = (unsigned char*)dest;
     const unsigned char* s = (const unsigned char*)src;
     if (d == s || n == 0) {
         return dest;
     }
+    if (d + n <= s || s + n <= d) {
+        return memcpy(dest, src, n);
+    }
     if (d < s) {
-        for (size_t i = 0; i < n; ++i) {
-            d[i] = s[i];
-        }
-    } else {
-        for (size_t i = n; i != 0; --i) {
-            d[i - 1] = s[i - 1];
-        }
+        // Each movsl reads its dword before writing it, so a forward copy is
+        // safe with dest below src whatever the distance
+        return kos_memcpy_words(dest, src, n);
     }
+    copy_backward(d, s, n);
     return dest;
 }
 
@@ -51,12 +116,8 @@ int memcmp(const void* s1, const void* s2, size_t n) {
 }
 
 void* memset(void* s, int c, size_t n) {
-    unsigned char* p = (unsigned char*)s;
-    unsigned char v = (unsigned char)(c & 0xFF);
-    for (size_t i = 0; i < n; ++i) {
-        p[i] = v;
-    }
-    return s;
+    if (n >= KOS_MEM_LARGE_MIN) return KOS_MEMSET_LARGE(s, c, n);
+    return kos_memset_words(s, c, n);
 }
 
 int strcmp(const char* a, const char* b) {
@@ -0,0 +1,178 @@
+// memops.cpp - dispatched memcpy/memset variants and the memory benchmark
+#include <lib/memops.hpp>
+#include <lib/stdio.hpp>
+#include <arch/x86/hardware/cpu/cpu.hpp>
+#include <arch/x86/hardware/cpu/features.hpp>
+#include <arch/x86/hardware/cpu/fpu.hpp>
+#include <process/scheduler.hpp>
+#include <memory/heap.hpp>
+#include <console/tty.hpp>
+
+using namespace kos::lib;
+using namespace kos::console;
+using namespace kos::arch::x86::hardware::cpu;
+
+namespace {
+    typedef void* (*CopyFn)(void*, const void*, size_t);
+    typedef void* (*SetFn)(void*, int, size_t);
+    typedef void (*StreamFn)(void*, const void*, uint32_t);
+
+    // --- ERMS: microcode picks the chunk size, byte ops are the fast path ---
+
+    void* MemcpyErms(void* dest, const void* src, size_t n) {
+        void* d = dest;
+        __asm__ __volatile__("cld; rep movsb" : "+D"(d), "+S"(src), "+c"(n) : : "memory", "cc");
+        return dest;
+    }
+
+    void* MemsetErms(void* s, int c, size_t n) {
+        void* d = s;
+        __asm__ __volatile__("cld; rep stosb" : "+D"(d), "+c"(n) : "a"(c) : "memory", "cc");
+        return s;
+    }
+
+    // --- Non-temporal copy for write-combined targets ---
+
+    typedef long long Vec2i64 __attribute__((vector_size(16)));
+    typedef long long Vec2i64u __attribute__((vector_size(16), may_alias, aligned(1)));
+
+    // Below this the FPU claim and the sfence cost more than streaming saves
+    const uint32_t STREAM_MIN_BYTES = 4096;
+    const uint32_t STREAM_BLOCK = 64;
+
+    // Kept out of line so no XMM use is scheduled outside KernelBegin/End.
+    // dest is 16-byte aligned, n a multiple of STREAM_BLOCK.
+    __attribute__((target("sse2"), noinline))
+    void StreamBlocksSse2(uint8_t* dest, const uint8_t* src, uint32_t n) {
+        for (; n; n -= STREAM_BLOCK, dest += STREAM_BLOCK, src += STREAM_BLOCK) {
+            const Vec2i64u* s = (const Vec2i64u*)src;
+            Vec2i64 a = s[0], b = s[1], c = s[2], d = s[3];
+            __builtin_ia32_movntdq((Vec2i64*)dest, a);
+            __builtin_ia32_movntdq((Vec2i64*)(dest + 16), b);
+            __builtin_ia32_movntdq((Vec2i64*)(dest + 32), c);
+            __builtin_ia32_movntdq((Vec2i64*)(dest + 48), d);
+        }
+        // Non-temporal stores are weakly ordered; drain them before returning
+        __asm__ __volatile__("sfence" : : : "memory");
+    }
+
+    void StreamCopySse2(void* dest, const void* src, uint32_t n) {
+        if (n < STREAM_MIN_BYTES) {
+            kos_memcpy_fast(dest, src, n);
+            return;
+        }
+        uint8_t* d = (uint8_t*)dest;
+        const uint8_t* s = (const uint8_t*)src;
+        uint32_t head = (0u - (uint32_t)d) & 15u;
+        kos_memcpy_words(d, s, head);
+        d += head; s += head; n -= head;
+        uint32_t body = n & ~(STREAM_BLOCK - 1);
+        uint32_t flags = FPU::KernelBegin();
+        StreamBlocksSse2(d, s, body);
+        FPU::KernelEnd(flags);
+        kos_memcpy_words(d + body, s + body, n - body);
+    }
+
+    void StreamCopyPlain(void* dest, const void* src, uint32_t n) {
+        kos_memcpy_fast(dest, src, n);
+    }
+
+    StreamFn s_stream_copy = StreamCopyPlain;
+
+    const CpuVariant s_memcpy_variants[] = {
+        { CPU_FEATURE_ERMS, (void*)&MemcpyErms, "rep-movsb" },
+        { CPU_FEATURE_NONE, (void*)&kos_memcpy_words, "rep-movsl" },
+    };
+    const CpuVariant s_memset_variants[] = {
+        { CPU_FEATURE_ERMS, (void*)&MemsetErms, "rep-stosb" },
+        { CPU_FEATURE_NONE, (void*)&kos_memset_words, "rep-stosl" },
+    };
+    const CpuVariant s_stream_variants[] = {
+        { CPU_FEATURE_SSE2, (void*)&StreamCopySse2, "sse2-movntdq" },
+        { CPU_FEATURE_NONE, (void*)&StreamCopyPlain, "memcpy" },
+    };
+    CpuDispatch s_memcpy_dispatch("memcpy", (void**)&kos_memcpy_fast, s_memcpy_variants, 2);
+    CpuDispatch s_memset_dispatch("memset", (void**)&kos_memset_fast, s_memset_variants, 2);
+    CpuDispatch s_stream_dispatch("memcpy.stream", (void**)&s_stream_copy, s_stream_variants, 2);
+
+    // --- Benchmark ---
+
+    void* StreamBench(void* dest, const void* src, size_t n) {
+        StreamCopySse2(dest, src, n);
+        return dest;
+    }
+
+    struct BenchVariant {
+        const char* op;
+        const char* name;
+        CpuFeature feature;
+        CopyFn copy;
+        SetFn set;
+    };
+
+    const BenchVariant s_bench[] = {
+        { "memcpy", "rep-movsl", CPU_FEATURE_NONE, kos_memcpy_words, nullptr },
+        { "memcpy", "rep-movsb", CPU_FEATURE_ERMS, MemcpyErms, nullptr },
+        { "memcpy", "sse2-movntdq", CPU_FEATURE_SSE2, StreamBench, nullptr },
+        { "memset", "rep-stosl", CPU_FEATURE_NONE, nullptr, kos_memset_words },
+        { "memset", "rep-stosb", CPU_FEATURE_ERMS, nullptr, MemsetErms },
+    };
+    const uint32_t s_bench_sizes[] = { 64, 512, 4096, 65536, 1048576 };
+    const uint32_t BENCH_MAX_SIZE = 1048576;
+    const uint32_t BENCH_BYTES_PER_RUN = 8u * 1048576u;
+    const uint32_t BENCH_MIN_ITERS = 8;
+
+    uint64_t TimeVariant(const BenchVariant& v, uint8_t* dst, const uint8_t* src, uint32_t size, uint32_t iters) {
+        // One untimed pass to warm caches and TLB
+        if (v.copy) v.copy(dst, src, size); else v.set(dst, 0x5A, size);
+        uint64_t start = cpu::ReadTSC();
+        for (uint32_t i = 0; i < iters; ++i) {
+            if (v.copy) v.copy(dst, src, size); else v.set(dst, 0x5A, size);
+        }
+        return cpu::ReadTSC() - start;
+    }
+}
+
+void MemOps::StreamCopy(void* dest, const void* src, uint32_t n) {
+    s_stream_copy(dest, src, n);
+}
+
+void MemOps::Benchmark() {
+    using kos::process::g_scheduler;
+    uint32_t cycles_per_us = g_scheduler ? g_scheduler->GetCyclesPerMicrosecond() : 0;
+    if (!cpu::HasTSC() || !cycles_per_us) {
+        TTY::Write("membench: TSC not calibrated yet\n");
+        return;
+    }
+    uint8_t* src = (uint8_t*)kos::memory::Heap::Alloc(BENCH_MAX_SIZE, 64);
+    uint8_t* dst = (uint8_t*)kos::memory::Heap::Alloc(BENCH_MAX_SIZE, 64);
+    if (!src || !dst) {
+        TTY::Write("membench: out of memory\n");
+        if (src) kos::memory::Heap::Free(src);
+        if (dst) kos::memory::Heap::Free(dst);
+        return;
+    }
+    for (uint32_t i = 0; i < BENCH_MAX_SIZE; ++i) src[i] = (uint8_t)i;
+
+    char line[96];
+    TTY::Write("op      variant        size      GB/s\n");
+    for (uint32_t v = 0; v < sizeof(s_bench) / sizeof(s_bench[0]); ++v) {
+        if (!CpuFeatures::Has(s_bench[v].feature)) continue;
+        for (uint32_t z = 0; z < sizeof(s_bench_sizes) / sizeof(s_bench_sizes[0]); ++z) {
+            uint32_t size = s_bench_sizes[z];
+            uint32_t iters = BENCH_BYTES_PER_RUN / size;
+            if (iters < BENCH_MIN_ITERS) iters = BENCH_MIN_ITERS;
+            uint64_t cycles = TimeVariant(s_bench[v], dst, src, size, iters);
+            if (!cycles) cycles = 1;
+            // Bytes per microsecond is MB/s; show it as GB/s with two decimals
+            uint32_t mbps = (uint32_t)((uint64_t)size * iters * cycles_per_us / cycles);
+            uint32_t frac = (mbps % 1000) / 10;
+            kos::sys::snprintf(line, sizeof(line), "%s  %s  %u  %u.%u%u\n",
+                               s_bench[v].op, s_bench[v].name, size, mbps / 1000, frac / 10, frac % 10);
+            TTY::Write(line);
+        }
+    }
+
+    kos::memory::Heap::Free(src);
+    kos::memory::Heap::Free(dst);
+}
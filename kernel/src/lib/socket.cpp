@@ -1,6 +1,7 @@
 
 #include "lib/socket.hpp"
 #include "lib/string.hpp"
+#include "process/poller.hpp"
 
 using namespace kos::lib;
 
@@ -29,6 +30,16 @@ static InternalSocket* find_socket(int fd) {
     return nullptr;
 }
 
+// Apps link this file too, and pollers only exist in the kernel
+static void notify_pollers(int fd, unsigned events) {
+#ifndef KOS_BUILD_APPS
+    kos::process::Poller::Notify(kos::process::POLL_SOURCE_SOCKET, (uint32_t)fd, events);
+#else
+    (void)fd;
+    (void)events;
+#endif
+}
+
 int Socket::kos_socket(SocketDomain domain, SocketType type, SocketProtocol protocol) {
     if (socket_count >= MAX_SOCKETS) return -1;
     int fd = next_fd++;
@@ -67,6 +78,7 @@ bool Socket::connect(const char* path) {
     if (sock->connected) return false;
     sock->connected = true;
     String::strncpy(reinterpret_cast<int8_t*>(sock->path), reinterpret_cast<const int8_t*>(path), sizeof(sock->path));
+    notify_pollers(socketFd, kos::process::POLL_OUT);
     return true;
 }
 
@@ -77,6 +89,7 @@ void Socket::closeSocket() {
                 socket_table[j] = socket_table[j + 1];
             }
             --socket_count;
+            notify_pollers(socketFd, kos::process::POLL_HUP);
             socketFd = -1;
             break;
         }
@@ -105,6 +118,7 @@ int Socket::send(const char* data, int length) {
     }
     if (!receiver) return -2;
     // Simulate data transfer: in a real kernel, this would enqueue data to the receiver's buffer
+    notify_pollers(receiver->fd, kos::process::POLL_IN);
     return length;
 }
 
@@ -140,6 +154,7 @@ extern "C" int SocketConnectInet(int type /*1=DGRAM,2=STREAM*/, const char* radd
     s.rport = rport;
     String::strncpy(reinterpret_cast<int8_t*>(s.raddr), reinterpret_cast<const int8_t*>(raddr ? raddr : ""), sizeof(s.raddr));
     s.path[0] = '\0';
+    notify_pollers(fd, kos::process::POLL_OUT);
     return fd;
 }
 
@@ -173,3 +188,8 @@ int kos::lib::SocketEnumerate(SocketEnumEntry* out, int max) {
     return n;
 }
 
+unsigned kos::lib::SocketPollState(int fd) {
+    InternalSocket* sock = find_socket(fd);
+    if (!sock) return kos::process::POLL_HUP;
+    return sock->connected ? kos::process::POLL_OUT : 0u;
+}
@@ -91,22 +91,8 @@ uint32_t String::strlen(const int8_t* s){
 }
 
 void* String::memmove(void* dest, const void* src, uint32_t n) {
-    // Implement overlap-safe move similar to C's memmove, using uint32_t length
-    uint8_t*       d = (uint8_t*)dest;
-    const uint8_t* s = (const uint8_t*)src;
-    if (d == s || n == 0) {
-        return dest;
-    }
-    if (d < s) {
-        for (uint32_t i = 0; i < n; ++i) {
-            d[i] = s[i];
-        }
-    } else {
-        for (uint32_t i = n; i != 0; --i) {
-            d[i - 1] = s[i - 1];
-        }
-    }
-    return dest;
+    // Word-based and overlap-safe; see lib/libc/string.c
+    return ::memmove(dest, src, n);
 }
 
 void* String::memchr(const void* s, int c, uint32_t n) {
@@ -132,16 +118,9 @@ int32_t String::memcmp(const void* a, const void* b, uint32_t n) {
 }
 
 void* String::memset(void* s, int c, uint32_t n) {
-    uint8_t* p = (uint8_t*)s;
-    uint8_t v = (uint8_t)(c & 0xFF);
-    for (uint32_t i = 0; i < n; ++i) {
-        p[i] = v;
-    }
-    return s;
+    return ::memset(s, c, n);
 }
 
-
-
 int8_t* String::strncpy(int8_t* dest, const int8_t* src, uint32_t n) {
     uint32_t i = 0;
     for (; i < n - 1 && src[i]; ++i) {
@@ -10,13 +10,28 @@
 #include <memory/paging.hpp>
 #include <arch/x86/hardware/pci/peripheral_component_inter_constants.hpp>
 #include <arch/x86/hardware/rtc/rtc.hpp>
+#include <process/trace.hpp>
+#include <process/tls.hpp>
+#include <process/pipe.hpp>
+#include <process/message_queue.hpp>
+#include <process/poller.hpp>
+#include <process/shared_memory.hpp>
+#include <process/futex.hpp>
+#include <drivers/block_cache.hpp>
+#include <fs/file_table.hpp>
 
 using namespace kos::sys;
 using namespace kos::console;
 using namespace kos::common;
 
 // Use fully qualified name for global filesystem pointer
-static uint32_t g_list_flags = 0; // flags used by listdir_ex
+static uint32_t g_list_flags = 0; // flags used by listdir_ex before TLS is up
+
+// Listing flags belong to the thread running the app, not the whole system
+static void set_list_flags(uint32_t flags) {
+    if (kos::process::ThreadControlBlock* tcb = kos::process::TLS::Current()) tcb->list_flags = flags;
+    else g_list_flags = flags;
+}
 
 // Forward declaration for path normalization used by sys_listdir and sys_chdir
 static void normalize_abs_path(const int8_t* inPath, const int8_t* cwd, int8_t* outBuf, int outSize);
@@ -328,24 +343,24 @@ extern "C" void sys_listdir_ex(const int8_t* path, uint32_t flags) {
     if (!kos::fs::g_fs_ptr) return;
     // Unify: -l implies -a, so include ALL when LONG is set
     if (flags & 1u) flags |= (1u<<1);
-    g_list_flags = flags;
+    set_list_flags(flags);
     int8_t absBuf[160];
     const int8_t* cwd = table()->cwd ? table()->cwd : (const int8_t*)"/";
     const int8_t* use = path && path[0] ? path : cwd;
     normalize_abs_path(use, cwd, absBuf, (int)sizeof(absBuf));
     // Root always lists root
-    if (absBuf[0] == '/' && absBuf[1] == 0) { kos::fs::g_fs_ptr->ListRoot(); g_list_flags = 0; return; }
+    if (absBuf[0] == '/' && absBuf[1] == 0) { kos::fs::g_fs_ptr->ListRoot(); set_list_flags(0); return; }
     // Optional safety: if DirExists says no for '/', still list root
     if (!kos::fs::g_fs_ptr->DirExists(absBuf)) {
-    if (absBuf[0] == '/' && absBuf[1] == 0) { kos::fs::g_fs_ptr->ListRoot(); g_list_flags = 0; return; }
+    if (absBuf[0] == '/' && absBuf[1] == 0) { kos::fs::g_fs_ptr->ListRoot(); set_list_flags(0); return; }
         TTY::Write((const int8_t*)"ls: path not found: ");
         TTY::Write(absBuf);
         TTY::PutChar('\n');
-        g_list_flags = 0;
+        set_list_flags(0);
         return;
     }
     kos::fs::g_fs_ptr->ListDir(absBuf);
-    g_list_flags = 0;
+    set_list_flags(0);
 }
 
 // Read a file into buffer; returns bytes read or -1
@@ -603,9 +618,132 @@ namespace kos { namespace sys {
         table()->cwd = dst;
     }
     // Provide a lightweight accessor so fs code can check listing flags
-    uint32_t CurrentListFlags() { return g_list_flags; }
+    uint32_t CurrentListFlags() {
+        kos::process::ThreadControlBlock* tcb = kos::process::TLS::Current();
+        return tcb ? tcb->list_flags : g_list_flags;
+    }
 }}
 
+extern "C" void sys_trace_mark(const int8_t* label, uint32_t value) {
+    kos::process::Tracer::Mark((const char*)label, value);
+}
+
+extern "C" uint32_t sys_pipe_find(const int8_t* name) {
+    return kos::process::PipeAPI::FindPipe((const char*)name);
+}
+
+extern "C" uint32_t sys_pipe_writev(uint32_t pipe_id, void* vec, uint32_t count, int32_t block) {
+    return kos::process::PipeAPI::WritePipeV(pipe_id, (kos::process::PipeVec*)vec, count, block != 0);
+}
+
+extern "C" uint32_t sys_pipe_readv(uint32_t pipe_id, void* vec, uint32_t count, int32_t block) {
+    return kos::process::PipeAPI::ReadPipeV(pipe_id, (kos::process::PipeVec*)vec, count, block != 0);
+}
+
+extern "C" uint32_t sys_mq_find(const int8_t* name) {
+    return kos::process::MessageQueueAPI::FindQueue((const char*)name);
+}
+
+extern "C" uint32_t sys_mq_send_batch(uint32_t queue_id, const void* entries, uint32_t count, int32_t block) {
+    return kos::process::MessageQueueAPI::SendBatch(queue_id, (const kos::process::MessageBatchEntry*)entries,
+                                                    count, block != 0);
+}
+
+extern "C" uint32_t sys_mq_receive_batch(uint32_t queue_id, void* entries, uint32_t count, int32_t block) {
+    return kos::process::MessageQueueAPI::ReceiveBatch(queue_id, (kos::process::MessageBatchEntry*)entries,
+                                                       count, block != 0);
+}
+
+extern "C" uint32_t sys_poll_create() {
+    return kos::process::PollerAPI::Create();
+}
+
+extern "C" int32_t sys_poll_destroy(uint32_t poller_id) {
+    return kos::process::PollerAPI::Destroy(poller_id) ? 0 : -1;
+}
+
+extern "C" int32_t sys_poll_ctl(uint32_t poller_id, uint32_t op, const void* reg) {
+    return kos::process::PollerAPI::Control(poller_id, op, (const kos::process::PollRegistration*)reg) ? 0 : -1;
+}
+
+extern "C" int32_t sys_poll_wait(uint32_t poller_id, void* out, uint32_t max, int32_t timeout_ms) {
+    return kos::process::PollerAPI::Wait(poller_id, (kos::process::PollEvent*)out, max, timeout_ms);
+}
+
+extern "C" uint32_t sys_shm_create(const int8_t* name, uint32_t size) {
+    return kos::process::SharedMemoryAPI::Create((const char*)name, size);
+}
+
+extern "C" uint32_t sys_shm_open(const int8_t* name) {
+    return kos::process::SharedMemoryAPI::Open((const char*)name);
+}
+
+extern "C" void* sys_shm_map(uint32_t region_id, uint32_t* size_out) {
+    return kos::process::SharedMemoryAPI::Map(region_id, size_out);
+}
+
+extern "C" int32_t sys_shm_unmap(uint32_t region_id) {
+    return kos::process::SharedMemoryAPI::Unmap(region_id) ? 0 : -1;
+}
+
+extern "C" int32_t sys_shm_destroy(uint32_t region_id) {
+    return kos::process::SharedMemoryAPI::Destroy(region_id) ? 0 : -1;
+}
+
+extern "C" int32_t sys_futex_wait(volatile uint32_t* addr, uint32_t expected, int32_t timeout_ms) {
+    return kos::process::Futex::Wait(addr, expected, timeout_ms);
+}
+
+extern "C" uint32_t sys_futex_wake(volatile uint32_t* addr, uint32_t count) {
+    return kos::process::Futex::Wake(addr, count);
+}
+
+extern "C" int32_t sys_sync() {
+    bool ok = !kos::fs::g_fs_ptr || kos::fs::g_fs_ptr->Sync();
+    return (kos::drivers::BlockCacheAPI::SyncAll() && ok) ? 0 : -1;
+}
+
+extern "C" int32_t sys_fs_stats(void* out) {
+    if (!out || !kos::fs::g_fs_ptr) return -1;
+    return kos::fs::g_fs_ptr->GetStats(*(kos::fs::FsStats*)out) ? 0 : -1;
+}
+
+extern "C" int32_t sys_open(const int8_t* path, uint32_t flags) {
+    if (!path || !path[0]) return -1;
+    int8_t absBuf[160];
+    const int8_t* cwd = table()->cwd ? table()->cwd : (const int8_t*)"/";
+    normalize_abs_path(path, cwd, absBuf, (int)sizeof(absBuf));
+    return kos::fs::FileAPI::Open(absBuf, flags);
+}
+
+extern "C" int32_t sys_close(int32_t fd) {
+    return kos::fs::FileAPI::Close(fd);
+}
+
+extern "C" int32_t sys_read(int32_t fd, uint8_t* buf, uint32_t len) {
+    return kos::fs::FileAPI::Read(fd, buf, len);
+}
+
+extern "C" int32_t sys_write(int32_t fd, const uint8_t* buf, uint32_t len) {
+    return kos::fs::FileAPI::Write(fd, buf, len);
+}
+
+extern "C" int32_t sys_pread(int32_t fd, uint8_t* buf, uint32_t len, uint32_t offset) {
+    return kos::fs::FileAPI::PRead(fd, buf, len, offset);
+}
+
+extern "C" int32_t sys_pwrite(int32_t fd, const uint8_t* buf, uint32_t len, uint32_t offset) {
+    return kos::fs::FileAPI::PWrite(fd, buf, len, offset);
+}
+
+extern "C" int32_t sys_seek(int32_t fd, int32_t offset, uint32_t whence) {
+    return kos::fs::FileAPI::Seek(fd, offset, whence);
+}
+
+extern "C" int32_t sys_fsize(int32_t fd) {
+    return kos::fs::FileAPI::Size(fd);
+}
+
 extern "C" void InitSysApi() {
     ApiTable* t = table();
     t->putc = &sys_putc;
@@ -653,4 +791,38 @@ extern "C" void InitSysApi() {
     t->net_list_sockets = &sys_net_list_sockets;
     // Directory enumeration
     t->enumdir = &sys_enumdir;
+    // Scheduler trace markers
+    t->trace_mark = &sys_trace_mark;
+    // Batched pipe and message queue IPC
+    t->pipe_find = &sys_pipe_find;
+    t->pipe_writev = &sys_pipe_writev;
+    t->pipe_readv = &sys_pipe_readv;
+    t->mq_find = &sys_mq_find;
+    t->mq_send_batch = &sys_mq_send_batch;
+    t->mq_receive_batch = &sys_mq_receive_batch;
+    // Readiness multiplexing
+    t->poll_create = &sys_poll_create;
+    t->poll_destroy = &sys_poll_destroy;
+    t->poll_ctl = &sys_poll_ctl;
+    t->poll_wait = &sys_poll_wait;
+    // Shared memory and futexes
+    t->shm_create = &sys_shm_create;
+    t->shm_open = &sys_shm_open;
+    t->shm_map = &sys_shm_map;
+    t->shm_unmap = &sys_shm_unmap;
+    t->shm_destroy = &sys_shm_destroy;
+    t->futex_wait = &sys_futex_wait;
+    t->futex_wake = &sys_futex_wake;
+    // Block cache
+    t->sync = &sys_sync;
+    t->fs_stats = &sys_fs_stats;
+    // File descriptors
+    t->open = &sys_open;
+    t->close = &sys_close;
+    t->read = &sys_read;
+    t->write = &sys_write;
+    t->pread = &sys_pread;
+    t->pwrite = &sys_pwrite;
+    t->seek = &sys_seek;
+    t->fsize = &sys_fsize;
 }
\ No newline at end of file
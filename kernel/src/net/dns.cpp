@@ -8,6 +8,9 @@
 #include <lib/string.hpp>
 #include <lib/syscalls.hpp>
 #include <drivers/net/e1000/e1000_poll.h>
+#ifndef KOS_BUILD_APPS
+#include <process/workqueue.hpp>
+#endif
 
 namespace kos {
 namespace net {
@@ -245,8 +248,11 @@ bool dns_resolve(const char* hostname, uint32_t dns_server_ip,
     // Wait for response (simple polling for now)
     // TODO: Implement proper timeout mechanism
     for (uint32_t i = 0; i < timeout_ms && !g_dns_response_ready; ++i) {
-        // Poll NIC for incoming packets
-        e1000_rx_poll();
+        // Poll NIC for incoming packets, unless the kworker-hi RX work item already does
+#ifndef KOS_BUILD_APPS
+        if (!kos::process::g_highpri_workqueue || !kos::process::g_highpri_workqueue->IsRunning())
+#endif
+            e1000_rx_poll();
         // Simple delay loop (very rough, ~1ms per iteration)
         for (volatile int j = 0; j < 10000; ++j);
     }
@@ -1,4 +1,7 @@
 #include "include/net/nic.hpp"
+#ifndef KOS_BUILD_APPS
+#include <services/service_manager.hpp>
+#endif
 
 static void (*_rx_cb)(const kos::common::uint8_t*, kos::common::uint32_t) = 0;
 static bool (*_tx_fn)(const kos::common::uint8_t*, kos::common::uint32_t) = 0;
@@ -21,6 +24,9 @@ void kos_nic_register_tx(bool (*txfn)(const kos::common::uint8_t* frame, kos::co
 
 void kos_nic_driver_rx(const kos::common::uint8_t* frame, kos::common::uint32_t len) {
     if (_rx_cb) _rx_cb(frame, len);
+#ifndef KOS_BUILD_APPS
+    kos::services::ServiceManager::PostEvent(kos::services::SERVICE_EVENT_NET_RX, len);
+#endif
 }
 
 void kos_nic_set_mac(const kos::common::uint8_t mac[6]) {
@@ -0,0 +1,113 @@
+#include <process/futex.hpp>
+#include <process/scheduler.hpp>
+#include <memory/paging.hpp>
+#include <services/service_manager.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
+
+using namespace kos::process;
+using namespace kos::memory;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
+using kos::arch::x86::hardware::cpu::InterruptsEnabled;
+
+namespace {
+    // Longest single sleep; bounds a Wake that lands just before SleepTask
+    const uint32_t FUTEX_SLICE_MS = 20;
+
+    struct FutexWaiter {
+        phys_addr_t key;
+        uint32_t task_id;           // 0 when waiting from boot context
+        volatile bool woken;
+        bool in_use;
+    };
+
+    FutexWaiter s_waiters[FUTEX_MAX_WAITERS];
+
+    phys_addr_t KeyOf(volatile uint32_t* addr) {
+        phys_addr_t phys = Paging::GetPhys((virt_addr_t)addr);
+        return phys ? phys : (phys_addr_t)addr;
+    }
+
+    // Park the caller for up to ms; returns early on WakeTask or an interrupt
+    void Nap(uint32_t task_id, uint32_t ms) {
+        if (ms > FUTEX_SLICE_MS) ms = FUTEX_SLICE_MS;
+        if (task_id && g_scheduler) {
+            g_scheduler->SleepTask(task_id, ms);
+        } else if (InterruptsEnabled()) {
+            __asm__ __volatile__("hlt");
+        }
+    }
+}
+
+namespace kos::process::Futex {
+
+    int32_t Wait(volatile uint32_t* addr, uint32_t expected, int32_t timeout_ms) {
+        if (!addr || ((uint32_t)addr & 3)) return FUTEX_INVALID;
+
+        uint32_t self = SchedulerAPI::GetCurrentThreadId();
+        phys_addr_t key = KeyOf(addr);
+
+        // Checking the word and queueing must not be split by a Wake
+        uint32_t flags = IrqSave();
+        if (*addr != expected) {
+            IrqRestore(flags);
+            return FUTEX_AGAIN;
+        }
+        FutexWaiter* w = nullptr;
+        for (uint32_t i = 0; i < FUTEX_MAX_WAITERS; ++i) {
+            if (s_waiters[i].in_use) continue;
+            w = &s_waiters[i];
+            w->key = key;
+            w->task_id = self;
+            w->woken = false;
+            w->in_use = true;
+            break;
+        }
+        IrqRestore(flags);
+
+        if (!w) {
+            // Table full: back off once and let the caller re-check
+            Nap(self, FUTEX_SLICE_MS);
+            return FUTEX_WOKEN;
+        }
+
+        uint32_t start = kos::services::ServiceManager::UptimeMs();
+        int32_t result = FUTEX_WOKEN;
+        while (!w->woken) {
+            uint32_t remaining = FUTEX_SLICE_MS;
+            if (timeout_ms >= 0) {
+                uint32_t elapsed = kos::services::ServiceManager::UptimeMs() - start;
+                if (elapsed >= (uint32_t)timeout_ms) {
+                    result = FUTEX_TIMEDOUT;
+                    break;
+                }
+                remaining = (uint32_t)timeout_ms - elapsed;
+            }
+            Nap(self, remaining);
+        }
+
+        flags = IrqSave();
+        // A Wake that raced the timeout still counts as a wakeup
+        if (w->woken) result = FUTEX_WOKEN;
+        w->in_use = false;
+        IrqRestore(flags);
+        return result;
+    }
+
+    uint32_t Wake(volatile uint32_t* addr, uint32_t count) {
+        if (!addr || count == 0) return 0;
+        phys_addr_t key = KeyOf(addr);
+
+        uint32_t woken = 0;
+        uint32_t flags = IrqSave();
+        for (uint32_t i = 0; i < FUTEX_MAX_WAITERS && woken < count; ++i) {
+            FutexWaiter& w = s_waiters[i];
+            if (!w.in_use || w.woken || w.key != key) continue;
+            w.woken = true;
+            if (w.task_id) SchedulerAPI::WakeThread(w.task_id);
+            ++woken;
+        }
+        IrqRestore(flags);
+        return woken;
+    }
+}
@@ -1,27 +1,26 @@
 #include <process/message_queue.hpp>
+#include <process/poller.hpp>
 #include <process/scheduler.hpp>
 #include <process/thread_manager.hpp>
 #include <memory/heap.hpp>
 #include <lib/string.hpp>
 #include <console/logger.hpp>
 #include <console/tty.hpp>
+#include <lib/stdio.hpp>
+#include <arch/x86/hardware/cpu/cpu.hpp>
+#include <services/service_manager.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
 
 using namespace kos::process;
 using namespace kos::memory;
 using namespace kos::lib;
 using namespace kos::console;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
 
 MessageQueueManager* kos::process::g_message_queue_manager = nullptr;
 
 namespace {
-    bool NamesEqual(const char* a, const char* b) {
-        if (!a || !b) return false;
-        uint32_t len_a = strlen(a);
-        uint32_t len_b = strlen(b);
-        if (len_a != len_b) return false;
-        return String::strcmp((const int8_t*)a, (const int8_t*)b, len_a) == 0;
-    }
-
     uint32_t CurrentEndpointId() {
         if (!g_scheduler) return 0;
         Thread* current = g_scheduler->GetCurrentTask();
@@ -34,34 +33,66 @@ namespace {
 
         return current->task_id;
     }
-}
 
-QueueMessage::QueueMessage(uint32_t id, uint32_t sender, uint32_t receiver,
-                           MessageType msg_type, uint32_t size, const void* payload)
-    : message_id(id), sender_id(sender), receiver_id(receiver), type(msg_type),
-      data_size(size), data(nullptr), next(nullptr) {
+    inline void CompilerBarrier() {
+        __asm__ __volatile__("" : : : "memory");
+    }
 
-    if (size > 0 && payload) {
-        data = (uint8_t*)Heap::Alloc(size);
-        if (data) {
-            memcpy(data, payload, size);
-        } else {
-            data_size = 0;
+    // i386 has no cmpxchg/xadd; on the single CPU KOS runs on, a short
+    // interrupts-off section gives the same atomicity
+    inline bool CompareAndSwap(volatile uint32_t* word, uint32_t expected, uint32_t desired) {
+        uint32_t flags = IrqSave();
+        bool swapped = (*word == expected);
+        if (swapped) *word = desired;
+        IrqRestore(flags);
+        return swapped;
+    }
+
+    inline uint32_t FetchAdd(volatile uint32_t* word, uint32_t delta) {
+        uint32_t flags = IrqSave();
+        uint32_t old = *word;
+        *word = old + delta;
+        IrqRestore(flags);
+        return old;
+    }
+
+    uint32_t RoundUpPow2(uint32_t v) {
+        uint32_t p = 2;
+        while (p < v && p < 0x80000000u) p <<= 1;
+        return p;
+    }
+
+    void CopyOut(const QueueSlot* slot, MessageType* out_type, void* buffer, uint32_t buffer_size,
+                 uint32_t* bytes_read, uint32_t* out_sender_id, uint32_t* out_message_id) {
+        uint32_t copy_size = (slot->data_size < buffer_size) ? slot->data_size : buffer_size;
+        if (copy_size > 0 && buffer) {
+            memcpy(buffer, slot->heap_data ? slot->heap_data : slot->inline_data, copy_size);
         }
+        if (bytes_read) *bytes_read = copy_size;
+        if (out_type) *out_type = slot->type;
+        if (out_sender_id) *out_sender_id = slot->sender_id;
+        if (out_message_id) *out_message_id = slot->message_id;
     }
-}
 
-QueueMessage::~QueueMessage() {
-    if (data) {
-        Heap::Free(data);
-        data = nullptr;
+    // Drops the hold GetOrCreateLane() took, on every way out of Enqueue()
+    struct LaneHold {
+        QueueLane* lane;
+        explicit LaneHold(QueueLane* l) : lane(l) {}
+        ~LaneHold() { if (lane) FetchAdd(&lane->users, (uint32_t)-1); }
+    };
+
+    // The slot at the head of a lane holds a published message
+    bool LaneReady(const QueueLane* lane) {
+        if (!lane->slots) return false;
+        uint32_t pos = lane->dequeue_pos;
+        return (int32_t)(lane->slots[pos & lane->mask].sequence - (pos + 1)) >= 0;
     }
 }
 
 MessageQueue::MessageQueue(uint32_t id, const char* queue_name,
                            uint32_t max_msgs, uint32_t max_msg_size)
     : queue_id(id), max_messages(max_msgs), max_message_size(max_msg_size),
-      message_count(0), message_head(nullptr), message_tail(nullptr), next_message_id(1),
+      message_count(0), lane_count(0), lane_capacity(RoundUpPow2(max_msgs)), next_message_id(1),
       is_closed(false), blocking_mode(true) {
 
     int name_len = strlen(queue_name ? queue_name : "");
@@ -71,6 +102,20 @@ MessageQueue::MessageQueue(uint32_t id, const char* queue_name,
     }
     name[name_len] = '\0';
 
+    for (uint32_t i = 0; i < MQ_MAX_LANES; ++i) {
+        lanes[i].receiver_id = 0;
+        lanes[i].users = 0;
+        lanes[i].enqueue_pos = 0;
+        lanes[i].dequeue_pos = 0;
+        lanes[i].mask = 0;
+        lanes[i].slots = nullptr;
+    }
+    if (InitLane(&lanes[0], 0)) {
+        lane_count = 1;
+    } else {
+        Logger::Log("MQ: cannot allocate the shared lane");
+    }
+
     queue_mutex = new Mutex();
     read_cv = new ConditionVariable();
     write_cv = new ConditionVariable();
@@ -80,59 +125,236 @@ MessageQueue::~MessageQueue() {
     Close();
     Flush();
 
+    for (uint32_t i = 0; i < MQ_MAX_LANES; ++i) {
+        if (lanes[i].slots) Heap::Free(lanes[i].slots);
+        lanes[i].slots = nullptr;
+    }
     if (queue_mutex) delete queue_mutex;
     if (read_cv) delete read_cv;
     if (write_cv) delete write_cv;
 }
 
-QueueMessage* MessageQueue::FindMatchingMessage(uint32_t receiver_id, QueueMessage** prev_out) const {
-    QueueMessage* prev = nullptr;
-    QueueMessage* msg = message_head;
+bool MessageQueue::InitLane(QueueLane* lane, uint32_t receiver_id) {
+    QueueSlot* slots = (QueueSlot*)Heap::Alloc(sizeof(QueueSlot) * lane_capacity, 64);
+    if (!slots) return false;
+    for (uint32_t i = 0; i < lane_capacity; ++i) {
+        slots[i].sequence = i;
+        slots[i].heap_data = nullptr;
+    }
+    lane->enqueue_pos = 0;
+    lane->dequeue_pos = 0;
+    lane->mask = lane_capacity - 1;
+    lane->slots = slots;
+    lane->receiver_id = receiver_id;
+    lane->users = 0;
+    return true;
+}
+
+QueueLane* MessageQueue::FindLane(uint32_t receiver_id) const {
+    uint32_t count = lane_count;
+    CompilerBarrier();
+    for (uint32_t i = 1; i < count; ++i) {
+        if (lanes[i].receiver_id == receiver_id) return (QueueLane*)&lanes[i];
+    }
+    return nullptr;
+}
+
+// The lookup and the users bump form one interrupts-off section, so a
+// lane cannot be rebound between them
+QueueLane* MessageQueue::AcquireLane(uint32_t receiver_id) const {
+    uint32_t flags = IrqSave();
+    QueueLane* lane = FindLane(receiver_id);
+    if (lane) lane->users = lane->users + 1;
+    IrqRestore(flags);
+    return lane;
+}
+
+void MessageQueue::ReleaseLane(const QueueLane* lane) {
+    if (lane) FetchAdd(&lane->users, (uint32_t)-1);
+}
+
+QueueLane* MessageQueue::GetOrCreateLane(uint32_t receiver_id) {
+    QueueLane* lane = AcquireLane(receiver_id);
+    if (lane) return lane;
 
-    while (msg) {
-        if (receiver_id == 0 || msg->receiver_id == 0 || msg->receiver_id == receiver_id) {
-            if (prev_out) *prev_out = prev;
-            return msg;
+    LockGuard lock(*queue_mutex);
+    lane = AcquireLane(receiver_id);
+    if (lane) return lane;
+    if (lane_count == 0) return nullptr;
+    if (lane_count < MQ_MAX_LANES) {
+        lane = &lanes[lane_count];
+        if (!InitLane(lane, receiver_id)) return nullptr;
+        lane->users = 1;
+        // Lookups scan up to lane_count without the mutex: publish the lane last
+        CompilerBarrier();
+        lane_count = lane_count + 1;
+        return lane;
+    }
+
+    // Receiver ids are pids and task ids, which only grow; rebind a lane
+    // that has drained and that no sender or receiver is holding
+    uint32_t flags = IrqSave();
+    for (uint32_t i = 1; i < lane_count && !lane; ++i) {
+        QueueLane* candidate = &lanes[i];
+        if (candidate->users || candidate->enqueue_pos != candidate->dequeue_pos) continue;
+        candidate->receiver_id = receiver_id;
+        candidate->users = 1;
+        lane = candidate;
+    }
+    IrqRestore(flags);
+    if (!lane) Logger::LogKV("MQ: out of receiver lanes", name);
+    return lane;
+}
+
+bool MessageQueue::TryReserve() {
+    while (true) {
+        uint32_t count = message_count;
+        if (count >= max_messages) return false;
+        if (CompareAndSwap(&message_count, count, count + 1)) return true;
+    }
+}
+
+void MessageQueue::ReleaseReservation() {
+    FetchAdd(&message_count, (uint32_t)-1);
+}
+
+bool MessageQueue::LanePush(QueueLane* lane, uint32_t sender_id, uint32_t receiver_id, MessageType type,
+                            const void* data, uint32_t size, uint8_t* heap_data) {
+    if (!lane->slots) return false;
+    QueueSlot* slot;
+    uint32_t pos = lane->enqueue_pos;
+    while (true) {
+        slot = &lane->slots[pos & lane->mask];
+        int32_t dif = (int32_t)(slot->sequence - pos);
+        if (dif == 0) {
+            if (CompareAndSwap(&lane->enqueue_pos, pos, pos + 1)) break;
+        } else if (dif < 0) {
+            return false;   // Lane full
+        }
+        pos = lane->enqueue_pos;
+    }
+
+    slot->message_id = FetchAdd(&next_message_id, 1);
+    slot->sender_id = sender_id;
+    slot->receiver_id = receiver_id;
+    slot->type = type;
+    slot->data_size = size;
+    slot->heap_data = heap_data;
+    if (!heap_data && size > 0) memcpy(slot->inline_data, data, size);
+    // Contents before the turn counter; x86 keeps the stores in order
+    CompilerBarrier();
+    slot->sequence = pos + 1;
+    return true;
+}
+
+bool MessageQueue::LanePop(QueueLane* lane, MessageType* out_type, void* buffer, uint32_t buffer_size,
+                           uint32_t* bytes_read, uint32_t* out_sender_id, uint32_t* out_message_id) {
+    if (!lane->slots) return false;
+    QueueSlot* slot;
+    uint32_t pos = lane->dequeue_pos;
+    while (true) {
+        slot = &lane->slots[pos & lane->mask];
+        int32_t dif = (int32_t)(slot->sequence - (pos + 1));
+        if (dif == 0) {
+            if (CompareAndSwap(&lane->dequeue_pos, pos, pos + 1)) break;
+        } else if (dif < 0) {
+            return false;   // Lane empty
         }
-        prev = msg;
-        msg = msg->next;
+        pos = lane->dequeue_pos;
     }
 
-    if (prev_out) *prev_out = nullptr;
-    return nullptr;
+    CompilerBarrier();
+    CopyOut(slot, out_type, buffer, buffer_size, bytes_read, out_sender_id, out_message_id);
+    uint8_t* heap_data = slot->heap_data;
+    slot->heap_data = nullptr;
+    // Hand the slot to the producer one lap ahead
+    CompilerBarrier();
+    slot->sequence = pos + lane->mask + 1;
+    if (heap_data) Heap::Free(heap_data);
+    return true;
+}
+
+bool MessageQueue::LanePeek(const QueueLane* lane, MessageType* out_type, void* buffer, uint32_t buffer_size,
+                            uint32_t* bytes_available, uint32_t* out_sender_id, uint32_t* out_message_id) const {
+    if (!lane->slots) return false;
+    while (true) {
+        uint32_t pos = lane->dequeue_pos;
+        const QueueSlot* slot = &lane->slots[pos & lane->mask];
+        uint32_t seq = slot->sequence;
+        int32_t dif = (int32_t)(seq - (pos + 1));
+        if (dif < 0) return false;
+        if (dif > 0) continue;
+        CompilerBarrier();
+        CopyOut(slot, out_type, buffer, buffer_size, bytes_available, out_sender_id, out_message_id);
+        CompilerBarrier();
+        // A receiver that took the slot meanwhile makes the copy stale
+        if (lane->dequeue_pos == pos && slot->sequence == seq) return true;
+    }
 }
 
 bool MessageQueue::Send(uint32_t sender_id, uint32_t receiver_id, MessageType type,
                         const void* data, uint32_t size, bool block) {
+    if (!Enqueue(sender_id, receiver_id, type, data, size, block, false)) return false;
+    NotifyReceivers();
+    return true;
+}
+
+void MessageQueue::NotifyReceivers() {
+    read_cv->Broadcast();
+    Poller::Notify(POLL_SOURCE_QUEUE, queue_id, POLL_IN);
+    kos::services::ServiceManager::PostEvent(kos::services::SERVICE_EVENT_MESSAGE, queue_id);
+}
+
+bool MessageQueue::Enqueue(uint32_t sender_id, uint32_t receiver_id, MessageType type,
+                           const void* data, uint32_t size, bool block, bool notify_before_wait) {
     if (is_closed) return false;
     if (size > 0 && !data) return false;
     if (size > max_message_size) return false;
 
-    LockGuard lock(*queue_mutex);
+    QueueLane* lane = (receiver_id == 0) ? &lanes[0] : GetOrCreateLane(receiver_id);
+    if (!lane) return false;
+    LaneHold hold(receiver_id ? lane : nullptr);
 
-    while (IsFull()) {
+    // Every lane holds max_messages, so a reserved message always finds a slot
+    while (!TryReserve()) {
         if (!block || is_closed) return false;
-        write_cv->Wait(*queue_mutex);
+        // Messages already queued by this batch must be able to drain
+        if (notify_before_wait) NotifyReceivers();
+        LockGuard lock(*queue_mutex);
+        if (IsFull() && !is_closed) write_cv->Wait(*queue_mutex);
     }
 
-    QueueMessage* msg = new QueueMessage(next_message_id++, sender_id, receiver_id, type, size, data);
-    if (!msg || (size > 0 && !msg->data)) {
-        delete msg;
-        return false;
+    uint8_t* heap_data = nullptr;
+    if (size > MQ_INLINE_PAYLOAD) {
+        heap_data = (uint8_t*)Heap::Alloc(size);
+        if (!heap_data) {
+            ReleaseReservation();
+            return false;
+        }
+        memcpy(heap_data, data, size);
     }
 
-    if (!message_head) {
-        message_head = message_tail = msg;
-    } else {
-        message_tail->next = msg;
-        message_tail = msg;
+    if (!LanePush(lane, sender_id, receiver_id, type, data, size, heap_data)) {
+        if (heap_data) Heap::Free(heap_data);
+        ReleaseReservation();
+        return false;
     }
-
-    message_count++;
-    read_cv->Broadcast();
     return true;
 }
 
+uint32_t MessageQueue::SendBatch(uint32_t sender_id, const MessageBatchEntry* entries,
+                                 uint32_t count, bool block) {
+    if (!entries) return 0;
+
+    uint32_t sent = 0;
+    for (; sent < count; ++sent) {
+        const MessageBatchEntry& e = entries[sent];
+        if (!Enqueue(sender_id, e.receiver_id, e.type, e.data, e.size, block, sent > 0)) break;
+    }
+    if (sent) NotifyReceivers();
+    return sent;
+}
+
 bool MessageQueue::Receive(uint32_t receiver_id, MessageType* out_type,
                            void* buffer, uint32_t buffer_size, uint32_t* bytes_read,
                            uint32_t* out_sender_id, uint32_t* out_message_id,
@@ -140,44 +362,62 @@ bool MessageQueue::Receive(uint32_t receiver_id, MessageType* out_type,
     if (is_closed) return false;
     if (!buffer || buffer_size == 0) return false;
 
-    LockGuard lock(*queue_mutex);
-
-    QueueMessage* prev = nullptr;
-    QueueMessage* msg = FindMatchingMessage(receiver_id, &prev);
+    if (!Take(receiver_id, out_type, buffer, buffer_size, bytes_read, out_sender_id, out_message_id, block)) {
+        if (bytes_read) *bytes_read = 0;
+        return false;
+    }
+    write_cv->Signal();
+    Poller::Notify(POLL_SOURCE_QUEUE, queue_id, POLL_OUT);
+    return true;
+}
 
-    while (!msg) {
-        if (!block || is_closed) {
-            if (bytes_read) *bytes_read = 0;
-            return false;
+uint32_t MessageQueue::ReceiveBatch(uint32_t receiver_id, MessageBatchEntry* entries,
+                                    uint32_t count, bool block) {
+    if (!entries || is_closed) return 0;
+
+    uint32_t got = 0;
+    for (; got < count; ++got) {
+        MessageBatchEntry& e = entries[got];
+        e.length = 0;
+        if (!e.data || e.size == 0) break;
+        // Only the first message may wait; the rest are taken if already queued
+        if (!Take(receiver_id, &e.type, e.data, e.size, &e.length, &e.sender_id, &e.message_id,
+                  block && got == 0)) {
+            break;
         }
-        read_cv->Wait(*queue_mutex);
-        msg = FindMatchingMessage(receiver_id, &prev);
     }
-
-    uint32_t copy_size = (msg->data_size < buffer_size) ? msg->data_size : buffer_size;
-    if (copy_size > 0 && msg->data) {
-        memcpy(buffer, msg->data, copy_size);
+    if (got) {
+        write_cv->Broadcast();
+        Poller::Notify(POLL_SOURCE_QUEUE, queue_id, POLL_OUT);
     }
+    return got;
+}
 
-    if (bytes_read) *bytes_read = copy_size;
-    if (out_type) *out_type = msg->type;
-    if (out_sender_id) *out_sender_id = msg->sender_id;
-    if (out_message_id) *out_message_id = msg->message_id;
+bool MessageQueue::Take(uint32_t receiver_id, MessageType* out_type,
+                        void* buffer, uint32_t buffer_size, uint32_t* bytes_read,
+                        uint32_t* out_sender_id, uint32_t* out_message_id, bool block) {
+    while (true) {
+        bool got = false;
+        if (receiver_id != 0) {
+            QueueLane* own = AcquireLane(receiver_id);
+            got = (own && LanePop(own, out_type, buffer, buffer_size, bytes_read, out_sender_id, out_message_id)) ||
+                  LanePop(&lanes[0], out_type, buffer, buffer_size, bytes_read, out_sender_id, out_message_id);
+            ReleaseLane(own);
+        } else {
+            uint32_t count = lane_count;
+            for (uint32_t i = 0; i < count && !got; ++i) {
+                got = LanePop(&lanes[i], out_type, buffer, buffer_size, bytes_read, out_sender_id, out_message_id);
+            }
+        }
+        if (got) {
+            ReleaseReservation();
+            return true;
+        }
 
-    if (prev) {
-        prev->next = msg->next;
-    } else {
-        message_head = msg->next;
-    }
-    if (message_tail == msg) {
-        message_tail = prev;
+        if (!block || is_closed) return false;
+        LockGuard lock(*queue_mutex);
+        read_cv->Wait(*queue_mutex);
     }
-
-    message_count--;
-    delete msg;
-
-    write_cv->Signal();
-    return true;
 }
 
 bool MessageQueue::Peek(uint32_t receiver_id, MessageType* out_type,
@@ -186,25 +426,33 @@ bool MessageQueue::Peek(uint32_t receiver_id, MessageType* out_type,
     if (is_closed) return false;
     if (!buffer || buffer_size == 0) return false;
 
-    LockGuard lock(*queue_mutex);
-
-    QueueMessage* msg = FindMatchingMessage(receiver_id, nullptr);
-    if (!msg) {
-        if (bytes_available) *bytes_available = 0;
-        return false;
-    }
-
-    uint32_t copy_size = (msg->data_size < buffer_size) ? msg->data_size : buffer_size;
-    if (copy_size > 0 && msg->data) {
-        memcpy(buffer, msg->data, copy_size);
+    if (receiver_id != 0) {
+        const QueueLane* own = AcquireLane(receiver_id);
+        bool found = own && LanePeek(own, out_type, buffer, buffer_size, bytes_available, out_sender_id, out_message_id);
+        ReleaseLane(own);
+        if (found) return true;
+        if (LanePeek(&lanes[0], out_type, buffer, buffer_size, bytes_available, out_sender_id, out_message_id)) {
+            return true;
+        }
+    } else {
+        uint32_t count = lane_count;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (LanePeek(&lanes[i], out_type, buffer, buffer_size, bytes_available, out_sender_id, out_message_id)) {
+                return true;
+            }
+        }
     }
 
-    if (bytes_available) *bytes_available = copy_size;
-    if (out_type) *out_type = msg->type;
-    if (out_sender_id) *out_sender_id = msg->sender_id;
-    if (out_message_id) *out_message_id = msg->message_id;
+    if (bytes_available) *bytes_available = 0;
+    return false;
+}
 
-    return true;
+bool MessageQueue::HasMessageFor(uint32_t receiver_id) const {
+    if (receiver_id == 0) return !IsEmpty();
+    const QueueLane* own = AcquireLane(receiver_id);
+    bool ready = own && LaneReady(own);
+    ReleaseLane(own);
+    return ready || LaneReady(&lanes[0]);
 }
 
 void MessageQueue::Close() {
@@ -212,20 +460,20 @@ void MessageQueue::Close() {
     is_closed = true;
     read_cv->Broadcast();
     write_cv->Broadcast();
+    Poller::Notify(POLL_SOURCE_QUEUE, queue_id, POLL_HUP);
 }
 
 void MessageQueue::Flush() {
     LockGuard lock(*queue_mutex);
 
-    while (message_head) {
-        QueueMessage* msg = message_head;
-        message_head = message_head->next;
-        delete msg;
+    uint32_t count = lane_count;
+    for (uint32_t i = 0; i < count; ++i) {
+        while (LanePop(&lanes[i], nullptr, nullptr, 0, nullptr, nullptr, nullptr)) {
+            ReleaseReservation();
+        }
     }
-
-    message_tail = nullptr;
-    message_count = 0;
     write_cv->Broadcast();
+    Poller::Notify(POLL_SOURCE_QUEUE, queue_id, POLL_OUT);
 }
 
 void MessageQueue::PrintInfo() const {
@@ -239,48 +487,82 @@ void MessageQueue::PrintInfo() const {
     TTY::WriteHex(max_messages);
     TTY::Write(" MaxMsgSize: ");
     TTY::WriteHex(max_message_size);
+    TTY::Write(" Lanes: ");
+    TTY::WriteHex(lane_count);
     TTY::Write(is_closed ? " [CLOSED]" : " [OPEN]");
     TTY::Write(blocking_mode ? " [BLOCKING]" : " [NON-BLOCKING]");
     TTY::Write("\n");
 }
 
-MessageQueueManager::MessageQueueManager() : queue_count(0), next_queue_id(1) {
-    for (int i = 0; i < 64; ++i) {
-        queues[i] = nullptr;
+void MessageQueue::Benchmark() {
+    using namespace kos::arch::x86::hardware;
+    if (!cpu::cpu::HasTSC()) {
+        TTY::Write("mqbench: no TSC\n");
+        return;
+    }
+
+    const uint32_t rounds = 4096;
+    const uint32_t sizes[] = { 16, MQ_INLINE_PAYLOAD, 256 };
+    uint8_t out[256];
+    uint8_t in[256];
+    for (uint32_t i = 0; i < sizeof(out); ++i) out[i] = (uint8_t)i;
+
+    char line[80];
+    TTY::Write("size  send  receive  (cycles/op)\n");
+    MessageQueue queue(0, "mqbench", 64, 256);
+    for (uint32_t z = 0; z < sizeof(sizes) / sizeof(sizes[0]); ++z) {
+        uint32_t size = sizes[z];
+        uint64_t send_cycles = 0;
+        uint64_t recv_cycles = 0;
+        uint32_t done = 0;
+        for (; done < rounds; ++done) {
+            uint32_t got = 0;
+            uint64_t t0 = cpu::cpu::ReadTSC();
+            bool sent = queue.Send(1, 0, MSG_TYPE_GENERIC, out, size, false);
+            uint64_t t1 = cpu::cpu::ReadTSC();
+            bool received = sent && queue.Receive(0, nullptr, in, sizeof(in), &got, nullptr, nullptr, false);
+            uint64_t t2 = cpu::cpu::ReadTSC();
+            if (!received) break;
+            send_cycles += t1 - t0;
+            recv_cycles += t2 - t1;
+        }
+        if (!done) done = 1;
+        kos::sys::snprintf(line, sizeof(line), "%u  %u  %u\n",
+                           size, (uint32_t)(send_cycles / done), (uint32_t)(recv_cycles / done));
+        TTY::Write(line);
     }
-    manager_mutex = new Mutex();
+}
+
+MessageQueueManager::MessageQueueManager() {
+    manager_lock = new RwLock();
     Logger::Log("Message queue manager initialized");
 }
 
 MessageQueueManager::~MessageQueueManager() {
     CloseAllQueues();
-    if (manager_mutex) delete manager_mutex;
+    if (manager_lock) delete manager_lock;
 }
 
 MessageQueue* MessageQueueManager::CreateQueue(const char* name, uint32_t max_messages,
                                                uint32_t max_message_size) {
-    if (!name || queue_count >= 64 || max_messages == 0 || max_message_size == 0) return nullptr;
+    if (!name || max_messages == 0 || max_message_size == 0) return nullptr;
 
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*manager_lock);
 
-    if (FindQueueIndex(name) >= 0) {
+    if (queues.Find(name)) {
         return nullptr;
     }
 
-    int slot = -1;
-    for (int i = 0; i < 64; ++i) {
-        if (!queues[i]) {
-            slot = i;
-            break;
-        }
-    }
-    if (slot < 0) return nullptr;
+    uint32_t id = queues.Reserve();
+    if (!id) return nullptr;
 
-    MessageQueue* queue = new MessageQueue(next_queue_id++, name, max_messages, max_message_size);
-    if (!queue) return nullptr;
+    MessageQueue* queue = new MessageQueue(id, name, max_messages, max_message_size);
+    if (!queue || !queues.Publish(id, queue, queue->GetName())) {
+        delete queue;
+        queues.Release(id);
+        return nullptr;
+    }
 
-    queues[slot] = queue;
-    queue_count++;
     if (Logger::IsDebugEnabled()) {
         Logger::Log("Created message queue");
     }
@@ -288,14 +570,13 @@ MessageQueue* MessageQueueManager::CreateQueue(const char* name, uint32_t max_me
 }
 
 bool MessageQueueManager::DestroyQueue(uint32_t queue_id) {
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*manager_lock);
 
-    int index = FindQueueIndex(queue_id);
-    if (index < 0) return false;
+    MessageQueue* queue = (MessageQueue*)queues.Find(queue_id);
+    if (!queue) return false;
 
-    delete queues[index];
-    queues[index] = nullptr;
-    queue_count--;
+    queues.Release(queue_id);
+    delete queue;
     Logger::Log("Destroyed message queue");
     return true;
 }
@@ -303,73 +584,54 @@ bool MessageQueueManager::DestroyQueue(uint32_t queue_id) {
 bool MessageQueueManager::DestroyQueue(const char* name) {
     if (!name) return false;
 
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*manager_lock);
 
-    int index = FindQueueIndex(name);
-    if (index < 0) return false;
+    uint32_t id = queues.FindId(name);
+    if (!id) return false;
 
-    delete queues[index];
-    queues[index] = nullptr;
-    queue_count--;
+    MessageQueue* queue = (MessageQueue*)queues.Find(id);
+    queues.Release(id);
+    delete queue;
     Logger::Log("Destroyed message queue");
     return true;
 }
 
 MessageQueue* MessageQueueManager::FindQueue(uint32_t queue_id) const {
-    int index = FindQueueIndex(queue_id);
-    return (index >= 0) ? queues[index] : nullptr;
+    ReadLockGuard lock(*manager_lock);
+    return (MessageQueue*)queues.Find(queue_id);
 }
 
 MessageQueue* MessageQueueManager::FindQueue(const char* name) const {
     if (!name) return nullptr;
 
-    int index = FindQueueIndex(name);
-    return (index >= 0) ? queues[index] : nullptr;
-}
-
-int MessageQueueManager::FindQueueIndex(uint32_t queue_id) const {
-    for (int i = 0; i < 64; ++i) {
-        if (queues[i] && queues[i]->GetId() == queue_id) {
-            return i;
-        }
-    }
-    return -1;
-}
-
-int MessageQueueManager::FindQueueIndex(const char* name) const {
-    if (!name) return -1;
-
-    for (int i = 0; i < 64; ++i) {
-        if (queues[i] && NamesEqual(queues[i]->GetName(), name)) {
-            return i;
-        }
-    }
-    return -1;
+    ReadLockGuard lock(*manager_lock);
+    return (MessageQueue*)queues.Find(name);
 }
 
 void MessageQueueManager::CloseAllQueues() {
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*manager_lock);
 
-    for (int i = 0; i < 64; ++i) {
-        if (queues[i]) {
-            delete queues[i];
-            queues[i] = nullptr;
+    for (uint32_t i = 0; i < queues.SlotCount(); ++i) {
+        MessageQueue* queue = (MessageQueue*)queues.At(i);
+        if (queue) {
+            queues.Release(queues.IdAt(i));
+            delete queue;
         }
     }
-    queue_count = 0;
 }
 
 void MessageQueueManager::PrintAllQueues() const {
-    LockGuard lock(*manager_mutex);
+    ReadLockGuard lock(*manager_lock);
 
     TTY::Write("=== Message Queue Manager ===\n");
     TTY::Write("Active queues: ");
-    TTY::WriteHex(queue_count);
-    TTY::Write("/64\n");
+    TTY::WriteHex(queues.GetCount());
+    TTY::Write("\n");
 
-    for (int i = 0; i < 64; ++i) {
-        if (queues[i]) {
-            queues[i]->PrintInfo();
+    for (uint32_t i = 0; i < queues.SlotCount(); ++i) {
+        MessageQueue* queue = (MessageQueue*)queues.At(i);
+        if (queue) {
+            queue->PrintInfo();
         }
     }
 }
@@ -426,6 +688,24 @@ namespace kos::process::MessageQueueAPI {
                               bytes_read, out_sender_id, out_message_id, block);
     }
 
+    uint32_t SendBatch(uint32_t queue_id, const MessageBatchEntry* entries, uint32_t count, bool block) {
+        if (!g_message_queue_manager) return 0;
+
+        MessageQueue* queue = g_message_queue_manager->FindQueue(queue_id);
+        if (!queue) return 0;
+
+        return queue->SendBatch(CurrentEndpointId(), entries, count, block);
+    }
+
+    uint32_t ReceiveBatch(uint32_t queue_id, MessageBatchEntry* entries, uint32_t count, bool block) {
+        if (!g_message_queue_manager) return 0;
+
+        MessageQueue* queue = g_message_queue_manager->FindQueue(queue_id);
+        if (!queue) return 0;
+
+        return queue->ReceiveBatch(CurrentEndpointId(), entries, count, block);
+    }
+
     bool Receive(const char* name, MessageType* out_type,
                  void* buffer, uint32_t buffer_size, uint32_t* bytes_read,
                  uint32_t* out_sender_id, uint32_t* out_message_id,
@@ -0,0 +1,182 @@
+#include <process/object_table.hpp>
+#include <memory/heap.hpp>
+#include <lib/string.hpp>
+
+using namespace kos::process;
+using namespace kos::memory;
+using namespace kos::lib;
+
+namespace {
+    const uint32_t BUCKET_DELETED = 0xFFFFFFFFu;
+    const uint32_t MIN_SLOTS = 16;
+    const uint32_t MIN_BUCKETS = 16;
+
+    // FNV-1a
+    uint32_t HashName(const char* name) {
+        uint32_t h = 2166136261u;
+        while (*name) {
+            h ^= (uint8_t)*name++;
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    bool NamesEqual(const char* a, const char* b) {
+        while (*a && *a == *b) {
+            ++a;
+            ++b;
+        }
+        return *a == *b;
+    }
+}
+
+ObjectTable::ObjectTable()
+    : slots(nullptr), slot_count(0), free_head(0), object_count(0),
+      buckets(nullptr), bucket_mask(0), bucket_used(0) {
+}
+
+ObjectTable::~ObjectTable() {
+    if (slots) Heap::Free(slots);
+    if (buckets) Heap::Free(buckets);
+}
+
+bool ObjectTable::GrowSlots() {
+    uint32_t capacity = slot_count ? slot_count * 2 : MIN_SLOTS;
+    if (capacity > OBJECT_INDEX_MASK) capacity = OBJECT_INDEX_MASK;
+    if (capacity <= slot_count) return false;
+
+    Slot* grown = (Slot*)Heap::Alloc(sizeof(Slot) * capacity);
+    if (!grown) return false;
+    if (slots) {
+        String::memmove(grown, slots, sizeof(Slot) * slot_count);
+        Heap::Free(slots);
+    }
+    // Thread the new slots onto the free list so the lowest index goes first
+    for (uint32_t i = capacity; i > slot_count; --i) {
+        Slot& s = grown[i - 1];
+        s.object = nullptr;
+        s.name = nullptr;
+        s.hash = 0;
+        s.generation = 0;
+        s.reserved = false;
+        s.next_free = free_head;
+        free_head = i;
+    }
+    slots = grown;
+    slot_count = capacity;
+    return true;
+}
+
+ObjectTable::Slot* ObjectTable::SlotFor(uint32_t id) const {
+    uint32_t index = id & OBJECT_INDEX_MASK;
+    if (index == 0 || index > slot_count) return nullptr;
+    Slot* s = &slots[index - 1];
+    if (s->generation != (id >> OBJECT_INDEX_BITS)) return nullptr;
+    return s;
+}
+
+uint32_t ObjectTable::Reserve() {
+    if (!free_head && !GrowSlots()) return 0;
+    uint32_t index = free_head - 1;
+    Slot& s = slots[index];
+    free_head = s.next_free;
+    s.object = nullptr;
+    s.name = nullptr;
+    s.reserved = true;
+    return (s.generation << OBJECT_INDEX_BITS) | (index + 1);
+}
+
+bool ObjectTable::Publish(uint32_t id, void* object, const char* name) {
+    Slot* s = SlotFor(id);
+    if (!s || !s->reserved || s->object || !object || !name) return false;
+
+    // Keep probe chains short: rebuild past 3/4 full (tombstones count),
+    // doubling while live names would still fill half the table
+    uint32_t capacity = bucket_mask + 1;
+    if (!buckets || (bucket_used + 1) * 4 > capacity * 3) {
+        uint32_t target = MIN_BUCKETS;
+        while (target < (object_count + 1) * 2) target <<= 1;
+        if (!RebuildBuckets(target)) return false;
+    }
+
+    s->object = object;
+    s->name = name;
+    s->hash = HashName(name);
+    object_count++;
+    InsertBucket((uint32_t)(s - slots));
+    return true;
+}
+
+void ObjectTable::Release(uint32_t id) {
+    Slot* s = SlotFor(id);
+    if (!s || !s->reserved) return;
+
+    if (s->object) {
+        uint32_t* bucket = FindBucket(s->name, s->hash);
+        if (bucket) *bucket = BUCKET_DELETED;
+        object_count--;
+    }
+    s->object = nullptr;
+    s->name = nullptr;
+    s->reserved = false;
+    s->generation = (s->generation + 1) & OBJECT_GENERATION_MASK;
+    s->next_free = free_head;
+    free_head = (uint32_t)(s - slots) + 1;
+}
+
+void* ObjectTable::Find(uint32_t id) const {
+    Slot* s = SlotFor(id);
+    return s ? s->object : nullptr;
+}
+
+void* ObjectTable::Find(const char* name) const {
+    if (!name) return nullptr;
+    uint32_t* bucket = FindBucket(name, HashName(name));
+    return bucket ? slots[*bucket - 1].object : nullptr;
+}
+
+uint32_t ObjectTable::FindId(const char* name) const {
+    if (!name) return 0;
+    uint32_t* bucket = FindBucket(name, HashName(name));
+    return bucket ? IdAt(*bucket - 1) : 0;
+}
+
+uint32_t ObjectTable::IdAt(uint32_t index) const {
+    if (index >= slot_count || !slots[index].object) return 0;
+    return (slots[index].generation << OBJECT_INDEX_BITS) | (index + 1);
+}
+
+bool ObjectTable::RebuildBuckets(uint32_t capacity) {
+    uint32_t* fresh = (uint32_t*)Heap::Alloc(sizeof(uint32_t) * capacity);
+    if (!fresh) return false;
+    String::memset(fresh, 0, sizeof(uint32_t) * capacity);
+    if (buckets) Heap::Free(buckets);
+    buckets = fresh;
+    bucket_mask = capacity - 1;
+    bucket_used = 0;
+    for (uint32_t i = 0; i < slot_count; ++i) {
+        if (slots[i].object) InsertBucket(i);
+    }
+    return true;
+}
+
+void ObjectTable::InsertBucket(uint32_t index) {
+    uint32_t i = slots[index].hash & bucket_mask;
+    while (buckets[i] && buckets[i] != BUCKET_DELETED) i = (i + 1) & bucket_mask;
+    if (!buckets[i]) bucket_used++;
+    buckets[i] = index + 1;
+}
+
+uint32_t* ObjectTable::FindBucket(const char* name, uint32_t hash) const {
+    if (!buckets) return nullptr;
+    // The load limit guarantees an empty bucket ends every probe
+    uint32_t i = hash & bucket_mask;
+    while (uint32_t v = buckets[i]) {
+        if (v != BUCKET_DELETED) {
+            const Slot& s = slots[v - 1];
+            if (s.hash == hash && NamesEqual(s.name, name)) return &buckets[i];
+        }
+        i = (i + 1) & bucket_mask;
+    }
+    return nullptr;
+}
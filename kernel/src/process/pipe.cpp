@@ -1,9 +1,12 @@
 #include <process/pipe.hpp>
+#include <process/poller.hpp>
 #include <process/scheduler.hpp>
 #include <memory/heap.hpp>
 #include <lib/string.hpp>
 #include <console/logger.hpp>
 #include <console/tty.hpp>
+#include <lib/stdio.hpp>
+#include <arch/x86/hardware/cpu/cpu.hpp>
 
 using namespace kos::process;
 using namespace kos::memory;
@@ -13,6 +16,43 @@ using namespace kos::console;
 // Global pipe manager instance
 PipeManager* kos::process::g_pipe_manager = nullptr;
 
+namespace {
+    const uint32_t STREAM_MIN_CAPACITY = 64;
+
+    inline void CompilerBarrier() {
+        __asm__ __volatile__("" : : : "memory");
+    }
+
+    // Orders an earlier store before a later load, the one reordering x86
+    // allows; i386 has no mfence
+    inline void FullBarrier() {
+        __asm__ __volatile__("lock; addl $0, (%%esp)" : : : "memory", "cc");
+    }
+
+    inline bool TryTake(volatile uint32_t* guard) {
+        uint32_t v = 1;
+        __asm__ __volatile__("xchgl %0, %1" : "+r"(v), "+m"(*guard) : : "memory");
+        return v == 0;
+    }
+
+    inline void Take(volatile uint32_t* guard) {
+        while (!TryTake(guard)) {
+            if (g_scheduler) g_scheduler->Yield();
+        }
+    }
+
+    inline void Drop(volatile uint32_t* guard) {
+        CompilerBarrier();
+        *guard = 0;
+    }
+
+    uint32_t RoundUpPow2(uint32_t v) {
+        uint32_t p = STREAM_MIN_CAPACITY;
+        while (p < v && p < 0x80000000u) p <<= 1;
+        return p;
+    }
+}
+
 // PipeMessage implementation
 
 PipeMessage::PipeMessage(uint32_t sender, uint32_t size, const void* msg_data) 
@@ -37,10 +77,12 @@ PipeMessage::~PipeMessage() {
 
 // Pipe implementation
 
-Pipe::Pipe(uint32_t id, const char* pipe_name, uint32_t buffer_sz, uint32_t max_msgs)
+Pipe::Pipe(uint32_t id, const char* pipe_name, uint32_t buffer_sz, uint32_t max_msgs, PipeMode pipe_mode)
     : pipe_id(id), buffer_size(buffer_sz), current_size(0), max_messages(max_msgs),
       message_count(0), message_queue(nullptr), queue_tail(nullptr),
-      reader_count(0), writer_count(0), is_closed(false), blocking_mode(true) {
+      reader_count(0), writer_count(0), is_closed(false), blocking_mode(true),
+      mode(pipe_mode), ring(nullptr), ring_mask(0), ring_head(0), ring_tail(0),
+      write_guard(0), read_guard(0), writer_waiting(0), reader_waiting(0) {
     
     // Copy pipe name
     int name_len = strlen(pipe_name);
@@ -60,6 +102,19 @@ Pipe::Pipe(uint32_t id, const char* pipe_name, uint32_t buffer_sz, uint32_t max_
     pipe_mutex = new Mutex();
     read_cv = new ConditionVariable();
     write_cv = new ConditionVariable();
+
+    if (mode == PIPE_MODE_STREAM) {
+        uint32_t capacity = RoundUpPow2(buffer_sz);
+        ring = (uint8_t*)Heap::Alloc(capacity, 64);
+        if (ring) {
+            ring_mask = capacity - 1;
+            buffer_size = capacity;
+        } else {
+            // Without a ring the pipe stays usable with message framing
+            Logger::Log("Pipe: stream ring allocation failed, using message mode");
+            mode = PIPE_MODE_MESSAGE;
+        }
+    }
 }
 
 Pipe::~Pipe() {
@@ -69,6 +124,119 @@ Pipe::~Pipe() {
     if (pipe_mutex) delete pipe_mutex;
     if (read_cv) delete read_cv;
     if (write_cv) delete write_cv;
+    if (ring) Heap::Free(ring);
+}
+
+// Stream ring. Each side reads the other's index, copies, and only then
+// publishes its own; x86 keeps stores in order, so a compiler barrier is
+// enough to make the data visible before the index.
+
+uint32_t Pipe::RingWrite(const uint8_t* src, uint32_t size) {
+    uint32_t head = ring_head;
+    uint32_t space = buffer_size - (head - ring_tail);
+    uint32_t n = (size < space) ? size : space;
+    if (n == 0) return 0;
+    uint32_t off = head & ring_mask;
+    uint32_t first = buffer_size - off;
+    if (first > n) first = n;
+    memcpy(ring + off, src, first);
+    if (n > first) memcpy(ring, src + first, n - first);
+    CompilerBarrier();
+    ring_head = head + n;
+    return n;
+}
+
+uint32_t Pipe::RingRead(uint8_t* dst, uint32_t size, bool consume) {
+    uint32_t tail = ring_tail;
+    uint32_t used = ring_head - tail;
+    uint32_t n = (size < used) ? size : used;
+    if (n == 0) return 0;
+    CompilerBarrier();
+    uint32_t off = tail & ring_mask;
+    uint32_t first = buffer_size - off;
+    if (first > n) first = n;
+    memcpy(dst, ring + off, first);
+    if (n > first) memcpy(dst + first, ring, n - first);
+    if (consume) {
+        CompilerBarrier();
+        ring_tail = tail + n;
+    }
+    return n;
+}
+
+// Sleepers announce themselves before re-checking the ring, and the other
+// side publishes its index before looking for sleepers, so a wakeup cannot
+// fall between the two.
+
+void Pipe::WaitForSpace() {
+    LockGuard lock(*pipe_mutex);
+    writer_waiting = 1;
+    FullBarrier();
+    while (RingUsed() >= buffer_size && !is_closed) {
+        write_cv->Wait(*pipe_mutex);
+    }
+    writer_waiting = 0;
+}
+
+void Pipe::WaitForData() {
+    LockGuard lock(*pipe_mutex);
+    reader_waiting = 1;
+    FullBarrier();
+    while (RingUsed() == 0 && !is_closed) {
+        read_cv->Wait(*pipe_mutex);
+    }
+    reader_waiting = 0;
+}
+
+bool Pipe::WriteStream(uint32_t sender_id, const void* data, uint32_t size,
+                       uint32_t* bytes_written, bool block) {
+    if (bytes_written) *bytes_written = 0;
+    if (mode != PIPE_MODE_STREAM || !data || size == 0 || is_closed) return false;
+    if (!CanWrite(sender_id)) return false;
+
+    const uint8_t* src = (const uint8_t*)data;
+    uint32_t done = 0;
+    Take(&write_guard);
+    while (done < size) {
+        uint32_t n = RingWrite(src + done, size - done);
+        if (n) {
+            done += n;
+            FullBarrier();
+            if (reader_waiting) read_cv->Signal();
+            continue;
+        }
+        if (!block || is_closed) break;
+        WaitForSpace();
+    }
+    Drop(&write_guard);
+    if (done) Poller::Notify(POLL_SOURCE_PIPE, pipe_id, POLL_IN);
+
+    if (bytes_written) *bytes_written = done;
+    return block ? (done == size) : (done > 0);
+}
+
+bool Pipe::ReadStream(uint32_t reader_id, void* buffer, uint32_t buffer_size,
+                      uint32_t* bytes_read, bool block) {
+    if (bytes_read) *bytes_read = 0;
+    if (mode != PIPE_MODE_STREAM || !buffer || buffer_size == 0 || is_closed) return false;
+    if (!CanRead(reader_id)) return false;
+
+    uint32_t n = 0;
+    Take(&read_guard);
+    while (true) {
+        n = RingRead((uint8_t*)buffer, buffer_size, true);
+        if (n || !block || is_closed) break;
+        WaitForData();
+    }
+    Drop(&read_guard);
+
+    if (n) {
+        FullBarrier();
+        if (writer_waiting) write_cv->Signal();
+        Poller::Notify(POLL_SOURCE_PIPE, pipe_id, POLL_OUT);
+    }
+    if (bytes_read) *bytes_read = n;
+    return n > 0;
 }
 
 bool Pipe::Write(uint32_t sender_id, const void* data, uint32_t size, bool block) {
@@ -78,6 +246,13 @@ bool Pipe::Write(uint32_t sender_id, const void* data, uint32_t size, bool block
     if (!CanWrite(sender_id)) {
         return false;
     }
+
+    if (mode == PIPE_MODE_STREAM) {
+        // Keep Write's all-or-nothing contract: only the writer adds data,
+        // so space seen here can only grow before RingWrite runs
+        if (!block && (size > buffer_size || buffer_size - RingUsed() < size)) return false;
+        return WriteStream(sender_id, data, size, nullptr, block);
+    }
     
     LockGuard lock(*pipe_mutex);
     
@@ -89,14 +264,22 @@ bool Pipe::Write(uint32_t sender_id, const void* data, uint32_t size, bool block
         write_cv->Wait(*pipe_mutex);
     }
     
-    // Create new message
+    if (!AppendMessage(sender_id, data, size)) return false;
+    
+    // Notify waiting readers
+    read_cv->Signal();
+    Poller::Notify(POLL_SOURCE_PIPE, pipe_id, POLL_IN);
+    
+    return true;
+}
+
+bool Pipe::AppendMessage(uint32_t sender_id, const void* data, uint32_t size) {
     PipeMessage* msg = new PipeMessage(sender_id, size, data);
     if (!msg || !msg->data) {
         delete msg;
         return false;
     }
     
-    // Add to message queue
     if (!message_queue) {
         message_queue = queue_tail = msg;
     } else {
@@ -106,11 +289,131 @@ bool Pipe::Write(uint32_t sender_id, const void* data, uint32_t size, bool block
     
     message_count++;
     current_size += size;
+    return true;
+}
+
+void Pipe::PopMessage(void* buffer, uint32_t buffer_size, uint32_t* bytes_read, uint32_t* sender_id) {
+    PipeMessage* msg = message_queue;
     
-    // Notify waiting readers
-    read_cv->Signal();
+    // Copy data to buffer
+    uint32_t copy_size = (msg->data_size < buffer_size) ? msg->data_size : buffer_size;
+    memcpy(buffer, msg->data, copy_size);
     
-    return true;
+    if (bytes_read) *bytes_read = copy_size;
+    if (sender_id) *sender_id = msg->sender_id;
+    
+    // Remove message from queue
+    message_queue = msg->next;
+    if (!message_queue) {
+        queue_tail = nullptr;
+    }
+    
+    message_count--;
+    current_size -= msg->data_size;
+    
+    delete msg;
+}
+
+uint32_t Pipe::WriteV(uint32_t sender_id, PipeVec* vec, uint32_t count, bool block) {
+    if (!vec || count == 0 || is_closed) return 0;
+    if (!CanWrite(sender_id)) return 0;
+    for (uint32_t i = 0; i < count; ++i) vec[i].transferred = 0;
+
+    uint32_t done = 0;
+    if (mode == PIPE_MODE_STREAM) {
+        Take(&write_guard);
+        for (; done < count; ++done) {
+            PipeVec& v = vec[done];
+            if (!v.data || v.size == 0) break;
+            // Same all-or-nothing rule per element as Write()
+            if (!block && (v.size > buffer_size || buffer_size - RingUsed() < v.size)) break;
+            const uint8_t* src = (const uint8_t*)v.data;
+            while (v.transferred < v.size && !is_closed) {
+                uint32_t n = RingWrite(src + v.transferred, v.size - v.transferred);
+                if (n) {
+                    v.transferred += n;
+                    continue;
+                }
+                // Full: the reader has to hear about what is queued before we sleep
+                FullBarrier();
+                if (reader_waiting) read_cv->Signal();
+                WaitForSpace();
+            }
+            if (v.transferred < v.size) break;
+        }
+        Drop(&write_guard);
+        FullBarrier();
+        if (reader_waiting) read_cv->Signal();
+        if (done) Poller::Notify(POLL_SOURCE_PIPE, pipe_id, POLL_IN);
+        return done;
+    }
+
+    LockGuard lock(*pipe_mutex);
+    for (; done < count; ++done) {
+        PipeVec& v = vec[done];
+        if (!v.data || v.size == 0) break;
+        bool stop = false;
+        while (IsFull()) {
+            if (!block || is_closed) {
+                stop = true;
+                break;
+            }
+            if (done) read_cv->Broadcast();
+            write_cv->Wait(*pipe_mutex);
+        }
+        if (stop || !AppendMessage(sender_id, v.data, v.size)) break;
+        v.transferred = v.size;
+    }
+    // One wakeup for the whole batch
+    if (done) {
+        read_cv->Broadcast();
+        Poller::Notify(POLL_SOURCE_PIPE, pipe_id, POLL_IN);
+    }
+    return done;
+}
+
+uint32_t Pipe::ReadV(uint32_t reader_id, PipeVec* vec, uint32_t count, bool block) {
+    if (!vec || count == 0 || is_closed) return 0;
+    if (!CanRead(reader_id)) return 0;
+    for (uint32_t i = 0; i < count; ++i) vec[i].transferred = 0;
+
+    uint32_t done = 0;
+    if (mode == PIPE_MODE_STREAM) {
+        Take(&read_guard);
+        while (block && RingUsed() == 0 && !is_closed) WaitForData();
+        for (; done < count; ++done) {
+            PipeVec& v = vec[done];
+            if (!v.data || v.size == 0) break;
+            v.transferred = RingRead((uint8_t*)v.data, v.size, true);
+            if (v.transferred == 0) break;
+            if (v.transferred < v.size) {
+                ++done;     // Ring drained part way through this element
+                break;
+            }
+        }
+        Drop(&read_guard);
+        if (done) {
+            FullBarrier();
+            if (writer_waiting) write_cv->Signal();
+            Poller::Notify(POLL_SOURCE_PIPE, pipe_id, POLL_OUT);
+        }
+        return done;
+    }
+
+    LockGuard lock(*pipe_mutex);
+    while (block && IsEmpty() && !is_closed) {
+        read_cv->Wait(*pipe_mutex);
+    }
+    for (; done < count && message_queue; ++done) {
+        PipeVec& v = vec[done];
+        if (!v.data || v.size == 0) break;
+        PopMessage(v.data, v.size, &v.transferred, nullptr);
+    }
+    if (done) {
+        write_cv->Broadcast();
+        Poller::Notify(POLL_SOURCE_PIPE, pipe_id, POLL_OUT);
+    }
+    return done;
 }
 
 bool Pipe::Read(uint32_t reader_id, void* buffer, uint32_t buffer_size, 
@@ -121,6 +424,11 @@ bool Pipe::Read(uint32_t reader_id, void* buffer, uint32_t buffer_size,
     if (!CanRead(reader_id)) {
         return false;
     }
+
+    if (mode == PIPE_MODE_STREAM) {
+        if (sender_id) *sender_id = 0;
+        return ReadStream(reader_id, buffer, buffer_size, bytes_read, block);
+    }
     
     LockGuard lock(*pipe_mutex);
     
@@ -133,39 +441,31 @@ bool Pipe::Read(uint32_t reader_id, void* buffer, uint32_t buffer_size,
         read_cv->Wait(*pipe_mutex);
     }
     
-    // Get first message
-    PipeMessage* msg = message_queue;
-    if (!msg) {
+    if (!message_queue) {
         if (bytes_read) *bytes_read = 0;
         return false;
     }
     
-    // Copy data to buffer
-    uint32_t copy_size = (msg->data_size < buffer_size) ? msg->data_size : buffer_size;
-    memcpy(buffer, msg->data, copy_size);
-    
-    if (bytes_read) *bytes_read = copy_size;
-    if (sender_id) *sender_id = msg->sender_id;
-    
-    // Remove message from queue
-    message_queue = msg->next;
-    if (!message_queue) {
-        queue_tail = nullptr;
-    }
-    
-    message_count--;
-    current_size -= msg->data_size;
-    
-    delete msg;
+    PopMessage(buffer, buffer_size, bytes_read, sender_id);
     
     // Notify waiting writers
     write_cv->Signal();
+    Poller::Notify(POLL_SOURCE_PIPE, pipe_id, POLL_OUT);
     
     return true;
 }
 
 bool Pipe::Peek(void* buffer, uint32_t buffer_size, uint32_t* bytes_available, uint32_t* sender_id) {
     if (!buffer || buffer_size == 0 || is_closed) return false;
+
+    if (mode == PIPE_MODE_STREAM) {
+        Take(&read_guard);
+        uint32_t n = RingRead((uint8_t*)buffer, buffer_size, false);
+        Drop(&read_guard);
+        if (bytes_available) *bytes_available = n;
+        if (sender_id) *sender_id = 0;
+        return n > 0;
+    }
     
     LockGuard lock(*pipe_mutex);
     
@@ -285,10 +585,17 @@ void Pipe::Close() {
     // Wake up all waiting threads
     read_cv->Broadcast();
     write_cv->Broadcast();
+    Poller::Notify(POLL_SOURCE_PIPE, pipe_id, POLL_HUP);
 }
 
 void Pipe::Flush() {
     LockGuard lock(*pipe_mutex);
+
+    if (mode == PIPE_MODE_STREAM) {
+        Take(&read_guard);
+        ring_tail = ring_head;
+        Drop(&read_guard);
+    }
     
     // Delete all messages
     while (message_queue) {
@@ -303,6 +610,7 @@ void Pipe::Flush() {
     
     // Notify waiting writers
     write_cv->Broadcast();
+    Poller::Notify(POLL_SOURCE_PIPE, pipe_id, POLL_OUT);
 }
 
 void Pipe::PrintInfo() const {
@@ -310,12 +618,16 @@ void Pipe::PrintInfo() const {
     TTY::WriteHex(pipe_id);
     TTY::Write(" Name: ");
     TTY::Write(name);
-    TTY::Write(" Messages: ");
-    TTY::WriteHex(message_count);
-    TTY::Write("/");
-    TTY::WriteHex(max_messages);
+    if (mode == PIPE_MODE_STREAM) {
+        TTY::Write(" [STREAM]");
+    } else {
+        TTY::Write(" Messages: ");
+        TTY::WriteHex(message_count);
+        TTY::Write("/");
+        TTY::WriteHex(max_messages);
+    }
     TTY::Write(" Size: ");
-    TTY::WriteHex(current_size);
+    TTY::WriteHex(GetCurrentSize());
     TTY::Write("/");
     TTY::WriteHex(buffer_size);
     TTY::Write(" Readers: ");
@@ -327,48 +639,80 @@ void Pipe::PrintInfo() const {
     TTY::Write("\n");
 }
 
+void Pipe::Benchmark() {
+    using namespace kos::arch::x86::hardware;
+    uint32_t cycles_per_us = g_scheduler ? g_scheduler->GetCyclesPerMicrosecond() : 0;
+    if (!cpu::cpu::HasTSC() || !cycles_per_us) {
+        TTY::Write("pipebench: TSC not calibrated yet\n");
+        return;
+    }
+
+    const uint32_t total = 1024 * 1024;
+    const uint32_t chunks[] = { 16, 256, 2048 };
+    uint8_t out[2048];
+    uint8_t in[2048];
+    for (uint32_t i = 0; i < sizeof(out); ++i) out[i] = (uint8_t)i;
+
+    char line[80];
+    TTY::Write("mode     chunk   MB/s\n");
+    for (uint32_t m = 0; m < 2; ++m) {
+        PipeMode pm = m ? PIPE_MODE_STREAM : PIPE_MODE_MESSAGE;
+        Pipe pipe(0, "pipebench", 4096, 64, pm);
+        for (uint32_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); ++c) {
+            uint32_t chunk = chunks[c];
+            uint32_t moved = 0;
+            // Write/read pairs on one thread: measures the per-call cost of
+            // each path, not cross-thread handoff
+            uint64_t start = cpu::cpu::ReadTSC();
+            for (uint32_t done = 0; done < total; done += chunk) {
+                uint32_t got = 0;
+                if (!pipe.Write(0, out, chunk, false)) break;
+                if (!pipe.Read(0, in, chunk, &got, nullptr, false)) break;
+                moved += got;
+            }
+            uint64_t cycles = cpu::cpu::ReadTSC() - start;
+            if (!cycles) cycles = 1;
+            uint32_t mbps = (uint32_t)((uint64_t)moved * cycles_per_us / cycles);
+            kos::sys::snprintf(line, sizeof(line), "%s  %u  %u\n",
+                               pm == PIPE_MODE_STREAM ? "stream " : "message", chunk, mbps);
+            TTY::Write(line);
+        }
+    }
+}
+
 // PipeManager implementation
 
-PipeManager::PipeManager() : pipe_count(0), next_pipe_id(1) {
-    for (int i = 0; i < 64; i++) {
-        pipes[i] = nullptr;
-    }
-    manager_mutex = new Mutex();
+PipeManager::PipeManager() {
+    manager_lock = new RwLock();
     Logger::Log("Pipe manager initialized");
 }
 
 PipeManager::~PipeManager() {
     CloseAllPipes();
-    if (manager_mutex) delete manager_mutex;
+    if (manager_lock) delete manager_lock;
 }
 
-Pipe* PipeManager::CreatePipe(const char* name, uint32_t buffer_size, uint32_t max_messages) {
-    if (!name || pipe_count >= 64) return nullptr;
+Pipe* PipeManager::CreatePipe(const char* name, uint32_t buffer_size, uint32_t max_messages, PipeMode mode) {
+    if (!name) return nullptr;
     
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*manager_lock);
     
     // Check if pipe with same name already exists
-    if (FindPipeIndex(name) >= 0) {
+    if (pipes.Find(name)) {
         return nullptr; // Pipe already exists
     }
     
-    // Find empty slot
-    int slot = -1;
-    for (int i = 0; i < 64; i++) {
-        if (!pipes[i]) {
-            slot = i;
-            break;
-        }
-    }
-    
-    if (slot < 0) return nullptr;
+    uint32_t id = pipes.Reserve();
+    if (!id) return nullptr;
     
     // Create pipe
-    Pipe* pipe = new Pipe(next_pipe_id++, name, buffer_size, max_messages);
-    if (!pipe) return nullptr;
+    Pipe* pipe = new Pipe(id, name, buffer_size, max_messages, mode);
+    if (!pipe || !pipes.Publish(id, pipe, pipe->GetName())) {
+        delete pipe;
+        pipes.Release(id);
+        return nullptr;
+    }
     
-    pipes[slot] = pipe;
-    pipe_count++;
         if (Logger::IsDebugEnabled()) {
         Logger::Log("Created pipe");
     }
@@ -376,14 +720,13 @@ Pipe* PipeManager::CreatePipe(const char* name, uint32_t buffer_size, uint32_t m
 }
 
 bool PipeManager::DestroyPipe(uint32_t pipe_id) {
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*manager_lock);
     
-    int index = FindPipeIndex(pipe_id);
-    if (index < 0) return false;
+    Pipe* pipe = (Pipe*)pipes.Find(pipe_id);
+    if (!pipe) return false;
     
-    delete pipes[index];
-    pipes[index] = nullptr;
-    pipe_count--;
+    pipes.Release(pipe_id);
+    delete pipe;
     
     Logger::Log("Destroyed pipe");
     return true;
@@ -392,74 +735,55 @@ bool PipeManager::DestroyPipe(uint32_t pipe_id) {
 bool PipeManager::DestroyPipe(const char* name) {
     if (!name) return false;
     
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*manager_lock);
     
-    int index = FindPipeIndex(name);
-    if (index < 0) return false;
+    uint32_t id = pipes.FindId(name);
+    if (!id) return false;
     
-    delete pipes[index];
-    pipes[index] = nullptr;
-    pipe_count--;
+    Pipe* pipe = (Pipe*)pipes.Find(id);
+    pipes.Release(id);
+    delete pipe;
     
     Logger::Log("Destroyed pipe");
     return true;
 }
 
 Pipe* PipeManager::FindPipe(uint32_t pipe_id) const {
-    int index = FindPipeIndex(pipe_id);
-    return (index >= 0) ? pipes[index] : nullptr;
+    ReadLockGuard lock(*manager_lock);
+    return (Pipe*)pipes.Find(pipe_id);
 }
 
 Pipe* PipeManager::FindPipe(const char* name) const {
     if (!name) return nullptr;
     
-    int index = FindPipeIndex(name);
-    return (index >= 0) ? pipes[index] : nullptr;
-}
-
-int PipeManager::FindPipeIndex(uint32_t pipe_id) const {
-    for (int i = 0; i < 64; i++) {
-        if (pipes[i] && pipes[i]->GetId() == pipe_id) {
-            return i;
-        }
-    }
-    return -1;
-}
-
-int PipeManager::FindPipeIndex(const char* name) const {
-    if (!name) return -1;
-    
-    for (int i = 0; i < 64; i++) {
-        if (pipes[i] && String::strcmp((const int8_t*)pipes[i]->GetName(), (const int8_t*)name, strlen(name)) == 0) {
-            return i;
-        }
-    }
-    return -1;
+    ReadLockGuard lock(*manager_lock);
+    return (Pipe*)pipes.Find(name);
 }
 
 void PipeManager::CloseAllPipes() {
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*manager_lock);
     
-    for (int i = 0; i < 64; i++) {
-        if (pipes[i]) {
-            delete pipes[i];
-            pipes[i] = nullptr;
+    for (uint32_t i = 0; i < pipes.SlotCount(); i++) {
+        Pipe* pipe = (Pipe*)pipes.At(i);
+        if (pipe) {
+            pipes.Release(pipes.IdAt(i));
+            delete pipe;
         }
     }
-    pipe_count = 0;
 }
 
 void PipeManager::PrintAllPipes() const {
-    LockGuard lock(*manager_mutex);
+    ReadLockGuard lock(*manager_lock);
     
     TTY::Write("=== Pipe Manager ===\n");
     TTY::Write("Active pipes: ");
-    TTY::WriteHex(pipe_count);
-    TTY::Write("/64\n");
+    TTY::WriteHex(pipes.GetCount());
+    TTY::Write("\n");
     
-    for (int i = 0; i < 64; i++) {
-        if (pipes[i]) {
-            pipes[i]->PrintInfo();
+    for (uint32_t i = 0; i < pipes.SlotCount(); i++) {
+        Pipe* pipe = (Pipe*)pipes.At(i);
+        if (pipe) {
+            pipe->PrintInfo();
         }
     }
 }
@@ -468,10 +792,10 @@ void PipeManager::PrintAllPipes() const {
 
 namespace kos::process::PipeAPI {
     
-    uint32_t CreatePipe(const char* name, uint32_t buffer_size, uint32_t max_messages) {
+    uint32_t CreatePipe(const char* name, uint32_t buffer_size, uint32_t max_messages, PipeMode mode) {
         if (!g_pipe_manager) return 0;
         
-        Pipe* pipe = g_pipe_manager->CreatePipe(name, buffer_size, max_messages);
+        Pipe* pipe = g_pipe_manager->CreatePipe(name, buffer_size, max_messages, mode);
         return pipe ? pipe->GetId() : 0;
     }
     
@@ -522,6 +846,26 @@ namespace kos::process::PipeAPI {
         return pipe->Read(reader_id, buffer, buffer_size, bytes_read, sender_id, block);
     }
     
+    uint32_t WritePipeV(uint32_t pipe_id, PipeVec* vec, uint32_t count, bool block) {
+        if (!g_pipe_manager || !g_scheduler) return 0;
+        
+        Pipe* pipe = g_pipe_manager->FindPipe(pipe_id);
+        if (!pipe) return 0;
+        
+        Thread* current = g_scheduler->GetCurrentTask();
+        return pipe->WriteV(current ? current->task_id : 0, vec, count, block);
+    }
+    
+    uint32_t ReadPipeV(uint32_t pipe_id, PipeVec* vec, uint32_t count, bool block) {
+        if (!g_pipe_manager || !g_scheduler) return 0;
+        
+        Pipe* pipe = g_pipe_manager->FindPipe(pipe_id);
+        if (!pipe) return 0;
+        
+        Thread* current = g_scheduler->GetCurrentTask();
+        return pipe->ReadV(current ? current->task_id : 0, vec, count, block);
+    }
+    
     bool ReadPipe(const char* name, void* buffer, uint32_t buffer_size, 
                   uint32_t* bytes_read, uint32_t* sender_id, bool block) {
         if (!g_pipe_manager || !g_scheduler) return false;
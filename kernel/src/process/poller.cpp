@@ -0,0 +1,319 @@
+#include <process/poller.hpp>
+#include <process/scheduler.hpp>
+#include <process/pipe.hpp>
+#include <process/message_queue.hpp>
+#include <input/event_queue.hpp>
+#include <lib/socket.hpp>
+#include <services/service_manager.hpp>
+#include <console/tty.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
+
+using namespace kos::process;
+using namespace kos::console;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
+using kos::arch::x86::hardware::cpu::InterruptsEnabled;
+
+Poller* volatile Poller::s_first = nullptr;
+
+namespace {
+    // Longest single sleep: bounds the cost of a notification that lands
+    // between the last readiness scan and SleepTask
+    const uint32_t POLL_SLICE_MS = 50;
+
+    uint32_t s_next_id = 1;
+
+    inline void CompilerBarrier() {
+        __asm__ __volatile__("" : : : "memory");
+    }
+
+    inline void FullBarrier() {
+        __asm__ __volatile__("lock; addl $0, (%%esp)" : : : "memory", "cc");
+    }
+
+    inline uint32_t NowMs() {
+        return kos::services::ServiceManager::UptimeMs();
+    }
+
+    // Bits a registration cares about, including the always-on ones
+    inline uint32_t Interest(const PollRegistration& reg) {
+        return (reg.events & (POLL_IN | POLL_OUT)) | POLL_ERR | POLL_HUP;
+    }
+
+    bool ValidSource(uint32_t source) {
+        return source >= POLL_SOURCE_PIPE && source <= POLL_SOURCE_INPUT;
+    }
+}
+
+Poller::Poller(uint32_t id, uint32_t owner)
+    : poller_id(id), owner_id(owner), entry_count(0), wake_seq(0), waiter_id(0),
+      kicked(false), scan_pos(0), next(nullptr) {
+    for (uint32_t i = 0; i < POLL_MAX_ENTRIES; ++i) {
+        entries[i].in_use = false;
+        entries[i].signalled = 0;
+    }
+}
+
+Poller::~Poller() {
+}
+
+PollEntry* Poller::FindEntry(uint32_t source, uint32_t id) {
+    for (uint32_t i = 0; i < POLL_MAX_ENTRIES; ++i) {
+        if (entries[i].in_use && entries[i].reg.source == source && entries[i].reg.id == id) return &entries[i];
+    }
+    return nullptr;
+}
+
+bool Poller::Add(const PollRegistration& reg) {
+    if (!ValidSource(reg.source)) return false;
+    // Entries are read by Notify from interrupt context
+    uint32_t flags = IrqSave();
+    bool added = false;
+    if (!FindEntry(reg.source, reg.id)) {
+        for (uint32_t i = 0; i < POLL_MAX_ENTRIES; ++i) {
+            if (entries[i].in_use) continue;
+            entries[i].reg = reg;
+            entries[i].signalled = 0;
+            entries[i].in_use = true;
+            ++entry_count;
+            added = true;
+            break;
+        }
+    }
+    IrqRestore(flags);
+    return added;
+}
+
+bool Poller::Modify(const PollRegistration& reg) {
+    uint32_t flags = IrqSave();
+    PollEntry* e = FindEntry(reg.source, reg.id);
+    if (e) {
+        e->reg = reg;
+        e->signalled = 0;
+    }
+    IrqRestore(flags);
+    return e != nullptr;
+}
+
+bool Poller::Remove(uint32_t source, uint32_t id) {
+    uint32_t flags = IrqSave();
+    PollEntry* e = FindEntry(source, id);
+    if (e) {
+        e->in_use = false;
+        --entry_count;
+    }
+    IrqRestore(flags);
+    return e != nullptr;
+}
+
+uint32_t Poller::QueryLevel(const PollRegistration& reg) {
+    switch (reg.source) {
+        case POLL_SOURCE_PIPE: {
+            Pipe* pipe = g_pipe_manager ? g_pipe_manager->FindPipe(reg.id) : nullptr;
+            if (!pipe) return POLL_ERR | POLL_HUP;
+            uint32_t ready = pipe->IsEmpty() ? 0 : POLL_IN;
+            if (pipe->IsClosed()) ready |= POLL_HUP;
+            else if (!pipe->IsFull()) ready |= POLL_OUT;
+            return ready;
+        }
+        case POLL_SOURCE_QUEUE: {
+            MessageQueue* queue = g_message_queue_manager ? g_message_queue_manager->FindQueue(reg.id) : nullptr;
+            if (!queue) return POLL_ERR | POLL_HUP;
+            uint32_t ready = queue->HasMessageFor(reg.arg) ? POLL_IN : 0;
+            if (queue->IsClosed()) ready |= POLL_HUP;
+            else if (!queue->IsFull()) ready |= POLL_OUT;
+            return ready;
+        }
+        case POLL_SOURCE_SOCKET:
+            return kos::lib::SocketPollState((int)reg.id);
+        case POLL_SOURCE_INPUT:
+            return kos::input::InputEventQueue::Instance().Count() ? POLL_IN : 0;
+        default:
+            return POLL_ERR;
+    }
+}
+
+uint32_t Poller::Collect(PollEvent* out, uint32_t max) {
+    uint32_t n = 0;
+    uint32_t start = scan_pos;
+    for (uint32_t k = 0; k < POLL_MAX_ENTRIES && n < max; ++k) {
+        uint32_t i = (start + k) % POLL_MAX_ENTRIES;
+        PollEntry& e = entries[i];
+        if (!e.in_use) continue;
+
+        uint32_t flags = IrqSave();
+        uint32_t posted = e.signalled;
+        e.signalled = 0;
+        PollRegistration reg = e.reg;
+        IrqRestore(flags);
+
+        uint32_t ready = (reg.events & POLL_EDGE) ? posted : QueryLevel(reg);
+        // Sockets do not buffer data yet: an arrival is only known from the
+        // send that posted it
+        if (reg.source == POLL_SOURCE_SOCKET) ready |= posted & POLL_IN;
+        ready &= Interest(reg);
+        if (!ready) continue;
+
+        out[n].source = reg.source;
+        out[n].id = reg.id;
+        out[n].events = ready;
+        out[n].user_data = reg.user_data;
+        ++n;
+        scan_pos = i + 1;
+    }
+    return n;
+}
+
+void Poller::Sleep(uint32_t seq, uint32_t timeout_ms) {
+    if (timeout_ms > POLL_SLICE_MS) timeout_ms = POLL_SLICE_MS;
+    Thread* self = g_scheduler ? g_scheduler->GetCurrentTask() : nullptr;
+    if (self) {
+        waiter_id = self->task_id;
+        FullBarrier();
+        if (wake_seq == seq && !kicked) g_scheduler->SleepTask(self->task_id, timeout_ms);
+        waiter_id = 0;
+        return;
+    }
+    // Boot context (shell, service loop before threads run): nothing to put
+    // to sleep, but every source is fed by an interrupt or by code the
+    // timer tick drives, so halting until the next one loses nothing
+    if (InterruptsEnabled()) __asm__ __volatile__("hlt");
+}
+
+int32_t Poller::Wait(PollEvent* out, uint32_t max, int32_t timeout_ms) {
+    if (!out || max == 0) return -1;
+
+    uint32_t start = NowMs();
+    while (true) {
+        uint32_t seq = wake_seq;
+        CompilerBarrier();
+        uint32_t n = Collect(out, max);
+        if (n) return (int32_t)n;
+        if (kicked) {
+            kicked = false;
+            return 0;
+        }
+        if (timeout_ms == 0) return 0;
+
+        uint32_t remaining = POLL_SLICE_MS;
+        if (timeout_ms > 0) {
+            uint32_t elapsed = NowMs() - start;
+            if (elapsed >= (uint32_t)timeout_ms) return 0;
+            remaining = (uint32_t)timeout_ms - elapsed;
+        }
+        // A notification raced the scan: look again before sleeping
+        if (wake_seq != seq) continue;
+        Sleep(seq, remaining);
+    }
+}
+
+void Poller::Wake() {
+    uint32_t flags = IrqSave();
+    kicked = true;
+    wake_seq = wake_seq + 1;
+    if (waiter_id) SchedulerAPI::WakeThread(waiter_id);
+    IrqRestore(flags);
+}
+
+void Poller::NotifyAll(uint32_t source, uint32_t id, uint32_t events) {
+    uint32_t flags = IrqSave();
+    for (Poller* p = s_first; p; p = p->next) {
+        bool hit = false;
+        for (uint32_t i = 0; i < POLL_MAX_ENTRIES; ++i) {
+            PollEntry& e = p->entries[i];
+            if (!e.in_use || e.reg.source != source || e.reg.id != id) continue;
+            if (!(events & Interest(e.reg))) continue;
+            e.signalled |= events;
+            hit = true;
+        }
+        if (!hit) continue;
+        p->wake_seq = p->wake_seq + 1;
+        if (p->waiter_id) SchedulerAPI::WakeThread(p->waiter_id);
+    }
+    IrqRestore(flags);
+}
+
+Poller* Poller::Create(uint32_t owner_id) {
+    Poller* poller = new Poller(0, owner_id);
+    if (!poller) return nullptr;
+
+    uint32_t flags = IrqSave();
+    uint32_t count = 0;
+    for (Poller* p = s_first; p; p = p->next) ++count;
+    if (count >= POLL_MAX_POLLERS) {
+        IrqRestore(flags);
+        delete poller;
+        return nullptr;
+    }
+    poller->poller_id = s_next_id++;
+    poller->next = s_first;
+    s_first = poller;
+    IrqRestore(flags);
+    return poller;
+}
+
+bool Poller::Destroy(uint32_t id) {
+    uint32_t flags = IrqSave();
+    Poller* volatile* link = &s_first;
+    while (*link && (*link)->poller_id != id) link = &(*link)->next;
+    Poller* poller = *link;
+    if (poller) *link = poller->next;
+    IrqRestore(flags);
+    if (!poller) return false;
+    delete poller;
+    return true;
+}
+
+Poller* Poller::Find(uint32_t id) {
+    uint32_t flags = IrqSave();
+    Poller* p = s_first;
+    while (p && p->poller_id != id) p = p->next;
+    IrqRestore(flags);
+    return p;
+}
+
+void Poller::PrintAll() {
+    TTY::Write("=== Pollers ===\n");
+    uint32_t flags = IrqSave();
+    for (Poller* p = s_first; p; p = p->next) {
+        TTY::Write("Poller ID: ");
+        TTY::WriteHex(p->poller_id);
+        TTY::Write(" Owner: ");
+        TTY::WriteHex(p->owner_id);
+        TTY::Write(" Entries: ");
+        TTY::WriteHex(p->entry_count);
+        TTY::Write(p->waiter_id ? " (waiting)\n" : "\n");
+    }
+    IrqRestore(flags);
+}
+
+// PollerAPI implementation (process namespace)
+
+namespace kos::process::PollerAPI {
+
+    uint32_t Create() {
+        Poller* poller = Poller::Create(SchedulerAPI::GetCurrentThreadId());
+        return poller ? poller->GetId() : 0;
+    }
+
+    bool Destroy(uint32_t poller_id) {
+        return Poller::Destroy(poller_id);
+    }
+
+    bool Control(uint32_t poller_id, uint32_t op, const PollRegistration* reg) {
+        Poller* poller = Poller::Find(poller_id);
+        if (!poller || !reg) return false;
+        switch (op) {
+            case POLL_CTL_ADD: return poller->Add(*reg);
+            case POLL_CTL_MOD: return poller->Modify(*reg);
+            case POLL_CTL_DEL: return poller->Remove(reg->source, reg->id);
+            default: return false;
+        }
+    }
+
+    int32_t Wait(uint32_t poller_id, PollEvent* out, uint32_t max, int32_t timeout_ms) {
+        Poller* poller = Poller::Find(poller_id);
+        if (!poller) return -1;
+        return poller->Wait(out, max, timeout_ms);
+    }
+}
@@ -1,12 +1,47 @@
 #include <process/scheduler.hpp>
 #include <process/thread.h>
+#include <process/trace.hpp>
 #include <memory/heap.hpp>
 #include <lib/string.hpp>
 #include <console/logger.hpp>
+#include <arch/x86/hardware/cpu/cpu.hpp>
+#include <arch/x86/hardware/cpu/fpu.hpp>
+#include <process/tls.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
 
 using namespace kos::process;
 using namespace kos::memory;
 using namespace kos::console;
+using kos::arch::x86::hardware::cpu::cpu;
+using kos::arch::x86::hardware::cpu::FPU;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
+
+namespace {
+    // PIT runs at 100 Hz, so one tick is 10 ms
+    const uint32_t TICK_MICROSECONDS = 10000;
+    // Calibrate the TSC over half a second of timer ticks
+    const uint32_t TSC_CALIBRATION_TICKS = 50;
+    // Fair class: each runnable fair task should get the CPU once per window
+    const uint32_t FAIR_LATENCY_TICKS = 6;
+    // A woken sleeper may trail min_vruntime by at most this much
+    const uint64_t FAIR_SLEEPER_CREDIT_US = 30000;
+    const uint32_t FAIR_HEAP_INITIAL = 32;
+
+    inline uint32_t MsToTicks(uint32_t ms) {
+        uint32_t ticks = (ms * 100) / 1000;
+        return ticks ? ticks : 1;
+    }
+
+    // Reserved share of the CPU, per-mille
+    inline uint32_t DeadlineShare(const Thread* task) {
+        if (task->sched_class != SCHED_CLASS_DEADLINE || !task->dl_period) return 0;
+        return (task->dl_budget * 1000) / task->dl_period;
+    }
+
+    // Signed difference keeps tick comparisons right across wraparound
+    inline bool TickReached(uint32_t now, uint32_t when) { return (int32_t)(now - when) >= 0; }
+}
 
 // Global scheduler instance
 Scheduler* kos::process::g_scheduler = nullptr;
@@ -24,14 +59,22 @@ void TimerHandler::HandleTimerInterrupt(uint32_t esp) {
 
 // Scheduler implementation
 Scheduler::Scheduler() 
-    : current_task(nullptr), sleeping_tasks(nullptr), next_task_id(1), current_tick(0),
-      timer_handler(nullptr), scheduling_enabled(false) {
+    : current_task(nullptr), sleeping_tasks(nullptr), deadline_queue(nullptr), throttled_tasks(nullptr),
+      deadline_utilization(0), fair_heap(nullptr), fair_count(0), fair_capacity(0), min_vruntime(0),
+      next_task_id(1), current_tick(0),
+      timer_handler(nullptr), scheduling_enabled(false),
+      tsc_available(false), cycles_per_us(0), calib_start_tsc(0), calib_start_tick(0) {
     
     // Initialize priority queues
     for (int i = 0; i < 5; i++) {
         ready_queues[i] = nullptr;
         ready_queue_tails[i] = nullptr;
+        wake_latency_samples[i] = 0;
+        wake_latency_max_us[i] = 0;
+        for (int b = 0; b < LATENCY_BUCKETS; b++) wake_latency_hist[i][b] = 0;
     }
+
+    tsc_available = cpu::HasTSC();
     
     timer_handler = new TimerHandler(this, 10); // 10 timer ticks per quantum
     Logger::Log("Advanced scheduler initialized");
@@ -47,6 +90,24 @@ Scheduler::~Scheduler() {
         }
     }
     
+    // Clean up fair-class tasks
+    while (fair_count) {
+        ThreadFactory::DestroyThread(FairPop());
+    }
+    delete[] fair_heap;
+    
+    // Clean up deadline-class tasks
+    while (deadline_queue) {
+        Thread* task = deadline_queue;
+        deadline_queue = deadline_queue->next;
+        ThreadFactory::DestroyThread(task);
+    }
+    while (throttled_tasks) {
+        Thread* task = throttled_tasks;
+        throttled_tasks = throttled_tasks->next;
+        ThreadFactory::DestroyThread(task);
+    }
+    
     // Clean up sleeping tasks
     while (sleeping_tasks) {
         Thread* task = sleeping_tasks;
@@ -64,12 +125,17 @@ Scheduler::~Scheduler() {
 }
 
 Thread* Scheduler::CreateTask(void* entry_point, uint32_t stack_size, ThreadPriority priority, const char* name) {
+    // Grow the fair heap here, in thread context, so enqueueing from the
+    // timer interrupt never has to allocate
+    ReserveFair(GetTaskCount() + 1);
     Thread* new_task = ThreadFactory::CreateThread(next_task_id++, entry_point, stack_size, priority, name);
     if (!new_task) {
         Logger::Log("Failed to create task");
         return nullptr;
     }
     
+    // Start level with the runnable fair tasks instead of owed a backlog
+    new_task->vruntime = min_vruntime;
     AddToReadyQueue(new_task);
         if (Logger::IsDebugEnabled()) {
             Logger::Log("Created task");
@@ -82,6 +148,23 @@ void Scheduler::AddToReadyQueue(Thread* task) {
     
     task->state = TASK_READY;
     task->next = nullptr;
+    task->ready_since_tsc = ReadCycles();
+    
+    if (task->sched_class == SCHED_CLASS_DEADLINE) {
+        AddToDeadlineQueue(task);
+        return;
+    }
+    
+    if (IsFairTask(task)) {
+        // Sleeper credit: a woken thread is placed a little ahead of the
+        // pack, but cannot bank the whole time it slept
+        if (task->woken) {
+            uint64_t floor = (min_vruntime > FAIR_SLEEPER_CREDIT_US) ? min_vruntime - FAIR_SLEEPER_CREDIT_US : 0;
+            if (task->vruntime < floor) task->vruntime = floor;
+        }
+        if (FairPush(task)) return;
+        // Heap could not grow: fall back to round-robin on the priority queue
+    }
     
     int priority = (int)task->priority;
     if (priority < 0 || priority >= 5) priority = PRIORITY_NORMAL;
@@ -94,13 +177,282 @@ void Scheduler::AddToReadyQueue(Thread* task) {
     }
 }
 
+void Scheduler::AddToDeadlineQueue(Thread* task) {
+    // Runnable again after its deadline: the old period is over, start a new one
+    if (!task->dl_throttled && TickReached(current_tick, task->dl_deadline)) {
+        StartDeadlinePeriod(task);
+    }
+    if (task->dl_throttled) {
+        task->next = throttled_tasks;
+        throttled_tasks = task;
+        return;
+    }
+    Thread** link = &deadline_queue;
+    while (*link && (int32_t)((*link)->dl_deadline - task->dl_deadline) <= 0) link = &(*link)->next;
+    task->next = *link;
+    *link = task;
+}
+
+void Scheduler::StartDeadlinePeriod(Thread* task) {
+    task->dl_deadline = current_tick + task->dl_period;
+    task->dl_budget_left = task->dl_budget;
+    task->dl_throttled = false;
+}
+
+// Called every tick. A deadline task that is still running or runnable
+// with budget left when its deadline arrives did not get to finish that
+// period's job: count a miss. A throttled task ran its whole budget, so
+// the reservation was met; it only gets a fresh period.
+void Scheduler::DeadlineTick() {
+    if (current_task && current_task->sched_class == SCHED_CLASS_DEADLINE) {
+        if (current_task->dl_budget_left) current_task->dl_budget_left--;
+        if (TickReached(current_tick, current_task->dl_deadline)) {
+            if (current_task->dl_budget_left) current_task->dl_misses++;
+            StartDeadlinePeriod(current_task);
+        }
+    }
+
+    while (deadline_queue && TickReached(current_tick, deadline_queue->dl_deadline)) {
+        Thread* task = deadline_queue;
+        deadline_queue = task->next;
+        if (task->dl_budget_left) task->dl_misses++;
+        StartDeadlinePeriod(task);
+        AddToDeadlineQueue(task);
+    }
+
+    Thread** link = &throttled_tasks;
+    while (*link) {
+        Thread* task = *link;
+        if (!TickReached(current_tick, task->dl_deadline)) {
+            link = &task->next;
+            continue;
+        }
+        *link = task->next;
+        StartDeadlinePeriod(task);
+        AddToDeadlineQueue(task);
+    }
+}
+
+// Take a READY task off whichever run queue holds it
+bool Scheduler::UnlinkReadyTask(Thread* task) {
+    if (task->fair_index >= 0) {
+        FairRemove(task);
+        return true;
+    }
+    for (int priority = 0; priority < 5; priority++) {
+        Thread* prev = nullptr;
+        for (Thread* t = ready_queues[priority]; t; prev = t, t = t->next) {
+            if (t != task) continue;
+            if (prev) prev->next = t->next; else ready_queues[priority] = t->next;
+            if (ready_queue_tails[priority] == t) ready_queue_tails[priority] = prev;
+            t->next = nullptr;
+            return true;
+        }
+    }
+    Thread** lists[2] = { &deadline_queue, &throttled_tasks };
+    for (int i = 0; i < 2; i++) {
+        for (Thread** link = lists[i]; *link; link = &(*link)->next) {
+            if (*link != task) continue;
+            *link = task->next;
+            task->next = nullptr;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Scheduler::ReleaseDeadline(Thread* task) {
+    deadline_utilization -= DeadlineShare(task);
+    task->sched_class = SCHED_CLASS_PRIORITY;
+    task->dl_throttled = false;
+}
+
+void Scheduler::AssignTimeSlice(Thread* task) {
+    if (task->sched_class == SCHED_CLASS_DEADLINE) {
+        task->time_slice = task->dl_budget_left;
+        return;
+    }
+    if (IsFairTask(task)) {
+        // Weighted share of the latency window, at least one tick
+        uint32_t weight = FairWeight(task);
+        uint32_t total = weight;
+        for (uint32_t i = 0; i < fair_count; i++) total += FairWeight(fair_heap[i]);
+        uint32_t slice = (FAIR_LATENCY_TICKS * weight) / total;
+        task->time_slice = slice ? slice : 1;
+        return;
+    }
+    // Higher priority gets more time
+    switch (task->priority) {
+        case PRIORITY_CRITICAL: task->time_slice = 20; break;
+        case PRIORITY_HIGH:     task->time_slice = 15; break;
+        case PRIORITY_NORMAL:   task->time_slice = 10; break;
+        case PRIORITY_LOW:      task->time_slice = 5;  break;
+        case PRIORITY_IDLE:     task->time_slice = 3;  break;
+    }
+}
+
+// --- Fair class ---
+//
+// PRIORITY_NORMAL and PRIORITY_LOW threads of the priority class are kept
+// in a min-heap on vruntime: run time scaled by NORMAL weight / own weight,
+// and by the number of runnable threads in the same process group so that
+// a process with many threads gets about the same share as one with a
+// single thread. The class runs after CRITICAL/HIGH and before IDLE.
+
+bool Scheduler::IsFairTask(const Thread* task) const {
+    return task->sched_class == SCHED_CLASS_PRIORITY &&
+           (task->priority == PRIORITY_NORMAL || task->priority == PRIORITY_LOW);
+}
+
+uint32_t Scheduler::FairWeight(const Thread* task) const {
+    return task->priority == PRIORITY_LOW ? FAIR_WEIGHT_LOW : FAIR_WEIGHT_NORMAL;
+}
+
+uint32_t Scheduler::GroupRunnable(uint32_t group_id) const {
+    if (!group_id) return 1;
+    uint32_t count = 0;
+    if (current_task && current_task->group_id == group_id && IsFairTask(current_task)) count++;
+    for (uint32_t i = 0; i < fair_count; i++) {
+        if (fair_heap[i]->group_id == group_id) count++;
+    }
+    return count ? count : 1;
+}
+
+bool Scheduler::ReserveFair(uint32_t capacity) {
+    if (capacity <= fair_capacity) return true;
+    uint32_t new_capacity = fair_capacity ? fair_capacity : FAIR_HEAP_INITIAL;
+    while (new_capacity < capacity) new_capacity *= 2;
+    Thread** grown = new Thread*[new_capacity];
+    if (!grown) return false;
+    uint32_t flags = IrqSave();
+    for (uint32_t i = 0; i < fair_count; i++) grown[i] = fair_heap[i];
+    Thread** old = fair_heap;
+    fair_heap = grown;
+    fair_capacity = new_capacity;
+    IrqRestore(flags);
+    delete[] old;
+    return true;
+}
+
+void Scheduler::FairSiftUp(uint32_t index) {
+    Thread* task = fair_heap[index];
+    while (index > 0) {
+        uint32_t parent = (index - 1) / 2;
+        if (fair_heap[parent]->vruntime <= task->vruntime) break;
+        fair_heap[index] = fair_heap[parent];
+        fair_heap[index]->fair_index = (int32_t)index;
+        index = parent;
+    }
+    fair_heap[index] = task;
+    task->fair_index = (int32_t)index;
+}
+
+void Scheduler::FairSiftDown(uint32_t index) {
+    Thread* task = fair_heap[index];
+    for (;;) {
+        uint32_t child = 2 * index + 1;
+        if (child >= fair_count) break;
+        if (child + 1 < fair_count && fair_heap[child + 1]->vruntime < fair_heap[child]->vruntime) child++;
+        if (task->vruntime <= fair_heap[child]->vruntime) break;
+        fair_heap[index] = fair_heap[child];
+        fair_heap[index]->fair_index = (int32_t)index;
+        index = child;
+    }
+    fair_heap[index] = task;
+    task->fair_index = (int32_t)index;
+}
+
+bool Scheduler::FairPush(Thread* task) {
+    if (fair_count >= fair_capacity) return false;
+    fair_heap[fair_count++] = task;
+    FairSiftUp(fair_count - 1);
+    return true;
+}
+
+Thread* Scheduler::FairPop() {
+    if (!fair_count) return nullptr;
+    Thread* task = fair_heap[0];
+    FairRemove(task);
+    return task;
+}
+
+void Scheduler::FairRemove(Thread* task) {
+    if (task->fair_index < 0) return;
+    uint32_t index = (uint32_t)task->fair_index;
+    task->fair_index = -1;
+    task->next = nullptr;
+    fair_count--;
+    if (index == fair_count) return;
+    Thread* last = fair_heap[fair_count];
+    fair_heap[index] = last;
+    last->fair_index = (int32_t)index;
+    FairSiftDown(index);
+    FairSiftUp((uint32_t)last->fair_index);
+}
+
+void Scheduler::UpdateMinVruntime() {
+    bool have = false;
+    uint64_t candidate = 0;
+    if (current_task && IsFairTask(current_task)) {
+        candidate = current_task->vruntime;
+        have = true;
+    }
+    if (fair_count && (!have || fair_heap[0]->vruntime < candidate)) {
+        candidate = fair_heap[0]->vruntime;
+        have = true;
+    }
+    if (have && candidate > min_vruntime) min_vruntime = candidate;
+}
+
+// Charge the running fair task for the time since it was last charged
+void Scheduler::UpdateCurrentFair() {
+    Thread* task = current_task;
+    if (!task || !IsFairTask(task)) return;
+    uint64_t exec_us;
+    if (cycles_per_us && task->fair_mark_tsc) {
+        uint64_t now = cpu::ReadTSC();
+        exec_us = CyclesToMicroseconds(now - task->fair_mark_tsc);
+        task->fair_mark_tsc = now;
+    } else {
+        exec_us = (uint64_t)(current_tick - task->fair_mark_tick) * TICK_MICROSECONDS;
+        task->fair_mark_tsc = ReadCycles();
+    }
+    task->fair_mark_tick = current_tick;
+    task->vruntime += exec_us * FAIR_WEIGHT_NORMAL * GroupRunnable(task->group_id) / FairWeight(task);
+    UpdateMinVruntime();
+}
+
+// Something other than the running fair task deserves the CPU
+bool Scheduler::FairShouldPreempt() const {
+    if (deadline_queue || ready_queues[PRIORITY_CRITICAL] || ready_queues[PRIORITY_HIGH]) return true;
+    return fair_count && fair_heap[0]->vruntime < current_task->vruntime;
+}
+
 Thread* Scheduler::RemoveFromReadyQueue() {
     return GetHighestPriorityTask();
 }
 
+bool Scheduler::HasReadyTask() const {
+    if (deadline_queue || fair_count) return true;
+    for (int priority = 0; priority < 5; priority++) {
+        if (ready_queues[priority]) return true;
+    }
+    return false;
+}
+
 Thread* Scheduler::GetHighestPriorityTask() {
-    // Check priorities from highest (0) to lowest (4)
+    // Deadline class first, earliest deadline at the head
+    if (deadline_queue) {
+        Thread* task = deadline_queue;
+        deadline_queue = task->next;
+        task->next = nullptr;
+        return task;
+    }
+
+    // Check priorities from highest (0) to lowest (4); the fair class
+    // takes the NORMAL slot
     for (int priority = 0; priority < 5; priority++) {
+        if (priority == PRIORITY_NORMAL && fair_count) return FairPop();
         if (ready_queues[priority]) {
             Thread* task = ready_queues[priority];
             ready_queues[priority] = ready_queues[priority]->next;
@@ -123,6 +475,8 @@ void Scheduler::ProcessSleepingTasks() {
         if (current_tick >= task->sleep_until) {
             // Thread should wake up
             *current = task->next;
+            task->woken = true;
+            Tracer::Wakeup(task->task_id);
             AddToReadyQueue(task);
         } else {
             current = &task->next;
@@ -135,6 +489,7 @@ void Scheduler::Schedule() {
     
     // Process any sleeping tasks that should wake up
     ProcessSleepingTasks();
+    UpdateCurrentFair();
     
     // Save current task if it exists and is still running
     if (current_task && current_task->state == TASK_RUNNING) {
@@ -149,23 +504,17 @@ void Scheduler::Schedule() {
         if (current_task && current_task->state == TASK_READY) {
             current_task->state = TASK_RUNNING;
         } else {
+            AccountSwitch(current_task, nullptr, true);
             current_task = nullptr; // Enter idle state
         }
         return;
     }
     
     Thread* old_task = current_task;
+    AccountSwitch(old_task, next_task, true);
     current_task = next_task;
     current_task->state = TASK_RUNNING;
-    
-    // Set time slice based on priority (higher priority gets more time)
-    switch (current_task->priority) {
-        case PRIORITY_CRITICAL: current_task->time_slice = 20; break;
-        case PRIORITY_HIGH:     current_task->time_slice = 15; break;
-        case PRIORITY_NORMAL:   current_task->time_slice = 10; break;
-        case PRIORITY_LOW:      current_task->time_slice = 5;  break;
-        case PRIORITY_IDLE:     current_task->time_slice = 3;  break;
-    }
+    AssignTimeSlice(current_task);
     
     // Context switch if we're switching tasks
     if (old_task && old_task != current_task) {
@@ -185,11 +534,15 @@ void Scheduler::TerminateCurrentTask() {
     if (!current_task) return;
     
     current_task->state = TASK_TERMINATED;
+    Tracer::Block(current_task->task_id, TASK_TERMINATED);
     
     Logger::Log("Terminated task");
     
+    ReleaseDeadline(current_task);
+    
     // Get next task
     Thread* terminated_task = current_task;
+    AccountSwitch(terminated_task, nullptr, true);
     current_task = nullptr;
     Schedule();
     
@@ -201,6 +554,7 @@ void Scheduler::BlockCurrentTask() {
     if (!current_task) return;
     
     current_task->state = TASK_BLOCKED;
+    Tracer::Block(current_task->task_id, TASK_BLOCKED);
     Schedule();
 }
 
@@ -209,6 +563,8 @@ void Scheduler::UnblockTask(uint32_t task_id) {
     Thread* task = FindTask(task_id);
     if (task && task->state == TASK_BLOCKED) {
         task->state = TASK_READY;
+        task->woken = true;
+        Tracer::Wakeup(task->task_id);
         AddToReadyQueue(task);
     }
 }
@@ -217,19 +573,39 @@ uint32_t Scheduler::OnTimerTick(uint32_t esp) {
     if (!scheduling_enabled) return esp;
     
     current_tick++; // Increment global tick counter
+    CalibrateCycles();
+    DeadlineTick();
     
     if (!current_task) return esp;
     
     // Update runtime statistics
     current_task->total_runtime++;
+    UpdateCurrentFair();
     
     // Decrement time slice
     if (current_task->time_slice > 0) {
         current_task->time_slice--;
     }
     
-    // If time slice expired and there are other tasks ready, preempt
-    if (current_task->time_slice == 0 && GetHighestPriorityTask()) {
+    // Deadline work preempts the priority class at once and, within the
+    // class, the earliest deadline wins. A deadline task out of budget is
+    // throttled if anything else can run; otherwise it keeps the CPU.
+    // Priority tasks are preempted when their slice expires and others are
+    // ready. Only peek here: dequeuing would drop the task on the floor.
+    bool preempt;
+    if (current_task->sched_class == SCHED_CLASS_DEADLINE) {
+        bool exhausted = current_task->dl_budget_left == 0 && HasReadyTask();
+        preempt = exhausted || (deadline_queue &&
+                  (int32_t)(deadline_queue->dl_deadline - current_task->dl_deadline) < 0);
+        if (exhausted) current_task->dl_throttled = true;
+    } else if (IsFairTask(current_task)) {
+        // Fair tasks only give way at slice end to someone with less vruntime
+        preempt = deadline_queue || (current_task->time_slice == 0 && FairShouldPreempt());
+        if (!preempt && current_task->time_slice == 0) AssignTimeSlice(current_task);
+    } else {
+        preempt = deadline_queue || (current_task->time_slice == 0 && HasReadyTask());
+    }
+    if (preempt) {
         // Save current task's context from interrupt stack frame
         SaveContextFromInterrupt(&current_task->context, esp);
         
@@ -240,17 +616,15 @@ uint32_t Scheduler::OnTimerTick(uint32_t esp) {
         // Get next task
         Thread* next_task = GetHighestPriorityTask();
         if (next_task) {
+            AccountSwitch(current_task, next_task, false);
             current_task = next_task;
             current_task->state = TASK_RUNNING;
-            
-            // Set time slice based on priority
-            switch (current_task->priority) {
-                case PRIORITY_CRITICAL: current_task->time_slice = 20; break;
-                case PRIORITY_HIGH:     current_task->time_slice = 15; break;
-                case PRIORITY_NORMAL:   current_task->time_slice = 10; break;
-                case PRIORITY_LOW:      current_task->time_slice = 5;  break;
-                case PRIORITY_IDLE:     current_task->time_slice = 3;  break;
-            }
+            AssignTimeSlice(current_task);
+            // Schedule() only picks a task and the caller keeps running, so
+            // the FPU and %gs follow the stack here, where it really changes.
+            // Lazy FPU: this only arms CR0.TS, registers move on first use (#NM).
+            FPU::SwitchTo(&current_task->fpu);
+            TLS::SwitchTo(current_task->tcb);
             
             // Return new task's stack pointer for interrupt return
             return RestoreContextToInterrupt(&current_task->context);
@@ -261,6 +635,12 @@ uint32_t Scheduler::OnTimerTick(uint32_t esp) {
 }
 
 void Scheduler::EnablePreemption() {
+    // Ticks only advance while scheduling is enabled, so (re)start the
+    // TSC calibration window here
+    if (tsc_available && !cycles_per_us) {
+        calib_start_tsc = cpu::ReadTSC();
+        calib_start_tick = current_tick;
+    }
     scheduling_enabled = true;
     Logger::Log("Preemptive scheduling enabled");
 }
@@ -282,6 +662,11 @@ uint32_t Scheduler::GetTaskCount() const {
         }
     }
     
+    // Count fair-class and deadline-class tasks
+    count += fair_count;
+    for (Thread* task = deadline_queue; task; task = task->next) count++;
+    for (Thread* task = throttled_tasks; task; task = task->next) count++;
+    
     // Count sleeping tasks
     Thread* task = sleeping_tasks;
     while (task) {
@@ -311,6 +696,19 @@ Thread* Scheduler::FindTask(uint32_t task_id) {
         }
     }
     
+    // Check fair-class tasks
+    for (uint32_t i = 0; i < fair_count; i++) {
+        if (fair_heap[i]->task_id == task_id) return fair_heap[i];
+    }
+    
+    // Check deadline-class tasks
+    for (Thread* task = deadline_queue; task; task = task->next) {
+        if (task->task_id == task_id) return task;
+    }
+    for (Thread* task = throttled_tasks; task; task = task->next) {
+        if (task->task_id == task_id) return task;
+    }
+    
     // Check sleeping tasks
     Thread* task = sleeping_tasks;
     while (task) {
@@ -327,6 +725,7 @@ bool Scheduler::SuspendTask(uint32_t task_id) {
     
     if (task == current_task) {
         current_task->state = TASK_SUSPENDED;
+        Tracer::Block(current_task->task_id, TASK_SUSPENDED);
         Schedule(); // Switch to another task
     } else {
         // Remove from ready queue if it's there
@@ -342,6 +741,8 @@ bool Scheduler::ResumeTask(uint32_t task_id) {
     if (!task || task->state != TASK_SUSPENDED) return false;
     
     task->state = TASK_READY;
+    task->woken = true;
+    Tracer::Wakeup(task->task_id);
     AddToReadyQueue(task);
     return true;
 }
@@ -356,7 +757,9 @@ bool Scheduler::KillTask(uint32_t task_id) {
         TerminateCurrentTask();
     } else {
         // Remove from queues and free memory
-        // Note: Would need proper queue removal here
+        // Note: sleeping and suspended tasks still need proper removal here
+        UnlinkReadyTask(task);
+        ReleaseDeadline(task);
         if (task->stack_base) {
             Heap::Free(task->stack_base);
             task->stack_base = nullptr;
@@ -375,14 +778,19 @@ bool Scheduler::SleepTask(uint32_t task_id, uint32_t milliseconds) {
     uint32_t ticks = (milliseconds * 100) / 1000;
     if (ticks == 0) ticks = 1;
     
+    if (task == current_task) UpdateCurrentFair();
+    else if (task->state == TASK_READY) UnlinkReadyTask(task);
+    
     task->state = TASK_SLEEPING;
     task->sleep_until = current_tick + ticks;
+    Tracer::Block(task->task_id, TASK_SLEEPING);
     
     // Add to sleeping tasks list
     task->next = sleeping_tasks;
     sleeping_tasks = task;
     
     if (task == current_task) {
+        AccountSwitch(task, nullptr, true);
         current_task = nullptr;
         Schedule(); // Switch to another task
     }
@@ -390,15 +798,78 @@ bool Scheduler::SleepTask(uint32_t task_id, uint32_t milliseconds) {
     return true;
 }
 
+bool Scheduler::WakeTask(uint32_t task_id) {
+    Thread** link = &sleeping_tasks;
+    while (*link && (*link)->task_id != task_id) link = &(*link)->next;
+    Thread* task = *link;
+    if (!task || task->state != TASK_SLEEPING) return false;
+
+    *link = task->next;
+    task->woken = true;
+    Tracer::Wakeup(task->task_id);
+    AddToReadyQueue(task);
+    return true;
+}
+
+bool Scheduler::SetDeadlineParams(uint32_t task_id, uint32_t period_ms, uint32_t budget_ms) {
+    uint32_t flags = IrqSave();
+    Thread* task = FindTask(task_id);
+    if (!task || task->state == TASK_TERMINATED) {
+        IrqRestore(flags);
+        return false;
+    }
+
+    uint32_t period = 0, budget = 0, share = 0;
+    if (period_ms) {
+        period = MsToTicks(period_ms);
+        budget = MsToTicks(budget_ms);
+        if (budget > period) {
+            IrqRestore(flags);
+            return false;
+        }
+        share = (budget * 1000) / period;
+        if (deadline_utilization - DeadlineShare(task) + share > DEADLINE_MAX_UTILIZATION) {
+            IrqRestore(flags);
+            Logger::LogKV("Deadline admission rejected", task->GetName());
+            return false;
+        }
+    }
+
+    // Pull it off its run queue so it is requeued on the right one
+    if (task == current_task) UpdateCurrentFair();
+    bool requeue = task != current_task && task->state == TASK_READY && UnlinkReadyTask(task);
+    ReleaseDeadline(task);
+    if (!period && task->vruntime < min_vruntime) task->vruntime = min_vruntime;
+    if (period) {
+        task->sched_class = SCHED_CLASS_DEADLINE;
+        task->dl_period = period;
+        task->dl_budget = budget;
+        StartDeadlinePeriod(task);
+        deadline_utilization += share;
+    }
+    if (requeue) AddToReadyQueue(task);
+    IrqRestore(flags);
+    return true;
+}
+
 bool Scheduler::SetTaskPriority(uint32_t task_id, ThreadPriority new_priority) {
+    uint32_t flags = IrqSave();
     Thread* task = FindTask(task_id);
-    if (!task || task->state == TASK_TERMINATED) return false;
+    if (!task || task->state == TASK_TERMINATED) {
+        IrqRestore(flags);
+        return false;
+    }
     
+    // Settle vruntime at the old weight, then requeue under the new
+    // priority; NORMAL and LOW map onto fair-class weights
+    if (task == current_task) UpdateCurrentFair();
+    bool requeue = task != current_task && task->state == TASK_READY && UnlinkReadyTask(task);
+    bool was_fair = IsFairTask(task);
     task->priority = new_priority;
+    if (!was_fair && IsFairTask(task) && task->vruntime < min_vruntime) task->vruntime = min_vruntime;
+    if (requeue) AddToReadyQueue(task);
     
-    // If task is in ready queue, we should move it to the correct priority queue
-    // For simplicity, just update the priority - it will be in the correct queue next time it's scheduled
-    
+    IrqRestore(flags);
     return true;
 }
 
@@ -417,6 +888,9 @@ uint32_t Scheduler::GetTaskCountByState(TaskState state) const {
                 task = task->next;
             }
         }
+        count += fair_count;
+        for (Thread* task = deadline_queue; task; task = task->next) count++;
+        for (Thread* task = throttled_tasks; task; task = task->next) count++;
     }
     
     // Check sleeping tasks
@@ -459,6 +933,47 @@ void Scheduler::PrintTaskList() const {
         }
     }
     
+    // Show fair-class ready tasks (heap order)
+    for (uint32_t i = 0; i < fair_count; i++) {
+        Thread* t = fair_heap[i];
+        TTY::Write("READY: ID=");
+        TTY::WriteHex(t->task_id);
+        TTY::Write(" Priority=");
+        TTY::WriteHex(t->priority);
+        TTY::Write(" Runtime=");
+        TTY::WriteHex(t->total_runtime);
+        TTY::Write(" VRuntimeMs=");
+        TTY::WriteHex((uint32_t)(t->vruntime / 1000));
+        TTY::Write("\n");
+    }
+    
+    // Show deadline-class tasks, wherever they are queued
+    auto print_deadline = [](const Thread* t, const char* tag) {
+        TTY::Write(tag);
+        TTY::Write(": ID=");
+        TTY::WriteHex(t->task_id);
+        TTY::Write(" Period=");
+        TTY::WriteHex(t->dl_period);
+        TTY::Write(" Budget=");
+        TTY::WriteHex(t->dl_budget);
+        TTY::Write(" Left=");
+        TTY::WriteHex(t->dl_budget_left);
+        TTY::Write(" Misses=");
+        TTY::WriteHex(t->dl_misses);
+        TTY::Write("\n");
+    };
+    if (current_task && current_task->sched_class == SCHED_CLASS_DEADLINE) {
+        print_deadline(current_task, "DL-RUNNING");
+    }
+    for (Thread* t = deadline_queue; t; t = t->next) print_deadline(t, "DL-READY");
+    for (Thread* t = throttled_tasks; t; t = t->next) print_deadline(t, "DL-THROTTLED");
+    for (Thread* t = sleeping_tasks; t; t = t->next) {
+        if (t->sched_class == SCHED_CLASS_DEADLINE) print_deadline(t, "DL-SLEEPING");
+    }
+    TTY::Write("Deadline utilization (permille): ");
+    TTY::WriteHex(deadline_utilization);
+    TTY::Write("\n");
+    
     // Show sleeping tasks
     Thread* task = sleeping_tasks;
     while (task) {
@@ -471,6 +986,96 @@ void Scheduler::PrintTaskList() const {
     }
 }
 
+// Cycle accounting
+uint64_t Scheduler::ReadCycles() const {
+    return tsc_available ? cpu::ReadTSC() : 0;
+}
+
+void Scheduler::CalibrateCycles() {
+    if (!tsc_available || cycles_per_us) return;
+    if (current_tick - calib_start_tick < TSC_CALIBRATION_TICKS) return;
+    uint64_t elapsed = cpu::ReadTSC() - calib_start_tsc;
+    uint64_t per_us = elapsed / ((current_tick - calib_start_tick) * TICK_MICROSECONDS);
+    if (per_us == 0) per_us = 1;
+    cycles_per_us = (uint32_t)per_us;
+}
+
+uint64_t Scheduler::CyclesToMicroseconds(uint64_t cycles) const {
+    if (!cycles_per_us) return 0;
+    return cycles / cycles_per_us;
+}
+
+uint32_t Scheduler::CyclesToMilliseconds(uint64_t cycles) const {
+    uint64_t ms = CyclesToMicroseconds(cycles) / 1000;
+    return (ms > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (uint32_t)ms;
+}
+
+uint64_t Scheduler::GetRunCycles(const Thread* task) const {
+    if (!task) return 0;
+    uint64_t cycles = task->run_cycles;
+    if (task == current_task && task->run_start_tsc && tsc_available) {
+        cycles += cpu::ReadTSC() - task->run_start_tsc;
+    }
+    return cycles;
+}
+
+// Called whenever current_task changes. prev may equal next when the
+// running task is re-picked; its run time is still charged but it does
+// not count as a switch.
+void Scheduler::AccountSwitch(Thread* prev, Thread* next, bool voluntary) {
+    if (prev != next) Tracer::Switch(prev ? prev->task_id : 0, next ? next->task_id : 0);
+    if (next) {
+        // vruntime is charged from here (see UpdateCurrentFair)
+        next->fair_mark_tick = current_tick;
+        next->fair_mark_tsc = ReadCycles();
+    }
+    if (!tsc_available) return;
+    uint64_t now = cpu::ReadTSC();
+    if (prev) {
+        if (prev->run_start_tsc) prev->run_cycles += now - prev->run_start_tsc;
+        prev->run_start_tsc = 0;
+        if (prev != next) {
+            if (voluntary) prev->voluntary_switches++;
+            else prev->involuntary_switches++;
+        }
+    }
+    if (next) {
+        if (next->ready_since_tsc) {
+            uint64_t waited = now - next->ready_since_tsc;
+            next->wait_cycles += waited;
+            if (next->woken) RecordWakeLatency((int)next->priority, waited);
+        }
+        next->woken = false;
+        next->ready_since_tsc = 0;
+        next->run_start_tsc = now;
+    }
+}
+
+void Scheduler::RecordWakeLatency(int priority, uint64_t cycles) {
+    if (!cycles_per_us) return; // not calibrated yet
+    if (priority < 0 || priority >= 5) priority = PRIORITY_NORMAL;
+    uint64_t us64 = CyclesToMicroseconds(cycles);
+    uint32_t us = (us64 > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (uint32_t)us64;
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && us >= (1u << bucket)) bucket++;
+    wake_latency_hist[priority][bucket]++;
+    wake_latency_samples[priority]++;
+    if (us > wake_latency_max_us[priority]) wake_latency_max_us[priority] = us;
+}
+
+uint32_t Scheduler::GetWakeLatencyBucket(int prio, int bucket) const {
+    if (prio < 0 || prio >= 5 || bucket < 0 || bucket >= LATENCY_BUCKETS) return 0;
+    return wake_latency_hist[prio][bucket];
+}
+
+uint32_t Scheduler::GetWakeLatencySamples(int prio) const {
+    return (prio >= 0 && prio < 5) ? wake_latency_samples[prio] : 0;
+}
+
+uint32_t Scheduler::GetWakeLatencyMaxMicroseconds(int prio) const {
+    return (prio >= 0 && prio < 5) ? wake_latency_max_us[prio] : 0;
+}
+
 // Helper functions for interrupt-based context switching
 void Scheduler::SaveContextFromInterrupt(CPUContext* context, uint32_t esp) {
     // The interrupt stack frame looks like this (from top to bottom):
@@ -574,6 +1179,16 @@ namespace kos::process::SchedulerAPI {
         return g_scheduler->ResumeTask(thread_id);
     }
     
+    bool WakeThread(uint32_t thread_id) {
+        if (!g_scheduler) return false;
+        return g_scheduler->WakeTask(thread_id);
+    }
+    
+    bool SetThreadDeadline(uint32_t thread_id, uint32_t period_ms, uint32_t budget_ms) {
+        if (!g_scheduler) return false;
+        return g_scheduler->SetDeadlineParams(thread_id, period_ms, budget_ms);
+    }
+    
     bool KillThread(uint32_t thread_id) {
         if (!g_scheduler) return false;
         return g_scheduler->KillTask(thread_id);
@@ -0,0 +1,300 @@
+#include <process/shared_memory.hpp>
+#include <process/scheduler.hpp>
+#include <memory/heap.hpp>
+#include <memory/pmm.hpp>
+#include <memory/paging.hpp>
+#include <lib/string.hpp>
+#include <console/logger.hpp>
+#include <console/tty.hpp>
+
+using namespace kos::process;
+using namespace kos::memory;
+using namespace kos::lib;
+using namespace kos::console;
+
+SharedMemoryManager* kos::process::g_shm_manager = nullptr;
+
+namespace {
+    bool NamesEqual(const char* a, const char* b) {
+        if (!a || !b) return false;
+        uint32_t len_a = strlen(a);
+        uint32_t len_b = strlen(b);
+        if (len_a != len_b) return false;
+        return String::strcmp((const int8_t*)a, (const int8_t*)b, len_a) == 0;
+    }
+
+    inline uint32_t PageRound(uint32_t bytes) {
+        return (bytes + (uint32_t)PAGE_SIZE - 1) & ~((uint32_t)PAGE_SIZE - 1);
+    }
+}
+
+// SharedMemoryRegion implementation
+
+SharedMemoryRegion::SharedMemoryRegion(uint32_t id, const char* region_name, uint32_t bytes, uint32_t owner)
+    : region_id(id), owner_id(owner), size(PageRound(bytes)), page_count(0),
+      frames(nullptr), base(0), mapper_count(0), unlinked(false) {
+    int name_len = strlen(region_name);
+    if (name_len >= (int)sizeof(name)) name_len = sizeof(name) - 1;
+    for (int i = 0; i < name_len; i++) {
+        name[i] = region_name[i];
+    }
+    name[name_len] = '\0';
+
+    for (uint32_t i = 0; i < SHM_MAX_MAPPERS; i++) {
+        mappers[i] = 0;
+    }
+}
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+    if (!frames) return;
+    for (uint32_t i = 0; i < page_count; i++) {
+        Paging::UnmapPage(base + i * PAGE_SIZE);
+        PMM::FreeFrame(frames[i]);
+    }
+    Heap::Free(frames);
+}
+
+bool SharedMemoryRegion::Populate(virt_addr_t vaddr) {
+    uint32_t pages = size / PAGE_SIZE;
+    frames = (phys_addr_t*)Heap::Alloc(sizeof(phys_addr_t) * pages);
+    if (!frames) return false;
+    base = vaddr;
+
+    // page_count tracks what the destructor has to give back
+    for (uint32_t i = 0; i < pages; i++) {
+        phys_addr_t frame = PMM::AllocFrame();
+        if (!frame) return false;
+        virt_addr_t va = base + i * PAGE_SIZE;
+        Paging::MapPage(va, frame, Paging::Present | Paging::RW | Paging::User);
+        frames[i] = frame;
+        page_count++;
+        if ((Paging::GetPhys(va) & ~((phys_addr_t)PAGE_SIZE - 1)) != frame) return false;
+    }
+    String::memset((void*)base, 0, size);
+    return true;
+}
+
+void* SharedMemoryRegion::Map(uint32_t task_id) {
+    if (unlinked) return nullptr;
+    if (!IsMappedBy(task_id)) {
+        if (mapper_count >= SHM_MAX_MAPPERS) return nullptr;
+        mappers[mapper_count++] = task_id;
+    }
+    return (void*)base;
+}
+
+bool SharedMemoryRegion::Unmap(uint32_t task_id) {
+    for (uint32_t i = 0; i < mapper_count; i++) {
+        if (mappers[i] != task_id) continue;
+        mappers[i] = mappers[--mapper_count];
+        return true;
+    }
+    return false;
+}
+
+bool SharedMemoryRegion::IsMappedBy(uint32_t task_id) const {
+    for (uint32_t i = 0; i < mapper_count; i++) {
+        if (mappers[i] == task_id) return true;
+    }
+    return false;
+}
+
+void SharedMemoryRegion::PrintInfo() const {
+    TTY::Write("SHM ID: ");
+    TTY::WriteHex(region_id);
+    TTY::Write(" Name: ");
+    TTY::Write(name);
+    TTY::Write(" Size: ");
+    TTY::WriteHex(size);
+    TTY::Write(" At: ");
+    TTY::WriteHex((uint32_t)base);
+    TTY::Write(" Mappers: ");
+    TTY::WriteHex(mapper_count);
+    if (unlinked) TTY::Write(" (destroyed)");
+    TTY::Write("\n");
+}
+
+// SharedMemoryManager implementation
+
+SharedMemoryManager::SharedMemoryManager() : region_count(0), next_region_id(1) {
+    for (uint32_t i = 0; i < SHM_MAX_REGIONS; i++) {
+        regions[i] = nullptr;
+    }
+    manager_lock = new RwLock();
+    Logger::Log("Shared memory manager initialized");
+}
+
+SharedMemoryManager::~SharedMemoryManager() {
+    for (uint32_t i = 0; i < SHM_MAX_REGIONS; i++) {
+        if (regions[i]) Release(i);
+    }
+    if (manager_lock) delete manager_lock;
+}
+
+int SharedMemoryManager::FindRegionIndex(uint32_t region_id) const {
+    for (uint32_t i = 0; i < SHM_MAX_REGIONS; i++) {
+        if (regions[i] && regions[i]->GetId() == region_id) return i;
+    }
+    return -1;
+}
+
+int SharedMemoryManager::FindRegionIndex(const char* name) const {
+    if (!name) return -1;
+    // A destroyed region keeps its slot until unmapped but loses its name
+    for (uint32_t i = 0; i < SHM_MAX_REGIONS; i++) {
+        if (regions[i] && !regions[i]->IsUnlinked() && NamesEqual(regions[i]->GetName(), name)) return i;
+    }
+    return -1;
+}
+
+virt_addr_t SharedMemoryManager::FindWindowSpace(uint32_t bytes) const {
+    virt_addr_t candidate = SHM_WINDOW_BASE;
+    const virt_addr_t window_end = SHM_WINDOW_BASE + SHM_WINDOW_SIZE;
+    bool moved = true;
+    // Slide past every region overlapping the candidate until none does
+    while (moved) {
+        moved = false;
+        if (candidate + bytes > window_end) return 0;
+        for (uint32_t i = 0; i < SHM_MAX_REGIONS; i++) {
+            const SharedMemoryRegion* r = regions[i];
+            if (!r || !r->GetBase()) continue;
+            virt_addr_t r_end = r->GetBase() + r->GetSize();
+            if (candidate < r_end && r->GetBase() < candidate + bytes) {
+                candidate = r_end;
+                moved = true;
+            }
+        }
+    }
+    return candidate;
+}
+
+void SharedMemoryManager::Release(int index) {
+    delete regions[index];
+    regions[index] = nullptr;
+    region_count--;
+}
+
+SharedMemoryRegion* SharedMemoryManager::CreateRegion(const char* name, uint32_t size, uint32_t owner_id) {
+    if (!name || !name[0] || size == 0 || size > SHM_MAX_SIZE) return nullptr;
+
+    WriteLockGuard lock(*manager_lock);
+    if (region_count >= SHM_MAX_REGIONS || FindRegionIndex(name) >= 0) return nullptr;
+
+    int slot = -1;
+    for (uint32_t i = 0; i < SHM_MAX_REGIONS; i++) {
+        if (!regions[i]) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) return nullptr;
+
+    SharedMemoryRegion* region = new SharedMemoryRegion(next_region_id, name, size, owner_id);
+    if (!region) return nullptr;
+    virt_addr_t vaddr = FindWindowSpace(region->GetSize());
+    if (!vaddr || !region->Populate(vaddr)) {
+        Logger::LogKV("SHM: cannot back region", name);
+        delete region;
+        return nullptr;
+    }
+
+    next_region_id++;
+    regions[slot] = region;
+    region_count++;
+    if (Logger::IsDebugEnabled()) {
+        Logger::LogKV("Created shared memory region", name);
+    }
+    return region;
+}
+
+bool SharedMemoryManager::DestroyRegion(uint32_t region_id) {
+    WriteLockGuard lock(*manager_lock);
+    int index = FindRegionIndex(region_id);
+    if (index < 0 || regions[index]->IsUnlinked()) return false;
+
+    if (regions[index]->GetMapperCount() > 0) {
+        regions[index]->MarkUnlinked();
+    } else {
+        Release(index);
+    }
+    return true;
+}
+
+SharedMemoryRegion* SharedMemoryManager::FindRegion(uint32_t region_id) const {
+    ReadLockGuard lock(*manager_lock);
+    int index = FindRegionIndex(region_id);
+    return (index >= 0) ? regions[index] : nullptr;
+}
+
+SharedMemoryRegion* SharedMemoryManager::FindRegion(const char* name) const {
+    ReadLockGuard lock(*manager_lock);
+    int index = FindRegionIndex(name);
+    return (index >= 0) ? regions[index] : nullptr;
+}
+
+void* SharedMemoryManager::MapRegion(uint32_t region_id, uint32_t task_id, uint32_t* size_out) {
+    // Exclusive: the mapper list changes
+    WriteLockGuard lock(*manager_lock);
+    int index = FindRegionIndex(region_id);
+    if (index < 0) return nullptr;
+    void* addr = regions[index]->Map(task_id);
+    if (addr && size_out) *size_out = regions[index]->GetSize();
+    return addr;
+}
+
+bool SharedMemoryManager::UnmapRegion(uint32_t region_id, uint32_t task_id) {
+    WriteLockGuard lock(*manager_lock);
+    int index = FindRegionIndex(region_id);
+    if (index < 0 || !regions[index]->Unmap(task_id)) return false;
+    if (regions[index]->IsUnlinked() && regions[index]->GetMapperCount() == 0) {
+        Release(index);
+    }
+    return true;
+}
+
+void SharedMemoryManager::PrintAllRegions() const {
+    ReadLockGuard lock(*manager_lock);
+
+    TTY::Write("=== Shared Memory ===\n");
+    TTY::Write("Regions: ");
+    TTY::WriteHex(region_count);
+    TTY::Write("/");
+    TTY::WriteHex(SHM_MAX_REGIONS);
+    TTY::Write("\n");
+
+    for (uint32_t i = 0; i < SHM_MAX_REGIONS; i++) {
+        if (regions[i]) regions[i]->PrintInfo();
+    }
+}
+
+// SharedMemoryAPI implementation (process namespace)
+
+namespace kos::process::SharedMemoryAPI {
+
+    uint32_t Create(const char* name, uint32_t size) {
+        if (!g_shm_manager) return 0;
+        SharedMemoryRegion* region = g_shm_manager->CreateRegion(name, size, SchedulerAPI::GetCurrentThreadId());
+        return region ? region->GetId() : 0;
+    }
+
+    uint32_t Open(const char* name) {
+        if (!g_shm_manager) return 0;
+        SharedMemoryRegion* region = g_shm_manager->FindRegion(name);
+        return region ? region->GetId() : 0;
+    }
+
+    void* Map(uint32_t region_id, uint32_t* size_out) {
+        if (!g_shm_manager) return nullptr;
+        return g_shm_manager->MapRegion(region_id, SchedulerAPI::GetCurrentThreadId(), size_out);
+    }
+
+    bool Unmap(uint32_t region_id) {
+        if (!g_shm_manager) return false;
+        return g_shm_manager->UnmapRegion(region_id, SchedulerAPI::GetCurrentThreadId());
+    }
+
+    bool Destroy(uint32_t region_id) {
+        if (!g_shm_manager) return false;
+        return g_shm_manager->DestroyRegion(region_id);
+    }
+}
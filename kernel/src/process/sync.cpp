@@ -1,9 +1,33 @@
 #include <process/sync.hpp>
 #include <process/scheduler.hpp>
 #include <console/logger.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
 
 using namespace kos::process;
 using namespace kos::console;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
+
+namespace {
+    uint32_t CurrentThreadId() {
+        if (g_scheduler && g_scheduler->GetCurrentTask()) {
+            return g_scheduler->GetCurrentTask()->task_id;
+        }
+        return 0;
+    }
+
+    inline void CompilerBarrier() {
+        asm volatile("" ::: "memory");
+    }
+
+    inline void YieldOrSpin() {
+        if (g_scheduler) {
+            g_scheduler->Yield();
+        } else {
+            asm volatile("rep; nop" ::: "memory");
+        }
+    }
+}
 
 // Mutex implementation
 Mutex::Mutex() : owner_thread_id(0), waiting_queue(nullptr), locked(false) {
@@ -195,3 +219,204 @@ void ConditionVariable::Broadcast() {
         }
     }
 }
+
+
+// RwLock implementation
+RwLock::RwLock()
+    : guard(0), reader_count(0), writers_waiting(0), writer_id(0),
+      write_depth(0), writer_held(false) {
+    for (uint32_t i = 0; i < MAX_READERS; i++) {
+        reader_ids[i] = 0;
+        reader_depth[i] = 0;
+    }
+}
+
+RwLock::~RwLock() {
+}
+
+void RwLock::Acquire() {
+    while (__sync_lock_test_and_set(&guard, 1u) != 0u) {
+        YieldOrSpin();
+    }
+}
+
+void RwLock::Release() {
+    __sync_lock_release(&guard);
+}
+
+int RwLock::FindReader(uint32_t thread_id) const {
+    for (uint32_t i = 0; i < MAX_READERS; i++) {
+        if (reader_depth[i] && reader_ids[i] == thread_id) return (int)i;
+    }
+    return -1;
+}
+
+bool RwLock::TryReadLocked(uint32_t thread_id) {
+    // The writer may read what it is protecting
+    if (writer_held && writer_id == thread_id) {
+        write_depth++;
+        return true;
+    }
+
+    // A nested read must not wait for a writer that waits for it
+    int slot = FindReader(thread_id);
+    if (slot >= 0) {
+        reader_depth[slot]++;
+        reader_count++;
+        return true;
+    }
+
+    // Back off while a writer holds or is waiting for the lock
+    if (writer_held || writers_waiting) return false;
+
+    for (uint32_t i = 0; i < MAX_READERS; i++) {
+        if (reader_depth[i]) continue;
+        reader_ids[i] = thread_id;
+        reader_depth[i] = 1;
+        reader_count++;
+        return true;
+    }
+    // Every slot is taken; wait for a reader to leave
+    return false;
+}
+
+void RwLock::ReadLock() {
+    uint32_t current_thread = CurrentThreadId();
+
+    while (true) {
+        Acquire();
+        bool acquired = TryReadLocked(current_thread);
+        Release();
+        if (acquired) return;
+        YieldOrSpin();
+    }
+}
+
+bool RwLock::TryReadLock() {
+    uint32_t current_thread = CurrentThreadId();
+
+    Acquire();
+    bool acquired = TryReadLocked(current_thread);
+    Release();
+
+    return acquired;
+}
+
+void RwLock::ReadUnlock() {
+    uint32_t current_thread = CurrentThreadId();
+
+    Acquire();
+    int slot = FindReader(current_thread);
+    if (writer_held && writer_id == current_thread && write_depth > 1) {
+        write_depth--;
+    } else if (slot >= 0) {
+        reader_depth[slot]--;
+        reader_count--;
+    }
+    Release();
+}
+
+void RwLock::WriteLock() {
+    uint32_t current_thread = CurrentThreadId();
+    bool waiting = false;
+
+    while (true) {
+        Acquire();
+
+        if (writer_held && writer_id == current_thread) {
+            write_depth++;
+            if (waiting) writers_waiting--;
+            Release();
+            return;
+        }
+
+        if (!writer_held && reader_count == 0) {
+            writer_held = true;
+            writer_id = current_thread;
+            write_depth = 1;
+            if (waiting) writers_waiting--;
+            Release();
+            return;
+        }
+
+        // Register as waiting so new readers stop entering
+        if (!waiting) {
+            writers_waiting++;
+            waiting = true;
+        }
+
+        Release();
+        YieldOrSpin();
+    }
+}
+
+bool RwLock::TryWriteLock() {
+    uint32_t current_thread = CurrentThreadId();
+    bool acquired = false;
+
+    Acquire();
+    if (writer_held && writer_id == current_thread) {
+        write_depth++;
+        acquired = true;
+    } else if (!writer_held && reader_count == 0) {
+        writer_held = true;
+        writer_id = current_thread;
+        write_depth = 1;
+        acquired = true;
+    }
+    Release();
+
+    return acquired;
+}
+
+void RwLock::WriteUnlock() {
+    uint32_t current_thread = CurrentThreadId();
+
+    Acquire();
+    if (writer_held && writer_id == current_thread) {
+        if (--write_depth == 0) {
+            writer_held = false;
+            writer_id = 0;
+        }
+    }
+    Release();
+}
+
+// SeqLock implementation
+SeqLock::SeqLock() : sequence(0), writer_lock(0), saved_flags(0) {
+}
+
+uint32_t SeqLock::ReadBegin() const {
+    uint32_t seq;
+    while ((seq = sequence) & 1u) {
+        asm volatile("rep; nop" ::: "memory");
+    }
+    CompilerBarrier();
+    return seq;
+}
+
+bool SeqLock::ReadRetry(uint32_t start) const {
+    CompilerBarrier();
+    return sequence != start;
+}
+
+void SeqLock::WriteLock() {
+    uint32_t flags = IrqSave();
+
+    while (__sync_lock_test_and_set(&writer_lock, 1u) != 0u) {
+        asm volatile("rep; nop" ::: "memory");
+    }
+
+    saved_flags = flags;
+    sequence = sequence + 1;
+    CompilerBarrier();
+}
+
+void SeqLock::WriteUnlock() {
+    CompilerBarrier();
+    sequence = sequence + 1;
+
+    uint32_t flags = saved_flags;
+    __sync_lock_release(&writer_lock);
+    IrqRestore(flags);
+}
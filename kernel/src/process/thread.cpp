@@ -1,4 +1,5 @@
 #include <process/thread.h>
+#include <process/tls.hpp>
 #include <memory/heap.hpp>
 #include <lib/string.hpp>
 #include <console/logger.hpp>
@@ -8,13 +9,18 @@ using namespace kos::process;
 using namespace kos::memory;
 using namespace kos::lib;
 using namespace kos::console;
+using kos::arch::x86::hardware::cpu::FPU;
 
 // Thread implementation
 
 Thread::Thread() 
     : task_id(0), state(TASK_READY), priority(PRIORITY_NORMAL), 
       stack_base(nullptr), stack_size(0), time_slice(0), sleep_until(0), 
-      total_runtime(0), name("unnamed"), next(nullptr) {
+      total_runtime(0), run_cycles(0), wait_cycles(0), run_start_tsc(0), ready_since_tsc(0),
+      voluntary_switches(0), involuntary_switches(0), woken(false), sched_class(SCHED_CLASS_PRIORITY),
+      dl_period(0), dl_budget(0), dl_deadline(0), dl_budget_left(0), dl_misses(0), dl_throttled(false),
+      vruntime(0), fair_index(-1), group_id(0), fair_mark_tsc(0), fair_mark_tick(0), fpu{nullptr, false}, tcb(nullptr),
+      name("unnamed"), next(nullptr) {
     memset(&context, 0, sizeof(CPUContext));
 }
 
@@ -22,6 +28,10 @@ Thread::Thread(uint32_t id, void* entry_point, uint32_t stack_sz,
                ThreadPriority prio, const char* thread_name) 
     : task_id(id), state(TASK_READY), priority(prio), stack_base(nullptr),
       stack_size(stack_sz), time_slice(0), sleep_until(0), total_runtime(0), 
+      run_cycles(0), wait_cycles(0), run_start_tsc(0), ready_since_tsc(0),
+      voluntary_switches(0), involuntary_switches(0), woken(false), sched_class(SCHED_CLASS_PRIORITY),
+      dl_period(0), dl_budget(0), dl_deadline(0), dl_budget_left(0), dl_misses(0), dl_throttled(false),
+      vruntime(0), fair_index(-1), group_id(0), fair_mark_tsc(0), fair_mark_tick(0), fpu{nullptr, false}, tcb(nullptr),
       name(thread_name), next(nullptr) {
     
     memset(&context, 0, sizeof(CPUContext));
@@ -46,6 +56,16 @@ bool Thread::Initialize(uint32_t id, void* entry_point, uint32_t stack_sz,
         Logger::Log("Failed to allocate stack for thread");
         return false;
     }
+    // Not fatal: without a save area the thread's FPU state is not preserved
+    if (!fpu.area && !FPU::InitContext(&fpu)) {
+        Logger::Log("Failed to allocate FPU save area for thread");
+    }
+    if (!tcb) tcb = TLS::Create(this);
+    if (!tcb) {
+        Logger::Log("Failed to allocate TLS block for thread");
+        FreeStack();
+        return false;
+    }
     
     SetupInitialStack(entry_point);
     return true;
@@ -53,6 +73,9 @@ bool Thread::Initialize(uint32_t id, void* entry_point, uint32_t stack_sz,
 
 void Thread::Cleanup() {
     FreeStack();
+    FPU::FreeContext(&fpu);
+    TLS::Destroy(tcb);
+    tcb = nullptr;
     state = TASK_TERMINATED;
 }
 
@@ -96,7 +119,8 @@ void Thread::SetupInitialStack(void* entry_point) {
     context.ds = 0x10;  // Data segment
     context.es = 0x10;
     context.fs = 0x10;
-    context.gs = 0x10;
+    // %gs is the thread pointer; the switch path rebases the TLS descriptor
+    context.gs = TLS::IsReady() ? TLS::Selector() : 0x10;
     
     // Set entry point
     context.eip = (uint32_t)entry_point;
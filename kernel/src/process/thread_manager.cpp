@@ -1,5 +1,6 @@
 #include <process/thread_manager.hpp>
 #include <process/scheduler.hpp>
+#include <process/tls.hpp>
 #include <process/pipe.hpp>
 #include <console/logger.hpp>
 #include <console/tty.hpp>
@@ -35,7 +36,7 @@ ThreadManager::ThreadManager()
       user_thread_count(0), main_thread(nullptr), shell_thread(nullptr),
     idle_thread(nullptr), threading_initialized(false) {
     
-    manager_mutex = new Mutex();
+    registry_lock = new RwLock();
 
     
         Logger::LogStatus("Thread manager created", true);
@@ -45,13 +46,13 @@ ThreadManager::ThreadManager()
 
 ThreadManager::~ThreadManager() {
     TerminateAllThreads();
-    if (manager_mutex) delete manager_mutex;
+    if (registry_lock) delete registry_lock;
 }
 
 bool ThreadManager::Initialize() {
     if (threading_initialized) return true;
     
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*registry_lock);
     
     // Ensure scheduler is available
     if (!g_scheduler) {
@@ -127,7 +128,7 @@ uint32_t ThreadManager::CreateSystemThread(void* entry_point, uint32_t stack_siz
     Thread* thread = g_scheduler->CreateTask(entry_point, stack_size, priority, description);
     if (!thread) return 0;
     
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*registry_lock);
     AddThreadEntry(thread, type, description, parent_id, true);
     if (Logger::IsDebugEnabled()) {
         Logger::Log("Created system thread");
@@ -143,7 +144,11 @@ uint32_t ThreadManager::CreateUserThread(void* entry_point, uint32_t stack_size,
     Thread* thread = g_scheduler->CreateTask(entry_point, stack_size, priority, description);
     if (!thread) return 0;
     
-    LockGuard lock(*manager_mutex);
+    // Threads of a process share its fair-scheduling group
+    Thread* parent = parent_id ? g_scheduler->FindTask(parent_id) : nullptr;
+    if (parent) thread->SetGroupId(parent->GetGroupId());
+    
+    WriteLockGuard lock(*registry_lock);
     AddThreadEntry(thread, THREAD_USER_PROCESS, description, parent_id, false);
         if (Logger::IsDebugEnabled()) {
             Logger::Log("Created user thread");
@@ -155,7 +160,7 @@ uint32_t ThreadManager::CreateUserThread(void* entry_point, uint32_t stack_size,
 bool ThreadManager::TerminateThread(uint32_t thread_id) {
     if (!g_scheduler) return false;
     
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*registry_lock);
     RemoveThreadEntry(thread_id);
     
     bool result = g_scheduler->KillTask(thread_id);
@@ -271,12 +276,12 @@ void ThreadManager::RemoveThreadEntry(uint32_t thread_id) {
 }
 
 ThreadEntry* ThreadManager::GetThreadEntry(uint32_t thread_id) {
-    LockGuard lock(*manager_mutex);
+    ReadLockGuard lock(*registry_lock);
     return FindThreadEntry(thread_id);
 }
 
 void ThreadManager::PrintAllThreads() const {
-    LockGuard lock(*manager_mutex);
+    ReadLockGuard lock(*registry_lock);
     
     TTY::Write("=== Thread Manager Status ===\n");
     TTY::Write("Total threads: ");
@@ -311,7 +316,7 @@ void ThreadManager::PrintAllThreads() const {
 }
 
 void ThreadManager::TerminateAllUserThreads() {
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*registry_lock);
     
     ThreadEntry* entry = thread_registry;
     while (entry) {
@@ -325,7 +330,7 @@ void ThreadManager::TerminateAllUserThreads() {
 }
 
 void ThreadManager::TerminateAllThreads() {
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*registry_lock);
     
     while (thread_registry) {
         ThreadEntry* entry = thread_registry;
@@ -428,9 +433,11 @@ uint32_t ThreadManager::SpawnProcess(const char* elf_path, const char* name, uin
         return 0;
     }
 
-    LockGuard lock(*manager_mutex);
+    WriteLockGuard lock(*registry_lock);
     // Assign PID (first spawn -> PID 1)
     uint32_t pid = s_next_pid++;
+    thread->SetGroupId(pid);
+    if (thread->tcb) thread->tcb->pid = pid;
     AddThreadEntry(thread, THREAD_USER_PROCESS, (name && *name) ? name : "proc", parent_id, false);
     // Set pid on the entry we just added (head of list)
     if (thread_registry && thread_registry->thread == thread) {
@@ -448,7 +455,7 @@ uint32_t ThreadManager::SpawnProcess(const char* elf_path, const char* name, uin
 }
 
 uint32_t ThreadManager::GetPid(uint32_t thread_id) {
-    LockGuard lock(*manager_mutex);
+    ReadLockGuard lock(*registry_lock);
     ThreadEntry* e = FindThreadEntry(thread_id);
     return e ? e->pid : 0;
 }
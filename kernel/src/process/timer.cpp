@@ -4,8 +4,6 @@
 #include <console/logger.hpp>
 #include <console/tty.hpp>
 #include <kernel/globals.hpp>
-#include <drivers/keyboard/keyboard_driver.hpp>
-#include <drivers/ps2/ps2.hpp>
 #include <services/service_manager.hpp>
 
 using namespace kos::process;
@@ -62,23 +60,16 @@ SchedulerTimerHandler::SchedulerTimerHandler(InterruptManager* interrupt_manager
 uint32_t SchedulerTimerHandler::HandleInterrupt(uint32_t esp) {
     tick_count++;
     
-    // Poll keyboard only in text mode as fallback for missing IRQ1.
-    // In graphics mode, window manager owns keyboard fallback polling.
-    if (::kos::g_display_mode != kos::kernel::DisplayMode::Graphics
-        && ::kos::g_kbd_poll_enabled
-        && ::kos::g_keyboard_driver_ptr) {
-        for (int i = 0; i < 4; ++i) {
-            if (!::kos::g_keyboard_driver_ptr->PollOnce()) break;
-        }
-    }
-
-    // Drive service ticking from the timer ISR only in text mode.
-    // In graphics mode, services are ticked from the main kernel loop to avoid
-    // concurrent TickAll() calls that can race window/input updates.
+    // Text mode has no thread that reliably gets the CPU to host the service
+    // event loop, so until one does, drive services from here. Work queues
+    // are not drained here: their items (input decode, NIC RX, logging) run
+    // from the shell's idle loop, not on top of whatever the tick interrupted.
     static uint32_t s_svc_tick_div = 0;
-    if (kos::g_display_mode != kos::kernel::DisplayMode::Graphics && ++s_svc_tick_div >= 3) { // 100 Hz / 3 ≈ 33 Hz
+    if (kos::g_display_mode != kos::kernel::DisplayMode::Graphics
+        && !kos::services::ServiceManager::IsEventLoopRunning()
+        && ++s_svc_tick_div >= 3) { // 100 Hz / 3 ≈ 33 Hz
         s_svc_tick_div = 0;
-        kos::services::ServiceManager::TickAll();
+        kos::services::ServiceManager::DispatchEvents();
     }
 
     // Call scheduler's timer tick handler and get potentially new ESP
@@ -0,0 +1,114 @@
+#include <process/tls.hpp>
+#include <process/thread.h>
+#include <arch/x86/memory/gdt.hpp>
+#include <memory/heap.hpp>
+#include <lib/string.hpp>
+#include <console/logger.hpp>
+
+using namespace kos::process;
+using namespace kos::memory;
+using namespace kos::lib;
+using namespace kos::console;
+using kos::arch::x86::memory::GlobalDescriptorTable;
+
+bool TLS::s_ready = false;
+
+namespace {
+    const uint32_t AREA_SIZE = TLS::STATIC_RESERVE + sizeof(ThreadControlBlock);
+
+    GlobalDescriptorTable* s_gdt = nullptr;
+    uint8_t s_boot_area[AREA_SIZE] __attribute__((aligned(TLS::BLOCK_ALIGN)));
+
+    inline ThreadControlBlock* BlockAt(uint8_t* area) {
+        return (ThreadControlBlock*)(area + TLS::STATIC_RESERVE);
+    }
+
+    void InitBlock(ThreadControlBlock* tcb, Thread* thread) {
+        tcb->self = tcb;
+        tcb->thread = thread;
+        tcb->pid = 0;
+        tcb->list_flags = 0;
+        tcb->static_size = 0;
+    }
+
+    inline ThreadControlBlock* BootBlock() { return BlockAt(s_boot_area); }
+}
+
+void TLS::Initialize(GlobalDescriptorTable* gdt) {
+    s_gdt = gdt;
+    InitBlock(BootBlock(), nullptr);
+    s_ready = true;
+    SwitchTo(nullptr);
+}
+
+uint16_t TLS::Selector() {
+    return s_gdt ? s_gdt->TlsSegmentSelector() : 0;
+}
+
+ThreadControlBlock* TLS::Create(Thread* thread) {
+    uint8_t* area = (uint8_t*)Heap::Alloc(AREA_SIZE, BLOCK_ALIGN);
+    if (!area) return nullptr;
+    ThreadControlBlock* tcb = BlockAt(area);
+    InitBlock(tcb, thread);
+    return tcb;
+}
+
+void TLS::Destroy(ThreadControlBlock* tcb) {
+    if (!tcb || tcb == BootBlock()) return;
+    // A thread can be destroyed while its block is still the live one
+    // (it terminated itself); fall back to the boot block before freeing
+    if (Current() == tcb) SwitchTo(nullptr);
+    Heap::Free((uint8_t*)tcb - STATIC_RESERVE);
+}
+
+void TLS::SwitchTo(ThreadControlBlock* tcb) {
+    if (!s_ready) return;
+    if (!tcb) tcb = BootBlock();
+    // The descriptor cache only refreshes on a selector load, so reload %gs
+    s_gdt->SetTlsBase((uint32_t)tcb);
+    uint16_t sel = s_gdt->TlsSegmentSelector();
+    __asm__ __volatile__("movw %0, %%gs" : : "r"(sel) : "memory");
+}
+
+bool TLS::LoadStaticImage(const uint8_t* init, uint32_t filesz, uint32_t memsz, uint32_t align) {
+    ThreadControlBlock* tcb = Current();
+    if (!tcb) return false;
+    if (!align) align = 1;
+    if (align > BLOCK_ALIGN || (align & (align - 1)) || filesz > memsz) return false;
+    // The linker puts the block end at the thread pointer, rounded up to p_align
+    uint32_t size = (memsz + align - 1) & ~(align - 1);
+    if (size > STATIC_RESERVE) return false;
+    uint8_t* block = (uint8_t*)tcb - size;
+    if (filesz) String::memmove(block, init, filesz);
+    String::memset(block + filesz, 0, size - filesz);
+    tcb->static_size = size;
+    return true;
+}
+
+void* TLS::SaveStatic() {
+    ThreadControlBlock* tcb = Current();
+    if (!tcb || !tcb->static_size) return nullptr;
+    uint32_t size = tcb->static_size;
+    uint8_t* saved = (uint8_t*)Heap::Alloc(size + sizeof(uint32_t));
+    if (!saved) {
+        Logger::Log("TLS: cannot save static block of the calling app");
+        return nullptr;
+    }
+    *(uint32_t*)saved = size;
+    String::memmove(saved + sizeof(uint32_t), (uint8_t*)tcb - size, size);
+    return saved;
+}
+
+void TLS::RestoreStatic(void* saved) {
+    ThreadControlBlock* tcb = Current();
+    if (!tcb) return;
+    if (!saved) {
+        tcb->static_size = 0;
+        return;
+    }
+    uint8_t* bytes = (uint8_t*)saved;
+    uint32_t size = *(uint32_t*)bytes;
+    String::memmove((uint8_t*)tcb - size, bytes + sizeof(uint32_t), size);
+    tcb->static_size = size;
+    Heap::Free(saved);
+}
@@ -0,0 +1,271 @@
+#include <process/trace.hpp>
+#include <process/scheduler.hpp>
+#include <process/thread.h>
+#include <lib/serial.hpp>
+#include <lib/stdio.hpp>
+#include <arch/x86/hardware/cpu/cpu.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
+
+using namespace kos::process;
+using namespace kos::lib;
+using kos::sys::snprintf;
+using kos::arch::x86::hardware::cpu::cpu;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
+
+volatile bool Tracer::s_enabled = false;
+
+namespace {
+    struct TraceRing {
+        TraceEvent events[Tracer::RING_SIZE];
+        volatile uint32_t head;     // Monotonic write count; slot = head & (RING_SIZE - 1)
+    };
+
+    TraceRing s_rings[Tracer::MAX_CPUS];
+    char s_labels[Tracer::MAX_LABELS][Tracer::LABEL_LEN];
+    uint32_t s_label_count = 0;
+
+    inline uint32_t CurrentCpu() { return 0; }
+
+    // Find or add a label slot. Called with interrupts masked.
+    uint32_t InternLabel(const char* label) {
+        if (!label) label = "mark";
+        for (uint32_t i = 0; i < s_label_count; ++i) {
+            uint32_t k = 0;
+            while (k < Tracer::LABEL_LEN - 1 && label[k] && s_labels[i][k] == label[k]) ++k;
+            if (s_labels[i][k] == 0 && (label[k] == 0 || k == Tracer::LABEL_LEN - 1)) return i;
+        }
+        if (s_label_count >= Tracer::MAX_LABELS) return Tracer::MAX_LABELS - 1;
+        uint32_t slot = s_label_count++;
+        uint32_t k = 0;
+        for (; k < Tracer::LABEL_LEN - 1 && label[k]; ++k) s_labels[slot][k] = label[k];
+        s_labels[slot][k] = 0;
+        return slot;
+    }
+
+    // --- JSON output helpers ---
+
+    void Emit(const char* s) { serial_write(s); }
+
+    // Copy a name into the output, dropping characters that would need escaping
+    void EmitName(const char* name) {
+        char buf[48];
+        uint32_t n = 0;
+        if (!name) name = "unnamed";
+        for (; *name && n < sizeof(buf) - 1; ++name) {
+            char c = *name;
+            if (c == '"' || c == '\\' || (uint8_t)c < 0x20) continue;
+            buf[n++] = c;
+        }
+        buf[n] = 0;
+        Emit(buf);
+    }
+
+    // Microseconds with nanosecond fraction, e.g. "1234.567"
+    void EmitTimestamp(uint64_t delta_cycles) {
+        uint32_t cyc_per_us = g_scheduler ? g_scheduler->GetCyclesPerMicrosecond() : 0;
+        // Before calibration assume a 1 GHz clock so the trace is still usable
+        if (!cyc_per_us) cyc_per_us = 1000;
+        uint64_t ns = (delta_cycles * 1000ull) / cyc_per_us;
+        uint32_t us = (uint32_t)(ns / 1000ull);
+        uint32_t frac = (uint32_t)(ns % 1000ull);
+        char buf[24];
+        snprintf(buf, sizeof(buf), "%u.", us);
+        Emit(buf);
+        buf[0] = (char)('0' + frac / 100);
+        buf[1] = (char)('0' + (frac / 10) % 10);
+        buf[2] = (char)('0' + frac % 10);
+        buf[3] = 0;
+        Emit(buf);
+    }
+
+    bool s_first_event = true;
+
+    void BeginEvent(const char* ph, uint32_t pid, uint32_t tid, uint64_t delta_cycles) {
+        char buf[64];
+        Emit(s_first_event ? "\n" : ",\n");
+        s_first_event = false;
+        snprintf(buf, sizeof(buf), "{\"ph\":\"%s\",\"pid\":%u,\"tid\":%u,\"ts\":", ph, pid, tid);
+        Emit(buf);
+        EmitTimestamp(delta_cycles);
+    }
+
+    void EmitMetadata(const char* what, uint32_t pid, uint32_t tid, const char* name) {
+        char buf[64];
+        Emit(s_first_event ? "\n" : ",\n");
+        s_first_event = false;
+        snprintf(buf, sizeof(buf), "{\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"name\":\"%s\",\"args\":{\"name\":\"",
+                 pid, tid, what);
+        Emit(buf);
+        EmitName(name);
+        Emit("\"}}");
+    }
+
+    const char* BlockReason(uint32_t state) {
+        switch (state) {
+            case TASK_BLOCKED:    return "block";
+            case TASK_SLEEPING:   return "sleep";
+            case TASK_SUSPENDED:  return "suspend";
+            case TASK_TERMINATED: return "exit";
+            default:              return "deschedule";
+        }
+    }
+
+    // Chrome trace processes: scheduler threads under one pid, IRQ lines under another
+    const uint32_t PID_THREADS = 1;
+    const uint32_t PID_IRQS = 2;
+}
+
+bool Tracer::Start() {
+    if (!cpu::HasTSC()) return false;
+    s_enabled = true;
+    return true;
+}
+
+void Tracer::Stop() {
+    s_enabled = false;
+}
+
+void Tracer::Clear() {
+    uint32_t flags = IrqSave();
+    for (uint32_t c = 0; c < MAX_CPUS; ++c) s_rings[c].head = 0;
+    s_label_count = 0;
+    IrqRestore(flags);
+}
+
+uint32_t Tracer::GetEventCount() {
+    uint32_t total = 0;
+    for (uint32_t c = 0; c < MAX_CPUS; ++c) {
+        uint32_t h = s_rings[c].head;
+        total += (h > RING_SIZE) ? RING_SIZE : h;
+    }
+    return total;
+}
+
+uint32_t Tracer::GetOverwrittenCount() {
+    uint32_t total = 0;
+    for (uint32_t c = 0; c < MAX_CPUS; ++c) {
+        uint32_t h = s_rings[c].head;
+        if (h > RING_SIZE) total += h - RING_SIZE;
+    }
+    return total;
+}
+
+void Tracer::Record(uint16_t type, uint32_t arg0, uint32_t arg1) {
+    uint32_t cpu_id = CurrentCpu();
+    TraceRing& ring = s_rings[cpu_id];
+    uint32_t flags = IrqSave();
+    TraceEvent& ev = ring.events[ring.head & (RING_SIZE - 1)];
+    ev.tsc = cpu::ReadTSC();
+    ev.type = type;
+    ev.cpu = (uint16_t)cpu_id;
+    ev.arg0 = arg0;
+    ev.arg1 = arg1;
+    ring.head = ring.head + 1;
+    IrqRestore(flags);
+}
+
+void Tracer::Mark(const char* label, uint32_t value) {
+    if (!s_enabled) return;
+    uint32_t flags = IrqSave();
+    uint32_t slot = InternLabel(label);
+    IrqRestore(flags);
+    Record(TRACE_MARK, slot, value);
+}
+
+uint32_t Tracer::Dump() {
+    Stop();
+
+    // Earliest timestamp across all rings becomes ts=0
+    uint64_t base = 0;
+    bool have_base = false;
+    for (uint32_t c = 0; c < MAX_CPUS; ++c) {
+        uint32_t h = s_rings[c].head;
+        if (!h) continue;
+        uint32_t first = (h > RING_SIZE) ? h - RING_SIZE : 0;
+        uint64_t t = s_rings[c].events[first & (RING_SIZE - 1)].tsc;
+        if (!have_base || t < base) { base = t; have_base = true; }
+    }
+
+    s_first_event = true;
+    Emit("\n=== KOS TRACE BEGIN ===\n{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    EmitMetadata("process_name", PID_THREADS, 0, "KOS threads");
+    EmitMetadata("process_name", PID_IRQS, 0, "KOS IRQs");
+
+    uint32_t written = 0;
+    for (uint32_t c = 0; c < MAX_CPUS; ++c) {
+        TraceRing& ring = s_rings[c];
+        uint32_t h = ring.head;
+        uint32_t first = (h > RING_SIZE) ? h - RING_SIZE : 0;
+
+        // Name every thread that shows up in a switch; each tid only once
+        uint32_t named[64];
+        uint32_t named_count = 0;
+        for (uint32_t i = first; i < h; ++i) {
+            const TraceEvent& ev = ring.events[i & (RING_SIZE - 1)];
+            if (ev.type != TRACE_SWITCH || ev.arg1 == 0) continue;
+            bool seen = false;
+            for (uint32_t k = 0; k < named_count; ++k) if (named[k] == ev.arg1) { seen = true; break; }
+            if (seen || named_count >= 64) continue;
+            named[named_count++] = ev.arg1;
+            Thread* t = g_scheduler ? g_scheduler->FindTask(ev.arg1) : nullptr;
+            char fallback[24];
+            snprintf(fallback, sizeof(fallback), "tid %u", ev.arg1);
+            EmitMetadata("thread_name", PID_THREADS, ev.arg1, t ? t->GetName() : fallback);
+        }
+
+        // One thread runs per CPU at a time: close its slice on every switch
+        uint32_t running = 0;
+        uint64_t last = 0;
+        char buf[64];
+        for (uint32_t i = first; i < h; ++i) {
+            const TraceEvent& ev = ring.events[i & (RING_SIZE - 1)];
+            uint64_t d = ev.tsc - base;
+            last = d;
+            switch (ev.type) {
+                case TRACE_SWITCH:
+                    if (running) {
+                        BeginEvent("E", PID_THREADS, running, d);
+                        Emit("}");
+                    }
+                    running = ev.arg1;
+                    if (running) {
+                        BeginEvent("B", PID_THREADS, running, d);
+                        Emit(",\"name\":\"run\"}");
+                    }
+                    break;
+                case TRACE_WAKEUP:
+                    BeginEvent("i", PID_THREADS, ev.arg0, d);
+                    Emit(",\"s\":\"t\",\"name\":\"wakeup\"}");
+                    break;
+                case TRACE_BLOCK:
+                    BeginEvent("i", PID_THREADS, ev.arg0, d);
+                    Emit(",\"s\":\"t\",\"name\":\"");
+                    Emit(BlockReason(ev.arg1));
+                    Emit("\"}");
+                    break;
+                case TRACE_IRQ_ENTER:
+                case TRACE_IRQ_EXIT:
+                    BeginEvent(ev.type == TRACE_IRQ_ENTER ? "B" : "E", PID_IRQS, ev.arg0, d);
+                    snprintf(buf, sizeof(buf), ",\"name\":\"irq%u\"}", ev.arg0);
+                    Emit(buf);
+                    break;
+                case TRACE_MARK:
+                    BeginEvent("i", PID_THREADS, running, d);
+                    Emit(",\"s\":\"t\",\"name\":\"");
+                    EmitName(ev.arg0 < s_label_count ? s_labels[ev.arg0] : "mark");
+                    snprintf(buf, sizeof(buf), "\",\"args\":{\"value\":%u}}", ev.arg1);
+                    Emit(buf);
+                    break;
+            }
+            written++;
+        }
+        if (running) {
+            BeginEvent("E", PID_THREADS, running, last);
+            Emit("}");
+        }
+    }
+
+    Emit("\n]}\n=== KOS TRACE END ===\n");
+    return written;
+}
@@ -0,0 +1,356 @@
+#include <process/workqueue.hpp>
+#include <process/scheduler.hpp>
+#include <process/thread_manager.hpp>
+#include <console/logger.hpp>
+#include <console/tty.hpp>
+#include <arch/x86/hardware/cpu/cpu.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
+
+using namespace kos::process;
+using namespace kos::console;
+using kos::arch::x86::hardware::cpu::cpu;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
+
+WorkQueue* WorkQueue::s_first = nullptr;
+WorkQueue* kos::process::g_system_workqueue = nullptr;
+WorkQueue* kos::process::g_highpri_workqueue = nullptr;
+
+namespace {
+    // Workers with nothing to do sleep one timer tick between checks
+    const uint32_t WORKER_IDLE_SLEEP_MS = 10;
+    // kworker-hi decodes keyboard/mouse input and polls NIC RX; it gets a
+    // guaranteed tick every 50 ms so CPU-bound PRIORITY_HIGH work cannot
+    // starve input dispatch
+    const uint32_t HIGHPRI_PERIOD_MS = 50;
+    const uint32_t HIGHPRI_BUDGET_MS = 10;
+
+    inline uint32_t CurrentTick() {
+        return g_scheduler ? g_scheduler->GetCurrentTick() : 0;
+    }
+
+    bool s_has_tsc = false;
+
+    // Set while some caller is draining inline; a drain from an interrupt
+    // that lands in the middle of another one leaves the items to it
+    volatile bool s_inline_draining = false;
+}
+
+WorkQueue::WorkQueue(const char* queue_name, ThreadPriority prio, uint32_t pool_sz)
+    : name(queue_name), priority(prio), worker_id(0), worker_alive(false), pending_head(nullptr), pending_tail(nullptr),
+      delayed(nullptr), pool(nullptr), free_items(nullptr), pool_size(pool_sz), next_queue(nullptr) {
+    stats.queued = stats.executed = stats.dropped = 0;
+    stats.depth = stats.max_depth = stats.max_latency_ticks = 0;
+    stats.busy_cycles = 0;
+
+    if (pool_size) {
+        pool = new WorkItem[pool_size];
+        if (!pool) {
+            pool_size = 0;
+            Logger::Log("WorkQueue: failed to allocate item pool");
+        }
+    }
+    for (uint32_t i = 0; i < pool_size; i++) {
+        pool[i].pooled = true;
+        pool[i].next = free_items;
+        free_items = &pool[i];
+    }
+
+    uint32_t flags = IrqSave();
+    next_queue = s_first;
+    s_first = this;
+    IrqRestore(flags);
+}
+
+WorkQueue::~WorkQueue() {
+    uint32_t flags = IrqSave();
+    WorkQueue** link = &s_first;
+    while (*link && *link != this) link = &(*link)->next_queue;
+    if (*link) *link = next_queue;
+    IrqRestore(flags);
+    delete[] pool;
+}
+
+bool WorkQueue::Start() {
+    if (worker_id) return true;
+    s_has_tsc = cpu::HasTSC();
+    worker_id = ThreadManagerAPI::CreateSystemThread((void*)WorkerEntry, THREAD_SYSTEM_SERVICE,
+                                                     4096, priority, name);
+    if (!worker_id) {
+        Logger::Log("WorkQueue: failed to create worker thread");
+        return false;
+    }
+    return true;
+}
+
+// Worker threads have no argument; find the queue that owns this thread.
+void WorkQueue::WorkerEntry() {
+    WorkQueue* self = nullptr;
+    while (!self) {
+        uint32_t tid = SchedulerAPI::GetCurrentThreadId();
+        for (WorkQueue* q = s_first; q; q = q->next_queue) {
+            if (q->worker_id == tid) { self = q; break; }
+        }
+        // Start() may not have stored worker_id yet
+        if (!self) SchedulerAPI::SleepThread(WORKER_IDLE_SLEEP_MS);
+    }
+    // From here on the inline drain leaves this queue alone
+    self->worker_alive = true;
+
+    for (;;) {
+        if (self->RunPending() == 0) {
+            SchedulerAPI::SleepThread(WORKER_IDLE_SLEEP_MS);
+        }
+    }
+}
+
+WorkItem* WorkQueue::AllocItem() {
+    WorkItem* item = free_items;
+    if (item) free_items = item->next;
+    return item;
+}
+
+void WorkQueue::FreeItem(WorkItem* item) {
+    item->next = free_items;
+    free_items = item;
+}
+
+void WorkQueue::EnqueuePendingLocked(WorkItem* item, uint32_t now) {
+    item->next = nullptr;
+    item->queued = true;
+    item->queued_tick = now;
+    if (pending_tail) pending_tail->next = item;
+    else pending_head = item;
+    pending_tail = item;
+    if (++stats.depth > stats.max_depth) stats.max_depth = stats.depth;
+}
+
+void WorkQueue::InsertDelayedLocked(WorkItem* item) {
+    item->queued = true;
+    WorkItem** link = &delayed;
+    // Signed difference keeps ordering correct across tick wraparound
+    while (*link && (int32_t)((*link)->due_tick - item->due_tick) <= 0) link = &(*link)->next;
+    item->next = *link;
+    *link = item;
+}
+
+bool WorkQueue::QueueWork(WorkFn fn, void* arg, bool blocking) {
+    if (!fn) return false;
+    uint32_t flags = IrqSave();
+    WorkItem* item = AllocItem();
+    if (!item) {
+        stats.dropped++;
+        IrqRestore(flags);
+        return false;
+    }
+    item->fn = fn;
+    item->arg = arg;
+    item->blocking = blocking;
+    EnqueuePendingLocked(item, CurrentTick());
+    stats.queued++;
+    IrqRestore(flags);
+    return true;
+}
+
+bool WorkQueue::QueueDelayedWork(WorkFn fn, void* arg, uint32_t delay_ms, bool blocking) {
+    if (!fn) return false;
+    uint32_t flags = IrqSave();
+    WorkItem* item = AllocItem();
+    if (!item) {
+        stats.dropped++;
+        IrqRestore(flags);
+        return false;
+    }
+    item->fn = fn;
+    item->arg = arg;
+    item->blocking = blocking;
+    item->due_tick = CurrentTick() + ThreadUtils::MillisecondsToTicks(delay_ms);
+    InsertDelayedLocked(item);
+    stats.queued++;
+    IrqRestore(flags);
+    return true;
+}
+
+bool WorkQueue::QueueItem(WorkItem* item) {
+    if (!item || !item->fn) return false;
+    uint32_t flags = IrqSave();
+    if (item->queued) {
+        IrqRestore(flags);
+        return false;
+    }
+    EnqueuePendingLocked(item, CurrentTick());
+    stats.queued++;
+    IrqRestore(flags);
+    return true;
+}
+
+bool WorkQueue::QueueDelayedItem(WorkItem* item, uint32_t delay_ms) {
+    if (!item || !item->fn) return false;
+    uint32_t flags = IrqSave();
+    if (item->queued) {
+        IrqRestore(flags);
+        return false;
+    }
+    item->due_tick = CurrentTick() + ThreadUtils::MillisecondsToTicks(delay_ms);
+    InsertDelayedLocked(item);
+    stats.queued++;
+    IrqRestore(flags);
+    return true;
+}
+
+bool WorkQueue::Cancel(WorkItem* item) {
+    if (!item) return false;
+    bool removed = false;
+    uint32_t flags = IrqSave();
+    if (item->queued) {
+        WorkItem* prev = nullptr;
+        for (WorkItem* it = pending_head; it; prev = it, it = it->next) {
+            if (it != item) continue;
+            if (prev) prev->next = it->next; else pending_head = it->next;
+            if (pending_tail == it) pending_tail = prev;
+            stats.depth--;
+            removed = true;
+            break;
+        }
+        if (!removed) {
+            for (WorkItem** link = &delayed; *link; link = &(*link)->next) {
+                if (*link != item) continue;
+                *link = item->next;
+                removed = true;
+                break;
+            }
+        }
+        if (removed) {
+            item->queued = false;
+            item->next = nullptr;
+            if (item->pooled) FreeItem(item);
+        }
+    }
+    IrqRestore(flags);
+    return removed;
+}
+
+uint32_t WorkQueue::RunPending(bool allow_blocking) {
+    uint32_t ran = 0;
+    uint32_t flags = IrqSave();
+    uint32_t now = CurrentTick();
+    while (delayed && (int32_t)(now - delayed->due_tick) >= 0) {
+        WorkItem* item = delayed;
+        delayed = item->next;
+        EnqueuePendingLocked(item, item->due_tick);
+    }
+
+    while (pending_head) {
+        WorkItem* item = pending_head;
+        pending_head = item->next;
+        if (!pending_head) pending_tail = nullptr;
+        stats.depth--;
+        item->next = nullptr;
+        if (item->blocking && !allow_blocking) {
+            // Delayed items were promoted above, so this cannot come round again
+            item->due_tick = now + 1;
+            InsertDelayedLocked(item);
+            continue;
+        }
+        // Clear before running so the function may requeue its own item
+        item->queued = false;
+        WorkFn fn = item->fn;
+        void* arg = item->arg;
+        uint32_t latency = now - item->queued_tick;
+        if (latency > stats.max_latency_ticks) stats.max_latency_ticks = latency;
+        if (item->pooled) FreeItem(item);
+        IrqRestore(flags);
+
+        uint64_t start = s_has_tsc ? cpu::ReadTSC() : 0;
+        fn(arg);
+        uint64_t spent = s_has_tsc ? cpu::ReadTSC() - start : 0;
+        ran++;
+
+        flags = IrqSave();
+        stats.executed++;
+        stats.busy_cycles += spent;
+    }
+    IrqRestore(flags);
+    return ran;
+}
+
+WorkQueueStats WorkQueue::GetStats() const {
+    uint32_t flags = IrqSave();
+    WorkQueueStats copy = stats;
+    IrqRestore(flags);
+    return copy;
+}
+
+void WorkQueue::PrintStats() const {
+    WorkQueueStats s = GetStats();
+    TTY::Write(name);
+    TTY::Write(": worker=");
+    TTY::WriteHex(worker_id);
+    TTY::Write(worker_alive ? "" : " (inline)");
+    TTY::Write(" prio=");
+    TTY::WriteHex((uint32_t)priority);
+    TTY::Write(" queued=");
+    TTY::WriteHex(s.queued);
+    TTY::Write(" done=");
+    TTY::WriteHex(s.executed);
+    TTY::Write(" dropped=");
+    TTY::WriteHex(s.dropped);
+    TTY::Write(" depth=");
+    TTY::WriteHex(s.depth);
+    TTY::Write("/");
+    TTY::WriteHex(s.max_depth);
+    TTY::Write(" maxlat=");
+    TTY::WriteHex(s.max_latency_ticks);
+    TTY::Write("t busy_us=");
+    TTY::WriteHex(g_scheduler ? (uint32_t)g_scheduler->CyclesToMicroseconds(s.busy_cycles) : 0);
+    TTY::Write("\n");
+}
+
+namespace kos::process::WorkQueueAPI {
+    void Initialize() {
+        if (!g_system_workqueue) g_system_workqueue = new WorkQueue("kworker", PRIORITY_NORMAL, 64);
+        if (!g_highpri_workqueue) g_highpri_workqueue = new WorkQueue("kworker-hi", PRIORITY_HIGH, 32);
+    }
+
+    void StartWorkers() {
+        for (WorkQueue* q = WorkQueue::First(); q; q = q->Next()) {
+            q->Start();
+        }
+        if (g_highpri_workqueue && g_highpri_workqueue->GetWorkerId()
+            && !SchedulerAPI::SetThreadDeadline(g_highpri_workqueue->GetWorkerId(),
+                                                HIGHPRI_PERIOD_MS, HIGHPRI_BUDGET_MS)) {
+            Logger::Log("WorkQueue: deadline reservation refused; kworker-hi stays in the priority class");
+        }
+    }
+
+    bool QueueWork(WorkFn fn, void* arg, bool blocking) {
+        return g_system_workqueue ? g_system_workqueue->QueueWork(fn, arg, blocking) : false;
+    }
+
+    bool QueueDelayedWork(WorkFn fn, void* arg, uint32_t delay_ms, bool blocking) {
+        return g_system_workqueue ? g_system_workqueue->QueueDelayedWork(fn, arg, delay_ms, blocking) : false;
+    }
+
+    uint32_t DrainInline(bool allow_blocking) {
+        uint32_t flags = IrqSave();
+        bool busy = s_inline_draining;
+        s_inline_draining = true;
+        IrqRestore(flags);
+        if (busy) return 0;
+        uint32_t drained = 0;
+        for (WorkQueue* q = WorkQueue::First(); q; q = q->Next()) {
+            if (q->IsRunning()) continue;
+            q->RunPending(allow_blocking);
+            drained++;
+        }
+        s_inline_draining = false;
+        return drained;
+    }
+
+    void PrintAll() {
+        TTY::Write("=== Work Queues ===\n");
+        for (WorkQueue* q = WorkQueue::First(); q; q = q->Next()) {
+            q->PrintStats();
+        }
+    }
+}
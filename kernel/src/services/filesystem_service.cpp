@@ -1,4 +1,5 @@
 #include <services/filesystem_service.hpp>
+#include <services/service_manager.hpp>
 #include <console/logger.hpp>
 #include <fs/filesystem.hpp>
 
@@ -34,6 +35,7 @@ bool FilesystemService::Start() {
     }
 
     Logger::Log("FilesystemService: ready");
+    ServiceManager::PostEvent(SERVICE_EVENT_FS_READY);
     return true;
 }
 
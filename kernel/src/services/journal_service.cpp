@@ -1,52 +1,67 @@
 #include "services/journal_service.hpp"
+#include "services/service_manager.hpp"
 #include "lib/string.hpp"
 #include <lib/socket.hpp>
+#include <fs/filesystem.hpp>
+#include <process/scheduler.hpp>
+#include <console/tty.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
 
 
 using namespace kos::services;
 using namespace kos::lib;
+using namespace kos::process;
+using namespace kos::console;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
+using kos::arch::x86::hardware::cpu::InterruptsEnabled;
 
 #define JOURNAL_SOCKET_PATH "/run/systemd/journal/socket"
-#define LOG_BUFFER_SIZE 100
-#define LOG_ENTRY_SIZE 100
 
-// Remove duplicate constructor
-#include <fs/filesystem.hpp>
+namespace {
+    const char* const LOG_PATH = "/var/log/system.log";
+
+    inline uint32_t NowMs() {
+        return ServiceManager::UptimeMs();
+    }
+
+    // Decimal digits of v at out; returns how many
+    uint32_t FormatDec(uint32_t v, char* out) {
+        char rev[10];
+        uint32_t n = 0;
+        do {
+            rev[n++] = (char)('0' + v % 10);
+            v /= 10;
+        } while (v);
+        for (uint32_t i = 0; i < n; ++i) out[i] = rev[n - 1 - i];
+        return n;
+    }
 
-// Helper at global scope to access the filesystem pointer defined in kernel.cpp
-namespace kos {
-namespace services {
-extern kos::fs::Filesystem* get_fs();
+    void WriteDec(uint32_t v) {
+        char digits[10];
+        uint32_t n = FormatDec(v, digits);
+        for (uint32_t i = 0; i < n; ++i) TTY::PutChar((int8_t)digits[i]);
+    }
 }
+
+JournalService::JournalService()
+    : journalSocket(nullptr), ringHead(0), ringTail(0), pendingSince(0), droppedUnreported(0),
+      writerBusy(false), writerThread(0), rotateRequested(false), fsReady(false), logDirReady(false), logSeq(0),
+      overflowPolicy(JOURNAL_OVERFLOW_WAIT),
+      commitWork(&JournalService::WriterWork, this, true), timerWork(&JournalService::WriterWork, this, true) {
+    String::memset(&stats, 0, sizeof(stats));
 }
-JournalService::JournalService() : logCount(0), journalSocket(nullptr), logFileFd(-1), logSeq(0) { fsReady = false; pendingFlush = false; }
 
 JournalService::~JournalService() {
     Stop();
-    if (journalSocket) {
-        delete journalSocket;
-        journalSocket = nullptr;
-    }
-    if (logFileFd >= 0) {
-        // Close log file (pseudo code, replace with your FS API)
-        // fs_close(logFileFd);
-        logFileFd = -1;
-    }
 }
 
 bool JournalService::Start() {
     if (journalSocket) { journalSocket->closeSocket(); delete journalSocket; journalSocket = nullptr; }
     journalSocket = new kos::lib::Socket(kos::lib::SocketDomain::UNIX, kos::lib::SocketType::DGRAM, kos::lib::SocketProtocol::DEFAULT);
-    bool ok = journalSocket->connect("/run/systemd/journal/socket");
-    // If FS is available, set ready and create dirs
-    fsReady = (kos::services::get_fs() != nullptr);
-    if (fsReady) {
-        ensureLogDir();
-        openLogFile();
-        if (pendingFlush) { Flush(); pendingFlush = false; }
-    } else {
-        pendingFlush = true;
-    }
+    bool ok = journalSocket->connect(JOURNAL_SOCKET_PATH);
+    // Lines logged before the filesystem is up stay queued until FS_READY
+    fsReady = (kos::fs::g_fs_ptr != nullptr);
     log("JournalService started");
     return ok;
 }
@@ -57,45 +72,28 @@ void JournalService::Stop() {
         delete journalSocket;
         journalSocket = nullptr;
     }
-    if (logFileFd >= 0) {
-        // Close log file (pseudo code, replace with your FS API)
-        // fs_close(logFileFd);
-        logFileFd = -1;
-    }
+    Flush();
 }
 
 void JournalService::log(const char* message) {
     if (!message) return;
-    if (logCount < LOG_BUFFER_SIZE) {
-        kos::lib::String::strncpy((int8_t*)logBuffer[logCount], (const int8_t*)message, LOG_ENTRY_SIZE - 1);
-        logBuffer[logCount][LOG_ENTRY_SIZE - 1] = 0;
-        ++logCount;
-    }
     sendToSocket(message);
-    persistLog(message);
+    enqueue(message);
 }
 
 void JournalService::Flush() {
-    for (int i = 0; i < logCount; ++i) {
-        persistLog(logBuffer[i]);
+    // IF clear means an interrupt handler (a text-mode shell command, say)
+    // that may have interrupted the filesystem itself
+    if (!InterruptsEnabled()) {
+        kick(true);
+        return;
     }
+    commit();
 }
 
 void JournalService::Rotate() {
-    // Simple rotation: append sequence number into rotated file name
-    ++logSeq;
-    char rotated[64];
-    // /var/log/system.log.N
-    const char* base = "/var/log/system.log";
-    int bi=0; for (; base[bi] && bi < (int)sizeof(rotated)-1; ++bi) rotated[bi] = base[bi];
-    rotated[bi++]='.';
-    // convert seq to decimal
-    uint32_t n = logSeq; char rev[16]; int ri=0; if(n==0){rev[ri++]='0';} while(n && ri<16){ rev[ri++]=char('0'+(n%10)); n/=10; }
-    while(ri) rotated[bi++] = rev[--ri];
-    rotated[bi]=0;
-    // For simplicity, we just write a rotation marker line to new file and continue writing there
-    openLogFile(); // reopen (placeholder; current fs API doesn't maintain file descriptors)
-    writeRaw("--- log rotated ---");
+    rotateRequested = true;
+    kick(true);
 }
 
 // setupSocket and closeSocket are now handled by the Socket class
@@ -108,46 +106,255 @@ void JournalService::sendToSocket(const char* message) {
 
 void JournalService::readFromSocket() {
     if (!journalSocket || journalSocket->getFd() < 0) return;
-    char buf[LOG_ENTRY_SIZE];
+    char buf[LINE_MAX + 1];
     // If recv is not implemented, use a stub or available method
-    // int bytes = journalSocket->recv(buf, LOG_ENTRY_SIZE - 1);
+    // int bytes = journalSocket->recv(buf, LINE_MAX);
     // For now, simulate no data read:
     int bytes = 0;
-    // If you have a Filesystem or other API to read from socket, use it here
     if (bytes > 0) {
         buf[bytes] = '\0';
-        persistLog(buf);
+        enqueue(buf);
     }
 }
 
-void JournalService::persistLog(const char* message) {
-    if (!message) return;
-    if (kos::services::get_fs()) {
-        fsReady = true;
+void JournalService::enqueue(const char* message) {
+    uint32_t len = String::strlen((const int8_t*)message);
+    if (len > LINE_MAX) len = LINE_MAX;
+    uint32_t need = len + 1;
+    bool waiting = false;
+    uint32_t waitStart = 0;
+    for (;;) {
+        uint32_t flags = IrqSave();
+        uint32_t head = ringHead;
+        if (RING_BYTES - (head - ringTail) >= need) {
+            // Copy line and newline, splitting at the end of the ring
+            uint32_t at = head & (RING_BYTES - 1);
+            uint32_t first = RING_BYTES - at;
+            if (first > len) first = len;
+            String::memmove(ring + at, message, first);
+            String::memmove(ring, message + first, len - first);
+            ring[(head + len) & (RING_BYTES - 1)] = '\n';
+            if (head == ringTail) pendingSince = NowMs();
+            ringHead = head + need;
+            stats.accepted++;
+            bool full = ringHead - ringTail >= COMMIT_BYTES;
+            IrqRestore(flags);
+            kick(full);
+            return;
+        }
+        IrqRestore(flags);
+
+        if (!waiting) waitStart = NowMs();
+        if (!canWait(flags, waitStart)) break;
+        // Back-pressure: let the writer catch up before taking more
+        if (!waiting) {
+            waiting = true;
+            stats.waits++;
+        }
+        kick(true);
+        SchedulerAPI::YieldThread();
+    }
+    uint32_t flags = IrqSave();
+    stats.dropped++;
+    droppedUnreported++;
+    IrqRestore(flags);
+}
+
+bool JournalService::canWait(uint32_t irqFlags, uint32_t waitStart) const {
+    if (overflowPolicy != JOURNAL_OVERFLOW_WAIT) return false;
+    // Never from an interrupt handler or the writer itself, and only if a
+    // worker thread exists to drain the ring meanwhile
+    if (!(irqFlags & kos::arch::x86::hardware::cpu::EFLAGS_IF) || !fsReady) return false;
+    if (writerBusy && writerThread == SchedulerAPI::GetCurrentThreadId()) return false;
+    if (!g_system_workqueue || !g_system_workqueue->IsRunning()) return false;
+    return NowMs() - waitStart < WAIT_MAX_MS;
+}
+
+void JournalService::kick(bool now) {
+    if (!fsReady || !g_system_workqueue) return;
+    // Items already queued are left as they are, so repeated kicks are free
+    if (now) g_system_workqueue->QueueItem(&commitWork);
+    else g_system_workqueue->QueueDelayedItem(&timerWork, COMMIT_DELAY_MS);
+}
+
+void JournalService::WriterWork(void* arg) {
+    ((JournalService*)arg)->commit();
+}
+
+bool JournalService::commit() {
+    uint32_t flags = IrqSave();
+    bool busy = writerBusy;
+    writerBusy = true;
+    IrqRestore(flags);
+    if (busy) return false;
+    writerThread = SchedulerAPI::GetCurrentThreadId();
+    kos::fs::Filesystem* fs = kos::fs::g_fs_ptr;
+    if (!fsReady || !fs) {
+        writerBusy = false;
+        return false;
+    }
+    // Never wait on an operation or disk request this may have preempted;
+    // the lines stay queued for the next try
+    if (fs->IsBusy()) {
+        writerBusy = false;
+        kick(false);
+        return false;
+    }
+    if (!logDirReady) {
         ensureLogDir();
-        writeRaw(message);
-    } else {
-        pendingFlush = true;
+        logDirReady = true;
+    }
+
+    bool ok = true;
+    flags = IrqSave();
+    uint32_t dropped = droppedUnreported;
+    droppedUnreported = 0;
+    IrqRestore(flags);
+    if (dropped) {
+        // Leave a mark where lines are missing
+        char note[48] = "--- journal dropped ";
+        uint32_t n = 20;
+        n += FormatDec(dropped, note + n);
+        String::memmove(note + n, " lines ---\n", 11);
+        n += 11;
+        if (!appendFile((const uint8_t*)note, n)) {
+            ok = false;
+            flags = IrqSave();
+            droppedUnreported += dropped;
+            IrqRestore(flags);
+        }
+    }
+
+    // One batch: whatever producers had queued when the writer started;
+    // they keep adding behind it meanwhile
+    flags = IrqSave();
+    uint32_t tail = ringTail;
+    uint32_t head = ringHead;
+    uint32_t since = pendingSince;
+    IrqRestore(flags);
+    uint32_t batch = head - tail;
+    while (ok && tail != head) {
+        uint32_t at = tail & (RING_BYTES - 1);
+        uint32_t run = RING_BYTES - at;
+        if (run > head - tail) run = head - tail;
+        if (!appendFile(ring + at, run)) {
+            ok = false;
+            break;
+        }
+        tail += run;
+        ringTail = tail;
+    }
+
+    uint32_t now = NowMs();
+    if (batch && ok) {
+        stats.commits++;
+        stats.committed_bytes += batch;
+        if (batch > stats.max_batch_bytes) stats.max_batch_bytes = batch;
+        if (now - since > stats.max_lag_ms) stats.max_lag_ms = now - since;
+    }
+    flags = IrqSave();
+    // Lines queued during the writes are at most this old
+    if (ringHead != ringTail && ok) pendingSince = now;
+    bool more = ringHead != ringTail;
+    bool full = ringHead - ringTail >= COMMIT_BYTES;
+    IrqRestore(flags);
+
+    // Rotation goes after the batch so earlier lines stay in the old file
+    if (rotateRequested) {
+        rotateRequested = false;
+        rotateFile();
+    }
+    writerBusy = false;
+    // A failed write is retried on the timer rather than straight away
+    if (more) kick(full && ok);
+    return ok;
+}
+
+bool JournalService::appendFile(const uint8_t* data, uint32_t len) {
+    kos::fs::Filesystem* fs = kos::fs::g_fs_ptr;
+    if (!fs || fs->WriteFile((const int8_t*)LOG_PATH, data, len) != (int32_t)len) {
+        stats.write_errors++;
+        // The directory may be gone (e.g. a new volume); recreate it next time
+        logDirReady = false;
+        return false;
+    }
+    return true;
+}
+
+void JournalService::rotateFile() {
+    kos::fs::Filesystem* fs = kos::fs::g_fs_ptr;
+    if (!fs) return;
+    // 8.3 names only: /var/log/system.1 ... system.999, skipping taken ones
+    for (uint32_t tries = 0; tries < 999; ++tries) {
+        logSeq = logSeq % 999 + 1;
+        char rotated[24] = "/var/log/system.";
+        uint32_t n = 16;
+        n += FormatDec(logSeq, rotated + n);
+        rotated[n] = 0;
+        if (fs->Rename((const int8_t*)LOG_PATH, (const int8_t*)rotated) != 0) continue;
+        stats.rotations++;
+        const char* marker = "--- log rotated ---\n";
+        appendFile((const uint8_t*)marker, String::strlen((const int8_t*)marker));
+        return;
     }
 }
 
 void JournalService::ensureLogDir() {
-    auto fs = get_fs(); if (!fs) return;
+    auto fs = kos::fs::g_fs_ptr; if (!fs) return;
     // Minimal: attempt to create /var and /var/log (ignore failures)
     fs->Mkdir((const int8_t*)"/var", 1);
     fs->Mkdir((const int8_t*)"/var/log", 1);
 }
 
-void JournalService::openLogFile() {
-    // Placeholder: Filesystem lacks open/append; we emulate by appending via WriteFile writes.
+JournalStats JournalService::GetStats() const {
+    uint32_t flags = IrqSave();
+    JournalStats copy = stats;
+    copy.pending_bytes = ringHead - ringTail;
+    copy.lag_ms = copy.pending_bytes ? NowMs() - pendingSince : 0;
+    IrqRestore(flags);
+    return copy;
 }
 
-void JournalService::writeRaw(const char* line) {
-    auto fs = get_fs(); if (!fs) return;
-    fs->WriteFile((const int8_t*)"/var/log/system.log", (const uint8_t*)line, kos::lib::String::strlen(line));
-    fs->WriteFile((const int8_t*)"/var/log/system.log", (const uint8_t*)"\n", 1);
+void JournalService::PrintStats() const {
+    JournalStats s = GetStats();
+    TTY::Write("=== Journal ===\n");
+    TTY::Write("accepted=");
+    WriteDec(s.accepted);
+    TTY::Write(" dropped=");
+    WriteDec(s.dropped);
+    TTY::Write(" waits=");
+    WriteDec(s.waits);
+    TTY::Write(" policy=");
+    TTY::Write(overflowPolicy == JOURNAL_OVERFLOW_WAIT ? "wait" : "drop");
+    TTY::Write("\ncommits=");
+    WriteDec(s.commits);
+    TTY::Write(" bytes=");
+    WriteDec(s.committed_bytes);
+    TTY::Write(" avg_batch=");
+    WriteDec(s.commits ? s.committed_bytes / s.commits : 0);
+    TTY::Write(" max_batch=");
+    WriteDec(s.max_batch_bytes);
+    TTY::Write(" errors=");
+    WriteDec(s.write_errors);
+    TTY::Write(" rotations=");
+    WriteDec(s.rotations);
+    TTY::Write("\npending=");
+    WriteDec(s.pending_bytes);
+    TTY::Write("/");
+    WriteDec(RING_BYTES);
+    TTY::Write(" lag=");
+    WriteDec(s.lag_ms);
+    TTY::Write("ms max_lag=");
+    WriteDec(s.max_lag_ms);
+    TTY::Write("ms");
+    if (!fsReady) TTY::Write(" (waiting for filesystem)");
+    TTY::Write("\n");
 }
 
-void JournalService::Tick() {
-    readFromSocket();
+void JournalService::OnEvent(const ServiceEvent& ev) {
+    if (ev.type != SERVICE_EVENT_FS_READY) return;
+    fsReady = true;
+    logDirReady = false;
+    // Events may be dispatched from the timer interrupt; the writer does the I/O
+    kick(true);
 }
@@ -5,6 +5,7 @@
 #include "include/net/rx_dispatch.hpp"
 #include <memory/heap.hpp>
 #include <process/thread_manager.hpp>
+#include <process/workqueue.hpp>
 #include <net/ipv4.hpp>
 #include <net/interface.hpp>
 #include "include/net/nic.hpp"
@@ -291,28 +292,22 @@ bool NetworkManagerService::Start() {
     // Without a NIC driver/stack we cannot actually bring up a link; report capability
     Logger::Log("NetworkManager: NOTE: NIC driver and TCP/IP stack not present yet; internet connectivity not available");
 
-    // Spawn a lightweight worker thread so service is visible in 'top'
-    if (threadId_ == 0 && kos::process::g_thread_manager) {
-        s_self = this;
-        threadId_ = kos::process::ThreadManagerAPI::CreateSystemThread((void*)worker_trampoline,
-                        kos::process::THREAD_SYSTEM_SERVICE, 2048, kos::process::PRIORITY_LOW, "networkd");
-        if (threadId_) Logger::LogKV("NetworkManager: worker thread", "started");
+    // Drain the NIC RX ring from the high-priority work queue, independent of
+    // the UI frame rate. Items queued now run once the workers start.
+    if (!s_rx_work.queued && g_highpri_workqueue) {
+        s_rx_work.fn = rx_poll_work;
+        if (g_highpri_workqueue->QueueItem(&s_rx_work)) Logger::LogKV("NetworkManager: RX polling", "kworker-hi");
     }
     return true;
 }
 
 // Static members
-NetworkManagerService* NetworkManagerService::s_self = nullptr;
-
-void NetworkManagerService::worker_trampoline() {
-    // Network service worker: polls RX and monitors link status
-    for (;;) {
-        // Poll E1000 RX ring for incoming packets
-        e1000_rx_poll();
-        
-        // Sleep to avoid busy-waiting
-        SchedulerAPI::SleepThread(10); // Poll every 10ms
-    }
+WorkItem NetworkManagerService::s_rx_work;
+
+void NetworkManagerService::rx_poll_work(void*) {
+    // Poll E1000 RX ring for incoming packets, then re-arm for the next tick
+    e1000_rx_poll();
+    if (g_highpri_workqueue) g_highpri_workqueue->QueueDelayedItem(&s_rx_work, RX_POLL_INTERVAL_MS);
 }
 
 
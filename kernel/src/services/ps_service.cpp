@@ -4,42 +4,93 @@
 #include <process/scheduler.hpp>
 #include <lib/string.hpp>
 #include <lib/stdio.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
 
 
 using namespace kos::process;
 using namespace kos::lib;
 using namespace kos::sys;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
 
 extern Scheduler* g_scheduler;
 
+// Row format: "<pid> <state> <prio> <ticks> <name> <run_ms> <wait_ms> <vol> <invol>".
+// The trailing fields come from TSC accounting and read 0 until the
+// scheduler has calibrated the TSC. After the rows, one line per priority:
+// "# LAT <prio> <samples> <max_us> <b0> ... <b15>" (log2-microsecond buckets),
+// preceded by one "# DL" line per deadline-class thread.
 extern "C" int ps_service_getinfo(char* buffer, int maxlen) {
     if (!buffer || maxlen <= 0) return 0;
     int written = 0;
-    auto write_line = [&](uint32_t pid, const char* state, uint32_t prio, uint32_t time, const char* name) {
-        const char* nm = name ? name : "unnamed";
-        int n = snprintf(buffer + written, (maxlen - written > 0) ? maxlen - written : 0,
-                         "%u %s %u %u %s\n", pid, state, prio, time, nm);
+    Scheduler* sched = kos::process::g_scheduler;
+    auto append = [&](const char* fmt, auto... args) {
+        int n = snprintf(buffer + written, (maxlen - written > 0) ? maxlen - written : 0, fmt, args...);
         if (n > 0) written += n;
     };
-    if (!kos::process::g_scheduler) {
+    auto write_line = [&](Thread* t, const char* state) {
+        const char* nm = t->GetName() ? t->GetName() : "unnamed";
+        append("%u %s %u %u %s %u %u %u %u\n", t->GetId(), state, (uint32_t)t->GetPriority(),
+               t->GetTotalRuntime(), nm,
+               sched->CyclesToMilliseconds(sched->GetRunCycles(t)),
+               sched->CyclesToMilliseconds(t->GetWaitCycles()),
+               t->GetVoluntarySwitches(), t->GetInvoluntarySwitches());
+    };
+    if (!sched) {
         return snprintf(buffer, maxlen, "No scheduler available\n");
     }
     // Note: header is printed by the 'top' app. Here we output only data rows.
-    Thread* current = kos::process::g_scheduler->GetCurrentTask();
+    Thread* current = sched->GetCurrentTask();
     if (current) {
-        write_line(current->GetId(), "RUNNING", current->GetPriority(), current->GetTotalRuntime(), current->GetName());
+        write_line(current, "RUNNING");
+    }
+    for (Thread* t = sched->GetDeadlineQueue(); t; t = t->next) {
+        write_line(t, "READY");
+    }
+    for (Thread* t = sched->GetThrottledTasks(); t; t = t->next) {
+        write_line(t, "THROTTLE");
+    }
+    // The fair heap is an array that a wakeup from an interrupt can grow
+    // (free and replace) or reorder, so copy it with interrupts masked
+    Thread* fair[64];
+    uint32_t fair_count = 0;
+    uint32_t flags = IrqSave();
+    while (fair_count < 64 && fair_count < sched->GetFairTaskCount()) {
+        fair[fair_count] = sched->GetFairTask(fair_count);
+        fair_count++;
+    }
+    IrqRestore(flags);
+    for (uint32_t i = 0; i < fair_count; i++) {
+        write_line(fair[i], "READY");
     }
     for (int prio = 0; prio < 5; prio++) {
-        Thread* t = kos::process::g_scheduler->GetReadyQueue(prio);
+        Thread* t = sched->GetReadyQueue(prio);
         while (t) {
-            write_line(t->GetId(), "READY", t->GetPriority(), t->GetTotalRuntime(), t->GetName());
+            write_line(t, "READY");
             t = t->next;
         }
     }
-    Thread* s = kos::process::g_scheduler->GetSleepingTasks();
+    Thread* s = sched->GetSleepingTasks();
     while (s) {
-        write_line(s->GetId(), "SLEEPING", s->GetPriority(), s->GetTotalRuntime(), s->GetName());
+        write_line(s, "SLEEPING");
         s = s->next;
     }
+    // Deadline-class threads: "# DL <pid> <period_ticks> <budget_ticks> <misses>"
+    auto dl_line = [&](Thread* t) {
+        if (t->GetSchedClass() != SCHED_CLASS_DEADLINE) return;
+        append("# DL %u %u %u %u\n", t->GetId(), t->dl_period, t->dl_budget, t->GetDeadlineMisses());
+    };
+    if (current) dl_line(current);
+    for (Thread* t = sched->GetDeadlineQueue(); t; t = t->next) dl_line(t);
+    for (Thread* t = sched->GetThrottledTasks(); t; t = t->next) dl_line(t);
+    for (Thread* t = sched->GetSleepingTasks(); t; t = t->next) dl_line(t);
+    for (int prio = 0; prio < 5; prio++) {
+        append("# LAT %u %u %u", (uint32_t)prio, sched->GetWakeLatencySamples(prio),
+               sched->GetWakeLatencyMaxMicroseconds(prio));
+        for (int b = 0; b < Scheduler::LATENCY_BUCKETS; b++) {
+            append(" %u", sched->GetWakeLatencyBucket(prio, b));
+        }
+        append("\n");
+    }
     return written;
 }
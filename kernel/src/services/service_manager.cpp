@@ -13,18 +13,44 @@
 #include <process/timer.hpp>
 #include <common/types.hpp>
 #include <lib/serial.hpp>
+#include <lib/stdio.hpp>
+#include <console/tty.hpp>
+#include <process/scheduler.hpp>
+#include <process/workqueue.hpp>
+#include <arch/x86/hardware/cpu/cpu.hpp>
+#include <arch/x86/hardware/cpu/irq.hpp>
 
 using namespace kos::console;
 using namespace kos::fs;
 using namespace kos::lib;
 using namespace kos::memory;
 using namespace kos::services;
+using kos::sys::snprintf;
+using kos::arch::x86::hardware::cpu::cpu;
+using kos::arch::x86::hardware::cpu::IrqSave;
+using kos::arch::x86::hardware::cpu::IrqRestore;
+
+namespace {
+    // Upper bound on an idle event-loop sleep; keeps the loop alive if a
+    // wakeup is ever lost and while the uptime clock is not running yet
+    const uint32_t MAX_IDLE_WAIT_MS = 1000;
+    // Work queues drained from the loop (no worker yet) need a pass every tick
+    const uint32_t INLINE_DRAIN_WAIT_MS = 10;
+    // Deadline reservation for the manager thread: one tick in every 30 ms
+    // keeps a ~33 Hz render loop on time under CPU-bound load
+    const uint32_t EVENT_LOOP_PERIOD_MS = 30;
+    const uint32_t EVENT_LOOP_BUDGET_MS = 10;
+
+    bool s_has_tsc = false;
+
+    inline uint64_t ReadCycles() { return s_has_tsc ? cpu::ReadTSC() : 0; }
+}
 
 // Global pointer to the registered JournalService instance
 static JournalService* g_journal_service = nullptr;
 
 // Accessor for JournalService
-JournalService* GetJournalService() { return g_journal_service; }
+JournalService* kos::services::GetJournalService() { return g_journal_service; }
 
 // Logger forwarding functions for journald-like logging
 extern "C" void LogToJournal(const char* message) {
@@ -75,8 +101,13 @@ static void strtolower(char* s) {
 
 // Static member definitions for ServiceManager
 ServiceNode* ServiceManager::s_head = nullptr;
+kos::process::SeqLock ServiceManager::s_list_lock;
 bool ServiceManager::s_debugCfg = false;
 uint32_t ServiceManager::s_boot_ms = 0;
+volatile uint32_t ServiceManager::s_event_mask = 0;
+volatile bool ServiceManager::s_events_pending = false;
+volatile uint32_t ServiceManager::s_loop_tid = 0;
+volatile bool ServiceManager::s_loop_running = false;
 
 // Register built-in services here
 static void RegisterBuiltinServices() {
@@ -157,9 +188,12 @@ void ServiceManager::ApplyConfig() {
                 int i = 0; for (; nm[i] && i < 63; ++i) { tmp[i] = nm[i]; }
                 tmp[i] = 0; strtolower(tmp);
                 if (String::strcmp((const uint8_t*)tmp, (const uint8_t*)svcname) == 0) {
-                    node->enabled = (String::strcmp((const char*)val, "on") == 0 ||
-                                     String::strcmp((const char*)val, "true") == 0 ||
-                                     String::strcmp((const char*)val, "1") == 0);
+                    bool on = (String::strcmp((const char*)val, "on") == 0 ||
+                               String::strcmp((const char*)val, "true") == 0 ||
+                               String::strcmp((const char*)val, "1") == 0);
+                    s_list_lock.WriteLock();
+                    node->enabled = on;
+                    s_list_lock.WriteUnlock();
                     break;
                 }
                 node = node->next;
@@ -185,6 +219,7 @@ uint32_t ServiceManager::UptimeMs() {
 
 void ServiceManager::InitAndStart() {
     Logger::Log("ServiceManager: applying configuration");
+    s_has_tsc = cpu::HasTSC();
     RegisterBuiltinServices();
     ApplyConfig();
     if (s_debugCfg) Logger::SetDebugEnabled(true);
@@ -193,7 +228,9 @@ void ServiceManager::InitAndStart() {
     while (node) {
         if (node->enabled) {
             Logger::LogKV("Starting service", node->svc->Name());
+            uint64_t start = ReadCycles();
             bool ok = node->svc->Start();
+            node->busy_cycles += ReadCycles() - start;
             Logger::LogStatus("Service start", ok);
         } else {
             Logger::LogKV("Service disabled", node->svc->Name());
@@ -202,55 +239,139 @@ void ServiceManager::InitAndStart() {
     }
 }
 
-void ServiceManager::TickAll() {
+void ServiceManager::PostEvent(ServiceEventType type, uint32_t data) {
+    if ((uint32_t)type >= SERVICE_EVENT_COUNT) return;
+    uint32_t bit = ServiceEventBit(type);
+    if (!(s_event_mask & bit)) return; // Nobody listens; the common case for NET_RX
+
+    bool posted = false;
+    uint32_t flags = IrqSave();
+    for (ServiceNode* node = s_head; node; node = node->next) {
+        if (!node->enabled || !(node->event_mask & bit)) continue;
+        node->pending |= bit;
+        node->pending_data[type] = data;
+        node->pending_count[type]++;
+        posted = true;
+    }
+    if (posted) {
+        s_events_pending = true;
+        if (s_loop_tid) SchedulerAPI::WakeThread(s_loop_tid);
+    }
+    IrqRestore(flags);
+}
+
+void ServiceManager::Deliver(ServiceNode* node, const ServiceEvent& ev) {
+    // Wall time around the handler; includes any preemption while it runs
+    uint64_t start = ReadCycles();
+    node->svc->OnEvent(ev);
+    node->busy_cycles += ReadCycles() - start;
+    node->events++;
+}
+
+uint32_t ServiceManager::DispatchEvents() {
+    // Clear first: anything posted from here on forces another pass
+    s_events_pending = false;
     uint32_t now = UptimeMs();
-    ServiceNode* node = s_head;
-    while (node) {
-        if (node->enabled) {
-            uint32_t interval = node->svc->TickIntervalMs();
-            // Services with interval=0 don't want periodic ticking
-            if (interval == 0) {
-                // Skip periodic ticking for services that don't want it
-            } else {
-                // Always tick if this is the first tick, while timer is not ready,
-                // or when enough time passed per service interval.
-                bool firstTick = (node->last_tick_ms == 0);
-                bool timerNotReady = (now == 0);
-                bool intervalElapsed = (now >= node->last_tick_ms && (now - node->last_tick_ms) >= interval);
-                
-                if (firstTick || timerNotReady || intervalElapsed) {
-                    node->svc->Tick();
-                    // Keep last_tick_ms at 0 until timer becomes valid; otherwise
-                    // services can get stuck forever if startup happens before timer updates.
-                    if (now > 0) {
-                        node->last_tick_ms = now;
-                    }
-                }
+    uint32_t wait = NO_TIMER;
+    for (ServiceNode* node = s_head; node; node = node->next) {
+        if (!node->enabled) continue;
+
+        if (node->pending) {
+            ServiceEvent events[SERVICE_EVENT_COUNT];
+            uint32_t n = 0;
+            uint32_t flags = IrqSave();
+            for (uint32_t t = 0; t < SERVICE_EVENT_COUNT; ++t) {
+                if (!(node->pending & (1u << t))) continue;
+                events[n].type = (ServiceEventType)t;
+                events[n].data = node->pending_data[t];
+                events[n].count = node->pending_count[t];
+                node->pending_count[t] = 0;
+                n++;
             }
+            node->pending = 0;
+            IrqRestore(flags);
+            for (uint32_t i = 0; i < n; ++i) Deliver(node, events[i]);
         }
-        node = node->next;
+
+        // Services with interval=0 get no timer events
+        uint32_t interval = node->svc->TickIntervalMs();
+        if (interval == 0) continue;
+
+        // Always fire on the first pass and while the timer is not ready;
+        // last_tick_ms stays 0 until the clock runs so nobody gets stuck.
+        uint32_t elapsed = now - node->last_tick_ms;
+        if (node->last_tick_ms == 0 || now == 0 || elapsed >= interval) {
+            // A whole period slipped by: the service missed a frame/deadline
+            if (node->last_tick_ms != 0 && now != 0 && elapsed >= 2 * interval) node->late_timers++;
+            ServiceEvent ev;
+            ev.type = SERVICE_EVENT_TIMER;
+            ev.data = now;
+            ev.count = 1;
+            Deliver(node, ev);
+            if (now > 0) node->last_tick_ms = now;
+            elapsed = 0;
+        }
+        uint32_t left = interval - elapsed;
+        if (left < wait) wait = left;
     }
+    return wait;
 }
 
-bool ServiceManager::IsEnabled(const char* name) {
-    ServiceNode* node = s_head;
-    while (node) {
-        if (String::strcmp((const uint8_t*)node->svc->Name(), (const uint8_t*)name) == 0) return node->enabled;
-        node = node->next;
+void ServiceManager::RunEventLoop() {
+    s_loop_tid = SchedulerAPI::GetCurrentThreadId();
+    s_loop_running = true;
+    Logger::Log("ServiceManager event loop running");
+    while (true) {
+        uint32_t wait = DispatchEvents();
+        if (kos::process::WorkQueueAPI::DrainInline(true) && wait > INLINE_DRAIN_WAIT_MS) {
+            wait = INLINE_DRAIN_WAIT_MS;
+        }
+        if (wait > MAX_IDLE_WAIT_MS) wait = MAX_IDLE_WAIT_MS;
+        if (wait == 0) wait = 1;
+        // Check and sleep with IRQs masked so a post cannot slip in between
+        uint32_t flags = IrqSave();
+        if (!s_events_pending) SchedulerAPI::SleepThread(wait);
+        IrqRestore(flags);
     }
-    return false;
 }
 
-// Background thread to drive TickAll periodically
-static void service_manager_thread() {
-    Logger::Log("ServiceManager thread running");
-    while (true) {
-        ServiceManager::TickAll();
-        // Use a short sleep to allow responsive ticking (services control their own rate via TickIntervalMs)
-        SchedulerAPI::SleepThread(16); // ~60 Hz base rate, individual services throttle themselves
+void ServiceManager::PrintStats() {
+    TTY::Write("=== Services ===\n");
+    Scheduler* sched = kos::process::g_scheduler;
+    char line[128];
+    for (ServiceNode* node = s_head; node; node = node->next) {
+        uint32_t cpu_us = sched ? (uint32_t)sched->CyclesToMicroseconds(node->busy_cycles) : 0;
+        snprintf(line, sizeof(line), "%s: %s events=%u cpu_us=%u timer=%ums late=%u mask=0x%x\n",
+                 node->svc->Name(), node->enabled ? "on" : "off", node->events, cpu_us,
+                 node->svc->TickIntervalMs(), node->late_timers, node->event_mask);
+        TTY::Write(line);
     }
 }
 
+bool ServiceManager::IsEnabled(const char* name) {
+    // Called on every journal write; readers never wait on Register()/ApplyConfig()
+    bool enabled;
+    uint32_t seq;
+    do {
+        seq = s_list_lock.ReadBegin();
+        enabled = false;
+        ServiceNode* node = s_head;
+        while (node) {
+            if (String::strcmp((const uint8_t*)node->svc->Name(), (const uint8_t*)name) == 0) {
+                enabled = node->enabled;
+                break;
+            }
+            node = node->next;
+        }
+    } while (s_list_lock.ReadRetry(seq));
+    return enabled;
+}
+
+// Background thread hosting the service event loop
+static void service_manager_thread() {
+    ServiceManager::RunEventLoop();
+}
+
 // Implement the public API in the proper namespace as declared in the header
 namespace kos { namespace services { namespace ServiceAPI {
     bool StartManagerThread() {
@@ -269,6 +390,9 @@ namespace kos { namespace services { namespace ServiceAPI {
         }
         s_started = true;
         Logger::Log("ServiceManager: manager thread created");
+        if (!SchedulerAPI::SetThreadDeadline(s_tid, EVENT_LOOP_PERIOD_MS, EVENT_LOOP_BUDGET_MS)) {
+            Logger::Log("ServiceManager: deadline reservation refused; using priority class");
+        }
         return true;
     }
 } } }
@@ -282,8 +406,20 @@ void ServiceManager::Register(IService* service) {
     node->svc = service;
     node->enabled = service->DefaultEnabled();
     node->last_tick_ms = 0;
+    node->event_mask = service->EventMask();
+    node->pending = 0;
+    for (uint32_t t = 0; t < SERVICE_EVENT_COUNT; ++t) {
+        node->pending_data[t] = 0;
+        node->pending_count[t] = 0;
+    }
+    node->events = 0;
+    node->late_timers = 0;
+    node->busy_cycles = 0;
+    s_list_lock.WriteLock();
     node->next = s_head;
     s_head = node;
+    s_event_mask = s_event_mask | node->event_mask;
+    s_list_lock.WriteUnlock();
 }
 
 
@@ -8,6 +8,10 @@ using namespace kos::arch::x86::hardware::rtc;
 namespace kos { 
     namespace services {
 
+uint32_t TimeService::TickIntervalMs() const {
+    return Logger::IsDebugEnabled() ? 1000 : 0;
+}
+
 void TimeService::Tick() {
     if (!Logger::IsDebugEnabled()) return;
     DateTime dt; RTC::Read(dt);
@@ -20,8 +20,8 @@
 #include <drivers/ps2/ps2.hpp>
 #include <lib/serial.hpp>
 #include <lib/stdio.hpp>
-#include <drivers/net/e1000/e1000_poll.h>
 #include <drivers/gpu/vmsvga.hpp>
+#include <drivers/block_cache.hpp>
 #include <process/thread_manager.hpp>
 #include <process/scheduler.hpp>
 #include <fs/filesystem.hpp>
@@ -534,6 +534,8 @@ static constexpr uint32_t kTaskButtonW = 120;
 static constexpr uint32_t kTaskButtonH = 18;
 
 static void TaskbarRebootSystem() {
+    if (kos::fs::g_fs_ptr) kos::fs::g_fs_ptr->Sync();
+    kos::drivers::BlockCacheAPI::SyncAll();
     if (app_reboot) {
         app_reboot();
         return;
@@ -556,6 +558,8 @@ static void TaskbarRebootSystem() {
 }
 
 static void TaskbarShutdownSystem() {
+    if (kos::fs::g_fs_ptr) kos::fs::g_fs_ptr->Sync();
+    kos::drivers::BlockCacheAPI::SyncAll();
     if (app_shutdown) {
         app_shutdown();
         return;
@@ -1002,9 +1006,7 @@ bool WindowManager::Start() {
 }
 
 void WindowManager::Tick() {
-    // Poll E1000 for received packets
-    e1000_rx_poll();
-    
+    // NIC RX is drained by NetworkManager's work item on kworker-hi, not per frame
     if (!kos::gfx::IsAvailable()) return;
     // Keep work area in sync with current resolution/panel reservation.
     {
@@ -31,12 +31,8 @@ void ProcessViewer::RefreshProcessList() {
     
     s_process_count = 0;
     
-    // Get thread entries from thread manager
-    // We need to iterate through all registered threads
-    ThreadEntry* current = nullptr;
-    
-    // Access the thread registry (we'll need to add a public accessor method)
-    // For now, we can use the global scheduler to get basic thread info
+    // List every scheduler task, registered or not; the thread registry
+    // only supplies the pid, under its shared lock
     if (g_scheduler) {
         // Index through known task slots
         for (uint32_t i = 0; i < MAX_PROCESSES && s_process_count < MAX_PROCESSES; i++) {
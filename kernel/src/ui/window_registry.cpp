@@ -13,13 +13,17 @@ uint32_t WindowRegistry::RegisterComponent(IUIComponent* component, uint32_t win
         return 0;  // Invalid
     }
     
+    lock_.WriteLock();
+    
     if (num_components_ >= MAX_WINDOWS) {
+        lock_.WriteUnlock();
         return 0;  // Registry full
     }
     
     // Check for duplicate window ID
     for (uint32_t i = 0; i < num_components_; ++i) {
         if (component_ids_[i] == window_id) {
+            lock_.WriteUnlock();
             return 0;  // Already registered
         }
     }
@@ -28,10 +32,12 @@ uint32_t WindowRegistry::RegisterComponent(IUIComponent* component, uint32_t win
     component_ids_[num_components_] = window_id;
     ++num_components_;
     
+    lock_.WriteUnlock();
     return window_id;
 }
 
 bool WindowRegistry::UnregisterComponent(uint32_t window_id) {
+    lock_.WriteLock();
     for (uint32_t i = 0; i < num_components_; ++i) {
         if (component_ids_[i] == window_id) {
             // Shift remaining components
@@ -40,27 +46,39 @@ bool WindowRegistry::UnregisterComponent(uint32_t window_id) {
                 component_ids_[j] = component_ids_[j + 1];
             }
             --num_components_;
+            lock_.WriteUnlock();
             return true;
         }
     }
+    lock_.WriteUnlock();
     return false;
 }
 
 IUIComponent* WindowRegistry::GetComponent(uint32_t window_id) const {
-    for (uint32_t i = 0; i < num_components_; ++i) {
-        if (component_ids_[i] == window_id) {
-            return components_[i];
+    IUIComponent* found;
+    uint32_t seq;
+    do {
+        seq = lock_.ReadBegin();
+        found = nullptr;
+        uint32_t count = num_components_;
+        for (uint32_t i = 0; i < count && i < MAX_WINDOWS; ++i) {
+            if (component_ids_[i] == window_id) {
+                found = components_[i];
+                break;
+            }
         }
-    }
-    return nullptr;
+    } while (lock_.ReadRetry(seq));
+    return found;
 }
 
 void WindowRegistry::Clear() {
+    lock_.WriteLock();
     for (uint32_t i = 0; i < num_components_; ++i) {
         components_[i] = nullptr;
         component_ids_[i] = 0;
     }
     num_components_ = 0;
+    lock_.WriteUnlock();
 }
 
 }}  // namespace kos::ui
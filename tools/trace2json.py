@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Extract scheduler traces from a KOS serial log as Chrome Trace Event JSON.
+
+The kernel's `trace dump` shell command writes the trace between
+"=== KOS TRACE BEGIN ===" and "=== KOS TRACE END ===" lines, one event
+per line. This script pulls a dump out of the surrounding log noise and
+writes a file that Perfetto (ui.perfetto.dev) or chrome://tracing can open.
+"""
+import argparse
+import json
+import sys
+
+BEGIN = '=== KOS TRACE BEGIN ==='
+END = '=== KOS TRACE END ==='
+
+
+def find_dumps(lines):
+    """Yield the body lines of every complete dump in the log."""
+    body = None
+    for line in lines:
+        if BEGIN in line:
+            body = []
+            continue
+        if END in line:
+            if body is not None:
+                yield body
+            body = None
+            continue
+        if body is not None:
+            body.append(line)
+
+
+def salvage(body):
+    """Parse event by event when the dump as a whole is not valid JSON.
+
+    Serial output can drop or garble characters; keep every event line that
+    still parses instead of losing the whole trace.
+    """
+    events = []
+    bad = 0
+    for line in body:
+        line = line.strip().rstrip(',')
+        if not line.startswith('{"ph"'):
+            continue
+        try:
+            events.append(json.loads(line))
+        except ValueError:
+            bad += 1
+    return {'displayTimeUnit': 'ns', 'traceEvents': events}, bad
+
+
+def convert(body):
+    text = '\n'.join(body)
+    try:
+        return json.loads(text), 0
+    except ValueError:
+        return salvage(body)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument('log', nargs='?', help='serial log file (default: stdin)')
+    ap.add_argument('-o', '--output', default='kos-trace.json', help='output JSON file')
+    ap.add_argument('-n', '--index', type=int, default=-1,
+                    help='which dump to extract when the log has several (default: last)')
+    args = ap.parse_args()
+
+    if args.log:
+        with open(args.log, 'r', encoding='utf-8', errors='replace') as f:
+            raw = f.read()
+    else:
+        raw = sys.stdin.read()
+    # The kernel writes CRLF on serial; QEMU logs keep the CR
+    lines = raw.replace('\r', '').split('\n')
+
+    dumps = list(find_dumps(lines))
+    if not dumps:
+        print('no trace dump found (run `trace start`, then `trace dump`)', file=sys.stderr)
+        return 1
+    try:
+        body = dumps[args.index]
+    except IndexError:
+        print(f'log has {len(dumps)} dump(s); index {args.index} out of range', file=sys.stderr)
+        return 1
+
+    trace, bad = convert(body)
+    with open(args.output, 'w', encoding='utf-8') as f:
+        json.dump(trace, f)
+    count = len(trace.get('traceEvents', []))
+    print(f'wrote {count} events to {args.output}' + (f' ({bad} corrupt lines skipped)' if bad else ''))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())